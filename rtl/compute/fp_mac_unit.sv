@@ -0,0 +1,89 @@
+//-----------------------------------------------------------------------------
+// Module: fp_mac_unit
+// Description: Multiply-Accumulate Unit for BF16/FP16/FP8 operations
+//              Performs: output = input * weight + accumulator (FP32)
+//              2-stage pipeline like mac_unit:
+//                Stage 1: Multiplication (exact, fp_mul) -> mult_reg
+//                Stage 2: Accumulation (fp32_add, RNE)   -> acc_reg
+//              Latency: 2 cycles from enable to acc_reg update
+//              fmt selects the operand encoding (fp_pkg FMT_BF16/FMT_FP16);
+//              FMT_FP8 reads data_in/weight_in as two FP8 lanes and
+//              registers the MX-scaled sum of both products (fp8_pair)
+//-----------------------------------------------------------------------------
+
+module fp_mac_unit
+    import fp_pkg::*;
+(
+    input  logic                      clk,
+    input  logic                      rst_n,
+
+    // Control signals
+    input  logic                      enable,
+    input  logic                      clear_acc,   // Clear accumulator
+    input  logic [1:0]                fmt,
+    input  logic                      fp8_e5m2,    // FP8: E5M2 (else E4M3)
+    input  logic [7:0]                w_scale,     // FP8: MX E8M0 scales
+    input  logic [7:0]                x_scale,
+
+    // Data inputs
+    input  logic [15:0]               data_in,     // Input activation
+    input  logic [15:0]               weight_in,   // Weight value
+
+    // Data output
+    output logic [31:0]               data_out,    // Accumulated result (FP32)
+    output logic                      valid_out    // Accumulator updated
+);
+
+    //-------------------------------------------------------------------------
+    // Internal Signals
+    //-------------------------------------------------------------------------
+    // Pipeline Stage 1: Multiplication register (FP32)
+    logic [31:0]                      mult_reg;
+    logic                             enable_d1;
+
+    // Pipeline Stage 2: Accumulator (FP32)
+    logic [31:0]                      acc_reg;
+
+    //-------------------------------------------------------------------------
+    // Pipeline Stage 1: Register multiplication result
+    //-------------------------------------------------------------------------
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            mult_reg  <= '0;
+            enable_d1 <= 1'b0;
+        end else if (clear_acc) begin
+            mult_reg  <= '0;
+            enable_d1 <= 1'b0;
+        end else begin
+            enable_d1 <= enable;
+            if (enable) begin
+                mult_reg <= (fmt == FMT_FP8) ? fp8_pair(data_in, weight_in, fp8_e5m2, w_scale, x_scale)
+                                             : fp_mul(data_in, weight_in, fmt);
+            end
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Pipeline Stage 2: Accumulator Register
+    //-------------------------------------------------------------------------
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            acc_reg   <= '0;
+            valid_out <= 1'b0;
+        end else if (clear_acc) begin
+            acc_reg   <= '0;
+            valid_out <= 1'b0;
+        end else begin
+            valid_out <= enable_d1;
+            if (enable_d1) begin
+                acc_reg <= fp32_add(acc_reg, mult_reg);
+            end
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Output Assignment
+    //-------------------------------------------------------------------------
+    assign data_out = acc_reg;
+
+endmodule
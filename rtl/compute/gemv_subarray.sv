@@ -5,14 +5,51 @@
 //              - Weight matrix: 32 rows x 8 cols
 //              - Input vector: 8 elements
 //              - Output vector: 32 elements
+//              load_acc restores a saved output vector (preemption
+//              context): row r's sum goes into its column-0 accumulator,
+//              the other columns restart from 0, so the row sums continue
+//              from acc_in
+//              Accumulator width from MAX_K (guard bits, ref_acc_bits() in
+//              sw/ref): a sum of up to MAX_K INT8 products is bounded by
+//              MAX_K * (-128 * -128) and needs INPUT_WIDTH + WEIGHT_WIDTH
+//              - 1 + clog2(MAX_K + 1) bits. Column c only sees every
+//              SUBARRAY_COLS-th product, so columns 1..7 are sized for
+//              ceil(MAX_K / SUBARRAY_COLS) products; column 0 also holds
+//              a restored row sum and keeps the full ACC_WIDTH, as does
+//              the row adder. output_vector is sign-extended to
+//              OUTPUT_WIDTH (buffer/DMA format unchanged)
+//              FP_EN adds SUBARRAY_COLS/2 fp_mac_units per row for
+//              fp_fmt = BF16/FP16: lane pair {2j+1, 2j} is element j, the
+//              FP32 lane sums reduce pairwise (fp32_add) into the row
+//              output, ref_gemm_fp() in sw/ref. fp_fmt = FP8 feeds each
+//              fp_mac_unit two FP8 lanes at the INT8 line rate, scaled by
+//              the MX block scales of the current line (mx_w_scale per
+//              row, mx_x_scale; MX_SCALE_ONE without MX), ref_gemm_fp8().
+//              The INT8 MACs idle while an FP format is selected; load_acc
+//              is INT8 only
+//              FANOUT_STAGES registers every input before the MACs (long
+//              BRAM → MAC and broadcast nets at high Fmax): the broadcast
+//              signals (input_vector, enable/clear_acc/load_acc, fp_fmt,
+//              fp8_e5m2, mx_x_scale) get one register chain per group of
+//              SUBARRAY_ROWS / FANOUT_GROUPS rows, so each copy only drives
+//              its own rows' MACs; the per-row inputs (weights, mx_w_scale,
+//              acc_in) get one chain. All inputs shift together, so the
+//              results are unchanged and enable → valid_out grows from 3 to
+//              3 + FANOUT_STAGES cycles (PE_ctrl GEMV_PIPE)
 //-----------------------------------------------------------------------------
 
-module gemv_subarray #(
+module gemv_subarray
+    import fp_pkg::*;
+#(
     parameter int INPUT_WIDTH   = 8,
     parameter int WEIGHT_WIDTH  = 8,
     parameter int OUTPUT_WIDTH  = 32,
     parameter int SUBARRAY_ROWS = 32,  // Output vector size
-    parameter int SUBARRAY_COLS = 8    // Input vector size
+    parameter int SUBARRAY_COLS = 8,   // Input vector size
+    parameter int MAX_K         = 1 << (OUTPUT_WIDTH - INPUT_WIDTH - WEIGHT_WIDTH),  // Longest dot product
+    parameter bit FP_EN         = 0,   // BF16/FP16 MACs (8-bit lanes only)
+    parameter int FANOUT_STAGES = 0,   // Input register stages before the MACs
+    parameter int FANOUT_GROUPS = 1    // Broadcast register copies (divides SUBARRAY_ROWS)
 )(
     input  logic                      clk,
     input  logic                      rst_n,
@@ -20,10 +57,16 @@ module gemv_subarray #(
     // Control signals
     input  logic                      enable,
     input  logic                      clear_acc,
+    input  logic                      load_acc,
+    input  logic [1:0]                fp_fmt,      // fp_pkg FMT_* (INT8 unless FP_EN)
+    input  logic                      fp8_e5m2,    // FP8: E5M2 (else E4M3)
+    input  logic [SUBARRAY_ROWS-1:0][7:0] mx_w_scale,  // FP8: E8M0 per row
+    input  logic [7:0]                mx_x_scale,
 
     // Data inputs
     input  logic [SUBARRAY_COLS-1:0][INPUT_WIDTH-1:0]  input_vector,
     input  logic [SUBARRAY_ROWS-1:0][SUBARRAY_COLS-1:0][WEIGHT_WIDTH-1:0] weight_matrix,
+    input  logic [SUBARRAY_ROWS-1:0][OUTPUT_WIDTH-1:0] acc_in,     // load_acc value
 
     // Data output
     output logic [SUBARRAY_ROWS-1:0][OUTPUT_WIDTH-1:0] output_vector,
@@ -32,16 +75,136 @@ module gemv_subarray #(
     output logic                      valid_out
 );
 
+    //-------------------------------------------------------------------------
+    // Local Parameters
+    //-------------------------------------------------------------------------
+    localparam int PROD_WIDTH    = INPUT_WIDTH + WEIGHT_WIDTH;
+    localparam int COL_K         = (MAX_K + SUBARRAY_COLS - 1) / SUBARRAY_COLS;
+    localparam int K_BITS        = $clog2(MAX_K + 1) - 1;
+    localparam int COL_K_BITS    = $clog2(COL_K + 1) - 1;
+    localparam int ACC_WIDTH     = (PROD_WIDTH + K_BITS < OUTPUT_WIDTH) ? PROD_WIDTH + K_BITS : OUTPUT_WIDTH;
+    localparam int COL_ACC_WIDTH = (PROD_WIDTH + COL_K_BITS < ACC_WIDTH) ? PROD_WIDTH + COL_K_BITS : ACC_WIDTH;
+    localparam int FP_COLS       = SUBARRAY_COLS / 2;
+    localparam int GROUP_ROWS    = (FANOUT_GROUPS > 0) ? SUBARRAY_ROWS / FANOUT_GROUPS : SUBARRAY_ROWS;
+
+    //-------------------------------------------------------------------------
+    // Fan-out Pipeline Types
+    //-------------------------------------------------------------------------
+    // Broadcast to all rows: one copy per row group
+    typedef struct packed {
+        logic                                      enable;
+        logic                                      clear_acc;
+        logic                                      load_acc;
+        logic [1:0]                                fp_fmt;
+        logic                                      fp8_e5m2;
+        logic [7:0]                                mx_x_scale;
+        logic [SUBARRAY_COLS-1:0][INPUT_WIDTH-1:0] input_vector;
+    } bcast_t;
+
+    // Used by one row only
+    typedef struct packed {
+        logic [SUBARRAY_COLS-1:0][WEIGHT_WIDTH-1:0] weight;
+        logic [7:0]                                 mx_w_scale;
+        logic [OUTPUT_WIDTH-1:0]                    acc_in;
+    } row_in_t;
+
     //-------------------------------------------------------------------------
     // Internal Signals
     //-------------------------------------------------------------------------
-    logic [SUBARRAY_ROWS-1:0][SUBARRAY_COLS-1:0][OUTPUT_WIDTH-1:0] mac_outputs;
+    logic [SUBARRAY_ROWS-1:0][SUBARRAY_COLS-1:0][ACC_WIDTH-1:0] mac_outputs;
     logic [SUBARRAY_ROWS-1:0][SUBARRAY_COLS-1:0] mac_valid;
-    logic [SUBARRAY_ROWS-1:0][OUTPUT_WIDTH-1:0] row_sums;
+    logic [SUBARRAY_ROWS-1:0][ACC_WIDTH-1:0] row_sums;
 
     // Valid pipeline (1 stage for output register after MAC valid)
     logic mac_valid_ref;
 
+    // Fan-out pipeline outputs (the MAC inputs)
+    bcast_t                                bcast_in;
+    bcast_t  [FANOUT_GROUPS-1:0]           bcast;
+    row_in_t [SUBARRAY_ROWS-1:0]           row_in;
+    row_in_t [SUBARRAY_ROWS-1:0]           row_q;
+
+    // Floating-point path
+    logic fp_active;
+    logic [FANOUT_GROUPS-1:0] grp_fp_active;
+    logic [FANOUT_GROUPS-1:0] grp_int_enable;
+    logic [SUBARRAY_ROWS-1:0][FP_COLS-1:0][31:0] fp_outputs;
+    logic [SUBARRAY_ROWS-1:0][FP_COLS-1:0] fp_valid;
+    logic [SUBARRAY_ROWS-1:0][31:0] fp_row_sums;
+
+    //-------------------------------------------------------------------------
+    // Fan-out Pipeline
+    //-------------------------------------------------------------------------
+    always_comb begin
+        bcast_in.enable       = enable;
+        bcast_in.clear_acc    = clear_acc;
+        bcast_in.load_acc     = load_acc;
+        bcast_in.fp_fmt       = fp_fmt;
+        bcast_in.fp8_e5m2     = fp8_e5m2;
+        bcast_in.mx_x_scale   = mx_x_scale;
+        bcast_in.input_vector = input_vector;
+        for (int r = 0; r < SUBARRAY_ROWS; r++) begin
+            row_in[r].weight     = weight_matrix[r];
+            row_in[r].mx_w_scale = mx_w_scale[r];
+            row_in[r].acc_in     = acc_in[r];
+        end
+    end
+
+    genvar g;
+    generate
+        // Every row must map to a broadcast copy (row / GROUP_ROWS)
+        if (FANOUT_GROUPS < 1 || SUBARRAY_ROWS % FANOUT_GROUPS != 0) begin : gen_bad_groups
+            $error("gemv_subarray: FANOUT_GROUPS (%0d) must be >= 1 and divide SUBARRAY_ROWS (%0d)",
+                   FANOUT_GROUPS, SUBARRAY_ROWS);
+        end
+        if (FANOUT_STAGES < 0) begin : gen_bad_stages
+            $error("gemv_subarray: FANOUT_STAGES (%0d) must be >= 0", FANOUT_STAGES);
+        end
+
+        if (FANOUT_STAGES == 0) begin : gen_no_fanout
+            assign bcast = {FANOUT_GROUPS{bcast_in}};
+            assign row_q = row_in;
+        end else begin : gen_fanout
+            for (g = 0; g < FANOUT_GROUPS; g++) begin : gen_group
+                // Replicas must not be merged back into one register
+                (* keep = "true" *) bcast_t [FANOUT_STAGES-1:0] pipe;
+
+                always_ff @(posedge clk or negedge rst_n) begin
+                    if (!rst_n) begin
+                        pipe <= '0;
+                    end else begin
+                        pipe[0] <= bcast_in;
+                        for (int s = 1; s < FANOUT_STAGES; s++)
+                            pipe[s] <= pipe[s-1];
+                    end
+                end
+
+                assign bcast[g] = pipe[FANOUT_STAGES-1];
+            end
+
+            row_in_t [FANOUT_STAGES-1:0][SUBARRAY_ROWS-1:0] row_pipe;
+
+            always_ff @(posedge clk or negedge rst_n) begin
+                if (!rst_n) begin
+                    row_pipe <= '0;
+                end else begin
+                    row_pipe[0] <= row_in;
+                    for (int s = 1; s < FANOUT_STAGES; s++)
+                        row_pipe[s] <= row_pipe[s-1];
+                end
+            end
+
+            assign row_q = row_pipe[FANOUT_STAGES-1];
+        end
+
+        for (g = 0; g < FANOUT_GROUPS; g++) begin : gen_group_ctrl
+            assign grp_fp_active[g]  = FP_EN && (bcast[g].fp_fmt != FMT_INT8);
+            assign grp_int_enable[g] = bcast[g].enable && !grp_fp_active[g];
+        end
+    endgenerate
+
+    assign fp_active = grp_fp_active[0];
+
     //-------------------------------------------------------------------------
     // Generate MAC Units - One per weight element
     //-------------------------------------------------------------------------
@@ -49,20 +212,29 @@ module gemv_subarray #(
     generate
         for (row = 0; row < SUBARRAY_ROWS; row++) begin : gen_row
             for (col = 0; col < SUBARRAY_COLS; col++) begin : gen_col
+                localparam int W = (col == 0) ? ACC_WIDTH : COL_ACC_WIDTH;
+                localparam int G = row / GROUP_ROWS;
+
+                logic signed [W-1:0] mac_out;
+
                 mac_unit #(
                     .INPUT_WIDTH  (INPUT_WIDTH),
                     .WEIGHT_WIDTH (WEIGHT_WIDTH),
-                    .OUTPUT_WIDTH (OUTPUT_WIDTH)
+                    .OUTPUT_WIDTH (W)
                 ) u_mac (
                     .clk        (clk),
                     .rst_n      (rst_n),
-                    .enable     (enable),
-                    .clear_acc  (clear_acc),
-                    .data_in    (input_vector[col]),
-                    .weight_in  (weight_matrix[row][col]),
-                    .data_out   (mac_outputs[row][col]),
+                    .enable     (grp_int_enable[G]),
+                    .clear_acc  (bcast[G].clear_acc),
+                    .load_acc   (bcast[G].load_acc),
+                    .acc_in     ((col == 0) ? W'(row_q[row].acc_in) : W'(0)),
+                    .data_in    (bcast[G].input_vector[col]),
+                    .weight_in  (row_q[row].weight[col]),
+                    .data_out   (mac_out),
                     .valid_out  (mac_valid[row][col])
                 );
+
+                assign mac_outputs[row][col] = ACC_WIDTH'(mac_out);
             end
         end
     endgenerate
@@ -81,10 +253,52 @@ module gemv_subarray #(
         end
     endgenerate
 
+    //-------------------------------------------------------------------------
+    // FP MAC Units - One per element pair, pairwise row reduction
+    //-------------------------------------------------------------------------
+    generate
+        if (FP_EN) begin : gen_fp
+            for (row = 0; row < SUBARRAY_ROWS; row++) begin : gen_fp_row
+                localparam int G = row / GROUP_ROWS;
+
+                for (col = 0; col < FP_COLS; col++) begin : gen_fp_col
+                    fp_mac_unit u_fp_mac (
+                        .clk        (clk),
+                        .rst_n      (rst_n),
+                        .enable     (bcast[G].enable && grp_fp_active[G]),
+                        .clear_acc  (bcast[G].clear_acc || bcast[G].load_acc),
+                        .fmt        (bcast[G].fp_fmt),
+                        .fp8_e5m2   (bcast[G].fp8_e5m2),
+                        .w_scale    (row_q[row].mx_w_scale),
+                        .x_scale    (bcast[G].mx_x_scale),
+                        .data_in    ({bcast[G].input_vector[2*col+1], bcast[G].input_vector[2*col]}),
+                        .weight_in  ({row_q[row].weight[2*col+1], row_q[row].weight[2*col]}),
+                        .data_out   (fp_outputs[row][col]),
+                        .valid_out  (fp_valid[row][col])
+                    );
+                end
+
+                always_comb begin
+                    logic [FP_COLS-1:0][31:0] lane;
+                    lane = fp_outputs[row];
+                    for (int w = FP_COLS; w > 1; w = w / 2) begin
+                        for (int i = 0; i < w / 2; i++)
+                            lane[i] = fp32_add(lane[2*i], lane[2*i+1]);
+                    end
+                    fp_row_sums[row] = lane[0];
+                end
+            end
+        end else begin : gen_no_fp
+            assign fp_outputs  = '0;
+            assign fp_valid    = '0;
+            assign fp_row_sums = '0;
+        end
+    endgenerate
+
     //-------------------------------------------------------------------------
     // MAC Valid Reference (all MACs share the same timing)
     //-------------------------------------------------------------------------
-    assign mac_valid_ref = mac_valid[0][0];
+    assign mac_valid_ref = mac_valid[0][0] | fp_valid[0][0];
 
     //-------------------------------------------------------------------------
     // Output Register - capture when MAC results are valid
@@ -93,14 +307,17 @@ module gemv_subarray #(
         if (!rst_n) begin
             output_vector <= '0;
         end else if (mac_valid_ref) begin
-            output_vector <= row_sums;
+            for (int r = 0; r < SUBARRAY_ROWS; r++)
+                output_vector[r] <= fp_active ? OUTPUT_WIDTH'(fp_row_sums[r])
+                                              : OUTPUT_WIDTH'($signed(row_sums[r]));
         end
     end
 
     //-------------------------------------------------------------------------
     // Valid Signal Pipeline
     // MAC valid_out fires 2 cycles after enable (mult_reg + acc_reg)
-    // Output register adds 1 more cycle -> total 3 cycles from enable
+    // Output register adds 1 more cycle -> total 3 cycles from enable,
+    // plus FANOUT_STAGES before the MACs
     //-------------------------------------------------------------------------
     always_ff @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
@@ -11,7 +11,11 @@ module large_pe_array #(
     parameter int SUBARRAY_ROWS  = 32,
     parameter int SUBARRAY_COLS  = 8,
     parameter int PE_ARRAY_ROWS  = 2,
-    parameter int PE_ARRAY_COLS  = 2
+    parameter int PE_ARRAY_COLS  = 2,
+    parameter int MAX_K          = 1 << (OUTPUT_WIDTH - INPUT_WIDTH - WEIGHT_WIDTH),
+    parameter bit FP_EN          = 0,
+    parameter int FANOUT_STAGES  = 0,
+    parameter int FANOUT_GROUPS  = 1
 )(
     input  logic                      clk,
     input  logic                      rst_n,
@@ -21,10 +25,14 @@ module large_pe_array #(
     input  logic [PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0] pe_enable,  // Individual PE enables
     input  logic                      start,
     input  logic                      clear,
+    input  logic [1:0]                fp_fmt,        // Element format (fp_pkg FMT_*)
+    input  logic                      fp8_e5m2,
 
     // Data inputs - shared input vector, separate weights per PE
     input  logic [PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_COLS-1:0][INPUT_WIDTH-1:0] input_vectors,
     input  logic [PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_ROWS-1:0][SUBARRAY_COLS-1:0][WEIGHT_WIDTH-1:0] weight_matrices,
+    input  logic [PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_ROWS-1:0][7:0] mx_w_scales,  // FP8 MX (E8M0)
+    input  logic [PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][7:0] mx_x_scales,
 
     // Data outputs
     output logic [PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_ROWS-1:0][OUTPUT_WIDTH-1:0] output_vectors,
@@ -49,15 +57,23 @@ module large_pe_array #(
                     .WEIGHT_WIDTH  (WEIGHT_WIDTH),
                     .OUTPUT_WIDTH  (OUTPUT_WIDTH),
                     .SUBARRAY_ROWS (SUBARRAY_ROWS),
-                    .SUBARRAY_COLS (SUBARRAY_COLS)
+                    .SUBARRAY_COLS (SUBARRAY_COLS),
+                    .MAX_K         (MAX_K),
+                    .FP_EN         (FP_EN),
+                    .FANOUT_STAGES (FANOUT_STAGES),
+                    .FANOUT_GROUPS (FANOUT_GROUPS)
                 ) u_pe_unit (
                     .clk           (clk),
                     .rst_n         (rst_n),
                     .pe_enable     (array_enable & pe_enable[r][c]),
                     .start         (start),
                     .clear         (clear),
+                    .fp_fmt        (fp_fmt),
+                    .fp8_e5m2      (fp8_e5m2),
                     .input_vector  (input_vectors[r][c]),
                     .weight_matrix (weight_matrices[r][c]),
+                    .mx_w_scale    (mx_w_scales[r][c]),
+                    .mx_x_scale    (mx_x_scales[r][c]),
                     .output_vector (output_vectors[r][c]),
                     .busy          (pe_busy[r][c]),
                     .done          (pe_done[r][c]),
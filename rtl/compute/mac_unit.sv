@@ -6,6 +6,10 @@
 //                Stage 1: Multiplication -> mult_reg
 //                Stage 2: Accumulation   -> acc_reg
 //              Latency: 2 cycles from enable to acc_reg update
+//              load_acc: acc_reg <= acc_in (context restore after a
+//              preemption), otherwise like clear_acc
+//              OUTPUT_WIDTH is the accumulator width (gemv_subarray sizes
+//              it from MAX_K); wraps on overflow
 //-----------------------------------------------------------------------------
 
 module mac_unit #(
@@ -19,6 +23,8 @@ module mac_unit #(
     // Control signals
     input  logic                      enable,
     input  logic                      clear_acc,   // Clear accumulator
+    input  logic                      load_acc,    // Load accumulator from acc_in
+    input  logic [OUTPUT_WIDTH-1:0]   acc_in,
 
     // Data inputs
     input  logic [INPUT_WIDTH-1:0]    data_in,     // Input activation
@@ -46,7 +52,7 @@ module mac_unit #(
         if (!rst_n) begin
             mult_reg  <= '0;
             enable_d1 <= 1'b0;
-        end else if (clear_acc) begin
+        end else if (clear_acc || load_acc) begin
             mult_reg  <= '0;
             enable_d1 <= 1'b0;
         end else begin
@@ -67,6 +73,9 @@ module mac_unit #(
         end else if (clear_acc) begin
             acc_reg   <= '0;
             valid_out <= 1'b0;
+        end else if (load_acc) begin
+            acc_reg   <= acc_in;
+            valid_out <= 1'b0;
         end else begin
             valid_out <= enable_d1;
             if (enable_d1) begin
@@ -12,7 +12,11 @@ module pe_array_cluster #(
     parameter int SUBARRAY_COLS   = 8,
     parameter int PE_ARRAY_ROWS   = 2,
     parameter int PE_ARRAY_COLS   = 2,
-    parameter int NUM_LARGE_ARRAYS = 4
+    parameter int NUM_LARGE_ARRAYS = 4,
+    parameter int MAX_K           = 1 << (OUTPUT_WIDTH - INPUT_WIDTH - WEIGHT_WIDTH),
+    parameter bit FP_EN           = 0,
+    parameter int FANOUT_STAGES   = 0,
+    parameter int FANOUT_GROUPS   = 1
 )(
     input  logic                      clk,
     input  logic                      rst_n,
@@ -21,6 +25,8 @@ module pe_array_cluster #(
     input  logic                      cluster_enable,
     input  logic                      start,
     input  logic                      clear,
+    input  logic [1:0]                fp_fmt,        // Element format (fp_pkg FMT_*)
+    input  logic                      fp8_e5m2,
 
     // Per-array enable
     input  logic [NUM_LARGE_ARRAYS-1:0] large_array_enable,
@@ -31,6 +37,8 @@ module pe_array_cluster #(
     // Data inputs
     input  logic [NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_COLS-1:0][INPUT_WIDTH-1:0] input_vectors,
     input  logic [NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_ROWS-1:0][SUBARRAY_COLS-1:0][WEIGHT_WIDTH-1:0] weight_matrices,
+    input  logic [NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_ROWS-1:0][7:0] mx_w_scales,  // FP8 MX (E8M0)
+    input  logic [NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][7:0] mx_x_scales,
 
     // Data outputs
     output logic [NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_ROWS-1:0][OUTPUT_WIDTH-1:0] output_vectors,
@@ -58,7 +66,11 @@ module pe_array_cluster #(
                 .SUBARRAY_ROWS (SUBARRAY_ROWS),
                 .SUBARRAY_COLS (SUBARRAY_COLS),
                 .PE_ARRAY_ROWS (PE_ARRAY_ROWS),
-                .PE_ARRAY_COLS (PE_ARRAY_COLS)
+                .PE_ARRAY_COLS (PE_ARRAY_COLS),
+                .MAX_K         (MAX_K),
+                .FP_EN         (FP_EN),
+                .FANOUT_STAGES (FANOUT_STAGES),
+                .FANOUT_GROUPS (FANOUT_GROUPS)
             ) u_large_pe_array (
                 .clk            (clk),
                 .rst_n          (rst_n),
@@ -66,8 +78,12 @@ module pe_array_cluster #(
                 .pe_enable      (pe_enable[i]),
                 .start          (start),
                 .clear          (clear),
+                .fp_fmt         (fp_fmt),
+                .fp8_e5m2       (fp8_e5m2),
                 .input_vectors  (input_vectors[i]),
                 .weight_matrices(weight_matrices[i]),
+                .mx_w_scales    (mx_w_scales[i]),
+                .mx_x_scales    (mx_x_scales[i]),
                 .output_vectors (output_vectors[i]),
                 .pe_busy        (pe_busy[i]),
                 .pe_done        (pe_done[i]),
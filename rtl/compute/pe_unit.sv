@@ -9,7 +9,11 @@ module pe_unit #(
     parameter int WEIGHT_WIDTH  = 8,
     parameter int OUTPUT_WIDTH  = 32,
     parameter int SUBARRAY_ROWS = 32,
-    parameter int SUBARRAY_COLS = 8
+    parameter int SUBARRAY_COLS = 8,
+    parameter int MAX_K         = 1 << (OUTPUT_WIDTH - INPUT_WIDTH - WEIGHT_WIDTH),
+    parameter bit FP_EN         = 0,
+    parameter int FANOUT_STAGES = 0,   // gemv_subarray input pipeline
+    parameter int FANOUT_GROUPS = 1
 )(
     input  logic                      clk,
     input  logic                      rst_n,
@@ -18,10 +22,14 @@ module pe_unit #(
     input  logic                      pe_enable,    // PE enable from controller
     input  logic                      start,        // Start computation
     input  logic                      clear,        // Clear accumulators
+    input  logic [1:0]                fp_fmt,       // Element format (fp_pkg FMT_*)
+    input  logic                      fp8_e5m2,
 
     // Data inputs
     input  logic [SUBARRAY_COLS-1:0][INPUT_WIDTH-1:0]  input_vector,
     input  logic [SUBARRAY_ROWS-1:0][SUBARRAY_COLS-1:0][WEIGHT_WIDTH-1:0] weight_matrix,
+    input  logic [SUBARRAY_ROWS-1:0][7:0]              mx_w_scale,   // FP8 MX (E8M0)
+    input  logic [7:0]                                 mx_x_scale,
 
     // Data output
     output logic [SUBARRAY_ROWS-1:0][OUTPUT_WIDTH-1:0] output_vector,
@@ -56,14 +64,24 @@ module pe_unit #(
         .WEIGHT_WIDTH  (WEIGHT_WIDTH),
         .OUTPUT_WIDTH  (OUTPUT_WIDTH),
         .SUBARRAY_ROWS (SUBARRAY_ROWS),
-        .SUBARRAY_COLS (SUBARRAY_COLS)
+        .SUBARRAY_COLS (SUBARRAY_COLS),
+        .MAX_K         (MAX_K),
+        .FP_EN         (FP_EN),
+        .FANOUT_STAGES (FANOUT_STAGES),
+        .FANOUT_GROUPS (FANOUT_GROUPS)
     ) u_gemv_subarray (
         .clk           (clk),
         .rst_n         (rst_n),
         .enable        (subarray_enable),
         .clear_acc     (subarray_clear),
+        .load_acc      (1'b0),
+        .fp_fmt        (fp_fmt),
+        .fp8_e5m2      (fp8_e5m2),
+        .mx_w_scale    (mx_w_scale),
+        .mx_x_scale    (mx_x_scale),
         .input_vector  (input_vector),
         .weight_matrix (weight_matrix),
+        .acc_in        ('0),
         .output_vector (subarray_output),
         .valid_out     (subarray_valid)
     );
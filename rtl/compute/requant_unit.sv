@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------
+// Module: requant_unit
+// Description: Output requantisation INT32 -> INT8 (one output vector)
+//              y = clamp((x * scale + round) >>> shift, -128, 127)
+//              round = 1 << (shift-1) (0 when shift = 0), optional ReLU
+//              Matches ref_requant() in sw/ref
+//              2-stage pipeline:
+//                Stage 1: x * scale -> prod_reg
+//                Stage 2: round, shift, ReLU, saturate -> data_out
+//              Latency: 2 cycles from valid_in to valid_out
+//-----------------------------------------------------------------------------
+
+module requant_unit #(
+    parameter int NUM_LANES    = 32,   // SUBARRAY_ROWS
+    parameter int ACC_WIDTH    = 32,   // OUTPUT_WIDTH
+    parameter int OUT_WIDTH    = 8,    // INPUT_WIDTH of the next layer
+    parameter int SCALE_WIDTH  = 16,
+    parameter int SHIFT_WIDTH  = 5
+)(
+    input  logic                                    clk,
+    input  logic                                    rst_n,
+
+    // Configuration (static during a job)
+    input  logic signed [SCALE_WIDTH-1:0]           scale,
+    input  logic [SHIFT_WIDTH-1:0]                  shift,
+    input  logic                                    relu,
+
+    // Data
+    input  logic                                    valid_in,
+    input  logic [NUM_LANES-1:0][ACC_WIDTH-1:0]     data_in,
+    output logic                                    valid_out,
+    output logic [NUM_LANES-1:0][OUT_WIDTH-1:0]     data_out
+);
+
+    //-------------------------------------------------------------------------
+    // Local Parameters
+    //-------------------------------------------------------------------------
+    localparam int PROD_WIDTH = ACC_WIDTH + SCALE_WIDTH;
+    localparam logic signed [PROD_WIDTH-1:0] OUT_MAX =  (2**(OUT_WIDTH-1)) - 1;
+    localparam logic signed [PROD_WIDTH-1:0] OUT_MIN = -(2**(OUT_WIDTH-1));
+
+    //-------------------------------------------------------------------------
+    // Pipeline Stage 1: Scale
+    //-------------------------------------------------------------------------
+    logic signed [PROD_WIDTH-1:0] prod_reg [NUM_LANES];
+    logic                         valid_d1;
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            valid_d1 <= 1'b0;
+            for (int i = 0; i < NUM_LANES; i++)
+                prod_reg[i] <= '0;
+        end else begin
+            valid_d1 <= valid_in;
+            if (valid_in) begin
+                for (int i = 0; i < NUM_LANES; i++)
+                    prod_reg[i] <= $signed(data_in[i]) * scale;
+            end
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Pipeline Stage 2: Round, Shift, ReLU, Saturate
+    //-------------------------------------------------------------------------
+    logic signed [PROD_WIDTH-1:0] round_val;
+    assign round_val = (shift == 0) ? '0 : (PROD_WIDTH'(1) <<< (shift - 1));
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            valid_out <= 1'b0;
+            data_out  <= '0;
+        end else begin
+            valid_out <= valid_d1;
+            if (valid_d1) begin
+                for (int i = 0; i < NUM_LANES; i++) begin
+                    logic signed [PROD_WIDTH-1:0] y;
+                    y = (prod_reg[i] + round_val) >>> shift;
+                    if (relu && y < 0)
+                        y = '0;
+                    if (y > OUT_MAX)
+                        data_out[i] <= OUT_MAX[OUT_WIDTH-1:0];
+                    else if (y < OUT_MIN)
+                        data_out[i] <= OUT_MIN[OUT_WIDTH-1:0];
+                    else
+                        data_out[i] <= y[OUT_WIDTH-1:0];
+                end
+            end
+        end
+    end
+
+endmodule
@@ -0,0 +1,123 @@
+//-----------------------------------------------------------------------------
+// Module: rope_unit
+// Description: Rotary position embedding on one output vector (Q/K tiles)
+//              Adjacent lanes (2j, 2j+1) form a pair rotated by the angle of
+//              its position: cs_in[j] = {sin, cos} in Q1.FRAC_BITS, taken
+//              from the RoPE table row of the column's position (entry
+//              (m0 mod head_dim)/2 + j for a tile starting at row m0)
+//                y0 = sat((x0*cos - x1*sin + round) >>> FRAC_BITS)
+//                y1 = sat((x0*sin + x1*cos + round) >>> FRAC_BITS)
+//              round = 1 << (FRAC_BITS-1), saturate to ACC_WIDTH
+//              enable = 0: data passes through with the same latency
+//              Matches ref_rope() in sw/ref
+//              2-stage pipeline:
+//                Stage 1: four products per pair -> prod_reg
+//                Stage 2: sum, round, shift, saturate -> data_out
+//              Latency: 2 cycles from valid_in to valid_out
+//-----------------------------------------------------------------------------
+
+module rope_unit #(
+    parameter int NUM_LANES = 32,   // SUBARRAY_ROWS (even)
+    parameter int ACC_WIDTH = 32,   // OUTPUT_WIDTH
+    parameter int CS_WIDTH  = 16,
+    parameter int FRAC_BITS = 14    // ROPE_FRAC_BITS
+)(
+    input  logic                                    clk,
+    input  logic                                    rst_n,
+
+    // Configuration (CONFIG.rope)
+    input  logic                                    enable,
+
+    // Data
+    input  logic                                    valid_in,
+    input  logic [NUM_LANES-1:0][ACC_WIDTH-1:0]     data_in,
+    input  logic [NUM_LANES/2-1:0][2*CS_WIDTH-1:0]  cs_in,      // {sin, cos} per pair
+    output logic                                    valid_out,
+    output logic [NUM_LANES-1:0][ACC_WIDTH-1:0]     data_out
+);
+
+    //-------------------------------------------------------------------------
+    // Local Parameters
+    //-------------------------------------------------------------------------
+    localparam int NUM_PAIRS  = NUM_LANES / 2;
+    localparam int PROD_WIDTH = ACC_WIDTH + CS_WIDTH;
+    localparam int SUM_WIDTH  = PROD_WIDTH + 1;
+    localparam logic signed [SUM_WIDTH-1:0] OUT_MAX =  (2**(ACC_WIDTH-1)) - 1;
+    localparam logic signed [SUM_WIDTH-1:0] OUT_MIN = -(2**(ACC_WIDTH-1));
+    localparam logic signed [SUM_WIDTH-1:0] ROUND   = SUM_WIDTH'(1) <<< (FRAC_BITS - 1);
+
+    //-------------------------------------------------------------------------
+    // Pipeline Stage 1: Products
+    //   p_xc0 = x0*cos, p_xs1 = x1*sin, p_xs0 = x0*sin, p_xc1 = x1*cos
+    //-------------------------------------------------------------------------
+    logic signed [PROD_WIDTH-1:0] p_xc0 [NUM_PAIRS];
+    logic signed [PROD_WIDTH-1:0] p_xs1 [NUM_PAIRS];
+    logic signed [PROD_WIDTH-1:0] p_xs0 [NUM_PAIRS];
+    logic signed [PROD_WIDTH-1:0] p_xc1 [NUM_PAIRS];
+    logic [NUM_LANES-1:0][ACC_WIDTH-1:0] data_d1;
+    logic                                enable_d1;
+    logic                                valid_d1;
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            valid_d1  <= 1'b0;
+            enable_d1 <= 1'b0;
+            data_d1   <= '0;
+            for (int j = 0; j < NUM_PAIRS; j++) begin
+                p_xc0[j] <= '0;
+                p_xs1[j] <= '0;
+                p_xs0[j] <= '0;
+                p_xc1[j] <= '0;
+            end
+        end else begin
+            valid_d1 <= valid_in;
+            if (valid_in) begin
+                enable_d1 <= enable;
+                data_d1   <= data_in;
+                for (int j = 0; j < NUM_PAIRS; j++) begin
+                    logic signed [ACC_WIDTH-1:0] x0, x1;
+                    logic signed [CS_WIDTH-1:0]  c, s;
+                    x0 = $signed(data_in[2*j]);
+                    x1 = $signed(data_in[2*j+1]);
+                    c  = $signed(cs_in[j][CS_WIDTH-1:0]);
+                    s  = $signed(cs_in[j][2*CS_WIDTH-1:CS_WIDTH]);
+                    p_xc0[j] <= x0 * c;
+                    p_xs1[j] <= x1 * s;
+                    p_xs0[j] <= x0 * s;
+                    p_xc1[j] <= x1 * c;
+                end
+            end
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Pipeline Stage 2: Sum, Round, Shift, Saturate
+    //-------------------------------------------------------------------------
+    function automatic logic [ACC_WIDTH-1:0] rot_sat(logic signed [SUM_WIDTH-1:0] sum);
+        logic signed [SUM_WIDTH-1:0] y;
+        y = (sum + ROUND) >>> FRAC_BITS;
+        if (y > OUT_MAX) y = OUT_MAX;
+        if (y < OUT_MIN) y = OUT_MIN;
+        return y[ACC_WIDTH-1:0];
+    endfunction
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            valid_out <= 1'b0;
+            data_out  <= '0;
+        end else begin
+            valid_out <= valid_d1;
+            if (valid_d1) begin
+                if (!enable_d1) begin
+                    data_out <= data_d1;
+                end else begin
+                    for (int j = 0; j < NUM_PAIRS; j++) begin
+                        data_out[2*j]   <= rot_sat(SUM_WIDTH'(p_xc0[j]) - SUM_WIDTH'(p_xs1[j]));
+                        data_out[2*j+1] <= rot_sat(SUM_WIDTH'(p_xs0[j]) + SUM_WIDTH'(p_xc1[j]));
+                    end
+                end
+            end
+        end
+    end
+
+endmodule
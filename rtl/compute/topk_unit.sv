@@ -0,0 +1,152 @@
+//-----------------------------------------------------------------------------
+// Module: topk_unit
+// Description: Streaming top-K over the output vectors of a GEMV (LM head)
+//              Keeps the best K (index, value) pairs seen so far in a sorted
+//              register list, so only K pairs leave the chip instead of M
+//              INT32 logits
+//              - Order: value descending, then index ascending. The order
+//                is total, so the result is independent of arrival order
+//              - Beat input: one NUM_LANES-lane output vector with the index
+//                of lane 0 and the number of valid lanes (last M tile)
+//              - Pair input: one explicit (index, value) per cycle, used to
+//                merge the lists of the per-PE units into one at job end
+//              - One candidate inserted per cycle: compare against all K
+//                entries in parallel, shift the tail down by one. A beat of
+//                n lanes takes n cycles (back to back beats do not bubble)
+//              - clear starts a new job (all entries invalid)
+//              Matches ref_topk() in sw/ref
+//-----------------------------------------------------------------------------
+
+module topk_unit #(
+    parameter int NUM_LANES = 32,     // SUBARRAY_ROWS
+    parameter int ACC_WIDTH = 32,     // OUTPUT_WIDTH
+    parameter int IDX_WIDTH = 32,
+    parameter int K         = 8       // NPU_TOPK_MAX
+)(
+    input  logic                                clk,
+    input  logic                                rst_n,
+    input  logic                                clear,      // New job
+
+    // Output vectors (requant-stage input)
+    input  logic [NUM_LANES-1:0][ACC_WIDTH-1:0] in_data,
+    input  logic [IDX_WIDTH-1:0]                in_base,    // Index of lane 0
+    input  logic [$clog2(NUM_LANES+1)-1:0]      in_lanes,   // Valid lanes (1..NUM_LANES)
+    input  logic                                in_valid,
+    output logic                                in_ready,
+
+    // Single pairs (merge of another unit's list)
+    input  logic [IDX_WIDTH-1:0]                pair_idx,
+    input  logic [ACC_WIDTH-1:0]                pair_val,
+    input  logic                                pair_valid,
+    output logic                                pair_ready,
+
+    // Running result (sorted, entry 0 = best)
+    output logic [K-1:0][IDX_WIDTH-1:0]         top_idx,
+    output logic [K-1:0][ACC_WIDTH-1:0]         top_val,
+    output logic [K-1:0]                        top_vld,
+    output logic                                busy
+);
+
+    //-------------------------------------------------------------------------
+    // Beat Buffer (lanes drained one per cycle)
+    //-------------------------------------------------------------------------
+    localparam int LANE_WIDTH = $clog2(NUM_LANES+1);
+
+    logic [NUM_LANES-1:0][ACC_WIDTH-1:0] beat_data;
+    logic [IDX_WIDTH-1:0]                beat_base;
+    logic [LANE_WIDTH-1:0]               beat_lanes;
+    logic [LANE_WIDTH-1:0]               lane;
+    logic                                beat_vld;
+    logic                                last_lane;
+
+    // The next beat is taken while the last lane of this one is inserted
+    assign last_lane  = beat_vld && (lane == beat_lanes - 1'b1);
+    assign in_ready   = !beat_vld || last_lane;
+    assign pair_ready = !beat_vld && !in_valid;   // Beats have priority
+    assign busy       = beat_vld;
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            beat_vld   <= 1'b0;
+            beat_data  <= '0;
+            beat_base  <= '0;
+            beat_lanes <= '0;
+            lane       <= '0;
+        end else if (clear) begin
+            beat_vld   <= 1'b0;
+            lane       <= '0;
+        end else if (in_valid && in_ready) begin
+            beat_vld   <= (in_lanes != 0);
+            beat_data  <= in_data;
+            beat_base  <= in_base;
+            beat_lanes <= in_lanes;
+            lane       <= '0;
+        end else if (beat_vld) begin
+            lane <= lane + 1'b1;
+            if (last_lane)
+                beat_vld <= 1'b0;
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Candidate Select
+    //-------------------------------------------------------------------------
+    logic                        cand_vld;
+    logic signed [ACC_WIDTH-1:0] cand_val;
+    logic [IDX_WIDTH-1:0]        cand_idx;
+
+    always_comb begin
+        if (beat_vld) begin
+            cand_vld = 1'b1;
+            cand_val = $signed(beat_data[lane]);
+            cand_idx = beat_base + IDX_WIDTH'(lane);
+        end else begin
+            cand_vld = pair_valid && pair_ready;
+            cand_val = $signed(pair_val);
+            cand_idx = pair_idx;
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Insertion (one candidate per cycle)
+    //   gt[i]: candidate ranks above slot i (or slot i is empty). The list
+    //          is sorted, so gt is 0..0 1..1 from slot 0 down and the
+    //          candidate lands in the first slot with gt set; the slots
+    //          below it shift down and the last entry drops out.
+    //-------------------------------------------------------------------------
+    logic [K-1:0] gt;
+
+    always_comb begin
+        for (int i = 0; i < K; i++)
+            gt[i] = !top_vld[i] || (cand_val > $signed(top_val[i])) ||
+                    (cand_val == $signed(top_val[i]) && cand_idx < top_idx[i]);
+    end
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            top_idx <= '0;
+            top_val <= '0;
+            top_vld <= '0;
+        end else if (clear) begin
+            top_vld <= '0;
+        end else if (cand_vld) begin
+            if (gt[0]) begin
+                top_idx[0] <= cand_idx;
+                top_val[0] <= cand_val;
+                top_vld[0] <= 1'b1;
+            end
+            for (int i = 1; i < K; i++) begin
+                if (gt[i] && !gt[i-1]) begin
+                    top_idx[i] <= cand_idx;
+                    top_val[i] <= cand_val;
+                    top_vld[i] <= 1'b1;
+                end else if (gt[i-1]) begin
+                    top_idx[i] <= top_idx[i-1];
+                    top_val[i] <= top_val[i-1];
+                    top_vld[i] <= top_vld[i-1];
+                end
+            end
+        end
+    end
+
+endmodule
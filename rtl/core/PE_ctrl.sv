@@ -9,6 +9,21 @@
 //              - LOAD_WAIT: BRAM output register pipeline (2nd cycle)
 //              - COMPUTE:   BRAM doutb_reg valid → gemv_enable=1
 //              K-tiling is handled by upper-level controller
+//              Stream mode (stream_mode latched at start, batch-1 decode):
+//              IDLE → LOAD → STREAM → DRAIN → STORE → DONE
+//              - LOAD:   clear_acc only (weight buffer is bypassed)
+//              - STREAM: one {input, weight} K-tile line per cycle from the
+//                        skid FIFO straight into gemv (stalls when empty)
+//              - DRAIN:  wait for the last line to leave the gemv pipeline
+//              stream_len is latched at start; a zero-length stream has no
+//              line to drain and goes LOAD → DONE without an output store
+//              (the output buffer keeps its contents)
+//              restore_acc (latched at start, instead of clear_acc): the
+//              first tile after a preemption loads the saved output vector
+//              into the accumulators in S_LOAD (gemv acc_in, top_pe)
+//              GEMV_PIPE: gemv_subarray FANOUT_STAGES. S_WAIT follows
+//              gemv_valid_out; S_DRAIN counts 3 + GEMV_PIPE cycles after
+//              the last stream line
 //-----------------------------------------------------------------------------
 
 module PE_ctrl #(
@@ -17,7 +32,9 @@ module PE_ctrl #(
     parameter int INPUT_WIDTH   = 8,
     parameter int WEIGHT_WIDTH  = 8,
     parameter int OUTPUT_WIDTH  = 32,
-    parameter int BUF_DEPTH     = 4
+    parameter int BUF_DEPTH     = 4,
+    parameter int NUM_WBANKS    = 2,   // Weight buffer banks, >= 2 (prefetch ping-pong)
+    parameter int GEMV_PIPE     = 0    // gemv_subarray FANOUT_STAGES (extra latency)
 )(
     input  logic clk,
     input  logic rst_n,
@@ -25,9 +42,14 @@ module PE_ctrl #(
     // Upper-level control interface
     input  logic start,
     input  logic clear_acc,
+    input  logic restore_acc,
     output logic busy,
     output logic done,
 
+    // Weight bank to compute from (latched at start); the upper-level
+    // controller may fill the other bank(s) meanwhile (cross-layer prefetch)
+    input  logic [$clog2(NUM_WBANKS)-1:0]                                   wbuf_bank,
+
     // Weight buffer read port (Port B) — full matrix width
     output logic [$clog2(BUF_DEPTH)-1:0]                                    wbuf_addr,
     output logic                                                             wbuf_rd_en,
@@ -38,6 +60,14 @@ module PE_ctrl #(
     output logic                                                             ibuf_rd_en,
     input  logic [SUBARRAY_COLS*INPUT_WIDTH-1:0]                            ibuf_rdata,
 
+    // Weight streaming (bypasses the weight buffer) — one K-tile per line
+    input  logic                                                             stream_mode,
+    input  logic [15:0]                                                      stream_len,
+    input  logic [SUBARRAY_ROWS*SUBARRAY_COLS*WEIGHT_WIDTH-1:0]             wstream_weight,
+    input  logic [SUBARRAY_COLS*INPUT_WIDTH-1:0]                            wstream_input,
+    input  logic                                                             wstream_valid,
+    output logic                                                             wstream_ready,
+
     // Output buffer write port (Port A) — full vector width
     output logic [$clog2(BUF_DEPTH)-1:0]                                    obuf_addr,
     output logic                                                             obuf_wr_en,
@@ -46,6 +76,7 @@ module PE_ctrl #(
     // gemv_subarray direct control
     output logic                                                             gemv_enable,
     output logic                                                             gemv_clear_acc,
+    output logic                                                             gemv_load_acc,
     output logic [SUBARRAY_COLS-1:0][INPUT_WIDTH-1:0]                       gemv_input_vector,
     output logic [SUBARRAY_ROWS-1:0][SUBARRAY_COLS-1:0][WEIGHT_WIDTH-1:0]  gemv_weight_matrix,
     input  logic [SUBARRAY_ROWS-1:0][OUTPUT_WIDTH-1:0]                      gemv_output_vector,
@@ -55,14 +86,16 @@ module PE_ctrl #(
     //-------------------------------------------------------------------------
     // FSM States
     //-------------------------------------------------------------------------
-    typedef enum logic [2:0] {
-        S_IDLE      = 3'd0,
-        S_LOAD      = 3'd1,  // BRAM enb=1 (read request), clear_acc if needed
-        S_LOAD_WAIT = 3'd2,  // BRAM output register latency (2nd cycle)
-        S_COMPUTE   = 3'd3,  // BRAM doutb_reg valid → gemv_enable=1
-        S_WAIT      = 3'd4,  // Wait for gemv_valid_out
-        S_STORE     = 3'd5,  // Write output to buffer
-        S_DONE      = 3'd6   // Signal completion
+    typedef enum logic [3:0] {
+        S_IDLE      = 4'd0,
+        S_LOAD      = 4'd1,  // BRAM enb=1 (read request), clear_acc if needed
+        S_LOAD_WAIT = 4'd2,  // BRAM output register latency (2nd cycle)
+        S_COMPUTE   = 4'd3,  // BRAM doutb_reg valid → gemv_enable=1
+        S_WAIT      = 4'd4,  // Wait for gemv_valid_out
+        S_STORE     = 4'd5,  // Write output to buffer
+        S_DONE      = 4'd6,  // Signal completion
+        S_STREAM    = 4'd7,  // Stream mode: gemv_enable per FIFO line
+        S_DRAIN     = 4'd8   // Stream mode: last line through gemv pipeline
     } state_t;
 
     state_t state, next_state;
@@ -71,6 +104,14 @@ module PE_ctrl #(
     // Internal Registers
     //-------------------------------------------------------------------------
     logic clear_acc_reg;  // Latched clear_acc at start
+    logic restore_reg;    // Latched restore_acc at start
+    logic stream_reg;     // Latched stream_mode at start
+    logic [$clog2(NUM_WBANKS)-1:0] bank_reg;   // Latched wbuf_bank at start
+    logic [15:0] stream_len_reg;  // Latched stream_len at start
+    logic [15:0] stream_cnt;   // Lines consumed in S_STREAM
+    logic        stream_fire;  // Line consumed this cycle
+    logic        stream_last;  // ... and it is the last one
+    logic [GEMV_PIPE+2:0] last_pipe;  // Last line: fan-out stages, MAC stage 1, 2, output register
 
     //-------------------------------------------------------------------------
     // State Register
@@ -93,25 +134,66 @@ module PE_ctrl #(
             next_state = state;
             case (state)
                 S_IDLE:      if (start) next_state = S_LOAD;
-                S_LOAD:      next_state = S_LOAD_WAIT;
+                S_LOAD:      next_state = !stream_reg              ? S_LOAD_WAIT :
+                                          (stream_len_reg == '0) ? S_DONE : S_STREAM;
                 S_LOAD_WAIT: next_state = S_COMPUTE;
                 S_COMPUTE:   next_state = S_WAIT;
                 S_WAIT:      if (gemv_valid_out) next_state = S_STORE;
                 S_STORE:     next_state = S_DONE;
                 S_DONE:      next_state = S_IDLE;
+                S_STREAM:    if (stream_last) next_state = S_DRAIN;
+                S_DRAIN:     if (last_pipe[GEMV_PIPE+2]) next_state = S_STORE;
                 default:     next_state = S_IDLE;
             endcase
         end
     end
 
     //-------------------------------------------------------------------------
-    // Latch clear_acc on start
+    // Latch clear_acc / restore_acc on start (restore wins)
     //-------------------------------------------------------------------------
     always_ff @(posedge clk or negedge rst_n) begin
-        if (!rst_n)
+        if (!rst_n) begin
             clear_acc_reg <= 1'b0;
-        else if (state == S_IDLE && start)
-            clear_acc_reg <= clear_acc;
+            restore_reg   <= 1'b0;
+        end else if (state == S_IDLE && start) begin
+            clear_acc_reg <= clear_acc && !restore_acc;
+            restore_reg   <= restore_acc;
+        end
+    end
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            stream_reg     <= 1'b0;
+            stream_len_reg <= '0;
+            bank_reg       <= '0;
+        end else if (state == S_IDLE && start) begin
+            stream_reg     <= stream_mode;
+            stream_len_reg <= stream_len;
+            bank_reg       <= wbuf_bank;
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Stream Line Counter / Drain Tracking
+    //   gemv output is final 3 + GEMV_PIPE cycles after the last enable
+    //   (see gemv_subarray: fan-out stages → mult_reg → acc_reg →
+    //   output_vector)
+    //-------------------------------------------------------------------------
+    assign wstream_ready = (state == S_STREAM);
+    assign stream_fire   = (state == S_STREAM) && wstream_valid;
+    assign stream_last   = stream_fire && (stream_cnt == stream_len_reg - 1'b1);
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            stream_cnt <= '0;
+            last_pipe  <= '0;
+        end else begin
+            last_pipe <= {last_pipe[GEMV_PIPE+1:0], stream_last};
+            if (state == S_IDLE)
+                stream_cnt <= '0;
+            else if (stream_fire)
+                stream_cnt <= stream_cnt + 1'b1;
+        end
     end
 
     //-------------------------------------------------------------------------
@@ -120,34 +202,46 @@ module PE_ctrl #(
     //   Cycle 1 (S_LOAD_WAIT): regceb=1 → doutb_reg <= ram_data
     //   Cycle 2 (S_COMPUTE):   doutb = doutb_reg → valid data
     //-------------------------------------------------------------------------
-    assign wbuf_rd_en = (state == S_LOAD);
-    assign ibuf_rd_en = (state == S_LOAD);
-    assign wbuf_addr  = '0;
+    assign wbuf_rd_en = (state == S_LOAD) && !stream_reg;
+    assign ibuf_rd_en = (state == S_LOAD) && !stream_reg;
+    // Bank b occupies lines [b*BANK_LINES, (b+1)*BANK_LINES)
+    localparam int BANK_LINES = BUF_DEPTH / NUM_WBANKS;
+
+    assign wbuf_addr  = $clog2(BUF_DEPTH)'(bank_reg * BANK_LINES);
     assign ibuf_addr  = '0;
 
     //-------------------------------------------------------------------------
     // gemv Data Path — BRAM output wired directly (combinational reinterpret)
     //   doutb_reg is stable from S_COMPUTE onward (no new read until next tile)
+    //   Stream mode: FIFO head line instead of the buffers
     //-------------------------------------------------------------------------
+    logic [SUBARRAY_ROWS*SUBARRAY_COLS*WEIGHT_WIDTH-1:0] w_line;
+    logic [SUBARRAY_COLS*INPUT_WIDTH-1:0]                i_line;
+
+    assign w_line = stream_reg ? wstream_weight : wbuf_rdata;
+    assign i_line = stream_reg ? wstream_input  : ibuf_rdata;
+
     always_comb begin
         for (int r = 0; r < SUBARRAY_ROWS; r++) begin
             for (int c = 0; c < SUBARRAY_COLS; c++) begin
-                gemv_weight_matrix[r][c] = wbuf_rdata[(r*SUBARRAY_COLS + c)*WEIGHT_WIDTH +: WEIGHT_WIDTH];
+                gemv_weight_matrix[r][c] = w_line[(r*SUBARRAY_COLS + c)*WEIGHT_WIDTH +: WEIGHT_WIDTH];
             end
         end
         for (int c = 0; c < SUBARRAY_COLS; c++) begin
-            gemv_input_vector[c] = ibuf_rdata[c*INPUT_WIDTH +: INPUT_WIDTH];
+            gemv_input_vector[c] = i_line[c*INPUT_WIDTH +: INPUT_WIDTH];
         end
     end
 
     //-------------------------------------------------------------------------
     // gemv Control — pipelined with BRAM 2-cycle latency
-    //   S_LOAD:      BRAM enb + clear_acc (if first K-tile)
+    //   S_LOAD:      BRAM enb + clear_acc (if first K-tile) or load_acc
+    //                (first tile after a context restore)
     //   S_LOAD_WAIT: BRAM output register pipeline
     //   S_COMPUTE:   doutb_reg valid → gemv_enable=1
     //-------------------------------------------------------------------------
-    assign gemv_enable    = (state == S_COMPUTE);
+    assign gemv_enable    = (state == S_COMPUTE) || stream_fire;
     assign gemv_clear_acc = (state == S_LOAD && clear_acc_reg);
+    assign gemv_load_acc  = (state == S_LOAD && restore_reg);
 
     //-------------------------------------------------------------------------
     // Output Buffer Write
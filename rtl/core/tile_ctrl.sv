@@ -0,0 +1,198 @@
+//-----------------------------------------------------------------------------
+// Module: tile_ctrl
+// Description: Tiling loop of one PE (PLAN.md 3.4) with tile-boundary
+//              preemption
+//                for m_tile: for n: for k_tile: fetch → compute
+//                                   store after the last k_tile
+//              FSM: IDLE → FETCH → RUN → WAIT → (STORE) → NEXT → FETCH ...
+//              - FETCH: DMA loads the weight/input tile (tile_req/ack)
+//              - RUN:   top_pe start; clear_acc on k_tile 0, restore_acc on
+//                       the first tile after a resume mid-column
+//              - STORE: output buffer line → Y[m_tile][n] (store_req/ack)
+//              - NEXT:  advance (k, n, m); with preempt held, SAVE instead
+//                       of the next FETCH
+//              - SAVE:  DMA writes the context: next loop indices and, if
+//                       the column is unfinished (ctx_acc), the output
+//                       buffer line, which holds the partial sums after
+//                       every tile. preempted pulses, the controller idles
+//              resume reloads the indices (ctx_m/n/k inputs); the DMA puts
+//              the saved line on top_pe restore_data with the first tile
+//              (tile_restore). Worst-case preemption latency: one fetch +
+//              tile + store + context save (preempt just after a FETCH)
+//              Matches the preemption model in sw/ref/npu_emu.c
+//-----------------------------------------------------------------------------
+
+module tile_ctrl #(
+    parameter int IDX_WIDTH = 16
+)(
+    input  logic                 clk,
+    input  logic                 rst_n,
+
+    // Job control
+    input  logic                 start,
+    input  logic                 resume,         // Continue from resume_m/n/k
+    input  logic                 preempt,        // Level, held until preempted/done
+    input  logic [IDX_WIDTH-1:0] num_m_tiles,
+    input  logic [IDX_WIDTH-1:0] num_n,
+    input  logic [IDX_WIDTH-1:0] num_k_tiles,
+    input  logic [IDX_WIDTH-1:0] resume_m,
+    input  logic [IDX_WIDTH-1:0] resume_n,
+    input  logic [IDX_WIDTH-1:0] resume_k,
+
+    // Tile load (DMA → weight/input buffer, restore line → restore_data)
+    output logic                 tile_req,
+    output logic [IDX_WIDTH-1:0] tile_m,
+    output logic [IDX_WIDTH-1:0] tile_n,
+    output logic [IDX_WIDTH-1:0] tile_k,
+    output logic                 tile_restore,
+    input  logic                 tile_ack,
+
+    // top_pe
+    output logic                 pe_start,
+    output logic                 pe_clear_acc,
+    output logic                 pe_restore_acc,
+    input  logic                 pe_done,
+
+    // Output store (last k_tile of a column)
+    output logic                 store_req,
+    input  logic                 store_ack,
+
+    // Context save
+    output logic                 ctx_save_req,
+    output logic [IDX_WIDTH-1:0] ctx_m,
+    output logic [IDX_WIDTH-1:0] ctx_n,
+    output logic [IDX_WIDTH-1:0] ctx_k,
+    output logic                 ctx_acc,        // Save the output buffer line too
+    input  logic                 ctx_save_ack,
+
+    output logic                 busy,
+    output logic                 done,           // Pulse
+    output logic                 preempted       // Pulse
+);
+
+    //-------------------------------------------------------------------------
+    // FSM States
+    //-------------------------------------------------------------------------
+    typedef enum logic [2:0] {
+        S_IDLE  = 3'd0,
+        S_FETCH = 3'd1,
+        S_RUN   = 3'd2,
+        S_WAIT  = 3'd3,
+        S_STORE = 3'd4,
+        S_NEXT  = 3'd5,
+        S_SAVE  = 3'd6,
+        S_DONE  = 3'd7
+    } state_t;
+
+    state_t state;
+
+    //-------------------------------------------------------------------------
+    // Loop Indices
+    //-------------------------------------------------------------------------
+    logic [IDX_WIDTH-1:0] m_idx, n_idx, k_idx;
+    logic [IDX_WIDTH-1:0] m_tiles, n_cols, k_tiles;
+    logic                 restore_pend;   // First tile after a mid-column resume
+    logic                 last_k, last_n, last_m;
+
+    assign last_k = (k_idx == k_tiles - 1'b1);
+    assign last_n = (n_idx == n_cols  - 1'b1);
+    assign last_m = (m_idx == m_tiles - 1'b1);
+
+    assign tile_req       = (state == S_FETCH);
+    assign tile_m         = m_idx;
+    assign tile_n         = n_idx;
+    assign tile_k         = k_idx;
+    assign tile_restore   = restore_pend;
+
+    assign pe_start       = (state == S_RUN);
+    assign pe_clear_acc   = (k_idx == '0) && !restore_pend;
+    assign pe_restore_acc = restore_pend;
+
+    assign store_req      = (state == S_STORE);
+
+    assign ctx_save_req   = (state == S_SAVE);
+    assign ctx_m          = m_idx;
+    assign ctx_n          = n_idx;
+    assign ctx_k          = k_idx;
+    assign ctx_acc        = (k_idx != '0);
+
+    assign busy           = (state != S_IDLE);
+    assign done           = (state == S_DONE);
+
+    //-------------------------------------------------------------------------
+    // Controller
+    //-------------------------------------------------------------------------
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            state        <= S_IDLE;
+            m_idx        <= '0;
+            n_idx        <= '0;
+            k_idx        <= '0;
+            m_tiles      <= '0;
+            n_cols       <= '0;
+            k_tiles      <= '0;
+            restore_pend <= 1'b0;
+            preempted    <= 1'b0;
+        end else begin
+            preempted <= 1'b0;
+
+            case (state)
+                S_IDLE: begin
+                    if (start || resume) begin
+                        state        <= S_FETCH;
+                        m_tiles      <= num_m_tiles;
+                        n_cols       <= num_n;
+                        k_tiles      <= num_k_tiles;
+                        m_idx        <= resume ? resume_m : '0;
+                        n_idx        <= resume ? resume_n : '0;
+                        k_idx        <= resume ? resume_k : '0;
+                        restore_pend <= resume && (resume_k != '0);
+                    end
+                end
+
+                S_FETCH: if (tile_ack) state <= S_RUN;
+
+                S_RUN: begin
+                    state        <= S_WAIT;
+                    restore_pend <= 1'b0;
+                end
+
+                S_WAIT: if (pe_done) state <= last_k ? S_STORE : S_NEXT;
+
+                S_STORE: if (store_ack) state <= S_NEXT;
+
+                // Tile boundary: the only point where a preemption is taken
+                S_NEXT: begin
+                    if (last_k && last_n && last_m) begin
+                        state <= S_DONE;
+                    end else begin
+                        if (!last_k) begin
+                            k_idx <= k_idx + 1'b1;
+                        end else begin
+                            k_idx <= '0;
+                            if (!last_n) begin
+                                n_idx <= n_idx + 1'b1;
+                            end else begin
+                                n_idx <= '0;
+                                m_idx <= m_idx + 1'b1;
+                            end
+                        end
+                        state <= preempt ? S_SAVE : S_FETCH;
+                    end
+                end
+
+                S_SAVE: begin
+                    if (ctx_save_ack) begin
+                        state     <= S_IDLE;
+                        preempted <= 1'b1;
+                    end
+                end
+
+                S_DONE: state <= S_IDLE;
+
+                default: state <= S_IDLE;
+            endcase
+        end
+    end
+
+endmodule
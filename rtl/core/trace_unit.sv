@@ -0,0 +1,180 @@
+//-----------------------------------------------------------------------------
+// Module: trace_unit
+// Description: Timestamped event trace into an on-chip ring buffer
+//              Entry (64-bit): {ts[31:0], id[7:0], arg[23:0]}
+//              - ts: cycle counter, runs while enabled, 0 after clear
+//              - One pending slot per event id; the lowest pending id is
+//                written each cycle. An event that finds its slot still
+//                full is counted in dropped
+//              - filter: events with a 0 bit are ignored
+//              - trig_en: nothing is recorded before the first trig_event
+//                (recorded itself if its filter bit is set)
+//              - stop_full = 0: ring wraps (newest DEPTH entries kept);
+//                stop_full = 1: recording stops when the ring is full
+//              - Read port: rd_idx → {rd_ts, rd_evt}, 1-cycle latency
+//              Matches ref_trace_unit() in sw/ref; decoded to the timeline
+//              format by sw/ref/npu_trace.c
+//-----------------------------------------------------------------------------
+
+module trace_unit #(
+    parameter int NUM_EVENTS = 8,
+    parameter int DEPTH      = 256,   // Power of 2
+    parameter int ARG_WIDTH  = 24,
+    parameter int TS_WIDTH   = 32,
+    parameter int IDX_WIDTH  = $clog2(DEPTH)
+)(
+    input  logic                                  clk,
+    input  logic                                  rst_n,
+
+    // Configuration (TRACE_CTRL / TRACE_FILTER / TRACE_TRIG)
+    input  logic                                  enable,
+    input  logic                                  clear,       // Pulse
+    input  logic                                  stop_full,
+    input  logic                                  trig_en,
+    input  logic [$clog2(NUM_EVENTS)-1:0]         trig_event,
+    input  logic [NUM_EVENTS-1:0]                 filter,
+
+    // Events
+    input  logic [NUM_EVENTS-1:0]                 ev_valid,
+    input  logic [NUM_EVENTS-1:0][ARG_WIDTH-1:0]  ev_arg,
+
+    // Status (TRACE_STATUS / TRACE_DROPPED)
+    output logic [IDX_WIDTH-1:0]                  wr_ptr,      // Next entry
+    output logic                                  wrapped,
+    output logic                                  triggered,
+    output logic                                  stopped,
+    output logic [31:0]                           dropped,
+
+    // Read port (TRACE_RD_IDX → TRACE_RD_TS / TRACE_RD_EVT)
+    input  logic [IDX_WIDTH-1:0]                  rd_idx,
+    output logic [TS_WIDTH-1:0]                   rd_ts,
+    output logic [31:0]                           rd_evt
+);
+
+    //-------------------------------------------------------------------------
+    // Local Parameters
+    //-------------------------------------------------------------------------
+    localparam int ENTRY_WIDTH = TS_WIDTH + 8 + ARG_WIDTH;
+
+    //-------------------------------------------------------------------------
+    // Timestamp
+    //-------------------------------------------------------------------------
+    logic [TS_WIDTH-1:0] ts;
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n)
+            ts <= '0;
+        else if (clear)
+            ts <= '0;
+        else if (enable)
+            ts <= ts + 1'b1;
+    end
+
+    //-------------------------------------------------------------------------
+    // Pending Slots + Arbiter (lowest id first)
+    //-------------------------------------------------------------------------
+    logic [NUM_EVENTS-1:0]                pend;
+    logic [TS_WIDTH-1:0]                  pend_ts  [NUM_EVENTS];
+    logic [ARG_WIDTH-1:0]                 pend_arg [NUM_EVENTS];
+    logic [$clog2(NUM_EVENTS)-1:0]        sel;
+    logic                                 wr_fire;
+    logic [NUM_EVENTS-1:0]                accept;
+    logic [NUM_EVENTS-1:0]                drop;
+
+    always_comb begin
+        sel = '0;
+        for (int e = NUM_EVENTS - 1; e >= 0; e--)
+            if (pend[e]) sel = e[$clog2(NUM_EVENTS)-1:0];
+    end
+
+    assign wr_fire = (|pend) && !stopped;
+
+    always_comb begin
+        for (int e = 0; e < NUM_EVENTS; e++) begin
+            accept[e] = enable && ev_valid[e] && filter[e] && !stopped &&
+                        (triggered || !trig_en || e == int'(trig_event));
+            drop[e]   = accept[e] && pend[e] && !(wr_fire && sel == e);
+        end
+    end
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            pend    <= '0;
+            dropped <= '0;
+            for (int e = 0; e < NUM_EVENTS; e++) begin
+                pend_ts[e]  <= '0;
+                pend_arg[e] <= '0;
+            end
+        end else if (clear) begin
+            pend    <= '0;
+            dropped <= '0;
+        end else begin
+            if (wr_fire)
+                pend[sel] <= 1'b0;
+            for (int e = 0; e < NUM_EVENTS; e++) begin
+                if (accept[e] && !drop[e]) begin
+                    pend[e]     <= 1'b1;
+                    pend_ts[e]  <= ts;
+                    pend_arg[e] <= ev_arg[e];
+                end
+            end
+            dropped <= dropped + 32'($countones(drop));
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Ring Pointer / Trigger
+    //-------------------------------------------------------------------------
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            wr_ptr    <= '0;
+            wrapped   <= 1'b0;
+            triggered <= 1'b0;
+            stopped   <= 1'b0;
+        end else if (clear) begin
+            wr_ptr    <= '0;
+            wrapped   <= 1'b0;
+            triggered <= 1'b0;
+            stopped   <= 1'b0;
+        end else begin
+            if (enable && trig_en && ev_valid[trig_event])
+                triggered <= 1'b1;
+            if (wr_fire) begin
+                wr_ptr <= wr_ptr + 1'b1;
+                if (wr_ptr == IDX_WIDTH'(DEPTH - 1)) begin
+                    wrapped <= 1'b1;
+                    stopped <= stop_full;
+                end
+            end
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Ring Buffer (port A: arbiter, port B: register read)
+    //-------------------------------------------------------------------------
+    logic [ENTRY_WIDTH-1:0] wr_entry;
+    logic [ENTRY_WIDTH-1:0] rd_entry;
+
+    assign wr_entry = {pend_ts[sel], 8'(sel), pend_arg[sel]};
+
+    sim_dual_port_bram #(
+        .RAM_WIDTH       (ENTRY_WIDTH),
+        .RAM_DEPTH       (DEPTH),
+        .RAM_PERFORMANCE ("LOW_LATENCY"),
+        .INIT_FILE       ("")
+    ) u_ring (
+        .addra  (wr_ptr),
+        .addrb  (rd_idx),
+        .dina   (wr_entry),
+        .clka   (clk),
+        .wea    (wr_fire),
+        .enb    (1'b1),
+        .rstb   (rst_n),
+        .regceb (1'b1),
+        .doutb  (rd_entry)
+    );
+
+    assign rd_ts  = rd_entry[ENTRY_WIDTH-1 -: TS_WIDTH];
+    assign rd_evt = 32'(rd_entry[8+ARG_WIDTH-1:0]);
+
+endmodule
@@ -0,0 +1,351 @@
+//-----------------------------------------------------------------------------
+// Module: axi4_buf_slave
+// Description: AXI4 memory-mapped window onto the top_pe BRAM buffers
+//              Address: {pe, region[1:0], offset[11:0]}
+//              - region 0: weight buffer lines (WLINE_WIDTH/8 bytes, W only)
+//              - region 1: input buffer lines  (ILINE_WIDTH/8 bytes, W only)
+//              - region 2: output buffer lines (OLINE_WIDTH/8 bytes, R only)
+//              Byte i of a line is line[8*i +: 8] (top_pe packing)
+//              INCR bursts of full-width beats (AxSIZE = log2(DATA_WIDTH/8)),
+//              one write and one read burst in flight, one beat per cycle
+//              Width converter:
+//              - Write: beats are merged (WSTRB) into a line register; the
+//                line is written to the buffer after its last beat (whole
+//                lines per burst; bytes not written keep the register's
+//                previous value, the buffer ports have no byte enables)
+//              - Read: output lines are fetched ahead into a 2-line queue
+//                (2-cycle BRAM latency) and returned beat by beat
+//              SLVERR: wrong region/direction, narrow size, non-INCR burst,
+//              PE or line out of range (no buffer access, beats consumed)
+//-----------------------------------------------------------------------------
+
+module axi4_buf_slave #(
+    parameter int NUM_PE         = 16,
+    parameter int AXI_ADDR_WIDTH = 20,
+    parameter int AXI_DATA_WIDTH = 64,     // <= ILINE_WIDTH
+    parameter int AXI_ID_WIDTH   = 4,
+    parameter int BUF_DEPTH      = 4,
+    parameter int WLINE_WIDTH    = 2048,   // SUBARRAY_ROWS*SUBARRAY_COLS*WEIGHT_WIDTH
+    parameter int ILINE_WIDTH    = 64,     // SUBARRAY_COLS*INPUT_WIDTH
+    parameter int OLINE_WIDTH    = 1024    // SUBARRAY_ROWS*OUTPUT_WIDTH
+)(
+    input  logic                                clk,
+    input  logic                                rst_n,
+
+    //-------------------------------------------------------------------------
+    // AXI4 Slave Interface
+    //-------------------------------------------------------------------------
+    // Write Address Channel
+    input  logic [AXI_ID_WIDTH-1:0]             s_axi_awid,
+    input  logic [AXI_ADDR_WIDTH-1:0]           s_axi_awaddr,
+    input  logic [7:0]                          s_axi_awlen,
+    input  logic [2:0]                          s_axi_awsize,
+    input  logic [1:0]                          s_axi_awburst,
+    input  logic                                s_axi_awvalid,
+    output logic                                s_axi_awready,
+
+    // Write Data Channel
+    input  logic [AXI_DATA_WIDTH-1:0]           s_axi_wdata,
+    input  logic [AXI_DATA_WIDTH/8-1:0]         s_axi_wstrb,
+    input  logic                                s_axi_wlast,
+    input  logic                                s_axi_wvalid,
+    output logic                                s_axi_wready,
+
+    // Write Response Channel
+    output logic [AXI_ID_WIDTH-1:0]             s_axi_bid,
+    output logic [1:0]                          s_axi_bresp,
+    output logic                                s_axi_bvalid,
+    input  logic                                s_axi_bready,
+
+    // Read Address Channel
+    input  logic [AXI_ID_WIDTH-1:0]             s_axi_arid,
+    input  logic [AXI_ADDR_WIDTH-1:0]           s_axi_araddr,
+    input  logic [7:0]                          s_axi_arlen,
+    input  logic [2:0]                          s_axi_arsize,
+    input  logic [1:0]                          s_axi_arburst,
+    input  logic                                s_axi_arvalid,
+    output logic                                s_axi_arready,
+
+    // Read Data Channel
+    output logic [AXI_ID_WIDTH-1:0]             s_axi_rid,
+    output logic [AXI_DATA_WIDTH-1:0]           s_axi_rdata,
+    output logic [1:0]                          s_axi_rresp,
+    output logic                                s_axi_rlast,
+    output logic                                s_axi_rvalid,
+    input  logic                                s_axi_rready,
+
+    //-------------------------------------------------------------------------
+    // top_pe Buffer Ports (address/data shared, enable per PE)
+    //-------------------------------------------------------------------------
+    output logic [$clog2(BUF_DEPTH)-1:0]        wbuf_wr_addr,
+    output logic [WLINE_WIDTH-1:0]              wbuf_wr_data,
+    output logic [NUM_PE-1:0]                   wbuf_wr_en,
+
+    output logic [$clog2(BUF_DEPTH)-1:0]        ibuf_wr_addr,
+    output logic [ILINE_WIDTH-1:0]              ibuf_wr_data,
+    output logic [NUM_PE-1:0]                   ibuf_wr_en,
+
+    output logic [$clog2(BUF_DEPTH)-1:0]        obuf_rd_addr,
+    output logic [NUM_PE-1:0]                   obuf_rd_en,
+    input  logic [NUM_PE-1:0][OLINE_WIDTH-1:0]  obuf_rd_data
+);
+
+    //-------------------------------------------------------------------------
+    // Local Parameters
+    //-------------------------------------------------------------------------
+    localparam int BEAT_BYTES  = AXI_DATA_WIDTH / 8;
+    localparam int BEAT_SHIFT  = $clog2(BEAT_BYTES);
+    localparam int WLINE_SHIFT = $clog2(WLINE_WIDTH / 8);
+    localparam int ILINE_SHIFT = $clog2(ILINE_WIDTH / 8);
+    localparam int OLINE_SHIFT = $clog2(OLINE_WIDTH / 8);
+    localparam int OBEATS      = OLINE_WIDTH / AXI_DATA_WIDTH;
+    localparam int PE_SEL_W    = (NUM_PE > 1) ? $clog2(NUM_PE) : 1;
+    localparam int LINE_W      = $clog2(BUF_DEPTH);
+
+    localparam logic [1:0] REGION_W = 2'd0;
+    localparam logic [1:0] REGION_X = 2'd1;
+    localparam logic [1:0] REGION_Y = 2'd2;
+
+    localparam logic [1:0] BURST_INCR = 2'b01;
+    localparam logic [1:0] RESP_OKAY  = 2'b00;
+    localparam logic [1:0] RESP_SLVERR= 2'b10;
+
+    //-------------------------------------------------------------------------
+    // Write Path
+    //-------------------------------------------------------------------------
+    typedef enum logic [1:0] {
+        W_IDLE = 2'b00,
+        W_DATA = 2'b01,
+        W_RESP = 2'b10
+    } w_state_t;
+
+    w_state_t                  w_state;
+    logic [AXI_ID_WIDTH-1:0]   w_id;
+    logic [11:0]               w_off;
+    logic [1:0]                w_region;
+    logic [PE_SEL_W-1:0]       w_pe;
+    logic                      w_err;          // Whole burst rejected
+    logic                      w_bad;          // SLVERR response
+    logic [WLINE_WIDTH-1:0]    w_line_reg;
+
+    logic [11:0]               w_line;
+    logic [11:0]               w_beat;
+    logic                      w_line_last;
+    logic                      w_beat_ok;
+
+    logic                      commit_en;
+    logic [1:0]                commit_region;
+    logic [PE_SEL_W-1:0]       commit_pe;
+    logic [LINE_W-1:0]         commit_line;
+
+    always_comb begin
+        if (w_region == REGION_W) begin
+            w_line      = w_off >> WLINE_SHIFT;
+            w_beat      = (w_off & 12'((1 << WLINE_SHIFT) - 1)) >> BEAT_SHIFT;
+            w_line_last = (w_beat == 12'((WLINE_WIDTH / AXI_DATA_WIDTH) - 1));
+        end else begin
+            w_line      = w_off >> ILINE_SHIFT;
+            w_beat      = (w_off & 12'((1 << ILINE_SHIFT) - 1)) >> BEAT_SHIFT;
+            w_line_last = (w_beat == 12'((ILINE_WIDTH / AXI_DATA_WIDTH) - 1));
+        end
+        w_beat_ok = !w_err && (w_line < 12'(BUF_DEPTH));
+    end
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            w_state       <= W_IDLE;
+            w_id          <= '0;
+            w_off         <= '0;
+            w_region      <= '0;
+            w_pe          <= '0;
+            w_err         <= 1'b0;
+            w_bad         <= 1'b0;
+            w_line_reg    <= '0;
+            commit_en     <= 1'b0;
+            commit_region <= '0;
+            commit_pe     <= '0;
+            commit_line   <= '0;
+        end else begin
+            commit_en <= 1'b0;
+            case (w_state)
+                W_IDLE: begin
+                    if (s_axi_awvalid) begin
+                        w_id     <= s_axi_awid;
+                        w_off    <= s_axi_awaddr[11:0];
+                        w_region <= s_axi_awaddr[13:12];
+                        w_pe     <= s_axi_awaddr[14 +: PE_SEL_W];
+                        w_err    <= (s_axi_awaddr[13:12] != REGION_W && s_axi_awaddr[13:12] != REGION_X) ||
+                                    s_axi_awsize != 3'(BEAT_SHIFT) || s_axi_awburst != BURST_INCR ||
+                                    int'(s_axi_awaddr[14 +: PE_SEL_W]) >= NUM_PE;
+                        w_bad    <= 1'b0;
+                        w_state  <= W_DATA;
+                    end
+                end
+
+                W_DATA: begin
+                    if (s_axi_wvalid) begin
+                        if (w_beat_ok) begin
+                            for (int b = 0; b < BEAT_BYTES; b++) begin
+                                if (s_axi_wstrb[b])
+                                    w_line_reg[(int'(w_beat) * BEAT_BYTES + b) * 8 +: 8] <= s_axi_wdata[b*8 +: 8];
+                            end
+                            // Line complete: written from the register next cycle
+                            if (w_line_last) begin
+                                commit_en     <= 1'b1;
+                                commit_region <= w_region;
+                                commit_pe     <= w_pe;
+                                commit_line   <= LINE_W'(w_line);
+                            end
+                        end else begin
+                            w_bad <= 1'b1;
+                        end
+                        w_off <= w_off + 12'(BEAT_BYTES);
+                        if (s_axi_wlast)
+                            w_state <= W_RESP;
+                    end
+                end
+
+                W_RESP: begin
+                    if (s_axi_bready)
+                        w_state <= W_IDLE;
+                end
+
+                default: w_state <= W_IDLE;
+            endcase
+        end
+    end
+
+    assign s_axi_awready = (w_state == W_IDLE);
+    assign s_axi_wready  = (w_state == W_DATA);
+    assign s_axi_bvalid  = (w_state == W_RESP);
+    assign s_axi_bid     = w_id;
+    assign s_axi_bresp   = w_bad ? RESP_SLVERR : RESP_OKAY;
+
+    assign wbuf_wr_addr  = commit_line;
+    assign wbuf_wr_data  = w_line_reg;
+    assign ibuf_wr_addr  = commit_line;
+    assign ibuf_wr_data  = w_line_reg[ILINE_WIDTH-1:0];
+
+    generate
+        for (genvar p = 0; p < NUM_PE; p++) begin : gen_wr_en
+            assign wbuf_wr_en[p] = commit_en && commit_region == REGION_W && int'(commit_pe) == p;
+            assign ibuf_wr_en[p] = commit_en && commit_region == REGION_X && int'(commit_pe) == p;
+        end
+    endgenerate
+
+    //-------------------------------------------------------------------------
+    // Read Path
+    //-------------------------------------------------------------------------
+    typedef enum logic {
+        R_IDLE = 1'b0,
+        R_DATA = 1'b1
+    } r_state_t;
+
+    r_state_t                  r_state;
+    logic [AXI_ID_WIDTH-1:0]   r_id;
+    logic [11:0]               r_off;
+    logic [PE_SEL_W-1:0]       r_pe;
+    logic                      r_err;
+    logic [7:0]                r_beats_left;   // Beats after the current one
+    logic [LINE_W:0]           r_issue_left;   // Lines still to fetch
+    logic [LINE_W-1:0]         r_issue_line;
+    logic [1:0]                r_pipe;         // Fetches in flight (BRAM latency)
+    logic [1:0]                r_cnt;          // Lines queued
+    logic [OLINE_WIDTH-1:0]    r_slot [2];     // [0]: line being returned
+
+    logic [11:0]               ar_first;
+    logic [11:0]               ar_last;
+    logic                      ar_err;
+    logic [11:0]               r_beat;
+    logic                      r_issue;
+    logic                      r_fire;
+    logic                      r_pop;
+    logic                      r_push;
+
+    assign ar_first = s_axi_araddr[11:0] >> OLINE_SHIFT;
+    assign ar_last  = 12'((int'(s_axi_araddr[11:0]) + (int'(s_axi_arlen) + 1) * BEAT_BYTES - 1) >> OLINE_SHIFT);
+
+    assign ar_err   = s_axi_araddr[13:12] != REGION_Y ||
+                      s_axi_arsize != 3'(BEAT_SHIFT) || s_axi_arburst != BURST_INCR ||
+                      int'(s_axi_araddr[14 +: PE_SEL_W]) >= NUM_PE ||
+                      ar_last >= 12'(BUF_DEPTH);
+
+    assign r_beat  = (r_off & 12'((1 << OLINE_SHIFT) - 1)) >> BEAT_SHIFT;
+    assign r_issue = (r_state == R_DATA) && (r_issue_left != '0) &&
+                     (int'(r_cnt) + int'(r_pipe[0]) + int'(r_pipe[1]) < 2);
+    assign r_fire  = s_axi_rvalid && s_axi_rready;
+    assign r_pop   = r_fire && !r_err && (r_beat == 12'(OBEATS - 1) || s_axi_rlast);
+    assign r_push  = r_pipe[1];
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            r_state      <= R_IDLE;
+            r_id         <= '0;
+            r_off        <= '0;
+            r_pe         <= '0;
+            r_err        <= 1'b0;
+            r_beats_left <= '0;
+            r_issue_left <= '0;
+            r_issue_line <= '0;
+            r_pipe       <= '0;
+            r_cnt        <= '0;
+            r_slot[0]    <= '0;
+            r_slot[1]    <= '0;
+        end else begin
+            r_pipe <= {r_pipe[0], r_issue};
+            if (r_issue) begin
+                r_issue_left <= r_issue_left - 1'b1;
+                r_issue_line <= r_issue_line + 1'b1;
+            end
+
+            // Line queue: pop the returned line, push the fetched one behind
+            if (r_pop)
+                r_slot[0] <= r_slot[1];
+            if (r_push)
+                r_slot[int'(r_cnt) - int'(r_pop)] <= obuf_rd_data[r_pe];
+            r_cnt <= r_cnt - 2'(r_pop) + 2'(r_push);
+
+            case (r_state)
+                R_IDLE: begin
+                    if (s_axi_arvalid) begin
+                        r_id         <= s_axi_arid;
+                        r_off        <= s_axi_araddr[11:0];
+                        r_pe         <= s_axi_araddr[14 +: PE_SEL_W];
+                        r_beats_left <= s_axi_arlen;
+                        r_err        <= ar_err;
+                        r_issue_left <= ar_err ? '0 : (LINE_W+1)'(ar_last - ar_first + 1'b1);
+                        r_issue_line <= LINE_W'(ar_first);
+                        r_state      <= R_DATA;
+                    end
+                end
+
+                R_DATA: begin
+                    if (r_fire) begin
+                        r_off        <= r_off + 12'(BEAT_BYTES);
+                        r_beats_left <= r_beats_left - 1'b1;
+                        if (s_axi_rlast)
+                            r_state <= R_IDLE;
+                    end
+                end
+
+                default: r_state <= R_IDLE;
+            endcase
+        end
+    end
+
+    assign s_axi_arready = (r_state == R_IDLE);
+    assign s_axi_rvalid  = (r_state == R_DATA) && (r_err || r_cnt != '0);
+    assign s_axi_rid     = r_id;
+    assign s_axi_rdata   = r_err ? '0 : r_slot[0][int'(r_beat) * AXI_DATA_WIDTH +: AXI_DATA_WIDTH];
+    assign s_axi_rresp   = r_err ? RESP_SLVERR : RESP_OKAY;
+    assign s_axi_rlast   = (r_beats_left == '0);
+
+    assign obuf_rd_addr  = r_issue_line;
+
+    generate
+        for (genvar p = 0; p < NUM_PE; p++) begin : gen_rd_en
+            assign obuf_rd_en[p] = r_issue && int'(r_pe) == p;
+        end
+    endgenerate
+
+endmodule
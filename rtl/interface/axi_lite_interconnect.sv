@@ -0,0 +1,202 @@
+//-----------------------------------------------------------------------------
+// Module: axi_lite_interconnect
+// Description: 1-to-N AXI4-Lite interconnect (address decoder / router)
+//              Slave window i = addr[SLAVE_ADDR_WIDTH +: SEL_WIDTH] == i
+//              - One outstanding write and one outstanding read
+//              - Response returns from the slave latched at request time
+//              - Addresses past the last slave get a DECERR response
+//-----------------------------------------------------------------------------
+
+module axi_lite_interconnect #(
+    parameter int NUM_SLAVES       = 4,
+    parameter int SLAVE_ADDR_WIDTH = 12,   // Per-slave window (npu_top: 4 KB)
+    parameter int AXI_ADDR_WIDTH   = SLAVE_ADDR_WIDTH + $clog2(NUM_SLAVES),
+    parameter int AXI_DATA_WIDTH   = 32
+)(
+    input  logic                      clk,
+    input  logic                      rst_n,
+
+    //-------------------------------------------------------------------------
+    // Upstream AXI4-Lite Slave Port (from host)
+    //-------------------------------------------------------------------------
+    input  logic [AXI_ADDR_WIDTH-1:0] s_axi_awaddr,
+    input  logic                      s_axi_awvalid,
+    output logic                      s_axi_awready,
+
+    input  logic [AXI_DATA_WIDTH-1:0] s_axi_wdata,
+    input  logic [AXI_DATA_WIDTH/8-1:0] s_axi_wstrb,
+    input  logic                      s_axi_wvalid,
+    output logic                      s_axi_wready,
+
+    output logic [1:0]                s_axi_bresp,
+    output logic                      s_axi_bvalid,
+    input  logic                      s_axi_bready,
+
+    input  logic [AXI_ADDR_WIDTH-1:0] s_axi_araddr,
+    input  logic                      s_axi_arvalid,
+    output logic                      s_axi_arready,
+
+    output logic [AXI_DATA_WIDTH-1:0] s_axi_rdata,
+    output logic [1:0]                s_axi_rresp,
+    output logic                      s_axi_rvalid,
+    input  logic                      s_axi_rready,
+
+    //-------------------------------------------------------------------------
+    // Downstream AXI4-Lite Master Ports (to npu_top instances)
+    //-------------------------------------------------------------------------
+    output logic [NUM_SLAVES-1:0][SLAVE_ADDR_WIDTH-1:0] m_axi_awaddr,
+    output logic [NUM_SLAVES-1:0]                       m_axi_awvalid,
+    input  logic [NUM_SLAVES-1:0]                       m_axi_awready,
+
+    output logic [NUM_SLAVES-1:0][AXI_DATA_WIDTH-1:0]   m_axi_wdata,
+    output logic [NUM_SLAVES-1:0][AXI_DATA_WIDTH/8-1:0] m_axi_wstrb,
+    output logic [NUM_SLAVES-1:0]                       m_axi_wvalid,
+    input  logic [NUM_SLAVES-1:0]                       m_axi_wready,
+
+    input  logic [NUM_SLAVES-1:0][1:0]                  m_axi_bresp,
+    input  logic [NUM_SLAVES-1:0]                       m_axi_bvalid,
+    output logic [NUM_SLAVES-1:0]                       m_axi_bready,
+
+    output logic [NUM_SLAVES-1:0][SLAVE_ADDR_WIDTH-1:0] m_axi_araddr,
+    output logic [NUM_SLAVES-1:0]                       m_axi_arvalid,
+    input  logic [NUM_SLAVES-1:0]                       m_axi_arready,
+
+    input  logic [NUM_SLAVES-1:0][AXI_DATA_WIDTH-1:0]   m_axi_rdata,
+    input  logic [NUM_SLAVES-1:0][1:0]                  m_axi_rresp,
+    input  logic [NUM_SLAVES-1:0]                       m_axi_rvalid,
+    output logic [NUM_SLAVES-1:0]                       m_axi_rready
+);
+
+    //-------------------------------------------------------------------------
+    // Local Parameters
+    //-------------------------------------------------------------------------
+    localparam int SEL_WIDTH = (AXI_ADDR_WIDTH > SLAVE_ADDR_WIDTH) ?
+                               AXI_ADDR_WIDTH - SLAVE_ADDR_WIDTH : 1;
+    localparam logic [1:0] RESP_DECERR = 2'b11;
+
+    //-------------------------------------------------------------------------
+    // Address Decode
+    //-------------------------------------------------------------------------
+    logic [SEL_WIDTH-1:0] aw_sel, ar_sel;
+    logic                 aw_hit, ar_hit;
+
+    assign aw_sel = (AXI_ADDR_WIDTH > SLAVE_ADDR_WIDTH) ? s_axi_awaddr[AXI_ADDR_WIDTH-1:SLAVE_ADDR_WIDTH] : '0;
+    assign ar_sel = (AXI_ADDR_WIDTH > SLAVE_ADDR_WIDTH) ? s_axi_araddr[AXI_ADDR_WIDTH-1:SLAVE_ADDR_WIDTH] : '0;
+    assign aw_hit = (aw_sel < NUM_SLAVES);
+    assign ar_hit = (ar_sel < NUM_SLAVES);
+
+    //-------------------------------------------------------------------------
+    // Write Path
+    //   W_IDLE: forward AW+W to the decoded slave (or accept for DECERR)
+    //   W_RESP: wait for B from the latched slave (or return DECERR)
+    //-------------------------------------------------------------------------
+    typedef enum logic [1:0] {
+        W_IDLE   = 2'b00,
+        W_RESP   = 2'b01,
+        W_DECERR = 2'b10
+    } wr_state_t;
+
+    wr_state_t            wr_state;
+    logic [SEL_WIDTH-1:0] wr_sel;
+    logic                 wr_accept;
+
+    // axi_lite_slave accepts AW and W together, so both are routed as a pair
+    assign wr_accept = s_axi_awvalid && s_axi_wvalid &&
+                       (aw_hit ? (m_axi_awready[aw_sel] && m_axi_wready[aw_sel]) : 1'b1);
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            wr_state <= W_IDLE;
+            wr_sel   <= '0;
+        end else begin
+            case (wr_state)
+                W_IDLE: begin
+                    if (wr_accept) begin
+                        wr_sel   <= aw_sel;
+                        wr_state <= aw_hit ? W_RESP : W_DECERR;
+                    end
+                end
+                W_RESP: begin
+                    if (m_axi_bvalid[wr_sel] && s_axi_bready)
+                        wr_state <= W_IDLE;
+                end
+                W_DECERR: begin
+                    if (s_axi_bready)
+                        wr_state <= W_IDLE;
+                end
+                default: wr_state <= W_IDLE;
+            endcase
+        end
+    end
+
+    always_comb begin
+        for (int i = 0; i < NUM_SLAVES; i++) begin
+            m_axi_awaddr[i]  = s_axi_awaddr[SLAVE_ADDR_WIDTH-1:0];
+            m_axi_wdata[i]   = s_axi_wdata;
+            m_axi_wstrb[i]   = s_axi_wstrb;
+            m_axi_awvalid[i] = (wr_state == W_IDLE) && aw_hit && (aw_sel == i) &&
+                               s_axi_awvalid && s_axi_wvalid;
+            m_axi_wvalid[i]  = m_axi_awvalid[i];
+            m_axi_bready[i]  = (wr_state == W_RESP) && (wr_sel == i) && s_axi_bready;
+        end
+    end
+
+    assign s_axi_awready = (wr_state == W_IDLE) && wr_accept;
+    assign s_axi_wready  = (wr_state == W_IDLE) && wr_accept;
+    assign s_axi_bvalid  = (wr_state == W_RESP) ? m_axi_bvalid[wr_sel] : (wr_state == W_DECERR);
+    assign s_axi_bresp   = (wr_state == W_RESP) ? m_axi_bresp[wr_sel]  : RESP_DECERR;
+
+    //-------------------------------------------------------------------------
+    // Read Path
+    //-------------------------------------------------------------------------
+    typedef enum logic [1:0] {
+        R_IDLE   = 2'b00,
+        R_RESP   = 2'b01,
+        R_DECERR = 2'b10
+    } rd_state_t;
+
+    rd_state_t            rd_state;
+    logic [SEL_WIDTH-1:0] rd_sel;
+    logic                 rd_accept;
+
+    assign rd_accept = s_axi_arvalid && (ar_hit ? m_axi_arready[ar_sel] : 1'b1);
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rd_state <= R_IDLE;
+            rd_sel   <= '0;
+        end else begin
+            case (rd_state)
+                R_IDLE: begin
+                    if (rd_accept) begin
+                        rd_sel   <= ar_sel;
+                        rd_state <= ar_hit ? R_RESP : R_DECERR;
+                    end
+                end
+                R_RESP: begin
+                    if (m_axi_rvalid[rd_sel] && s_axi_rready)
+                        rd_state <= R_IDLE;
+                end
+                R_DECERR: begin
+                    if (s_axi_rready)
+                        rd_state <= R_IDLE;
+                end
+                default: rd_state <= R_IDLE;
+            endcase
+        end
+    end
+
+    always_comb begin
+        for (int i = 0; i < NUM_SLAVES; i++) begin
+            m_axi_araddr[i]  = s_axi_araddr[SLAVE_ADDR_WIDTH-1:0];
+            m_axi_arvalid[i] = (rd_state == R_IDLE) && ar_hit && (ar_sel == i) && s_axi_arvalid;
+            m_axi_rready[i]  = (rd_state == R_RESP) && (rd_sel == i) && s_axi_rready;
+        end
+    end
+
+    assign s_axi_arready = (rd_state == R_IDLE) && rd_accept;
+    assign s_axi_rvalid  = (rd_state == R_RESP) ? m_axi_rvalid[rd_sel] : (rd_state == R_DECERR);
+    assign s_axi_rdata   = (rd_state == R_RESP) ? m_axi_rdata[rd_sel]  : '0;
+    assign s_axi_rresp   = (rd_state == R_RESP) ? m_axi_rresp[rd_sel]  : RESP_DECERR;
+
+endmodule
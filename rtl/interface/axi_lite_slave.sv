@@ -6,7 +6,8 @@
 module axi_lite_slave #(
     parameter int AXI_ADDR_WIDTH = 12,
     parameter int AXI_DATA_WIDTH = 32,
-    parameter int NUM_LARGE_ARRAYS = 4
+    parameter int NUM_LARGE_ARRAYS = 4,
+    parameter int FUSE_MAX_SEGS = 4
 )(
     input  logic                      clk,
     input  logic                      rst_n,
@@ -46,6 +47,9 @@ module axi_lite_slave #(
     //-------------------------------------------------------------------------
     output logic                      ctrl_start,
     output logic                      ctrl_clear,
+    output logic                      ctrl_enqueue,
+    output logic                      ctrl_preempt,
+    output logic                      ctrl_resume,
     output logic [NUM_LARGE_ARRAYS-1:0] cluster_enable,
     output logic [NUM_LARGE_ARRAYS-1:0][3:0] pe_enable,  // 4 PEs per array (2x2)
     output logic [AXI_DATA_WIDTH-1:0] config_reg,
@@ -60,12 +64,70 @@ module axi_lite_slave #(
     output logic [AXI_DATA_WIDTH-1:0] addr_weight,
     output logic [AXI_DATA_WIDTH-1:0] addr_output,
 
+    // Fused GEMV segments (fuse_cnt < 2: single GEMV). Register-only: the
+    // fused-job sequencing is modelled in sw/ref/npu_emu.c and not yet part
+    // of npu_top, so no RTL consumes these outputs
+    output logic [2:0]                fuse_cnt,
+    output logic [FUSE_MAX_SEGS-1:0][AXI_DATA_WIDTH-1:0] fuse_m,
+    output logic [FUSE_MAX_SEGS-1:0][AXI_DATA_WIDTH-1:0] fuse_out,
+
+    // Paged KV cache block table
+    output logic [AXI_DATA_WIDTH-1:0] kv_table,
+    output logic [4:0]                kv_block_shift,
+
+    // Zero-copy DMA (SG chains, IOMMU)
+    output logic [2:0]                sg_en,          // [0] W, [1] X, [2] Y
+    output logic                      iommu_enable,
+    output logic                      iommu_flush,    // Pulse
+    output logic [AXI_DATA_WIDTH-1:0] iommu_pt,
+    output logic [AXI_DATA_WIDTH-1:0] iommu_pages,
+    input  logic [31:0]               tlb_hits,
+    input  logic [31:0]               tlb_misses,
+
+    // LM-head top-k
+    output logic [3:0]                topk_k,
+
+    // Rotary embedding
+    output logic [AXI_DATA_WIDTH-1:0] rope_table,
+    output logic [15:0]               rope_pos,
+
+    // Preemption context
+    output logic [AXI_DATA_WIDTH-1:0] ctx_addr,
+
+    // FP8 (CONFIG.fmt = FP8): [0] E5M2, [1] MX; MX scale tables
+    output logic [1:0]                fp8_ctrl,
+    output logic [AXI_DATA_WIDTH-1:0] mx_w_scale,
+    output logic [AXI_DATA_WIDTH-1:0] mx_x_scale,
+
+    // Event trace
+    output logic                      trace_enable,
+    output logic                      trace_clear,    // Pulse
+    output logic                      trace_stop_full,
+    output logic                      trace_trig_en,
+    output logic [2:0]                trace_trig_event,
+    output logic [7:0]                trace_filter,
+    output logic                      trace_mark,     // Pulse
+    output logic [23:0]               trace_mark_arg,
+    output logic [15:0]               trace_rd_idx,
+    input  logic [15:0]               trace_wr_ptr,
+    input  logic                      trace_wrapped,
+    input  logic                      trace_triggered,
+    input  logic                      trace_stopped,
+    input  logic [31:0]               trace_dropped,
+    input  logic [31:0]               trace_rd_ts,
+    input  logic [31:0]               trace_rd_evt,
+
+    // Job queue
+    output logic                      queue_prefetch,
+    input  logic [3:0]                queue_count,
+
     //-------------------------------------------------------------------------
     // Status Inputs from NPU
     //-------------------------------------------------------------------------
     input  logic                      status_busy,
     input  logic                      status_done,
-    input  logic                      status_error
+    input  logic                      status_error,
+    input  logic                      status_preempted
 );
 
     //-------------------------------------------------------------------------
@@ -85,6 +147,34 @@ module axi_lite_slave #(
     localparam logic [11:0] REG_ADDR_INPUT = 12'h02C;
     localparam logic [11:0] REG_ADDR_WEIGHT= 12'h030;
     localparam logic [11:0] REG_ADDR_OUTPUT= 12'h034;
+    localparam logic [11:0] REG_FUSE_CNT   = 12'h038;
+    localparam logic [11:0] REG_QUEUE      = 12'h03C;
+    localparam logic [11:0] REG_KV_TABLE   = 12'h060;
+    localparam logic [11:0] REG_KV_BLOCK   = 12'h064;
+    localparam logic [11:0] REG_SG         = 12'h068;
+    localparam logic [11:0] REG_TOPK       = 12'h06C;
+    localparam logic [11:0] REG_IOMMU_CTRL = 12'h070;
+    localparam logic [11:0] REG_IOMMU_PT   = 12'h074;
+    localparam logic [11:0] REG_IOMMU_PAGES= 12'h078;
+    localparam logic [11:0] REG_TLB_HITS   = 12'h07C;
+    localparam logic [11:0] REG_TLB_MISSES = 12'h080;
+    localparam logic [11:0] REG_ROPE_TABLE = 12'h084;
+    localparam logic [11:0] REG_ROPE_POS   = 12'h088;
+    localparam logic [11:0] REG_CTX_ADDR   = 12'h08C;
+    localparam logic [11:0] REG_TRACE_CTRL  = 12'h090;
+    localparam logic [11:0] REG_TRACE_FILTER= 12'h094;
+    localparam logic [11:0] REG_TRACE_TRIG  = 12'h098;
+    localparam logic [11:0] REG_TRACE_MARK  = 12'h09C;
+    localparam logic [11:0] REG_TRACE_STATUS= 12'h0A0;
+    localparam logic [11:0] REG_TRACE_DROP  = 12'h0A4;
+    localparam logic [11:0] REG_TRACE_RD_IDX= 12'h0A8;
+    localparam logic [11:0] REG_TRACE_RD_TS = 12'h0AC;
+    localparam logic [11:0] REG_TRACE_RD_EVT= 12'h0B0;
+    localparam logic [11:0] REG_FP8        = 12'h0B4;
+    localparam logic [11:0] REG_MX_W_SCALE = 12'h0B8;
+    localparam logic [11:0] REG_MX_X_SCALE = 12'h0BC;
+    localparam logic [11:0] REG_FUSE_M_0   = 12'h040;  // + 4*seg
+    localparam logic [11:0] REG_FUSE_OUT_0 = 12'h050;  // + 4*seg
 
     //-------------------------------------------------------------------------
     // Internal Registers
@@ -99,6 +189,29 @@ module axi_lite_slave #(
     logic [AXI_DATA_WIDTH-1:0] reg_addr_input;
     logic [AXI_DATA_WIDTH-1:0] reg_addr_weight;
     logic [AXI_DATA_WIDTH-1:0] reg_addr_output;
+    logic [2:0]                reg_fuse_cnt;
+    logic                      reg_prefetch;
+    logic [AXI_DATA_WIDTH-1:0] reg_kv_table;
+    logic [4:0]                reg_kv_block;
+    logic [2:0]                reg_sg;
+    logic [3:0]                reg_topk;
+    logic [AXI_DATA_WIDTH-1:0] reg_rope_table;
+    logic [15:0]               reg_rope_pos;
+    logic [AXI_DATA_WIDTH-1:0] reg_ctx_addr;
+    logic [1:0]                reg_fp8;
+    logic [AXI_DATA_WIDTH-1:0] reg_mx_w_scale;
+    logic [AXI_DATA_WIDTH-1:0] reg_mx_x_scale;
+    logic [3:0]                reg_trace_ctrl;
+    logic [7:0]                reg_trace_filter;
+    logic [2:0]                reg_trace_trig;
+    logic                      reg_trace_mark;
+    logic [23:0]               reg_trace_mark_arg;
+    logic [15:0]               reg_trace_rd_idx;
+    logic [1:0]                reg_iommu_ctrl;
+    logic [AXI_DATA_WIDTH-1:0] reg_iommu_pt;
+    logic [AXI_DATA_WIDTH-1:0] reg_iommu_pages;
+    logic [AXI_DATA_WIDTH-1:0] reg_fuse_m   [FUSE_MAX_SEGS];
+    logic [AXI_DATA_WIDTH-1:0] reg_fuse_out [FUSE_MAX_SEGS];
 
     // AXI state machine
     typedef enum logic [1:0] {
@@ -172,7 +285,37 @@ module axi_lite_slave #(
             reg_addr_input  <= '0;
             reg_addr_weight <= '0;
             reg_addr_output <= '0;
+            reg_fuse_cnt    <= '0;
+            reg_prefetch    <= 1'b0;
+            reg_kv_table    <= '0;
+            reg_kv_block    <= '0;
+            reg_sg          <= '0;
+            reg_topk        <= '0;
+            reg_rope_table  <= '0;
+            reg_rope_pos    <= '0;
+            reg_ctx_addr    <= '0;
+            reg_fp8         <= '0;
+            reg_mx_w_scale  <= '0;
+            reg_mx_x_scale  <= '0;
+            reg_trace_ctrl  <= '0;
+            reg_trace_filter<= 8'hFF;  // Default: all events
+            reg_trace_trig  <= '0;
+            reg_trace_mark  <= 1'b0;
+            reg_trace_mark_arg <= '0;
+            reg_trace_rd_idx<= '0;
+            reg_iommu_ctrl  <= '0;
+            reg_iommu_pt    <= '0;
+            reg_iommu_pages <= '0;
+            // Fused-job segments: emulator-only (sw/ref/npu_emu.c)
+            for (int i = 0; i < FUSE_MAX_SEGS; i++) begin
+                reg_fuse_m[i]   <= '0;
+                reg_fuse_out[i] <= '0;
+            end
         end else if (axi_state == AXI_IDLE && s_axi_awvalid && s_axi_wvalid) begin
+            for (int i = 0; i < FUSE_MAX_SEGS; i++) begin
+                if (s_axi_awaddr[11:0] == REG_FUSE_M_0   + 12'(4*i)) reg_fuse_m[i]   <= s_axi_wdata;
+                if (s_axi_awaddr[11:0] == REG_FUSE_OUT_0 + 12'(4*i)) reg_fuse_out[i] <= s_axi_wdata;
+            end
             case (s_axi_awaddr[11:0])
                 REG_CTRL:        reg_ctrl        <= s_axi_wdata;
                 REG_CLUSTER_EN:  reg_cluster_en  <= s_axi_wdata;
@@ -187,12 +330,41 @@ module axi_lite_slave #(
                 REG_ADDR_INPUT:  reg_addr_input  <= s_axi_wdata;
                 REG_ADDR_WEIGHT: reg_addr_weight <= s_axi_wdata;
                 REG_ADDR_OUTPUT: reg_addr_output <= s_axi_wdata;
+                REG_FUSE_CNT:    reg_fuse_cnt    <= s_axi_wdata[2:0];
+                REG_QUEUE:       reg_prefetch    <= s_axi_wdata[0];
+                REG_KV_TABLE:    reg_kv_table    <= s_axi_wdata;
+                REG_KV_BLOCK:    reg_kv_block    <= s_axi_wdata[4:0];
+                REG_SG:          reg_sg          <= s_axi_wdata[2:0];
+                REG_TOPK:        reg_topk        <= s_axi_wdata[3:0];
+                REG_ROPE_TABLE:  reg_rope_table  <= s_axi_wdata;
+                REG_ROPE_POS:    reg_rope_pos    <= s_axi_wdata[15:0];
+                REG_CTX_ADDR:    reg_ctx_addr    <= s_axi_wdata;
+                REG_FP8:         reg_fp8         <= s_axi_wdata[1:0];
+                REG_MX_W_SCALE:  reg_mx_w_scale  <= s_axi_wdata;
+                REG_MX_X_SCALE:  reg_mx_x_scale  <= s_axi_wdata;
+                REG_TRACE_CTRL:  reg_trace_ctrl  <= s_axi_wdata[3:0];
+                REG_TRACE_FILTER:reg_trace_filter<= s_axi_wdata[7:0];
+                REG_TRACE_TRIG:  reg_trace_trig  <= s_axi_wdata[2:0];
+                REG_TRACE_MARK: begin
+                    reg_trace_mark     <= 1'b1;
+                    reg_trace_mark_arg <= s_axi_wdata[23:0];
+                end
+                REG_TRACE_RD_IDX:reg_trace_rd_idx<= s_axi_wdata[15:0];
+                REG_IOMMU_CTRL:  reg_iommu_ctrl  <= s_axi_wdata[1:0];
+                REG_IOMMU_PT:    reg_iommu_pt    <= s_axi_wdata;
+                REG_IOMMU_PAGES: reg_iommu_pages <= s_axi_wdata;
                 default: ;
             endcase
         end else begin
-            // Auto-clear start and clear bits
-            reg_ctrl[0] <= 1'b0;  // start
-            reg_ctrl[1] <= 1'b0;  // clear
+            // Auto-clear pulse bits
+            reg_ctrl[0]       <= 1'b0;  // start
+            reg_ctrl[1]       <= 1'b0;  // clear
+            reg_ctrl[2]       <= 1'b0;  // enqueue
+            reg_ctrl[3]       <= 1'b0;  // preempt
+            reg_ctrl[4]       <= 1'b0;  // resume
+            reg_iommu_ctrl[1] <= 1'b0;  // TLB flush
+            reg_trace_ctrl[1] <= 1'b0;  // Trace clear
+            reg_trace_mark    <= 1'b0;  // Trace marker
         end
     end
 
@@ -203,7 +375,7 @@ module axi_lite_slave #(
         s_axi_rdata = '0;
         case (addr_reg[11:0])
             REG_CTRL:       s_axi_rdata = reg_ctrl;
-            REG_STATUS:     s_axi_rdata = {29'b0, status_error, status_done, status_busy};
+            REG_STATUS:     s_axi_rdata = {28'b0, status_preempted, status_error, status_done, status_busy};
             REG_CLUSTER_EN: s_axi_rdata = reg_cluster_en;
             REG_PE_EN_0:    s_axi_rdata = reg_pe_en[0];
             REG_PE_EN_1:    s_axi_rdata = reg_pe_en[1];
@@ -216,8 +388,37 @@ module axi_lite_slave #(
             REG_ADDR_INPUT:  s_axi_rdata = reg_addr_input;
             REG_ADDR_WEIGHT: s_axi_rdata = reg_addr_weight;
             REG_ADDR_OUTPUT: s_axi_rdata = reg_addr_output;
+            REG_FUSE_CNT:    s_axi_rdata = {29'b0, reg_fuse_cnt};
+            REG_QUEUE:       s_axi_rdata = {20'b0, queue_count, 7'b0, reg_prefetch};
+            REG_KV_TABLE:    s_axi_rdata = reg_kv_table;
+            REG_KV_BLOCK:    s_axi_rdata = {27'b0, reg_kv_block};
+            REG_SG:          s_axi_rdata = {29'b0, reg_sg};
+            REG_TOPK:        s_axi_rdata = {28'b0, reg_topk};
+            REG_ROPE_TABLE:  s_axi_rdata = reg_rope_table;
+            REG_ROPE_POS:    s_axi_rdata = {16'b0, reg_rope_pos};
+            REG_CTX_ADDR:    s_axi_rdata = reg_ctx_addr;
+            REG_FP8:         s_axi_rdata = {30'b0, reg_fp8};
+            REG_MX_W_SCALE:  s_axi_rdata = reg_mx_w_scale;
+            REG_MX_X_SCALE:  s_axi_rdata = reg_mx_x_scale;
+            REG_TRACE_CTRL:  s_axi_rdata = {28'b0, reg_trace_ctrl[3:2], 1'b0, reg_trace_ctrl[0]};
+            REG_TRACE_FILTER:s_axi_rdata = {24'b0, reg_trace_filter};
+            REG_TRACE_TRIG:  s_axi_rdata = {29'b0, reg_trace_trig};
+            REG_TRACE_STATUS:s_axi_rdata = {13'b0, trace_stopped, trace_triggered, trace_wrapped, trace_wr_ptr};
+            REG_TRACE_DROP:  s_axi_rdata = trace_dropped;
+            REG_TRACE_RD_IDX:s_axi_rdata = {16'b0, reg_trace_rd_idx};
+            REG_TRACE_RD_TS: s_axi_rdata = trace_rd_ts;
+            REG_TRACE_RD_EVT:s_axi_rdata = trace_rd_evt;
+            REG_IOMMU_CTRL:  s_axi_rdata = {31'b0, reg_iommu_ctrl[0]};
+            REG_IOMMU_PT:    s_axi_rdata = reg_iommu_pt;
+            REG_IOMMU_PAGES: s_axi_rdata = reg_iommu_pages;
+            REG_TLB_HITS:    s_axi_rdata = tlb_hits;
+            REG_TLB_MISSES:  s_axi_rdata = tlb_misses;
             default:         s_axi_rdata = '0;
         endcase
+        for (int i = 0; i < FUSE_MAX_SEGS; i++) begin
+            if (addr_reg[11:0] == REG_FUSE_M_0   + 12'(4*i)) s_axi_rdata = reg_fuse_m[i];
+            if (addr_reg[11:0] == REG_FUSE_OUT_0 + 12'(4*i)) s_axi_rdata = reg_fuse_out[i];
+        end
     end
 
     //-------------------------------------------------------------------------
@@ -225,6 +426,9 @@ module axi_lite_slave #(
     //-------------------------------------------------------------------------
     assign ctrl_start      = reg_ctrl[0];
     assign ctrl_clear      = reg_ctrl[1];
+    assign ctrl_enqueue    = reg_ctrl[2];
+    assign ctrl_preempt    = reg_ctrl[3];
+    assign ctrl_resume     = reg_ctrl[4];
     assign cluster_enable  = reg_cluster_en[NUM_LARGE_ARRAYS-1:0];
     assign pe_enable[0]    = reg_pe_en[0][3:0];
     assign pe_enable[1]    = reg_pe_en[1][3:0];
@@ -238,5 +442,37 @@ module axi_lite_slave #(
     assign addr_input      = reg_addr_input;
     assign addr_weight     = reg_addr_weight;
     assign addr_output     = reg_addr_output;
+    assign fuse_cnt        = reg_fuse_cnt;
+    assign queue_prefetch  = reg_prefetch;
+    assign kv_table        = reg_kv_table;
+    assign kv_block_shift  = reg_kv_block;
+    assign sg_en           = reg_sg;
+    assign topk_k          = reg_topk;
+    assign rope_table      = reg_rope_table;
+    assign rope_pos        = reg_rope_pos;
+    assign ctx_addr        = reg_ctx_addr;
+    assign fp8_ctrl        = reg_fp8;
+    assign mx_w_scale      = reg_mx_w_scale;
+    assign mx_x_scale      = reg_mx_x_scale;
+    assign trace_enable    = reg_trace_ctrl[0];
+    assign trace_clear     = reg_trace_ctrl[1];
+    assign trace_stop_full = reg_trace_ctrl[2];
+    assign trace_trig_en   = reg_trace_ctrl[3];
+    assign trace_trig_event= reg_trace_trig;
+    assign trace_filter    = reg_trace_filter;
+    assign trace_mark      = reg_trace_mark;
+    assign trace_mark_arg  = reg_trace_mark_arg;
+    assign trace_rd_idx    = reg_trace_rd_idx;
+    assign iommu_enable    = reg_iommu_ctrl[0];
+    assign iommu_flush     = reg_iommu_ctrl[1];
+    assign iommu_pt        = reg_iommu_pt;
+    assign iommu_pages     = reg_iommu_pages;
+
+    generate
+        for (genvar i = 0; i < FUSE_MAX_SEGS; i++) begin : gen_fuse_out
+            assign fuse_m[i]   = reg_fuse_m[i];
+            assign fuse_out[i] = reg_fuse_out[i];
+        end
+    endgenerate
 
 endmodule
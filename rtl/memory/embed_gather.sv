@@ -0,0 +1,148 @@
+//-----------------------------------------------------------------------------
+// Module: embed_gather
+// Description: Embedding-gather address generator (CONFIG.gather job)
+//              Reads num_tokens 32-bit token ids from ids_base and issues
+//              one row burst per token to the DMA:
+//                src = table_base + id * row_bytes,  len = row_bytes,
+//                col = token index (input buffer column, X[k][col])
+//              - Next id is read while the current row request waits, so
+//                back to back rows are limited by the DMA, not the id reads
+//              - id >= vocab: error, no further rows are issued
+//              - done pulses once per job (with error if it stopped early)
+//              Matches emu_gather() in sw/ref/npu_emu.c
+//-----------------------------------------------------------------------------
+
+module embed_gather #(
+    parameter int ADDR_WIDTH = 32,
+    parameter int TOK_WIDTH  = 16     // Tokens per job (batch)
+)(
+    input  logic                  clk,
+    input  logic                  rst_n,
+    input  logic                  start,
+
+    // Configuration (DIM_M / DIM_K / DIM_N / ADDR_WEIGHT / ADDR_INPUT)
+    input  logic [ADDR_WIDTH-1:0] table_base,
+    input  logic [15:0]           row_bytes,      // Hidden size (INT8)
+    input  logic [31:0]           vocab,
+    input  logic [ADDR_WIDTH-1:0] ids_base,
+    input  logic [TOK_WIDTH-1:0]  num_tokens,
+
+    // Id read port (memory side, one outstanding read)
+    output logic [ADDR_WIDTH-1:0] id_addr,
+    output logic                  id_req,
+    input  logic                  id_gnt,
+    input  logic [31:0]           id_data,
+    input  logic                  id_data_valid,
+
+    // Row burst request to the DMA
+    output logic [ADDR_WIDTH-1:0] row_addr,
+    output logic [15:0]           row_len,
+    output logic [TOK_WIDTH-1:0]  row_col,
+    output logic                  row_valid,
+    input  logic                  row_ready,
+
+    output logic                  busy,
+    output logic                  done,           // Pulse
+    output logic                  error
+);
+
+    //-------------------------------------------------------------------------
+    // Id Fetch (one read in flight, one id buffered)
+    //-------------------------------------------------------------------------
+    logic [TOK_WIDTH-1:0] fetch_tok;      // Next token id to read
+    logic                 fetch_busy;     // Read issued, waiting for data
+    logic                 fetch_pending;  // id_req raised, waiting for grant
+    logic [31:0]          id_buf;
+    logic                 id_vld;
+    logic [TOK_WIDTH-1:0] id_tok;         // Token index of id_buf
+    logic                 active;
+
+    assign id_req  = fetch_pending;
+    assign id_addr = ids_base + ADDR_WIDTH'({fetch_tok, 2'b00});
+    assign busy    = active;
+    assign row_len = row_bytes;
+
+    //-------------------------------------------------------------------------
+    // Handshakes
+    //   id_take:   buffered id moves into the row request register
+    //   can_fetch: nothing in flight and the id buffer is free (or freed
+    //              this cycle), so the read data always finds it empty
+    //-------------------------------------------------------------------------
+    logic row_fire;
+    logic oov;                            // Buffered id outside the table
+    logic id_take;
+    logic can_fetch;
+
+    assign row_fire  = row_valid && row_ready;
+    assign oov       = id_vld && (id_buf >= vocab);
+    assign id_take   = id_vld && !oov && (!row_valid || row_fire);
+    assign can_fetch = active && !fetch_busy && (fetch_tok < num_tokens) &&
+                       (!id_vld || id_take) && !error;
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            active        <= 1'b0;
+            fetch_tok     <= '0;
+            fetch_busy    <= 1'b0;
+            fetch_pending <= 1'b0;
+            id_buf        <= '0;
+            id_vld        <= 1'b0;
+            id_tok        <= '0;
+            row_valid     <= 1'b0;
+            row_addr      <= '0;
+            row_col       <= '0;
+            done          <= 1'b0;
+            error         <= 1'b0;
+        end else begin
+            done <= 1'b0;
+
+            if (start && !active) begin
+                active        <= (num_tokens != 0);
+                done          <= (num_tokens == 0);
+                fetch_tok     <= '0;
+                fetch_busy    <= 1'b0;
+                fetch_pending <= 1'b0;
+                id_vld        <= 1'b0;
+                row_valid     <= 1'b0;
+                error         <= 1'b0;
+            end else if (active) begin
+                // Fetch
+                if (can_fetch) begin
+                    fetch_busy    <= 1'b1;
+                    fetch_pending <= 1'b1;
+                end
+                if (fetch_pending && id_gnt)
+                    fetch_pending <= 1'b0;
+                if (fetch_busy && id_data_valid) begin
+                    fetch_busy <= 1'b0;
+                    fetch_tok  <= fetch_tok + 1'b1;
+                    id_buf     <= id_data;
+                    id_tok     <= fetch_tok;
+                    id_vld     <= 1'b1;
+                end
+
+                // Buffered id → row request
+                if (row_fire)
+                    row_valid <= 1'b0;
+                if (oov) begin
+                    id_vld    <= 1'b0;
+                    error     <= 1'b1;
+                end else if (id_take) begin
+                    id_vld    <= 1'b0;
+                    row_valid <= 1'b1;
+                    row_addr  <= table_base + ADDR_WIDTH'(id_buf) * ADDR_WIDTH'(row_bytes);
+                    row_col   <= id_tok;
+                end
+
+                // Finish: all rows accepted, or the first bad id (after
+                // the row in flight, if any, has been taken)
+                if ((error || oov || (fetch_tok == num_tokens && !fetch_busy && !id_vld)) &&
+                    (!row_valid || row_fire)) begin
+                    active <= 1'b0;
+                    done   <= 1'b1;
+                end
+            end
+        end
+    end
+
+endmodule
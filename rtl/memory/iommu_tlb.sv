@@ -0,0 +1,193 @@
+//-----------------------------------------------------------------------------
+// Module: iommu_tlb
+// Description: IOMMU translation for DMA addresses (IOVA -> physical)
+//              Single-level page table at pt_base: one 32-bit PTE per page,
+//              PTE = physical page address | valid (bit 0)
+//              - Fully associative TLB, ENTRIES entries, round-robin refill
+//              - Hit: response registered in the accepting cycle (1/cycle)
+//              - Miss: one PTE read on the ptw port, refill, then the held
+//                request is retried and hits (the retry is not counted)
+//              - IOVA past pt_pages or invalid PTE: response with rsp_fault
+//              - enable = 0: addresses pass through untranslated
+//              Matches iommu_translate() in sw/ref/npu_emu.c
+//-----------------------------------------------------------------------------
+
+module iommu_tlb #(
+    parameter int ADDR_WIDTH = 32,
+    parameter int ENTRIES    = 16,
+    parameter int PAGE_SHIFT = 12
+)(
+    input  logic                  clk,
+    input  logic                  rst_n,
+
+    // Configuration (IOMMU_CTRL / IOMMU_PT / IOMMU_PAGES)
+    input  logic                  enable,
+    input  logic                  flush,          // Invalidate all entries
+    input  logic [ADDR_WIDTH-1:0] pt_base,
+    input  logic [ADDR_WIDTH-1:0] pt_pages,
+
+    // Translation request (one per DMA burst)
+    input  logic [ADDR_WIDTH-1:0] req_iova,
+    input  logic                  req_valid,
+    output logic                  req_ready,
+
+    // Translation response
+    output logic [ADDR_WIDTH-1:0] rsp_addr,
+    output logic                  rsp_fault,
+    output logic                  rsp_valid,
+    input  logic                  rsp_ready,
+
+    // Page-table read port
+    output logic [ADDR_WIDTH-1:0] ptw_addr,
+    output logic                  ptw_req,
+    input  logic                  ptw_gnt,
+    input  logic [31:0]           ptw_data,
+    input  logic                  ptw_data_valid,
+
+    // Statistics (IOMMU TLB_HITS / TLB_MISSES)
+    output logic [31:0]           hit_count,
+    output logic [31:0]           miss_count
+);
+
+    //-------------------------------------------------------------------------
+    // Local Parameters
+    //-------------------------------------------------------------------------
+    localparam int VPN_WIDTH = ADDR_WIDTH - PAGE_SHIFT;
+    localparam int IDX_WIDTH = $clog2(ENTRIES);
+
+    //-------------------------------------------------------------------------
+    // TLB Storage
+    //-------------------------------------------------------------------------
+    logic [VPN_WIDTH-1:0] tlb_vpn [ENTRIES];
+    logic [VPN_WIDTH-1:0] tlb_ppn [ENTRIES];
+    logic [ENTRIES-1:0]   tlb_vld;
+    logic [IDX_WIDTH-1:0] refill_ptr;
+
+    //-------------------------------------------------------------------------
+    // Lookup (combinational CAM)
+    //-------------------------------------------------------------------------
+    logic [VPN_WIDTH-1:0]  req_vpn;
+    logic [PAGE_SHIFT-1:0] req_off;
+    logic                  hit;
+    logic [VPN_WIDTH-1:0]  hit_ppn;
+
+    assign req_vpn = req_iova[ADDR_WIDTH-1:PAGE_SHIFT];
+    assign req_off = req_iova[PAGE_SHIFT-1:0];
+
+    always_comb begin
+        hit     = 1'b0;
+        hit_ppn = '0;
+        for (int i = 0; i < ENTRIES; i++) begin
+            if (tlb_vld[i] && tlb_vpn[i] == req_vpn) begin
+                hit     = 1'b1;
+                hit_ppn = tlb_ppn[i];
+            end
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Walk FSM
+    //-------------------------------------------------------------------------
+    typedef enum logic [1:0] {
+        S_IDLE    = 2'b00,
+        S_REQ     = 2'b01,   // ptw_req until granted
+        S_WAIT    = 2'b10    // PTE read in flight
+    } state_t;
+
+    state_t state;
+
+    logic                 retry;        // Held request was just walked
+    logic                 fault_hold;   // ... and its PTE was invalid
+    logic                 out_of_range;
+    logic                 can_issue;
+    logic                 accept;
+
+    assign out_of_range = (ADDR_WIDTH'(req_vpn) >= pt_pages);
+    assign can_issue    = (state == S_IDLE) && (!rsp_valid || rsp_ready);
+
+    // Accept on: pass-through, hit, out of range, or the retry of a faulted walk
+    assign accept    = req_valid && can_issue &&
+                       (!enable || hit || out_of_range || fault_hold);
+    assign req_ready = accept;
+
+    assign ptw_req  = (state == S_REQ);
+    assign ptw_addr = pt_base + ADDR_WIDTH'({req_vpn, 2'b00});
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            state      <= S_IDLE;
+            tlb_vld    <= '0;
+            refill_ptr <= '0;
+            retry      <= 1'b0;
+            fault_hold <= 1'b0;
+            hit_count  <= '0;
+            miss_count <= '0;
+            for (int i = 0; i < ENTRIES; i++) begin
+                tlb_vpn[i] <= '0;
+                tlb_ppn[i] <= '0;
+            end
+        end else if (flush) begin
+            state      <= S_IDLE;
+            tlb_vld    <= '0;
+            refill_ptr <= '0;
+            retry      <= 1'b0;
+            fault_hold <= 1'b0;
+        end else begin
+            case (state)
+                S_IDLE: begin
+                    if (accept) begin
+                        if (enable && hit && !retry)
+                            hit_count <= hit_count + 1'b1;
+                        retry      <= 1'b0;
+                        fault_hold <= 1'b0;
+                    end else if (req_valid && can_issue && enable) begin
+                        // Miss inside the table: walk
+                        miss_count <= miss_count + 1'b1;
+                        state      <= S_REQ;
+                    end
+                end
+
+                S_REQ: begin
+                    if (ptw_gnt)
+                        state <= S_WAIT;
+                end
+
+                S_WAIT: begin
+                    if (ptw_data_valid) begin
+                        state <= S_IDLE;
+                        retry <= 1'b1;
+                        if (ptw_data[0]) begin
+                            tlb_vpn[refill_ptr] <= req_vpn;
+                            tlb_ppn[refill_ptr] <= ptw_data[31:PAGE_SHIFT];
+                            tlb_vld[refill_ptr] <= 1'b1;
+                            refill_ptr          <= (refill_ptr == IDX_WIDTH'(ENTRIES - 1)) ?
+                                                   '0 : refill_ptr + 1'b1;
+                        end else begin
+                            fault_hold <= 1'b1;
+                        end
+                    end
+                end
+
+                default: state <= S_IDLE;
+            endcase
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Response Register
+    //-------------------------------------------------------------------------
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rsp_valid <= 1'b0;
+            rsp_addr  <= '0;
+            rsp_fault <= 1'b0;
+        end else if (accept) begin
+            rsp_valid <= 1'b1;
+            rsp_fault <= enable && !hit && (out_of_range || fault_hold);
+            rsp_addr  <= !enable ? req_iova : {hit_ppn, req_off};
+        end else if (rsp_ready) begin
+            rsp_valid <= 1'b0;
+        end
+    end
+
+endmodule
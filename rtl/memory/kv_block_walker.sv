@@ -0,0 +1,164 @@
+//-----------------------------------------------------------------------------
+// Module: kv_block_walker
+// Description: Block-table translation for paged KV-cache DMA reads
+//              Logical row r (token) of a paged operand lives at
+//                table[r >> block_shift] + (r & block_mask) * row_bytes
+//              table[] is an array of 32-bit physical block addresses in
+//              memory at table_base (CONFIG.kv_w / kv_x, REG_KV_TABLE)
+//              - Rows of the cached block translate back to back (1 per
+//                cycle); a block miss costs one table read
+//              - Lookahead: while the current block streams, the entry of
+//                the next block is fetched so a sequential walk never waits
+//                on the table (the sw/ref/npu_emu.c timing model); the
+//                table must have one spare entry past the last used block
+//              Matches kv_gather() in sw/ref/npu_emu.c
+//-----------------------------------------------------------------------------
+
+module kv_block_walker #(
+    parameter int ADDR_WIDTH = 32,
+    parameter int ROW_WIDTH  = 16     // Logical row index (tokens)
+)(
+    input  logic                  clk,
+    input  logic                  rst_n,
+    input  logic                  flush,          // New job: drop cached entries
+
+    // Configuration (static during a job)
+    input  logic [ADDR_WIDTH-1:0] table_base,
+    input  logic [4:0]            block_shift,    // log2(rows per block)
+    input  logic [15:0]           row_bytes,
+
+    // Translation request: logical row
+    input  logic [ROW_WIDTH-1:0]  req_row,
+    input  logic                  req_valid,
+    output logic                  req_ready,
+
+    // Translation response: physical byte address of the row
+    output logic [ADDR_WIDTH-1:0] rsp_addr,
+    output logic                  rsp_valid,
+    input  logic                  rsp_ready,
+
+    // Table read port (memory side, one outstanding read)
+    output logic [ADDR_WIDTH-1:0] tbl_addr,
+    output logic                  tbl_req,
+    input  logic                  tbl_gnt,
+    input  logic [31:0]           tbl_data,
+    input  logic                  tbl_data_valid
+);
+
+    //-------------------------------------------------------------------------
+    // Block Cache (current block + lookahead entry)
+    //-------------------------------------------------------------------------
+    logic [ROW_WIDTH-1:0]  cur_blk,  nxt_blk;
+    logic [ADDR_WIDTH-1:0] cur_base, nxt_base;
+    logic                  cur_vld,  nxt_vld;
+
+    logic [ROW_WIDTH-1:0]  req_blk;
+    logic [ROW_WIDTH-1:0]  req_off;
+    assign req_blk = req_row >> block_shift;
+    assign req_off = req_row & ((ROW_WIDTH'(1) << block_shift) - 1'b1);
+
+    logic hit_cur, hit_nxt;
+    assign hit_cur = cur_vld && (cur_blk == req_blk);
+    assign hit_nxt = nxt_vld && (nxt_blk == req_blk);
+
+    //-------------------------------------------------------------------------
+    // Table Fetch
+    //   demand:    request misses both entries
+    //   lookahead: current block is valid and the next one is not cached
+    //-------------------------------------------------------------------------
+    logic                 fetch_busy;      // Read issued, waiting for data
+    logic                 fetch_pending;   // tbl_req raised, waiting for grant
+    logic [ROW_WIDTH-1:0] fetch_blk;
+    logic                 demand;
+
+    assign demand = req_valid && !hit_cur && !hit_nxt;
+
+    logic                 want_fetch;
+    logic [ROW_WIDTH-1:0] want_blk;
+    always_comb begin
+        want_fetch = 1'b0;
+        want_blk   = '0;
+        if (demand) begin
+            want_fetch = 1'b1;
+            want_blk   = req_blk;
+        end else if (cur_vld && !(nxt_vld && nxt_blk == cur_blk + 1'b1)) begin
+            want_fetch = 1'b1;
+            want_blk   = cur_blk + 1'b1;
+        end
+    end
+
+    assign tbl_req  = fetch_pending;
+    assign tbl_addr = table_base + ADDR_WIDTH'({fetch_blk, 2'b00});
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            fetch_busy    <= 1'b0;
+            fetch_pending <= 1'b0;
+            fetch_blk     <= '0;
+            cur_vld       <= 1'b0;
+            nxt_vld       <= 1'b0;
+            cur_blk       <= '0;
+            nxt_blk       <= '0;
+            cur_base      <= '0;
+            nxt_base      <= '0;
+        end else if (flush) begin
+            fetch_busy    <= 1'b0;
+            fetch_pending <= 1'b0;
+            cur_vld       <= 1'b0;
+            nxt_vld       <= 1'b0;
+        end else begin
+            // Issue
+            if (!fetch_busy && want_fetch) begin
+                fetch_busy    <= 1'b1;
+                fetch_pending <= 1'b1;
+                fetch_blk     <= want_blk;
+            end
+            if (fetch_pending && tbl_gnt)
+                fetch_pending <= 1'b0;
+
+            // Fill: lookahead data goes to nxt, demand data to cur
+            if (fetch_busy && tbl_data_valid) begin
+                fetch_busy <= 1'b0;
+                if (cur_vld && fetch_blk == cur_blk + 1'b1) begin
+                    nxt_blk  <= fetch_blk;
+                    nxt_base <= tbl_data;
+                    nxt_vld  <= 1'b1;
+                end else begin
+                    cur_blk  <= fetch_blk;
+                    cur_base <= tbl_data;
+                    cur_vld  <= 1'b1;
+                    nxt_vld  <= 1'b0;
+                end
+            end
+
+            // Advance: first row of the next block promotes the lookahead
+            if (req_valid && req_ready && !hit_cur && hit_nxt) begin
+                cur_blk  <= nxt_blk;
+                cur_base <= nxt_base;
+                nxt_vld  <= 1'b0;
+            end
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Response Register
+    //-------------------------------------------------------------------------
+    logic [ADDR_WIDTH-1:0] hit_base;
+    assign hit_base  = hit_cur ? cur_base : nxt_base;
+    assign req_ready = (hit_cur || hit_nxt) && (!rsp_valid || rsp_ready);
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rsp_valid <= 1'b0;
+            rsp_addr  <= '0;
+        end else if (flush) begin
+            rsp_valid <= 1'b0;
+        end else if (req_valid && req_ready) begin
+            rsp_valid <= 1'b1;
+            rsp_addr  <= hit_base + ADDR_WIDTH'(req_off) * ADDR_WIDTH'(row_bytes);
+        end else if (rsp_ready) begin
+            rsp_valid <= 1'b0;
+        end
+    end
+
+endmodule
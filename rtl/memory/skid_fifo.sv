@@ -0,0 +1,71 @@
+//-----------------------------------------------------------------------------
+// Module: skid_fifo
+// Description: Small synchronous FIFO with valid/ready on both sides
+//              Absorbs DMA burst jitter between the memory side and a
+//              consumer that takes one entry per cycle (weight streaming)
+//              - DEPTH must be a power of two
+//              - Registered storage, 1-cycle write-to-read latency
+//              - in_ready stays high while not full, so a full-rate
+//                producer and consumer never stall each other
+//-----------------------------------------------------------------------------
+
+module skid_fifo #(
+    parameter int WIDTH = 64,
+    parameter int DEPTH = 4
+)(
+    input  logic             clk,
+    input  logic             rst_n,
+    input  logic             flush,      // Drop all entries
+
+    // Write side (producer)
+    input  logic [WIDTH-1:0] in_data,
+    input  logic             in_valid,
+    output logic             in_ready,
+
+    // Read side (consumer)
+    output logic [WIDTH-1:0] out_data,
+    output logic             out_valid,
+    input  logic             out_ready,
+
+    output logic [$clog2(DEPTH):0] count
+);
+
+    //-------------------------------------------------------------------------
+    // Storage and Pointers
+    //-------------------------------------------------------------------------
+    localparam int PTR_WIDTH = $clog2(DEPTH);
+
+    logic [WIDTH-1:0]     mem [DEPTH];
+    logic [PTR_WIDTH-1:0] wr_ptr;
+    logic [PTR_WIDTH-1:0] rd_ptr;
+
+    logic push, pop;
+
+    assign in_ready  = (count < DEPTH);
+    assign out_valid = (count != 0);
+    assign out_data  = mem[rd_ptr];
+
+    assign push = in_valid  && in_ready;
+    assign pop  = out_valid && out_ready;
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            wr_ptr <= '0;
+            rd_ptr <= '0;
+            count  <= '0;
+        end else if (flush) begin
+            wr_ptr <= '0;
+            rd_ptr <= '0;
+            count  <= '0;
+        end else begin
+            if (push) begin
+                mem[wr_ptr] <= in_data;
+                wr_ptr      <= wr_ptr + 1'b1;
+            end
+            if (pop)
+                rd_ptr <= rd_ptr + 1'b1;
+            count <= count + push - pop;
+        end
+    end
+
+endmodule
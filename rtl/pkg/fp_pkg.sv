@@ -0,0 +1,313 @@
+//-----------------------------------------------------------------------------
+// Module: fp_pkg
+// Description: Floating-point MAC arithmetic (fp_mac_unit, gemv_subarray)
+//              - fp_mul:   BF16/FP16 x BF16/FP16 → FP32
+//              - fp8_mul:  E4M3/E5M2 x E4M3/E5M2 x 2^scale → FP32
+//              - fp8_pair: two FP8 lane products summed (MX E8M0 scales)
+//              - fp32_add: FP32 + FP32, round to nearest even
+//              Simplifications (same in sw/ref ref_fp_mul / ref_fp32_add):
+//              - BF16 and FP32 subnormal inputs read as zero; FP16
+//                subnormals are exact (normal in FP32)
+//              - Results below the FP32 normal range flush to signed zero
+//              - NaN results are the canonical quiet NaN 0x7FC00000
+//-----------------------------------------------------------------------------
+
+package fp_pkg;
+
+    //-------------------------------------------------------------------------
+    // Element Formats (CONFIG.fmt)
+    //   INT8: 8 lanes per input/weight line, INT32 accumulate
+    //   BF16/FP16: lane pairs {lane 2j+1, lane 2j} form element j (little
+    //   endian), SUBARRAY_COLS/2 elements per line, FP32 accumulate
+    //   FP8: one element per lane (E4M3, or E5M2 with REG_FP8.e5m2), the
+    //   products of lanes 2j and 2j+1 are added before accumulation
+    //-------------------------------------------------------------------------
+    parameter logic [1:0]  FMT_INT8  = 2'd0;
+    parameter logic [1:0]  FMT_BF16  = 2'd1;
+    parameter logic [1:0]  FMT_FP16  = 2'd2;
+    parameter logic [1:0]  FMT_FP8   = 2'd3;
+
+    parameter logic [31:0] FP32_QNAN = 32'h7FC0_0000;
+
+    // MX block scales: E8M0, 2^(s - 127) per MX_BLOCK K elements, 8'hFF NaN
+    parameter int          MX_BLOCK     = 32;
+    parameter logic [7:0]  MX_SCALE_ONE = 8'd127;
+    parameter logic [7:0]  MX_SCALE_NAN = 8'hFF;
+
+    //-------------------------------------------------------------------------
+    // 16-bit operand: value = m / 2^10 * 2^e (m[10] set unless zero)
+    //-------------------------------------------------------------------------
+    typedef struct packed {
+        logic              s;
+        logic signed [9:0] e;
+        logic [10:0]       m;
+        logic              zero;
+        logic              inf;
+        logic              nan;
+    } fp16_op_t;
+
+    function automatic fp16_op_t fp16_decode(input logic [15:0] x, input logic [1:0] fmt);
+        fp16_op_t d;
+        d.s    = x[15];
+        d.zero = 1'b0;
+        d.inf  = 1'b0;
+        d.nan  = 1'b0;
+        if (fmt == FMT_BF16) begin
+            d.e    = 10'(x[14:7]) - 10'sd127;
+            d.m    = {1'b1, x[6:0], 3'b000};
+            d.zero = (x[14:7] == 8'd0);
+            d.inf  = (x[14:7] == 8'hFF) && (x[6:0] == '0);
+            d.nan  = (x[14:7] == 8'hFF) && (x[6:0] != '0);
+        end else begin
+            d.e    = 10'(x[14:10]) - 10'sd15;
+            d.m    = {1'b1, x[9:0]};
+            d.inf  = (x[14:10] == 5'h1F) && (x[9:0] == '0);
+            d.nan  = (x[14:10] == 5'h1F) && (x[9:0] != '0);
+            if (x[14:10] == 5'd0) begin
+                // Subnormal: 0.f * 2^-14, normalised
+                d.zero = (x[9:0] == '0);
+                d.m    = {1'b0, x[9:0]};
+                d.e    = -10'sd14;
+                for (int i = 0; i < 10; i++) begin
+                    if (!d.m[10] && !d.zero) begin
+                        d.m = d.m << 1;
+                        d.e = d.e - 10'sd1;
+                    end
+                end
+            end
+        end
+        return d;
+    endfunction
+
+    //-------------------------------------------------------------------------
+    // Product → FP32 (exact unless outside the FP32 normal range)
+    //-------------------------------------------------------------------------
+    function automatic logic [31:0] fp_mul(input logic [15:0] a, input logic [15:0] b,
+                                           input logic [1:0] fmt);
+        fp16_op_t          da, db;
+        logic              s;
+        logic [21:0]       p;
+        logic signed [9:0] e;
+        logic [22:0]       frac;
+
+        da = fp16_decode(a, fmt);
+        db = fp16_decode(b, fmt);
+        s  = da.s ^ db.s;
+
+        if (da.nan || db.nan || (da.inf && db.zero) || (db.inf && da.zero))
+            return FP32_QNAN;
+        if (da.inf || db.inf)
+            return {s, 8'hFF, 23'd0};
+        if (da.zero || db.zero)
+            return {s, 31'd0};
+
+        // p / 2^20 in [1, 4)
+        p = da.m * db.m;
+        e = da.e + db.e + 10'sd127;
+        if (p[21]) begin
+            e    = e + 10'sd1;
+            frac = {p[20:0], 2'b00};
+        end else begin
+            frac = {p[19:0], 3'b000};
+        end
+
+        if (e >= 10'sd255)
+            return {s, 8'hFF, 23'd0};
+        if (e <= 10'sd0)
+            return {s, 31'd0};
+        return {s, e[7:0], frac};
+    endfunction
+
+    //-------------------------------------------------------------------------
+    // FP8 operand: value = m / 8 * 2^e (m[3] set unless zero)
+    //   E4M3: bias 7, no inf, S.1111.111 NaN; E5M2: bias 15, IEEE inf/NaN
+    //-------------------------------------------------------------------------
+    typedef struct packed {
+        logic              s;
+        logic signed [9:0] e;
+        logic [3:0]        m;
+        logic              zero;
+        logic              inf;
+        logic              nan;
+    } fp8_op_t;
+
+    function automatic fp8_op_t fp8_decode(input logic [7:0] x, input logic e5m2);
+        fp8_op_t           d;
+        logic [4:0]        ef;
+        logic signed [9:0] emin;
+        d.s    = x[7];
+        d.zero = 1'b0;
+        d.inf  = 1'b0;
+        d.nan  = 1'b0;
+        if (e5m2) begin
+            ef    = x[6:2];
+            d.e   = 10'(ef) - 10'sd15;
+            d.m   = {1'b1, x[1:0], 1'b0};
+            emin  = -10'sd14;
+            d.inf = (ef == 5'h1F) && (x[1:0] == '0);
+            d.nan = (ef == 5'h1F) && (x[1:0] != '0);
+        end else begin
+            ef    = {1'b0, x[6:3]};
+            d.e   = 10'(ef) - 10'sd7;
+            d.m   = {1'b1, x[2:0]};
+            emin  = -10'sd6;
+            d.nan = (x[6:0] == 7'h7F);
+        end
+        if (ef == 5'd0) begin
+            // Subnormal: 0.f * 2^emin, normalised
+            d.m    = {1'b0, d.m[2:0]};
+            d.zero = (d.m == '0);
+            d.e    = emin;
+            for (int i = 0; i < 3; i++) begin
+                if (!d.m[3] && !d.zero) begin
+                    d.m = d.m << 1;
+                    d.e = d.e - 10'sd1;
+                end
+            end
+        end
+        return d;
+    endfunction
+
+    //-------------------------------------------------------------------------
+    // FP8 product x 2^scale_exp → FP32 (exact unless outside the FP32
+    // normal range)
+    //-------------------------------------------------------------------------
+    function automatic logic [31:0] fp8_mul(input logic [7:0] a, input logic [7:0] b,
+                                            input logic e5m2,
+                                            input logic signed [9:0] scale_exp);
+        fp8_op_t           da, db;
+        logic              s;
+        logic [7:0]        p;
+        logic signed [9:0] e;
+        logic [22:0]       frac;
+
+        da = fp8_decode(a, e5m2);
+        db = fp8_decode(b, e5m2);
+        s  = da.s ^ db.s;
+
+        if (da.nan || db.nan || (da.inf && db.zero) || (db.inf && da.zero))
+            return FP32_QNAN;
+        if (da.inf || db.inf)
+            return {s, 8'hFF, 23'd0};
+        if (da.zero || db.zero)
+            return {s, 31'd0};
+
+        // p / 2^6 in [1, 4)
+        p = da.m * db.m;
+        e = da.e + db.e + scale_exp + 10'sd127;
+        if (p[7]) begin
+            e    = e + 10'sd1;
+            frac = {p[6:0], 16'd0};
+        end else begin
+            frac = {p[5:0], 17'd0};
+        end
+
+        if (e >= 10'sd255)
+            return {s, 8'hFF, 23'd0};
+        if (e <= 10'sd0)
+            return {s, 31'd0};
+        return {s, e[7:0], frac};
+    endfunction
+
+    //-------------------------------------------------------------------------
+    // FP32 add, round to nearest even (guard/round/sticky)
+    //-------------------------------------------------------------------------
+    function automatic logic [31:0] fp32_add(input logic [31:0] a, input logic [31:0] b);
+        logic [31:0]       x, y;
+        logic              a_zero, b_zero, a_inf, b_inf, a_nan, b_nan;
+        logic              s;
+        logic [7:0]        d;
+        logic [26:0]       xm, ym, yfull;
+        logic [27:0]       sum;
+        logic [24:0]       mant;
+        logic signed [9:0] e;
+
+        a_zero = (a[30:23] == 8'd0);
+        b_zero = (b[30:23] == 8'd0);
+        a_inf  = (a[30:23] == 8'hFF) && (a[22:0] == '0);
+        b_inf  = (b[30:23] == 8'hFF) && (b[22:0] == '0);
+        a_nan  = (a[30:23] == 8'hFF) && (a[22:0] != '0);
+        b_nan  = (b[30:23] == 8'hFF) && (b[22:0] != '0);
+
+        if (a_nan || b_nan || (a_inf && b_inf && a[31] != b[31]))
+            return FP32_QNAN;
+        if (a_inf)
+            return a;
+        if (b_inf)
+            return b;
+        if (a_zero && b_zero)
+            return {a[31] & b[31], 31'd0};
+        if (a_zero)
+            return b;
+        if (b_zero)
+            return a;
+
+        // |x| >= |y|
+        if (a[30:0] >= b[30:0]) begin
+            x = a;
+            y = b;
+        end else begin
+            x = b;
+            y = a;
+        end
+        s     = x[31];
+        e     = 10'(x[30:23]);
+        d     = x[30:23] - y[30:23];
+        xm    = {1'b1, x[22:0], 3'b000};
+        yfull = {1'b1, y[22:0], 3'b000};
+        if (d >= 8'd27)
+            ym = 27'd1;
+        else
+            ym = (yfull >> d) | 27'(|(yfull & ((27'd1 << d) - 27'd1)));
+
+        if (x[31] == y[31]) begin
+            sum = 28'(xm) + 28'(ym);
+            if (sum[27]) begin
+                sum = (sum >> 1) | 28'(sum[0]);
+                e   = e + 10'sd1;
+            end
+        end else begin
+            sum = 28'(xm) - 28'(ym);
+            if (sum == '0)
+                return 32'd0;
+            for (int i = 0; i < 26; i++) begin
+                if (!sum[26]) begin
+                    sum = sum << 1;
+                    e   = e - 10'sd1;
+                end
+            end
+        end
+
+        // sum[26:3] significand, sum[2] guard, sum[1] round, sum[0] sticky
+        mant = 25'(sum[26:3]);
+        if (sum[2] && (sum[1] || sum[0] || sum[3]))
+            mant = mant + 25'd1;
+        if (mant[24]) begin
+            mant = mant >> 1;
+            e    = e + 10'sd1;
+        end
+
+        if (e >= 10'sd255)
+            return {s, 8'hFF, 23'd0};
+        if (e <= 10'sd0)
+            return {s, 31'd0};
+        return {s, e[7:0], mant[22:0]};
+    endfunction
+
+    //-------------------------------------------------------------------------
+    // Two FP8 lanes {a[15:8], a[7:0]} x {b[15:8], b[7:0]}, both scaled by
+    // 2^(w_scale + x_scale - 254), summed (lane 2j first)
+    //-------------------------------------------------------------------------
+    function automatic logic [31:0] fp8_pair(input logic [15:0] a, input logic [15:0] b,
+                                             input logic e5m2,
+                                             input logic [7:0] w_scale,
+                                             input logic [7:0] x_scale);
+        logic signed [9:0] sc;
+        if (w_scale == MX_SCALE_NAN || x_scale == MX_SCALE_NAN)
+            return FP32_QNAN;
+        sc = 10'(w_scale) + 10'(x_scale) - 10'sd254;
+        return fp32_add(fp8_mul(a[7:0], b[7:0], e5m2, sc),
+                        fp8_mul(a[15:8], b[15:8], e5m2, sc));
+    endfunction
+
+endpackage
@@ -10,7 +10,30 @@ package npu_pkg;
     //-------------------------------------------------------------------------
     parameter int INPUT_WIDTH  = 8;   // Input activation bit-width
     parameter int WEIGHT_WIDTH = 8;   // Weight bit-width
-    parameter int OUTPUT_WIDTH = 32;  // Output/Accumulator bit-width
+    parameter int OUTPUT_WIDTH = 32;  // Output bit-width (buffers, DMA)
+
+    // Accumulator width from the longest dot product (DIM_K) a job may
+    // have: INPUT_WIDTH + WEIGHT_WIDTH - 1 + clog2(MAX_K + 1) bits hold
+    // MAX_K * (-128 * -128) without overflow (ref_acc_bits() in sw/ref).
+    // 16384 covers LLaMA-7B (FFN down projection K = 11008): 30 bits,
+    // 27 bits in the MAC columns that see every 8th product. Jobs with
+    // DIM_K > MAX_K are rejected (STATUS.error)
+    parameter int MAX_K        = 16384;
+    parameter int ACC_WIDTH    = INPUT_WIDTH + WEIGHT_WIDTH - 1 + $clog2(MAX_K + 1);
+
+    // BF16/FP16/FP8 MACs with FP32 accumulate (CONFIG.fmt, fp_mac_unit):
+    // one per INT8 lane pair, so half the INT8 MACs per cycle for BF16/FP16;
+    // FP8 multiplies both lanes of the pair (INT8 rate)
+    parameter bit FP_EN        = 1;
+
+    // gemv_subarray input fan-out pipeline: FANOUT_STAGES register stages
+    // between the buffers and the MACs, the broadcast ones (input vector,
+    // enable/clear, formats) replicated per FANOUT_GROUPS row groups
+    // (8 rows each: an input element drives 8 INT8 + 4 FP MACs instead of
+    // 32 + 16). Adds FANOUT_STAGES cycles of enable → valid latency per
+    // tile (EMU_GEMV_FANOUT_STAGES in sw/ref)
+    parameter int FANOUT_STAGES = 1;
+    parameter int FANOUT_GROUPS = 4;
 
     //-------------------------------------------------------------------------
     // Array Size Parameters
@@ -34,6 +57,20 @@ package npu_pkg;
     parameter int AXI_ADDR_WIDTH = 12;
     parameter int AXI_DATA_WIDTH = 32;
 
+    //-------------------------------------------------------------------------
+    // AXI4 Buffer Window (axi4_buf_slave)
+    //   PE p buffer b at p * BUF_WIN_PE_STRIDE + b * BUF_WIN_BYTES, one
+    //   line per LINE_BYTES: W/X lines written, Y lines read, INCR bursts
+    //-------------------------------------------------------------------------
+    parameter int BUF_AXI_ADDR_WIDTH = 20;
+    parameter int BUF_AXI_DATA_WIDTH = 64;    // = input buffer line
+    parameter int BUF_AXI_ID_WIDTH   = 4;
+    parameter int BUF_WIN_BYTES      = 4096;  // Per buffer (AXI 4 KB burst boundary)
+    parameter int BUF_WIN_PE_STRIDE  = 4 * BUF_WIN_BYTES;
+    parameter int BUF_WIN_W          = 0;     // Weight lines (2048-bit)
+    parameter int BUF_WIN_X          = 1;     // Input lines (64-bit)
+    parameter int BUF_WIN_Y          = 2;     // Output lines (1024-bit, read only)
+
     //-------------------------------------------------------------------------
     // Register Address Map
     //-------------------------------------------------------------------------
@@ -52,11 +89,86 @@ package npu_pkg;
     parameter logic [11:0] REG_ADDR_WEIGHT= 12'h030;  // Weight data base address
     parameter logic [11:0] REG_ADDR_OUTPUT= 12'h034;  // Output data base address
 
+    // Horizontally fused GEMV (QKV / gate-up): one input load, weights of all
+    // segments concatenated at ADDR_WEIGHT, segment i rows -> FUSE_OUT_i.
+    // Emulator-only (sw/ref/npu_emu.c): npu_top has no fused-job path yet
+    parameter int          FUSE_MAX_SEGS  = 4;
+    parameter logic [11:0] REG_FUSE_CNT   = 12'h038;  // Segments (0/1: not fused)
+    parameter logic [11:0] REG_FUSE_M_0   = 12'h040;  // Segment 0 rows
+    parameter logic [11:0] REG_FUSE_M_1   = 12'h044;  // Segment 1 rows
+    parameter logic [11:0] REG_FUSE_M_2   = 12'h048;  // Segment 2 rows
+    parameter logic [11:0] REG_FUSE_M_3   = 12'h04C;  // Segment 3 rows
+    parameter logic [11:0] REG_FUSE_OUT_0 = 12'h050;  // Segment 0 output address
+    parameter logic [11:0] REG_FUSE_OUT_1 = 12'h054;  // Segment 1 output address
+    parameter logic [11:0] REG_FUSE_OUT_2 = 12'h058;  // Segment 2 output address
+    parameter logic [11:0] REG_FUSE_OUT_3 = 12'h05C;  // Segment 3 output address
+
+    // Job queue: CTRL.enqueue latches the job registers as one descriptor,
+    // CTRL.start then runs the queued jobs in order. With prefetch set the
+    // next descriptor's first weight tiles are loaded into the free weight
+    // bank (top_pe wbuf_bank) while the current job computes.
+    parameter int          JOBQ_DEPTH     = 8;
+    parameter logic [11:0] REG_QUEUE      = 12'h03C;  // [0] prefetch, [11:8] count (RO)
+
+    // Paged KV cache (CONFIG.kv_w / kv_x): row r of the paged operand is read
+    // from table[r >> KV_BLOCK] + (r & mask) * row_bytes (kv_block_walker)
+    parameter logic [11:0] REG_KV_TABLE   = 12'h060;  // Block table base address
+    parameter logic [11:0] REG_KV_BLOCK   = 12'h064;  // [4:0] log2(rows per block)
+
+    // Zero-copy DMA: SG flags make ADDR_WEIGHT/INPUT/OUTPUT point to a chain
+    // of 16-byte descriptors {addr, len, next, rsvd} (next = 0 ends it);
+    // with the IOMMU on, every DMA address is an IOVA (iommu_tlb)
+    parameter logic [11:0] REG_SG         = 12'h068;  // [0] W, [1] X, [2] Y
+    parameter logic [11:0] REG_IOMMU_CTRL = 12'h070;  // [0] enable, [1] TLB flush
+    parameter logic [11:0] REG_IOMMU_PT   = 12'h074;  // Page table base (PTE/4 KB page)
+    parameter logic [11:0] REG_IOMMU_PAGES= 12'h078;  // Page table entries
+    parameter logic [11:0] REG_TLB_HITS   = 12'h07C;  // RO
+    parameter logic [11:0] REG_TLB_MISSES = 12'h080;  // RO
+
+    // LM-head sampling (CONFIG.topk): one topk_unit per PE keeps the best
+    // K outputs, the merged list is stored as K {index, value} pairs
+    parameter int          TOPK_MAX       = 8;
+    parameter logic [11:0] REG_TOPK       = 12'h06C;  // [3:0] K (1..TOPK_MAX)
+
+    // Rotary embedding (CONFIG.rope): {sin, cos} Q1.14 table in DRAM, one
+    // row of HEAD_DIM/2 entries per position, column n rotated at pos+n
+    parameter logic [11:0] REG_ROPE_TABLE = 12'h084;  // Table base
+    parameter logic [11:0] REG_ROPE_POS   = 12'h088;  // [15:0] position of column 0
+    parameter logic [11:0] REG_CTX_ADDR   = 12'h08C;  // Preemption context save area
+
+    // Event trace (trace_unit): timestamped events in an on-chip ring of
+    // TRACE_DEPTH entries, read back one entry at a time. TRACE_MARK writes
+    // a software marker (event TRACE_EV_MARK, arg = wdata[23:0])
+    parameter int          TRACE_DEPTH     = 256;
+    parameter logic [11:0] REG_TRACE_CTRL  = 12'h090;  // [0] enable, [1] clear, [2] stop_full, [3] trig_en
+    parameter logic [11:0] REG_TRACE_FILTER= 12'h094;  // [7:0] events recorded
+    parameter logic [11:0] REG_TRACE_TRIG  = 12'h098;  // [2:0] trigger event
+    parameter logic [11:0] REG_TRACE_MARK  = 12'h09C;  // W: software marker
+    parameter logic [11:0] REG_TRACE_STATUS= 12'h0A0;  // RO: [15:0] wr_ptr, [16] wrapped, [17] triggered, [18] stopped
+    parameter logic [11:0] REG_TRACE_DROP  = 12'h0A4;  // RO: events lost to a full slot
+    parameter logic [11:0] REG_TRACE_RD_IDX= 12'h0A8;  // Entry to read
+    parameter logic [11:0] REG_TRACE_RD_TS = 12'h0AC;  // RO: timestamp (cycles)
+    parameter logic [11:0] REG_TRACE_RD_EVT= 12'h0B0;  // RO: {id[7:0], arg[23:0]}
+    parameter logic [11:0] REG_FP8         = 12'h0B4;  // [0] E5M2 (else E4M3), [1] MX scales
+    parameter logic [11:0] REG_MX_W_SCALE  = 12'h0B8;  // W scales [M][ceil(K/32)] E8M0
+    parameter logic [11:0] REG_MX_X_SCALE  = 12'h0BC;  // X scales [ceil(K/32)][N] E8M0
+
+    // Trace event ids (arg)
+    parameter int          TRACE_EV_JOB_START = 0;  // CONFIG[23:0]
+    parameter int          TRACE_EV_JOB_END   = 1;  // STATUS[23:0]
+    parameter int          TRACE_EV_TILE      = 2;  // Mask of the PEs with a valid tile
+    parameter int          TRACE_EV_DMA_RD    = 3;  // Burst bytes
+    parameter int          TRACE_EV_DMA_WR    = 4;  // Burst bytes
+    parameter int          TRACE_EV_STALL     = 5;  // Mask of the stalled PEs
+    parameter int          TRACE_EV_PREEMPT   = 6;  // Wave (M tile group) of the saved context
+    parameter int          TRACE_EV_MARK      = 7;  // TRACE_MARK wdata[23:0]
+
     //-------------------------------------------------------------------------
     // Status Bits
     //-------------------------------------------------------------------------
     typedef struct packed {
-        logic [28:0] reserved;
+        logic [27:0] reserved;
+        logic        preempted;  // Job stopped at a tile boundary, context saved
         logic        error;
         logic        done;
         logic        busy;
@@ -66,9 +178,49 @@ package npu_pkg;
     // Control Bits
     //-------------------------------------------------------------------------
     typedef struct packed {
-        logic [29:0] reserved;
+        logic [26:0] reserved;
+        logic        resume;     // Continue the job saved at REG_CTX_ADDR
+        logic        preempt;    // Stop at the next tile boundary
+        logic        enqueue;    // Push job registers into the job queue
         logic        clear;
         logic        start;
     } ctrl_t;
 
+    //-------------------------------------------------------------------------
+    // Config Bits (REG_CONFIG)
+    //   chain_out: requantise outputs into the on-chip input buffer instead
+    //              of writing INT32 to ADDR_OUTPUT
+    //   chain_in:  take the input vector from the input buffer (previous
+    //              layer's chain_out) instead of loading ADDR_INPUT
+    //   wstream:   batch-1 weight streaming, weight lines bypass the weight
+    //              buffer through the skid FIFO (requires DIM_N = 1)
+    //   kv_w/kv_x: weight / input rows paged through the KV block table
+    //              (at most one per job)
+    //   topk:      store the top-K (index, value) pairs of a GEMV instead of
+    //              Y (requires DIM_N = 1, not with chain_out)
+    //   gather:    DMA-only job: DIM_N token ids (uint32) at ADDR_INPUT select
+    //              rows of the INT8 table [DIM_M][DIM_K] at ADDR_WEIGHT, row n
+    //              written to input buffer column n (embed_gather)
+    //   rope:      rotate output row pairs (2i, 2i+1) by the REG_ROPE_TABLE
+    //              angles before store/requant (DIM_M multiple of HEAD_DIM,
+    //              not with topk, rope_unit)
+    //   fmt:       element format (fp_pkg FMT_*): INT8, or BF16/FP16/FP8 W/X
+    //              with FP32 Y (plain GEMM only, none of the modes above);
+    //              FP8 encoding and MX block scales in REG_FP8
+    //-------------------------------------------------------------------------
+    typedef struct packed {
+        logic signed [15:0] rq_scale;    // Requant multiplier
+        logic [1:0]         fmt;         // FMT_INT8 / FMT_BF16 / FMT_FP16 / FMT_FP8
+        logic               rope;        // Rotary embedding on Y (REG_ROPE_*)
+        logic [4:0]         rq_shift;    // Requant right shift (rounding)
+        logic               gather;      // Embedding rows → input buffer
+        logic               topk;        // Y = top-K pairs (REG_TOPK)
+        logic               kv_x;        // X rows via KV block table
+        logic               kv_w;        // W rows via KV block table
+        logic               wstream;
+        logic               rq_relu;     // Clamp negatives to 0 before saturate
+        logic               chain_in;
+        logic               chain_out;
+    } config_t;
+
 endpackage
@@ -0,0 +1,192 @@
+//-----------------------------------------------------------------------------
+// Module: npu_multi_top
+// Description: Multi-instance NPU top
+//              NUM_NPUS x npu_top behind one axi_lite_interconnect
+//              Register window of instance i: base = i << AXI_ADDR_WIDTH
+//              (4 KB each with the default 12-bit npu_top address space)
+//              Data ports are per instance; the shared memory / bandwidth
+//              model lives in the system testbench and sw/ref/npu_drv.c
+//-----------------------------------------------------------------------------
+
+module npu_multi_top
+    import npu_pkg::*;
+#(
+    parameter int NUM_NPUS         = 4,
+    parameter int INPUT_WIDTH      = npu_pkg::INPUT_WIDTH,
+    parameter int WEIGHT_WIDTH     = npu_pkg::WEIGHT_WIDTH,
+    parameter int OUTPUT_WIDTH     = npu_pkg::OUTPUT_WIDTH,
+    parameter int SUBARRAY_ROWS    = npu_pkg::SUBARRAY_ROWS,
+    parameter int SUBARRAY_COLS    = npu_pkg::SUBARRAY_COLS,
+    parameter int PE_ARRAY_ROWS    = npu_pkg::PE_ARRAY_ROWS,
+    parameter int PE_ARRAY_COLS    = npu_pkg::PE_ARRAY_COLS,
+    parameter int NUM_LARGE_ARRAYS = npu_pkg::NUM_LARGE_ARRAYS,
+    parameter int AXI_ADDR_WIDTH   = npu_pkg::AXI_ADDR_WIDTH,
+    parameter int AXI_DATA_WIDTH   = npu_pkg::AXI_DATA_WIDTH,
+    parameter int SYS_ADDR_WIDTH   = AXI_ADDR_WIDTH + ((NUM_NPUS > 1) ? $clog2(NUM_NPUS) : 1)
+)(
+    input  logic                      clk,
+    input  logic                      rst_n,
+
+    //-------------------------------------------------------------------------
+    // AXI4-Lite Slave Interface (System Control/Status)
+    //-------------------------------------------------------------------------
+    input  logic [SYS_ADDR_WIDTH-1:0] s_axi_awaddr,
+    input  logic                      s_axi_awvalid,
+    output logic                      s_axi_awready,
+
+    input  logic [AXI_DATA_WIDTH-1:0] s_axi_wdata,
+    input  logic [AXI_DATA_WIDTH/8-1:0] s_axi_wstrb,
+    input  logic                      s_axi_wvalid,
+    output logic                      s_axi_wready,
+
+    output logic [1:0]                s_axi_bresp,
+    output logic                      s_axi_bvalid,
+    input  logic                      s_axi_bready,
+
+    input  logic [SYS_ADDR_WIDTH-1:0] s_axi_araddr,
+    input  logic                      s_axi_arvalid,
+    output logic                      s_axi_arready,
+
+    output logic [AXI_DATA_WIDTH-1:0] s_axi_rdata,
+    output logic [1:0]                s_axi_rresp,
+    output logic                      s_axi_rvalid,
+    input  logic                      s_axi_rready,
+
+    //-------------------------------------------------------------------------
+    // Data Interface (one npu_top data port per instance)
+    //-------------------------------------------------------------------------
+    input  logic [NUM_NPUS-1:0][NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_COLS-1:0][INPUT_WIDTH-1:0] input_vectors,
+    input  logic [NUM_NPUS-1:0][NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_ROWS-1:0][SUBARRAY_COLS-1:0][WEIGHT_WIDTH-1:0] weight_matrices,
+    output logic [NUM_NPUS-1:0][NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_ROWS-1:0][OUTPUT_WIDTH-1:0] output_vectors,
+
+    //-------------------------------------------------------------------------
+    // Status Outputs
+    //-------------------------------------------------------------------------
+    output logic [NUM_NPUS-1:0]       npu_busy,
+    output logic [NUM_NPUS-1:0]       npu_done,
+    output logic [NUM_NPUS-1:0]       npu_interrupt,
+    output logic                      interrupt    // OR of all instances
+);
+
+    //-------------------------------------------------------------------------
+    // Interconnect → Instance AXI-Lite Signals
+    //-------------------------------------------------------------------------
+    logic [NUM_NPUS-1:0][AXI_ADDR_WIDTH-1:0]   m_awaddr;
+    logic [NUM_NPUS-1:0]                       m_awvalid;
+    logic [NUM_NPUS-1:0]                       m_awready;
+    logic [NUM_NPUS-1:0][AXI_DATA_WIDTH-1:0]   m_wdata;
+    logic [NUM_NPUS-1:0][AXI_DATA_WIDTH/8-1:0] m_wstrb;
+    logic [NUM_NPUS-1:0]                       m_wvalid;
+    logic [NUM_NPUS-1:0]                       m_wready;
+    logic [NUM_NPUS-1:0][1:0]                  m_bresp;
+    logic [NUM_NPUS-1:0]                       m_bvalid;
+    logic [NUM_NPUS-1:0]                       m_bready;
+    logic [NUM_NPUS-1:0][AXI_ADDR_WIDTH-1:0]   m_araddr;
+    logic [NUM_NPUS-1:0]                       m_arvalid;
+    logic [NUM_NPUS-1:0]                       m_arready;
+    logic [NUM_NPUS-1:0][AXI_DATA_WIDTH-1:0]   m_rdata;
+    logic [NUM_NPUS-1:0][1:0]                  m_rresp;
+    logic [NUM_NPUS-1:0]                       m_rvalid;
+    logic [NUM_NPUS-1:0]                       m_rready;
+
+    //-------------------------------------------------------------------------
+    // AXI-Lite Interconnect Instance
+    //-------------------------------------------------------------------------
+    axi_lite_interconnect #(
+        .NUM_SLAVES       (NUM_NPUS),
+        .SLAVE_ADDR_WIDTH (AXI_ADDR_WIDTH),
+        .AXI_ADDR_WIDTH   (SYS_ADDR_WIDTH),
+        .AXI_DATA_WIDTH   (AXI_DATA_WIDTH)
+    ) u_axi_lite_interconnect (
+        .clk           (clk),
+        .rst_n         (rst_n),
+
+        // Upstream (host)
+        .s_axi_awaddr  (s_axi_awaddr),
+        .s_axi_awvalid (s_axi_awvalid),
+        .s_axi_awready (s_axi_awready),
+        .s_axi_wdata   (s_axi_wdata),
+        .s_axi_wstrb   (s_axi_wstrb),
+        .s_axi_wvalid  (s_axi_wvalid),
+        .s_axi_wready  (s_axi_wready),
+        .s_axi_bresp   (s_axi_bresp),
+        .s_axi_bvalid  (s_axi_bvalid),
+        .s_axi_bready  (s_axi_bready),
+        .s_axi_araddr  (s_axi_araddr),
+        .s_axi_arvalid (s_axi_arvalid),
+        .s_axi_arready (s_axi_arready),
+        .s_axi_rdata   (s_axi_rdata),
+        .s_axi_rresp   (s_axi_rresp),
+        .s_axi_rvalid  (s_axi_rvalid),
+        .s_axi_rready  (s_axi_rready),
+
+        // Downstream (instances)
+        .m_axi_awaddr  (m_awaddr),
+        .m_axi_awvalid (m_awvalid),
+        .m_axi_awready (m_awready),
+        .m_axi_wdata   (m_wdata),
+        .m_axi_wstrb   (m_wstrb),
+        .m_axi_wvalid  (m_wvalid),
+        .m_axi_wready  (m_wready),
+        .m_axi_bresp   (m_bresp),
+        .m_axi_bvalid  (m_bvalid),
+        .m_axi_bready  (m_bready),
+        .m_axi_araddr  (m_araddr),
+        .m_axi_arvalid (m_arvalid),
+        .m_axi_arready (m_arready),
+        .m_axi_rdata   (m_rdata),
+        .m_axi_rresp   (m_rresp),
+        .m_axi_rvalid  (m_rvalid),
+        .m_axi_rready  (m_rready)
+    );
+
+    //-------------------------------------------------------------------------
+    // NPU Instances
+    //-------------------------------------------------------------------------
+    genvar n;
+    generate
+        for (n = 0; n < NUM_NPUS; n++) begin : gen_npu
+            npu_top #(
+                .INPUT_WIDTH      (INPUT_WIDTH),
+                .WEIGHT_WIDTH     (WEIGHT_WIDTH),
+                .OUTPUT_WIDTH     (OUTPUT_WIDTH),
+                .SUBARRAY_ROWS    (SUBARRAY_ROWS),
+                .SUBARRAY_COLS    (SUBARRAY_COLS),
+                .PE_ARRAY_ROWS    (PE_ARRAY_ROWS),
+                .PE_ARRAY_COLS    (PE_ARRAY_COLS),
+                .NUM_LARGE_ARRAYS (NUM_LARGE_ARRAYS),
+                .AXI_ADDR_WIDTH   (AXI_ADDR_WIDTH),
+                .AXI_DATA_WIDTH   (AXI_DATA_WIDTH)
+            ) u_npu_top (
+                .clk             (clk),
+                .rst_n           (rst_n),
+                .s_axi_awaddr    (m_awaddr[n]),
+                .s_axi_awvalid   (m_awvalid[n]),
+                .s_axi_awready   (m_awready[n]),
+                .s_axi_wdata     (m_wdata[n]),
+                .s_axi_wstrb     (m_wstrb[n]),
+                .s_axi_wvalid    (m_wvalid[n]),
+                .s_axi_wready    (m_wready[n]),
+                .s_axi_bresp     (m_bresp[n]),
+                .s_axi_bvalid    (m_bvalid[n]),
+                .s_axi_bready    (m_bready[n]),
+                .s_axi_araddr    (m_araddr[n]),
+                .s_axi_arvalid   (m_arvalid[n]),
+                .s_axi_arready   (m_arready[n]),
+                .s_axi_rdata     (m_rdata[n]),
+                .s_axi_rresp     (m_rresp[n]),
+                .s_axi_rvalid    (m_rvalid[n]),
+                .s_axi_rready    (m_rready[n]),
+                .input_vectors   (input_vectors[n]),
+                .weight_matrices (weight_matrices[n]),
+                .output_vectors  (output_vectors[n]),
+                .npu_busy        (npu_busy[n]),
+                .npu_done        (npu_done[n]),
+                .interrupt       (npu_interrupt[n])
+            );
+        end
+    endgenerate
+
+    assign interrupt = |npu_interrupt;
+
+endmodule
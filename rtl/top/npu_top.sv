@@ -15,6 +15,10 @@ module npu_top
     parameter int PE_ARRAY_ROWS    = npu_pkg::PE_ARRAY_ROWS,
     parameter int PE_ARRAY_COLS    = npu_pkg::PE_ARRAY_COLS,
     parameter int NUM_LARGE_ARRAYS = npu_pkg::NUM_LARGE_ARRAYS,
+    parameter int MAX_K            = npu_pkg::MAX_K,
+    parameter bit FP_EN            = npu_pkg::FP_EN,
+    parameter int FANOUT_STAGES    = npu_pkg::FANOUT_STAGES,
+    parameter int FANOUT_GROUPS    = npu_pkg::FANOUT_GROUPS,
     parameter int AXI_ADDR_WIDTH   = npu_pkg::AXI_ADDR_WIDTH,
     parameter int AXI_DATA_WIDTH   = npu_pkg::AXI_DATA_WIDTH
 )(
@@ -51,6 +55,10 @@ module npu_top
     //-------------------------------------------------------------------------
     input  logic [NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_COLS-1:0][INPUT_WIDTH-1:0] input_vectors,
     input  logic [NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_ROWS-1:0][SUBARRAY_COLS-1:0][WEIGHT_WIDTH-1:0] weight_matrices,
+    // FP8 MX block scales of the current lines (REG_MX_W/X_SCALE tables,
+    // MX_SCALE_ONE when REG_FP8.mx is clear)
+    input  logic [NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_ROWS-1:0][7:0] mx_w_scales,
+    input  logic [NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][7:0] mx_x_scales,
     output logic [NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0][SUBARRAY_ROWS-1:0][OUTPUT_WIDTH-1:0] output_vectors,
 
     //-------------------------------------------------------------------------
@@ -70,6 +78,16 @@ module npu_top
     logic [NUM_LARGE_ARRAYS-1:0] cluster_enable;
     logic [NUM_LARGE_ARRAYS-1:0][3:0] pe_enable_flat;
     logic [AXI_DATA_WIDTH-1:0] config_reg;
+    logic [AXI_DATA_WIDTH-1:0] dim_k;
+    logic [1:0]                fp8_ctrl;
+
+    // INT8 DIM_K beyond the accumulator guard bits (MAX_K; FP32
+    // accumulation has no such bound), or an FP format without FP_EN:
+    // the job is not started and reads back as
+    // DONE | ERROR until the next start
+    logic                      k_over;
+    logic                      job_start;
+    logic                      job_rejected;
 
     // PE enable conversion (flat to 2D)
     logic [NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0] pe_enable;
@@ -78,6 +96,7 @@ module npu_top
     logic                      status_busy;
     logic                      status_done;
     logic                      status_error;
+    logic                      status_preempted;
 
     // Cluster status signals
     logic [NUM_LARGE_ARRAYS-1:0] array_busy;
@@ -87,6 +106,28 @@ module npu_top
     logic [NUM_LARGE_ARRAYS-1:0][PE_ARRAY_ROWS-1:0][PE_ARRAY_COLS-1:0] pe_valid;
     logic                      cluster_busy;
     logic                      cluster_done;
+    logic                      status_done_d;
+
+    // Event trace
+    localparam int TRACE_IDX_WIDTH = $clog2(TRACE_DEPTH);
+    logic                      trace_enable;
+    logic                      trace_clear;
+    logic                      trace_stop_full;
+    logic                      trace_trig_en;
+    logic [2:0]                trace_trig_event;
+    logic [7:0]                trace_filter;
+    logic                      trace_mark;
+    logic [23:0]               trace_mark_arg;
+    logic [15:0]               trace_rd_idx;
+    logic [TRACE_IDX_WIDTH-1:0] trace_wr_ptr;
+    logic                      trace_wrapped;
+    logic                      trace_triggered;
+    logic                      trace_stopped;
+    logic [31:0]               trace_dropped;
+    logic [31:0]               trace_rd_ts;
+    logic [31:0]               trace_rd_evt;
+    logic [7:0]                trace_ev_valid;
+    logic [7:0][23:0]          trace_ev_arg;
 
     //-------------------------------------------------------------------------
     // PE Enable Conversion
@@ -137,11 +178,38 @@ module npu_top
         .cluster_enable   (cluster_enable),
         .pe_enable        (pe_enable_flat),
         .config_reg       (config_reg),
+        .dim_k            (dim_k),
+        .fp8_ctrl         (fp8_ctrl),
+
+        // Event trace
+        .trace_enable     (trace_enable),
+        .trace_clear      (trace_clear),
+        .trace_stop_full  (trace_stop_full),
+        .trace_trig_en    (trace_trig_en),
+        .trace_trig_event (trace_trig_event),
+        .trace_filter     (trace_filter),
+        .trace_mark       (trace_mark),
+        .trace_mark_arg   (trace_mark_arg),
+        .trace_rd_idx     (trace_rd_idx),
+        .trace_wr_ptr     (16'(trace_wr_ptr)),
+        .trace_wrapped    (trace_wrapped),
+        .trace_triggered  (trace_triggered),
+        .trace_stopped    (trace_stopped),
+        .trace_dropped    (trace_dropped),
+        .trace_rd_ts      (trace_rd_ts),
+        .trace_rd_evt     (trace_rd_evt),
+
+        // Job queue / IOMMU status: owned by the DMA/tiling controller,
+        // which is modelled in sw/ref/npu_emu.c and not yet part of npu_top
+        .queue_count      (4'd0),
+        .tlb_hits         (32'd0),
+        .tlb_misses       (32'd0),
 
         // Status Inputs
         .status_busy      (status_busy),
         .status_done      (status_done),
-        .status_error     (status_error)
+        .status_error     (status_error),
+        .status_preempted (status_preempted)
     );
 
     //-------------------------------------------------------------------------
@@ -155,17 +223,25 @@ module npu_top
         .SUBARRAY_COLS    (SUBARRAY_COLS),
         .PE_ARRAY_ROWS    (PE_ARRAY_ROWS),
         .PE_ARRAY_COLS    (PE_ARRAY_COLS),
-        .NUM_LARGE_ARRAYS (NUM_LARGE_ARRAYS)
+        .NUM_LARGE_ARRAYS (NUM_LARGE_ARRAYS),
+        .MAX_K            (MAX_K),
+        .FP_EN            (FP_EN),
+        .FANOUT_STAGES    (FANOUT_STAGES),
+        .FANOUT_GROUPS    (FANOUT_GROUPS)
     ) u_pe_array_cluster (
         .clk               (clk),
         .rst_n             (rst_n),
         .cluster_enable    (|cluster_enable),  // Enable if any array enabled
-        .start             (ctrl_start),
+        .start             (job_start),
         .clear             (ctrl_clear),
+        .fp_fmt            (config_reg[15:14]),
+        .fp8_e5m2          (fp8_ctrl[0]),
         .large_array_enable(cluster_enable),
         .pe_enable         (pe_enable),
         .input_vectors     (input_vectors),
         .weight_matrices   (weight_matrices),
+        .mx_w_scales       (mx_w_scales),
+        .mx_x_scales       (mx_x_scales),
         .output_vectors    (output_vectors),
         .array_busy        (array_busy),
         .array_done        (array_done),
@@ -176,30 +252,96 @@ module npu_top
         .cluster_done      (cluster_done)
     );
 
+    //-------------------------------------------------------------------------
+    // Event Trace
+    //-------------------------------------------------------------------------
+    always_comb begin
+        trace_ev_valid = '0;
+        trace_ev_arg   = '0;
+
+        // A rejected start (k_over) never reaches the cluster: no
+        // JOB_START, only a JOB_END with DONE | ERROR, so every JOB_START
+        // has its JOB_END
+        trace_ev_valid[TRACE_EV_JOB_START] = job_start;
+        trace_ev_arg[TRACE_EV_JOB_START]   = config_reg[23:0];
+        if (ctrl_start && k_over) begin
+            trace_ev_valid[TRACE_EV_JOB_END] = 1'b1;
+            trace_ev_arg[TRACE_EV_JOB_END]   = {20'b0, 1'b0, 1'b1, 1'b1, 1'b0};
+        end else begin
+            // Rising edge of status_done; a rejected start's edge was
+            // already logged above
+            trace_ev_valid[TRACE_EV_JOB_END] = status_done & ~status_done_d & ~job_rejected;
+            trace_ev_arg[TRACE_EV_JOB_END]   = {20'b0, status_preempted, status_error,
+                                                status_done, status_busy};
+        end
+        trace_ev_valid[TRACE_EV_TILE]      = |pe_valid;
+        trace_ev_arg[TRACE_EV_TILE]        = 24'(pe_valid);
+        trace_ev_valid[TRACE_EV_MARK]      = trace_mark;
+        trace_ev_arg[TRACE_EV_MARK]        = trace_mark_arg;
+
+        // DMA_RD / DMA_WR / STALL / PREEMPT: produced by the DMA/tiling
+        // controller (sw/ref/npu_emu.c), not yet part of npu_top
+    end
+
+    trace_unit #(
+        .NUM_EVENTS (8),
+        .DEPTH      (TRACE_DEPTH),
+        .ARG_WIDTH  (24),
+        .TS_WIDTH   (32)
+    ) u_trace_unit (
+        .clk        (clk),
+        .rst_n      (rst_n),
+        .enable     (trace_enable),
+        .clear      (trace_clear),
+        .stop_full  (trace_stop_full),
+        .trig_en    (trace_trig_en),
+        .trig_event (trace_trig_event),
+        .filter     (trace_filter),
+        .ev_valid   (trace_ev_valid),
+        .ev_arg     (trace_ev_arg),
+        .wr_ptr     (trace_wr_ptr),
+        .wrapped    (trace_wrapped),
+        .triggered  (trace_triggered),
+        .stopped    (trace_stopped),
+        .dropped    (trace_dropped),
+        .rd_idx     (trace_rd_idx[TRACE_IDX_WIDTH-1:0]),
+        .rd_ts      (trace_rd_ts),
+        .rd_evt     (trace_rd_evt)
+    );
+
     //-------------------------------------------------------------------------
     // Status Signal Assignment
     //-------------------------------------------------------------------------
+    assign k_over    = (config_reg[15:14] == 2'd0) ? (dim_k > AXI_DATA_WIDTH'(MAX_K)) : !FP_EN;
+    assign job_start = ctrl_start && !k_over;
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n)
+            job_rejected <= 1'b0;
+        else if (ctrl_start)
+            job_rejected <= k_over;
+    end
+
     assign status_busy  = cluster_busy;
-    assign status_done  = cluster_done;
-    assign status_error = 1'b0;  // TODO: Add error detection logic
+    assign status_done  = cluster_done | job_rejected;
+    assign status_error = job_rejected;
+    assign status_preempted = 1'b0;  // tile_ctrl runs under the DMA/tiling controller
 
     assign npu_busy = cluster_busy;
-    assign npu_done = cluster_done;
+    assign npu_done = status_done;
 
     //-------------------------------------------------------------------------
     // Interrupt Generation
     //-------------------------------------------------------------------------
-    logic cluster_done_d;
-
     always_ff @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            cluster_done_d <= 1'b0;
+            status_done_d <= 1'b0;
         end else begin
-            cluster_done_d <= cluster_done;
+            status_done_d <= status_done;
         end
     end
 
-    // Rising edge of cluster_done generates interrupt
-    assign interrupt = cluster_done & ~cluster_done_d;
+    // Rising edge of done (or a rejected start) generates interrupt
+    assign interrupt = status_done & ~status_done_d;
 
 endmodule
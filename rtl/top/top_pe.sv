@@ -7,6 +7,18 @@
 //              - Weight buffer: ROWS*COLS*WEIGHT_WIDTH = 2048-bit
 //              - Input buffer:  COLS*INPUT_WIDTH = 64-bit
 //              - Output buffer: ROWS*OUTPUT_WIDTH = 1024-bit
+//              Layer chaining (chain_en): each stored output vector is also
+//              requantised to INT8 and written into the input buffer as
+//              ROWS/COLS lines from chain_ibuf_base, so the next layer's
+//              K-tiles are ready without a host round trip. Wait for
+//              done && !chain_busy before starting the next layer.
+//              Weight streaming (stream_mode): {input, weight} K-tile lines
+//              from the DMA pass through a skid FIFO straight into gemv,
+//              bypassing the weight buffer; one line per cycle at most, so
+//              compute runs at the memory line rate.
+//              Preemption: at a tile boundary the output buffer line holds
+//              the partial sums (context, read out by the DMA); a start with
+//              restore_acc loads restore_data back into the accumulators.
 //-----------------------------------------------------------------------------
 
 module top_pe #(
@@ -15,7 +27,12 @@ module top_pe #(
     parameter int INPUT_WIDTH   = 8,
     parameter int WEIGHT_WIDTH  = 8,
     parameter int OUTPUT_WIDTH  = 32,
-    parameter int BUF_DEPTH     = 4
+    parameter int BUF_DEPTH     = 4,
+    parameter int STREAM_DEPTH  = 4,   // Weight-stream skid FIFO entries
+    parameter int NUM_WBANKS    = 2,   // Weight buffer banks (prefetch)
+    parameter int MAX_K         = 1 << (OUTPUT_WIDTH - INPUT_WIDTH - WEIGHT_WIDTH),  // Accumulator guard bits
+    parameter int FANOUT_STAGES = 0,   // gemv input pipeline (PE_ctrl compensates)
+    parameter int FANOUT_GROUPS = 1
 )(
     input  logic clk,
     input  logic rst_n,
@@ -23,9 +40,14 @@ module top_pe #(
     // Upper-level control
     input  logic start,
     input  logic clear_acc,
+    input  logic restore_acc,                       // Start from restore_data
     output logic busy,
     output logic done,
 
+    // Weight bank used by the next start (the other bank may be written
+    // while this one computes); bank b = lines [b*BUF_DEPTH/NUM_WBANKS, ...)
+    input  logic [$clog2(NUM_WBANKS)-1:0]                       wbuf_bank,
+
     // Weight buffer external write (Port A) — full matrix width
     input  logic [$clog2(BUF_DEPTH)-1:0]                        wbuf_wr_addr,
     input  logic [SUBARRAY_ROWS*SUBARRAY_COLS*WEIGHT_WIDTH-1:0] wbuf_wr_data,
@@ -39,7 +61,25 @@ module top_pe #(
     // Output buffer external read (Port B) — full vector width
     input  logic [$clog2(BUF_DEPTH)-1:0]                        obuf_rd_addr,
     input  logic                                                 obuf_rd_en,
-    output logic [SUBARRAY_ROWS*OUTPUT_WIDTH-1:0]               obuf_rd_data
+    output logic [SUBARRAY_ROWS*OUTPUT_WIDTH-1:0]               obuf_rd_data,
+
+    // Layer chaining (requantised output → input buffer)
+    input  logic                                                 chain_en,
+    input  logic [$clog2(BUF_DEPTH)-1:0]                        chain_ibuf_base,
+    input  logic signed [15:0]                                   rq_scale,
+    input  logic [4:0]                                           rq_shift,
+    input  logic                                                 rq_relu,
+    output logic                                                 chain_busy,
+
+    // Weight streaming (bypass): line = {input K-tile, weight K-tile}
+    input  logic                                                 stream_mode,
+    input  logic [15:0]                                          stream_len,
+    input  logic [SUBARRAY_COLS*INPUT_WIDTH+SUBARRAY_ROWS*SUBARRAY_COLS*WEIGHT_WIDTH-1:0] wstream_data,
+    input  logic                                                 wstream_valid,
+    output logic                                                 wstream_ready,
+
+    // Context restore (held from start until the first tile has loaded it)
+    input  logic [SUBARRAY_ROWS*OUTPUT_WIDTH-1:0]               restore_data
 );
 
     //-------------------------------------------------------------------------
@@ -48,6 +88,8 @@ module top_pe #(
     localparam int WEIGHT_BUF_WIDTH = SUBARRAY_ROWS * SUBARRAY_COLS * WEIGHT_WIDTH; // 2048
     localparam int INPUT_BUF_WIDTH  = SUBARRAY_COLS * INPUT_WIDTH;                   // 64
     localparam int OUTPUT_BUF_WIDTH = SUBARRAY_ROWS * OUTPUT_WIDTH;                  // 1024
+    localparam int CHAIN_LINES      = SUBARRAY_ROWS / SUBARRAY_COLS;                 // 4
+    localparam int STREAM_WIDTH     = INPUT_BUF_WIDTH + WEIGHT_BUF_WIDTH;            // 2112
 
     //-------------------------------------------------------------------------
     // Internal Wires: PE_ctrl ↔ Buffers
@@ -67,11 +109,22 @@ module top_pe #(
     logic                           obuf_wr_en_ctrl;
     logic [OUTPUT_BUF_WIDTH-1:0]   obuf_wr_data_ctrl;
 
+    // Input buffer write (Port A: external or chain writer)
+    logic [$clog2(BUF_DEPTH)-1:0]  ibuf_a_addr;
+    logic                           ibuf_a_en;
+    logic [INPUT_BUF_WIDTH-1:0]    ibuf_a_data;
+
+    // Weight stream (skid FIFO → PE_ctrl)
+    logic [STREAM_WIDTH-1:0]       fifo_data;
+    logic                           fifo_valid;
+    logic                           fifo_ready;
+
     //-------------------------------------------------------------------------
     // Internal Wires: PE_ctrl ↔ gemv_subarray
     //-------------------------------------------------------------------------
     logic                                                            gemv_enable;
     logic                                                            gemv_clear_acc;
+    logic                                                            gemv_load_acc;
     logic [SUBARRAY_COLS-1:0][INPUT_WIDTH-1:0]                      gemv_input_vector;
     logic [SUBARRAY_ROWS-1:0][SUBARRAY_COLS-1:0][WEIGHT_WIDTH-1:0] gemv_weight_matrix;
     logic [SUBARRAY_ROWS-1:0][OUTPUT_WIDTH-1:0]                     gemv_output_vector;
@@ -86,15 +139,19 @@ module top_pe #(
         .INPUT_WIDTH   (INPUT_WIDTH),
         .WEIGHT_WIDTH  (WEIGHT_WIDTH),
         .OUTPUT_WIDTH  (OUTPUT_WIDTH),
-        .BUF_DEPTH     (BUF_DEPTH)
+        .BUF_DEPTH     (BUF_DEPTH),
+        .NUM_WBANKS    (NUM_WBANKS),
+        .GEMV_PIPE     (FANOUT_STAGES)
     ) u_pe_ctrl (
         .clk              (clk),
         .rst_n            (rst_n),
         .start            (start),
         .clear_acc        (clear_acc),
+        .restore_acc      (restore_acc),
         .busy             (busy),
         .done             (done),
         // Weight buffer read
+        .wbuf_bank        (wbuf_bank),
         .wbuf_addr        (wbuf_rd_addr),
         .wbuf_rd_en       (wbuf_rd_en),
         .wbuf_rdata       (wbuf_rd_data),
@@ -102,6 +159,13 @@ module top_pe #(
         .ibuf_addr        (ibuf_rd_addr),
         .ibuf_rd_en       (ibuf_rd_en),
         .ibuf_rdata       (ibuf_rd_data),
+        // Weight streaming
+        .stream_mode      (stream_mode),
+        .stream_len       (stream_len),
+        .wstream_weight   (fifo_data[WEIGHT_BUF_WIDTH-1:0]),
+        .wstream_input    (fifo_data[STREAM_WIDTH-1:WEIGHT_BUF_WIDTH]),
+        .wstream_valid    (fifo_valid),
+        .wstream_ready    (fifo_ready),
         // Output buffer write
         .obuf_addr        (obuf_wr_addr_ctrl),
         .obuf_wr_en       (obuf_wr_en_ctrl),
@@ -109,6 +173,7 @@ module top_pe #(
         // gemv control
         .gemv_enable       (gemv_enable),
         .gemv_clear_acc    (gemv_clear_acc),
+        .gemv_load_acc     (gemv_load_acc),
         .gemv_input_vector (gemv_input_vector),
         .gemv_weight_matrix(gemv_weight_matrix),
         .gemv_output_vector(gemv_output_vector),
@@ -123,18 +188,106 @@ module top_pe #(
         .WEIGHT_WIDTH  (WEIGHT_WIDTH),
         .OUTPUT_WIDTH  (OUTPUT_WIDTH),
         .SUBARRAY_ROWS (SUBARRAY_ROWS),
-        .SUBARRAY_COLS (SUBARRAY_COLS)
+        .SUBARRAY_COLS (SUBARRAY_COLS),
+        .MAX_K         (MAX_K),
+        .FANOUT_STAGES (FANOUT_STAGES),
+        .FANOUT_GROUPS (FANOUT_GROUPS)
     ) u_gemv_subarray (
         .clk           (clk),
         .rst_n         (rst_n),
         .enable        (gemv_enable),
         .clear_acc     (gemv_clear_acc),
+        .load_acc      (gemv_load_acc),
+        .fp_fmt        (2'b00),  // INT8 (FP formats: npu_top)
+        .fp8_e5m2      (1'b0),
+        .mx_w_scale    ({SUBARRAY_ROWS{8'd127}}),
+        .mx_x_scale    (8'd127),
         .input_vector  (gemv_input_vector),
         .weight_matrix (gemv_weight_matrix),
+        .acc_in        (restore_data),
         .output_vector (gemv_output_vector),
         .valid_out     (gemv_valid_out)
     );
 
+    //-------------------------------------------------------------------------
+    // Weight-Stream Skid FIFO
+    //-------------------------------------------------------------------------
+    skid_fifo #(
+        .WIDTH     (STREAM_WIDTH),
+        .DEPTH     (STREAM_DEPTH)
+    ) u_stream_fifo (
+        .clk       (clk),
+        .rst_n     (rst_n),
+        .flush     (1'b0),
+        .in_data   (wstream_data),
+        .in_valid  (wstream_valid),
+        .in_ready  (wstream_ready),
+        .out_data  (fifo_data),
+        .out_valid (fifo_valid),
+        .out_ready (fifo_ready),
+        .count     ()
+    );
+
+    //-------------------------------------------------------------------------
+    // Requantisation (chain path)
+    //-------------------------------------------------------------------------
+    logic                                            rq_valid;
+    logic [SUBARRAY_ROWS-1:0][INPUT_WIDTH-1:0]       rq_data;
+
+    requant_unit #(
+        .NUM_LANES (SUBARRAY_ROWS),
+        .ACC_WIDTH (OUTPUT_WIDTH),
+        .OUT_WIDTH (INPUT_WIDTH)
+    ) u_requant_unit (
+        .clk       (clk),
+        .rst_n     (rst_n),
+        .scale     (rq_scale),
+        .shift     (rq_shift),
+        .relu      (rq_relu),
+        .valid_in  (chain_en && obuf_wr_en_ctrl),
+        .data_in   (obuf_wr_data_ctrl),
+        .valid_out (rq_valid),
+        .data_out  (rq_data)
+    );
+
+    //-------------------------------------------------------------------------
+    // Chain Writer: one requantised vector → CHAIN_LINES input buffer lines
+    //   Line j holds rows j*COLS .. j*COLS+COLS-1 (= next layer K-tile j)
+    //-------------------------------------------------------------------------
+    logic [SUBARRAY_ROWS-1:0][INPUT_WIDTH-1:0]       chain_vec;
+    logic [$clog2(CHAIN_LINES+1)-1:0]                chain_cnt;
+    logic                                            chain_active;
+    logic [1:0]                                      rq_inflight;  // requant pipeline
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            chain_vec    <= '0;
+            chain_cnt    <= '0;
+            chain_active <= 1'b0;
+            rq_inflight  <= '0;
+        end else begin
+            rq_inflight <= {rq_inflight[0], chain_en && obuf_wr_en_ctrl};
+            if (rq_valid) begin
+                chain_vec    <= rq_data;
+                chain_cnt    <= '0;
+                chain_active <= 1'b1;
+            end else if (chain_active) begin
+                if (chain_cnt == CHAIN_LINES - 1)
+                    chain_active <= 1'b0;
+                chain_cnt <= chain_cnt + 1'b1;
+            end
+        end
+    end
+
+    assign chain_busy = chain_active || (|rq_inflight);
+
+    // Chain writes take priority; the host must not write ibuf while chaining
+    assign ibuf_a_en   = chain_active || ibuf_wr_en;
+    assign ibuf_a_addr = chain_active ? chain_ibuf_base + chain_cnt[$clog2(BUF_DEPTH)-1:0]
+                                      : ibuf_wr_addr;
+    assign ibuf_a_data = chain_active ? chain_vec[chain_cnt*SUBARRAY_COLS +: SUBARRAY_COLS]
+                                      : ibuf_wr_data;
+
     //-------------------------------------------------------------------------
     // Weight Buffer (full matrix width = 2048-bit)
     //   Port A: external write
@@ -159,7 +312,7 @@ module top_pe #(
 
     //-------------------------------------------------------------------------
     // Input Buffer (full vector width = 64-bit)
-    //   Port A: external write
+    //   Port A: external write / chain writer
     //   Port B: PE_ctrl read (HIGH_PERFORMANCE: 2-cycle latency)
     //-------------------------------------------------------------------------
     sim_dual_port_bram #(
@@ -168,11 +321,11 @@ module top_pe #(
         .RAM_PERFORMANCE ("HIGH_PERFORMANCE"),
         .INIT_FILE       ("")
     ) u_input_buffer (
-        .addra  (ibuf_wr_addr),
+        .addra  (ibuf_a_addr),
         .addrb  (ibuf_rd_addr),
-        .dina   (ibuf_wr_data),
+        .dina   (ibuf_a_data),
         .clka   (clk),
-        .wea    (ibuf_wr_en),
+        .wea    (ibuf_a_en),
         .enb    (ibuf_rd_en),
         .rstb   (rst_n),
         .regceb (1'b1),
@@ -3,9 +3,23 @@
 // Description: Generates reference hex data for RTL verification
 //              Seed-based random test generation for MAC / GEMV / GEMM
 //              Usage: ./npu_ref [seed]  (default seed = 42)
+//                     ./npu_ref --shard <M> <K> <N> <workers> [seed] [--tiles <n>]
+//                               [--resume]
+//                     ./npu_ref --emu-llama [layers]
+//                     ./npu_ref --bench-scaling
 //-----------------------------------------------------------------------------
 
+#include <time.h>
+#include <math.h>
+#include <float.h>
+
 #include "npu_ref.h"
+#include "npu_shard.h"
+#include "npu_emu.h"
+#include "npu_drv.h"
+#include "npu_serve.h"
+#include "npu_plan.h"
+#include "npu_trace.h"
 
 #define HEX_DIR "hex_data/"
 
@@ -154,6 +168,8 @@ void generate_gemv_subarray_test_hex(int seed) {
     dump_to_hex_file(HEX_DIR "gemv_test_input.hex",  all_input,  num_tests * input_size, 8);
     dump_to_hex_file(HEX_DIR "gemv_test_weight.hex", all_weight, num_tests * weight_size, 8);
     dump_to_hex_file(HEX_DIR "gemv_test_output.hex", all_output, num_tests * output_size, 32);
+    dump_tile_hash_file(HEX_DIR "gemv_test_output_hash.hex", all_output,
+                        num_tests * output_size, output_size);
 
     free(all_input);
     free(all_weight);
@@ -167,8 +183,12 @@ void generate_gemv_subarray_test_hex(int seed) {
 #define CTRL_ROWS      16
 #define CTRL_COLS      4
 #define CTRL_NUM_TESTS 8
-#define CTRL_MAX_K     32
+#define CTRL_MAX_K     32    // Upper bound for TB memories only (no padding)
 
+// Variable-K packing: test t occupies exactly dim_k input bytes and
+// CTRL_ROWS*dim_k weight bytes (row stride dim_k), located through
+// gemv_ctrl_test_offset.hex = { input_offset, weight_offset } per test.
+// A partial last K-tile is zero-filled by the TB, not stored in the files.
 void generate_gemv_ctrl_test_hex(int seed) {
     printf("\n");
     printf("=============================================================\n");
@@ -178,11 +198,19 @@ void generate_gemv_ctrl_test_hex(int seed) {
            CTRL_ROWS, CTRL_COLS, CTRL_NUM_TESTS, CTRL_MAX_K);
 
     int dim_k_values[CTRL_NUM_TESTS] = {4, 8, 12, 16, 20, 24, 28, 32};
+    int input_offset[CTRL_NUM_TESTS];
+    int weight_offset[CTRL_NUM_TESTS];
 
-    // Allocate arrays with MAX_K stride (zero-padded)
-    int total_input  = CTRL_NUM_TESTS * CTRL_MAX_K;
-    int total_weight = CTRL_NUM_TESTS * CTRL_ROWS * CTRL_MAX_K;
+    // Packed sizes follow the real K of each test
+    int total_input  = 0;
+    int total_weight = 0;
     int total_output = CTRL_NUM_TESTS * CTRL_ROWS;
+    for (int t = 0; t < CTRL_NUM_TESTS; t++) {
+        input_offset[t]  = total_input;
+        weight_offset[t] = total_weight;
+        total_input  += dim_k_values[t];
+        total_weight += CTRL_ROWS * dim_k_values[t];
+    }
 
     int8_t*  all_input  = (int8_t*)calloc(total_input, sizeof(int8_t));
     int8_t*  all_weight = (int8_t*)calloc(total_weight, sizeof(int8_t));
@@ -192,37 +220,37 @@ void generate_gemv_ctrl_test_hex(int seed) {
 
     for (int t = 0; t < CTRL_NUM_TESTS; t++) {
         int dim_k = dim_k_values[t];
-        int base_input  = t * CTRL_MAX_K;
-        int base_weight = t * CTRL_ROWS * CTRL_MAX_K;
-        int base_output = t * CTRL_ROWS;
+        int8_t*  input  = &all_input[input_offset[t]];
+        int8_t*  weight = &all_weight[weight_offset[t]];
+        int32_t* output = &all_output[t * CTRL_ROWS];
 
-        // Generate random input (only dim_k entries, rest stays 0)
+        // Generate random input (dim_k entries)
         for (int k = 0; k < dim_k; k++)
-            all_input[base_input + k] = (int8_t)((rand() % 256) - 128);
+            input[k] = (int8_t)((rand() % 256) - 128);
 
-        // Generate random weight (only dim_k columns per row, rest stays 0)
+        // Generate random weight (dim_k columns per row)
         for (int r = 0; r < CTRL_ROWS; r++)
             for (int k = 0; k < dim_k; k++)
-                all_weight[base_weight + r * CTRL_MAX_K + k] =
-                    (int8_t)((rand() % 256) - 128);
+                weight[r * dim_k + k] = (int8_t)((rand() % 256) - 128);
 
-        // Compute expected output: tile-based accumulation (mimics RTL)
+        // Compute expected output: tile-based accumulation (mimics RTL,
+        // columns past dim_k in the last tile are zero)
         int num_tiles = (dim_k + CTRL_COLS - 1) / CTRL_COLS;
         for (int r = 0; r < CTRL_ROWS; r++)
-            all_output[base_output + r] = 0;
+            output[r] = 0;
 
         for (int tile = 0; tile < num_tiles; tile++) {
             for (int r = 0; r < CTRL_ROWS; r++) {
                 for (int c = 0; c < CTRL_COLS; c++) {
                     int k = tile * CTRL_COLS + c;
-                    int8_t inp = all_input[base_input + k];
-                    int8_t wgt = all_weight[base_weight + r * CTRL_MAX_K + k];
-                    all_output[base_output + r] += (int32_t)inp * (int32_t)wgt;
+                    if (k >= dim_k) continue;
+                    output[r] += (int32_t)input[k] * (int32_t)weight[r * dim_k + k];
                 }
             }
         }
 
-        printf("  Test %d: dim_k=%d, num_tiles=%d\n", t, dim_k, num_tiles);
+        printf("  Test %d: dim_k=%d, num_tiles=%d, offsets=(%d, %d)\n",
+               t, dim_k, num_tiles, input_offset[t], weight_offset[t]);
     }
 
     // Dump hex files
@@ -232,27 +260,658 @@ void generate_gemv_ctrl_test_hex(int seed) {
                      all_weight, total_weight, 8);
     dump_to_hex_file(HEX_DIR "gemv_ctrl_test_output.hex",
                      all_output, total_output, 32);
+    dump_tile_hash_file(HEX_DIR "gemv_ctrl_test_output_hash.hex",
+                        all_output, total_output, CTRL_ROWS);
 
-    // Dump dim_k values as 32-bit hex
+    // Dump dim_k values and offset table as 32-bit hex
     FILE *f_dimk = fopen(HEX_DIR "gemv_ctrl_test_dimk.hex", "w");
-    if (!f_dimk) {
-        printf("ERROR: Cannot open dimk hex file!\n");
+    FILE *f_off  = fopen(HEX_DIR "gemv_ctrl_test_offset.hex", "w");
+    if (!f_dimk || !f_off) {
+        printf("ERROR: Cannot open dimk/offset hex file!\n");
     } else {
-        for (int t = 0; t < CTRL_NUM_TESTS; t++)
+        for (int t = 0; t < CTRL_NUM_TESTS; t++) {
             fprintf(f_dimk, "%08X\n", (uint32_t)dim_k_values[t]);
-        fclose(f_dimk);
+            fprintf(f_off,  "%08X\n%08X\n",
+                    (uint32_t)input_offset[t], (uint32_t)weight_offset[t]);
+        }
     }
+    if (f_dimk) fclose(f_dimk);
+    if (f_off)  fclose(f_off);
 
+    int padded_input  = CTRL_NUM_TESTS * CTRL_MAX_K;
+    int padded_weight = CTRL_NUM_TESTS * CTRL_ROWS * CTRL_MAX_K;
     printf("  Generated: gemv_ctrl_test_input.hex  (%d entries, 8bit)\n", total_input);
     printf("  Generated: gemv_ctrl_test_weight.hex (%d entries, 8bit)\n", total_weight);
     printf("  Generated: gemv_ctrl_test_output.hex (%d entries, 32bit)\n", total_output);
     printf("  Generated: gemv_ctrl_test_dimk.hex   (%d entries, 32bit)\n", CTRL_NUM_TESTS);
+    printf("  Generated: gemv_ctrl_test_offset.hex (%d entries, 32bit)\n", 2 * CTRL_NUM_TESTS);
+    printf("  Packed input+weight: %d bytes (MAX_K padded: %d, %.0f%% saved)\n",
+           total_input + total_weight, padded_input + padded_weight,
+           100.0 * (1.0 - (double)(total_input + total_weight) /
+                          (padded_input + padded_weight)));
 
     free(all_input);
     free(all_weight);
     free(all_output);
 }
 
+//=============================================================================
+// REQUANT UNIT TEST HEX GENERATION (for requant_unit_tb)
+//=============================================================================
+
+#define REQUANT_NUM_TESTS 16
+
+// One SUBARRAY_ROWS-lane vector per test, each with its own CONFIG word
+// (scale/shift/relu in npu_pkg::config_t layout). Inputs mix random
+// accumulator-sized values with extremes to hit saturation and rounding.
+void generate_requant_test_hex(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Requant Unit Test Hex Generation (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    int lanes = SUBARRAY_ROWS;
+    int32_t*  all_input  = (int32_t*)calloc(REQUANT_NUM_TESTS * lanes, sizeof(int32_t));
+    int8_t*   all_output = (int8_t*)calloc(REQUANT_NUM_TESTS * lanes, sizeof(int8_t));
+    uint32_t* all_cfg    = (uint32_t*)calloc(REQUANT_NUM_TESTS, sizeof(uint32_t));
+
+    srand(seed);
+
+    for (int t = 0; t < REQUANT_NUM_TESTS; t++) {
+        int32_t* input = &all_input[t * lanes];
+        int16_t scale  = (t == 0) ? 1 : (int16_t)((rand() % 65536) - 32768);
+        int shift      = (t == 0) ? 0 : 20 + rand() % 12;
+        int relu       = t & 1;
+
+        for (int i = 0; i < lanes; i++)
+            input[i] = (int32_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand()) >> (rand() % 24);
+        input[0] = INT32_MAX;
+        input[1] = INT32_MIN;
+        input[2] = 0;
+        input[3] = (shift > 0) ? (1 << (shift - 1)) : 1;  // Rounding boundary
+
+        all_cfg[t] = NPU_CFG_RQ(scale, shift, relu);
+        ref_requant(input, &all_output[t * lanes], lanes, scale, shift, relu);
+    }
+
+    printf("  Total test cases: %d\n", REQUANT_NUM_TESTS);
+
+    dump_to_hex_file(HEX_DIR "requant_test_input.hex",  all_input,  REQUANT_NUM_TESTS * lanes, 32);
+    dump_to_hex_file(HEX_DIR "requant_test_output.hex", all_output, REQUANT_NUM_TESTS * lanes, 8);
+    dump_to_hex_file(HEX_DIR "requant_test_cfg.hex",    all_cfg,    REQUANT_NUM_TESTS, 32);
+
+    free(all_input);
+    free(all_output);
+    free(all_cfg);
+}
+
+//=============================================================================
+// KV BLOCK WALKER HEX GENERATION (rtl/memory/kv_block_walker.sv)
+//=============================================================================
+
+#define KV_WALK_SHIFT      3      // 8 rows per block
+#define KV_WALK_ROW_BYTES  128    // One head_dim=128 INT8 K/V row
+#define KV_WALK_BLOCKS     16
+#define KV_WALK_SEQ        64     // Sequential walk (attention over 64 tokens)
+#define KV_WALK_REQS       96     // ... then random rows
+
+// Block table (KV_WALK_BLOCKS entries + the spare entry read by lookahead)
+// holding a random permutation of physical blocks, logical rows, and the
+// expected physical row addresses
+void generate_kv_walker_test_hex(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("KV Block Walker Test Hex Generation (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    uint32_t table[KV_WALK_BLOCKS + 1];
+    uint32_t rows[KV_WALK_REQS];
+    uint32_t addrs[KV_WALK_REQS];
+    uint32_t block_bytes = (1u << KV_WALK_SHIFT) * KV_WALK_ROW_BYTES;
+    int rows_total = KV_WALK_BLOCKS << KV_WALK_SHIFT;
+
+    srand(seed);
+
+    int perm[KV_WALK_BLOCKS + 1];
+    for (int b = 0; b <= KV_WALK_BLOCKS; b++) perm[b] = b;
+    for (int b = KV_WALK_BLOCKS; b > 0; b--) {
+        int j = rand() % (b + 1);
+        int t = perm[b]; perm[b] = perm[j]; perm[j] = t;
+    }
+    for (int b = 0; b <= KV_WALK_BLOCKS; b++)
+        table[b] = 0x10000 + (uint32_t)perm[b] * block_bytes;
+
+    for (int i = 0; i < KV_WALK_REQS; i++) {
+        rows[i]  = (i < KV_WALK_SEQ) ? (uint32_t)i : (uint32_t)(rand() % rows_total);
+        addrs[i] = table[rows[i] >> KV_WALK_SHIFT] +
+                   (rows[i] & ((1u << KV_WALK_SHIFT) - 1)) * KV_WALK_ROW_BYTES;
+    }
+
+    printf("  Blocks: %d x %d rows, %d requests (%d sequential)\n",
+           KV_WALK_BLOCKS, 1 << KV_WALK_SHIFT, KV_WALK_REQS, KV_WALK_SEQ);
+
+    dump_to_hex_file(HEX_DIR "kv_walker_test_table.hex", table, KV_WALK_BLOCKS + 1, 32);
+    dump_to_hex_file(HEX_DIR "kv_walker_test_rows.hex",  rows,  KV_WALK_REQS, 32);
+    dump_to_hex_file(HEX_DIR "kv_walker_test_addr.hex",  addrs, KV_WALK_REQS, 32);
+}
+
+//=============================================================================
+// IOMMU TLB HEX GENERATION (rtl/memory/iommu_tlb.sv)
+//=============================================================================
+
+#define TLB_TEST_ENTRIES  16     // iommu_tlb ENTRIES / EMU_TLB_ENTRIES
+#define TLB_PT_PAGES      64
+#define TLB_STREAM_PAGES  32     // Phase 1: streaming, 4 bursts per page
+#define TLB_STREAM_REQS   (TLB_STREAM_PAGES * 4)
+#define TLB_NUM_REQS      256    // Phase 2: random over a 12-page working set
+#define TLB_FAULT_ADDR    0xFFFFFFFFu
+
+// Page table (two invalid PTEs), IOVAs and expected physical addresses
+// (TLB_FAULT_ADDR for faults). Also runs the sequence through a model of
+// the RTL TLB to report the expected hit/miss counts.
+void generate_iommu_tlb_test_hex(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("IOMMU TLB Test Hex Generation (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    uint32_t pt[TLB_PT_PAGES];
+    uint32_t iova[TLB_NUM_REQS];
+    uint32_t pa[TLB_NUM_REQS];
+
+    srand(seed);
+
+    for (int p = 0; p < TLB_PT_PAGES; p++)
+        pt[p] = ((0x400u + (uint32_t)p * 7u % 256u) << NPU_PAGE_SHIFT) | NPU_PTE_VALID;
+    pt[5]  &= ~NPU_PTE_VALID;
+    pt[40] &= ~NPU_PTE_VALID;
+
+    for (int i = 0; i < TLB_NUM_REQS; i++) {
+        uint32_t page = (i < TLB_STREAM_REQS) ? 8u + (uint32_t)(i / 4)
+                                              : 16u + (uint32_t)(rand() % 12);
+        if (i == TLB_NUM_REQS - 2) page = 40;             // Invalid PTE
+        if (i == TLB_NUM_REQS - 1) page = TLB_PT_PAGES;   // Past the table
+        iova[i] = (page << NPU_PAGE_SHIFT) | ((uint32_t)(rand() % 64) * 64u);
+    }
+
+    // Reference TLB (fully associative, round-robin refill)
+    uint32_t vpn[TLB_TEST_ENTRIES], ppn[TLB_TEST_ENTRIES];
+    int valid = 0, next = 0, hits = 0, misses = 0;
+    for (int i = 0; i < TLB_NUM_REQS; i++) {
+        uint32_t v = iova[i] >> NPU_PAGE_SHIFT;
+        int e = -1;
+        for (int t = 0; t < valid; t++)
+            if (vpn[t] == v) e = t;
+
+        if (e >= 0) {
+            hits++;
+        } else if (v < TLB_PT_PAGES) {
+            misses++;
+            if (pt[v] & NPU_PTE_VALID) {
+                e = next;
+                vpn[e] = v;
+                ppn[e] = pt[v] >> NPU_PAGE_SHIFT;
+                next = (next + 1) % TLB_TEST_ENTRIES;
+                if (valid < TLB_TEST_ENTRIES) valid++;
+            }
+        }
+        pa[i] = (e >= 0) ? (ppn[e] << NPU_PAGE_SHIFT) | (iova[i] & (NPU_PAGE_SIZE - 1))
+                         : TLB_FAULT_ADDR;
+    }
+
+    printf("  Requests: %d (%d streaming), expected %d hits / %d misses\n",
+           TLB_NUM_REQS, TLB_STREAM_REQS, hits, misses);
+
+    dump_to_hex_file(HEX_DIR "tlb_test_pt.hex",   pt,   TLB_PT_PAGES, 32);
+    dump_to_hex_file(HEX_DIR "tlb_test_iova.hex", iova, TLB_NUM_REQS, 32);
+    dump_to_hex_file(HEX_DIR "tlb_test_pa.hex",   pa,   TLB_NUM_REQS, 32);
+}
+
+//=============================================================================
+// EMBEDDING GATHER HEX GENERATION (rtl/memory/embed_gather.sv)
+//=============================================================================
+
+#define EG_TOKENS     32       // Token ids per job
+#define EG_VOCAB      LLAMA_VOCAB
+#define EG_ROW_BYTES  512      // 1/8-scale hidden
+#define EG_TABLE      0x10000000u
+#define EG_BAD_POS    20       // Second job: out-of-vocab id here
+
+// Token ids for two jobs (the second with an id == vocab at EG_BAD_POS)
+// and the expected row burst addresses of the first; the second job must
+// issue the same first EG_BAD_POS rows and then stop with an error.
+void generate_embed_gather_test_hex(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Embedding Gather Test Hex Generation (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    uint32_t ids[2 * EG_TOKENS];
+    uint32_t addr[EG_TOKENS];
+
+    srand(seed);
+
+    for (int n = 0; n < EG_TOKENS; n++) {
+        ids[n] = (n == 0) ? EG_VOCAB - 1 : (uint32_t)(rand() % EG_VOCAB);
+        ids[EG_TOKENS + n] = ids[n];
+        addr[n] = EG_TABLE + ids[n] * EG_ROW_BYTES;
+    }
+    ids[EG_TOKENS + EG_BAD_POS] = EG_VOCAB;
+
+    printf("  Tokens: %d per job, row %d B, bad id at %d in job 2\n",
+           EG_TOKENS, EG_ROW_BYTES, EG_BAD_POS);
+
+    dump_to_hex_file(HEX_DIR "embed_test_ids.hex",  ids,  2 * EG_TOKENS, 32);
+    dump_to_hex_file(HEX_DIR "embed_test_addr.hex", addr, EG_TOKENS, 32);
+}
+
+//=============================================================================
+// TOP-K UNIT HEX GENERATION (rtl/compute/topk_unit.sv)
+//=============================================================================
+
+#define TOPK_TEST_K      8      // topk_unit K / NPU_TOPK_MAX
+#define TOPK_NUM_TESTS   6
+#define TOPK_LEN         1000   // Outputs per test
+#define TOPK_BEAT_LEN    790    // Streamed as lane beats (last one ragged),
+                                // the rest as single pairs (merge port)
+
+// Logit vectors and their expected sorted top-K (index, value). Test 0 is
+// all ties, test 1 full-range random, the rest a narrow range so that many
+// values tie at the K-th place.
+void generate_topk_test_hex(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Top-K Unit Test Hex Generation (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    int32_t* all_logits = (int32_t*)calloc(TOPK_NUM_TESTS * TOPK_LEN, sizeof(int32_t));
+    int32_t* all_idx    = (int32_t*)calloc(TOPK_NUM_TESTS * TOPK_TEST_K, sizeof(int32_t));
+    int32_t* all_val    = (int32_t*)calloc(TOPK_NUM_TESTS * TOPK_TEST_K, sizeof(int32_t));
+
+    srand(seed);
+
+    for (int t = 0; t < TOPK_NUM_TESTS; t++) {
+        int32_t* logits = &all_logits[t * TOPK_LEN];
+        for (int i = 0; i < TOPK_LEN; i++) {
+            if (t == 0)
+                logits[i] = -5;
+            else if (t == 1)
+                logits[i] = (int32_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand());
+            else
+                logits[i] = (rand() % 64) - 32;
+        }
+        ref_topk(logits, TOPK_LEN, TOPK_TEST_K,
+                 &all_idx[t * TOPK_TEST_K], &all_val[t * TOPK_TEST_K]);
+    }
+
+    printf("  Total test cases: %d (K=%d, %d outputs each)\n",
+           TOPK_NUM_TESTS, TOPK_TEST_K, TOPK_LEN);
+
+    dump_to_hex_file(HEX_DIR "topk_test_logits.hex", all_logits, TOPK_NUM_TESTS * TOPK_LEN, 32);
+    dump_to_hex_file(HEX_DIR "topk_test_idx.hex",    all_idx,    TOPK_NUM_TESTS * TOPK_TEST_K, 32);
+    dump_to_hex_file(HEX_DIR "topk_test_val.hex",    all_val,    TOPK_NUM_TESTS * TOPK_TEST_K, 32);
+
+    free(all_logits);
+    free(all_idx);
+    free(all_val);
+}
+
+//=============================================================================
+// ROPE UNIT HEX GENERATION (rtl/compute/rope_unit.sv)
+//=============================================================================
+
+#define ROPE_NUM_TESTS  16
+#define ROPE_POSITIONS  4096
+
+// One SUBARRAY_ROWS-lane vector per test with the SUBARRAY_ROWS/2 table
+// entries its pairs use (random position, random 16-pair slice of the
+// head). Test 0 is position 0 (identity), the first lanes of every vector
+// hold extremes to hit saturation.
+void generate_rope_test_hex(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("RoPE Unit Test Hex Generation (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    int lanes = SUBARRAY_ROWS, pairs = SUBARRAY_ROWS / 2;
+    int head_pairs = LLAMA_HEAD_DIM / 2;
+    uint32_t* table      = (uint32_t*)calloc((size_t)ROPE_POSITIONS * head_pairs, sizeof(uint32_t));
+    int32_t*  all_input  = (int32_t*)calloc(ROPE_NUM_TESTS * lanes, sizeof(int32_t));
+    int32_t*  all_output = (int32_t*)calloc(ROPE_NUM_TESTS * lanes, sizeof(int32_t));
+    uint32_t* all_cs     = (uint32_t*)calloc(ROPE_NUM_TESTS * pairs, sizeof(uint32_t));
+
+    ref_rope_table(table, ROPE_POSITIONS, LLAMA_HEAD_DIM);
+    srand(seed);
+
+    for (int t = 0; t < ROPE_NUM_TESTS; t++) {
+        int32_t*  x  = &all_input[t * lanes];
+        uint32_t* cs = &all_cs[t * pairs];
+        int pos   = (t == 0) ? 0 : rand() % ROPE_POSITIONS;
+        int slice = (rand() % (head_pairs / pairs)) * pairs;
+
+        for (int i = 0; i < lanes; i++)
+            x[i] = (int32_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand()) >> (rand() % 24);
+        x[0] = INT32_MAX;
+        x[1] = INT32_MIN;
+        x[2] = INT32_MIN;
+        x[3] = INT32_MIN;
+        for (int j = 0; j < pairs; j++)
+            cs[j] = table[(size_t)pos * head_pairs + slice + j];
+
+        // Rotate the vector as one column (ref_rope pairs are lanes 2j, 2j+1)
+        memcpy(&all_output[t * lanes], x, lanes * sizeof(int32_t));
+        ref_rope(&all_output[t * lanes], lanes, 1, lanes, cs, 0);
+    }
+
+    printf("  Total test cases: %d\n", ROPE_NUM_TESTS);
+
+    dump_to_hex_file(HEX_DIR "rope_test_input.hex",  all_input,  ROPE_NUM_TESTS * lanes, 32);
+    dump_to_hex_file(HEX_DIR "rope_test_cs.hex",     all_cs,     ROPE_NUM_TESTS * pairs, 32);
+    dump_to_hex_file(HEX_DIR "rope_test_output.hex", all_output, ROPE_NUM_TESTS * lanes, 32);
+
+    free(table);
+    free(all_input);
+    free(all_output);
+    free(all_cs);
+}
+
+//=============================================================================
+// PREEMPTION HEX GENERATION (rtl/core/tile_ctrl.sv + top_pe)
+//=============================================================================
+
+#define PREEMPT_M  64      // 2 M tiles
+#define PREEMPT_K  64      // 8 K tiles
+#define PREEMPT_N  4
+
+// One K-tiled GEMM; tile_ctrl_tb preempts it at every offset and checks
+// that the resumed job still produces Y
+void generate_preempt_test_hex(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Preemption Test Hex Generation (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    int8_t*  W = (int8_t*)calloc(PREEMPT_M * PREEMPT_K, 1);
+    int8_t*  X = (int8_t*)calloc(PREEMPT_K * PREEMPT_N, 1);
+    int32_t* Y = (int32_t*)calloc(PREEMPT_M * PREEMPT_N, sizeof(int32_t));
+
+    generate_random_i8(W, PREEMPT_M * PREEMPT_K, seed);
+    generate_random_i8(X, PREEMPT_K * PREEMPT_N, seed + 1000);
+    ref_gemm_fast(W, X, Y, PREEMPT_M, PREEMPT_K, PREEMPT_N);
+
+    printf("  GEMM: %dx%dx%d\n", PREEMPT_M, PREEMPT_K, PREEMPT_N);
+
+    dump_to_hex_file(HEX_DIR "preempt_test_weight.hex", W, PREEMPT_M * PREEMPT_K, 8);
+    dump_to_hex_file(HEX_DIR "preempt_test_input.hex",  X, PREEMPT_K * PREEMPT_N, 8);
+    dump_to_hex_file(HEX_DIR "preempt_test_output.hex", Y, PREEMPT_M * PREEMPT_N, 32);
+
+    free(W);
+    free(X);
+    free(Y);
+}
+
+//=============================================================================
+// TRACE UNIT HEX GENERATION (rtl/core/trace_unit.sv)
+//=============================================================================
+
+#define TRACE_TEST_DEPTH   64
+#define TRACE_TEST_CYCLES  600
+#define TRACE_TEST_PCT     10     // Per event and cycle (MARK: 1)
+
+// One random event stream, two configurations: (1) wrapping ring, STALL
+// filtered out; (2) stop when full, nothing recorded before the first MARK.
+// Bursts of ~0.7 events per cycle into a 1-entry/cycle writer also exercise
+// the drop counter.
+void generate_trace_test_hex(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Trace Unit Test Hex Generation (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    uint8_t*  valid = (uint8_t*)calloc(TRACE_TEST_CYCLES, 1);
+    uint32_t* arg   = (uint32_t*)calloc(TRACE_TEST_CYCLES * TRACE_NUM_EVENTS, sizeof(uint32_t));
+    uint32_t* ring  = (uint32_t*)calloc(2 * TRACE_TEST_DEPTH, sizeof(uint32_t));
+    srand(seed);
+
+    for (int c = 0; c < TRACE_TEST_CYCLES; c++) {
+        for (int e = 0; e < TRACE_NUM_EVENTS; e++) {
+            int pct = (e == NPU_TRACE_EV_MARK) ? 1 : TRACE_TEST_PCT;
+            if (rand() % 100 < pct)
+                valid[c] |= (uint8_t)(1u << e);
+            arg[c * TRACE_NUM_EVENTS + e] = (((uint32_t)rand() << 12) ^ (uint32_t)rand()) & TRACE_ARG_MASK;
+        }
+    }
+
+    TraceRun runs[2] = {
+        { TRACE_TEST_DEPTH, 0xFFu & ~(1u << NPU_TRACE_EV_STALL), 0, 0, 0, 0, 0, 0, 0, 0 },
+        { TRACE_TEST_DEPTH, 0xFFu, 1, 1, NPU_TRACE_EV_MARK, 0, 0, 0, 0, 0 }
+    };
+    for (int r = 0; r < 2; r++) {
+        TraceRun* run = &runs[r];
+        char path[128];
+        memset(ring, 0, 2 * TRACE_TEST_DEPTH * sizeof(uint32_t));
+        ref_trace_unit(run, valid, arg, TRACE_TEST_CYCLES, ring);
+
+        uint32_t status[2] = {
+            run->wr_ptr | (run->wrapped ? NPU_TRACE_WRAPPED : 0) |
+            (run->triggered ? NPU_TRACE_TRIGGERED : 0) | (run->stopped ? NPU_TRACE_STOPPED : 0),
+            run->dropped
+        };
+        printf("  Config %d: wr_ptr=%u wrapped=%d triggered=%d stopped=%d dropped=%u\n",
+               r + 1, run->wr_ptr, run->wrapped, run->triggered, run->stopped, run->dropped);
+
+        sprintf(path, HEX_DIR "trace_test_ring_%d.hex", r + 1);
+        dump_to_hex_file(path, ring, 2 * TRACE_TEST_DEPTH, 32);
+        sprintf(path, HEX_DIR "trace_test_status_%d.hex", r + 1);
+        dump_to_hex_file(path, status, 2, 32);
+    }
+
+    dump_to_hex_file(HEX_DIR "trace_test_valid.hex", valid, TRACE_TEST_CYCLES, 8);
+    dump_to_hex_file(HEX_DIR "trace_test_arg.hex",   arg,   TRACE_TEST_CYCLES * TRACE_NUM_EVENTS, 32);
+
+    free(valid);
+    free(arg);
+    free(ring);
+}
+
+//=============================================================================
+// AXI4 BUFFER WINDOW HEX GENERATION (rtl/interface/axi4_buf_slave.sv)
+//=============================================================================
+
+#define AXIBUF_PES        2      // axi4_buf_slave_tb top_pe instances
+#define AXIBUF_DEPTH      4      // top_pe BUF_DEPTH
+#define AXIBUF_WLINE      (SUBARRAY_ROWS * SUBARRAY_COLS)   // Bytes
+#define AXIBUF_ILINE      SUBARRAY_COLS
+
+// Fill image of every weight and input line (per PE: W lines, then X
+// lines), written with one burst per buffer in the bandwidth benchmark
+void generate_axi_buf_test_hex(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("AXI4 Buffer Window Test Hex Generation (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    int per_pe = AXIBUF_DEPTH * (AXIBUF_WLINE + AXIBUF_ILINE);
+    int8_t* fill = (int8_t*)calloc((size_t)AXIBUF_PES * per_pe, 1);
+    generate_random_i8(fill, AXIBUF_PES * per_pe, seed);
+
+    printf("  PEs: %d, %d W lines x %d B, %d X lines x %d B\n",
+           AXIBUF_PES, AXIBUF_DEPTH, AXIBUF_WLINE, AXIBUF_DEPTH, AXIBUF_ILINE);
+
+    dump_to_hex_file(HEX_DIR "axi_buf_test_fill.hex", fill, AXIBUF_PES * per_pe, 8);
+
+    free(fill);
+}
+
+//=============================================================================
+// ACCUMULATOR WIDTH HEX GENERATION (gemv_subarray MAX_K guard bits)
+//=============================================================================
+
+#define ACC_TEST_K        512    // gemv_subarray_tb MAX_K
+
+// One 32x8 tile held for ACC_TEST_K / 8 enable cycles (K = ACC_TEST_K),
+// X = -128: rows 4i all -128 (largest sum, K * 2^14), rows 4i+1 all 127
+// (most negative), the rest random. Output through ref_acc_bits() wide
+// accumulators
+void generate_acc_test_hex(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Accumulator Width Test Hex Generation (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    int K = ACC_TEST_K;
+    int acc_bits = ref_acc_bits(K);
+    int col_bits = ref_acc_bits(K / SUBARRAY_COLS);
+    int8_t  x_tile[SUBARRAY_COLS];
+    int8_t  w_tile[SUBARRAY_ROWS * SUBARRAY_COLS];
+    int32_t y[SUBARRAY_ROWS];
+    int8_t* X = (int8_t*)malloc(K);
+    int8_t* W = (int8_t*)malloc((size_t)SUBARRAY_ROWS * K);
+
+    memset(x_tile, -128, sizeof(x_tile));
+    generate_random_i8(w_tile, SUBARRAY_ROWS * SUBARRAY_COLS, seed);
+    for (int r = 0; r < SUBARRAY_ROWS; r++) {
+        for (int c = 0; c < SUBARRAY_COLS; c++) {
+            if (r % 4 == 0) w_tile[r * SUBARRAY_COLS + c] = -128;
+            if (r % 4 == 1) w_tile[r * SUBARRAY_COLS + c] = 127;
+        }
+    }
+    for (int k = 0; k < K; k++) {
+        X[k] = x_tile[k % SUBARRAY_COLS];
+        for (int r = 0; r < SUBARRAY_ROWS; r++)
+            W[(size_t)r * K + k] = w_tile[r * SUBARRAY_COLS + k % SUBARRAY_COLS];
+    }
+    int wrapped = ref_gemv_acc(X, W, y, K, SUBARRAY_ROWS, acc_bits, col_bits);
+
+    printf("  K=%d: %d-bit accumulators (%d-bit columns), %d rows wrapped\n",
+           K, acc_bits, col_bits, wrapped);
+    printf("  Row 0: %d, row 1: %d\n", y[0], y[1]);
+
+    dump_to_hex_file(HEX_DIR "acc_test_input.hex",  x_tile, SUBARRAY_COLS, 8);
+    dump_to_hex_file(HEX_DIR "acc_test_weight.hex", w_tile, SUBARRAY_ROWS * SUBARRAY_COLS, 8);
+    dump_to_hex_file(HEX_DIR "acc_test_output.hex", y, SUBARRAY_ROWS, 32);
+
+    free(X);
+    free(W);
+}
+
+//=============================================================================
+// FLOATING-POINT MAC HEX GENERATION (gemv_subarray FP_EN, fp_mac_unit)
+//=============================================================================
+
+#define FP_TEST_LINES     16     // gemv_subarray_tb FP_TEST_LINES
+#define FP_TEST_K         (FP_TEST_LINES * FP_COLS)
+
+// Random value in [-range, range) encoded as fmt
+static uint16_t fp_random(int fmt, float range) {
+    float f = range * (2.0f * (float)rand() / ((float)RAND_MAX + 1.0f) - 1.0f);
+    return fmt == FMT_BF16 ? ref_f32_to_bf16(f) : ref_f32_to_fp16(f);
+}
+
+// One BF16 and one FP16 GEMV (32 rows, K = FP_TEST_K): per format
+// FP_TEST_LINES input lines and weight tiles (element j = lanes {2j+1, 2j},
+// little endian), outputs FP32 bits from ref_gemm_fp
+void generate_fp_test_hex(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("FP MAC Test Hex Generation (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    uint16_t X[2][FP_TEST_K];
+    uint16_t W[2][SUBARRAY_ROWS * FP_TEST_K];
+    uint16_t x_lines[2][FP_TEST_K];
+    uint16_t w_lines[2][SUBARRAY_ROWS * FP_TEST_K];
+    uint32_t Y[2][SUBARRAY_ROWS];
+
+    srand(seed);
+    for (int t = 0; t < 2; t++) {
+        int fmt = t == 0 ? FMT_BF16 : FMT_FP16;
+        for (int k = 0; k < FP_TEST_K; k++)
+            X[t][k] = fp_random(fmt, 4.0f);
+        for (int i = 0; i < SUBARRAY_ROWS * FP_TEST_K; i++)
+            W[t][i] = fp_random(fmt, 1.0f);
+        ref_gemm_fp(W[t], X[t], Y[t], SUBARRAY_ROWS, FP_TEST_K, 1, fmt);
+
+        // Line l holds elements l * FP_COLS .. l * FP_COLS + FP_COLS - 1
+        for (int l = 0; l < FP_TEST_LINES; l++) {
+            for (int j = 0; j < FP_COLS; j++) {
+                int k = l * FP_COLS + j;
+                x_lines[t][l * FP_COLS + j] = X[t][k];
+                for (int r = 0; r < SUBARRAY_ROWS; r++)
+                    w_lines[t][(l * SUBARRAY_ROWS + r) * FP_COLS + j] = W[t][r * FP_TEST_K + k];
+            }
+        }
+        printf("  %s: K=%d, row 0 = %08X (%g)\n", t == 0 ? "BF16" : "FP16",
+               FP_TEST_K, Y[t][0], ref_u32_to_f32(Y[t][0]));
+    }
+
+    dump_to_hex_file(HEX_DIR "fp_test_input.hex",  x_lines, 2 * FP_TEST_K * 2, 8);
+    dump_to_hex_file(HEX_DIR "fp_test_weight.hex", w_lines, 2 * SUBARRAY_ROWS * FP_TEST_K * 2, 8);
+    dump_to_hex_file(HEX_DIR "fp_test_output.hex", Y, 2 * SUBARRAY_ROWS, 32);
+}
+
+//=============================================================================
+// FP8 / MX HEX GENERATION (gemv_subarray FP8 lanes, block scales)
+//=============================================================================
+
+#define FP8_TEST_LINES    16     // gemv_subarray_tb FP8_TEST_LINES
+#define FP8_TEST_K        (FP8_TEST_LINES * SUBARRAY_COLS)
+#define FP8_TEST_KB       (FP8_TEST_K / MX_BLOCK)
+
+// Two 32-row GEMVs, K = FP8_TEST_K: E4M3 without scales (all
+// MX_SCALE_ONE) and E5M2 with MX scales (rows and blocks of different
+// magnitude). Per test: input lines, weight tiles (lane c = element 8l + c),
+// W scales [row][block], X scales [block], FP32 outputs of ref_gemm_fp8
+void generate_fp8_test_hex(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("FP8 / MX Test Hex Generation (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    float    xf[FP8_TEST_K], wf[SUBARRAY_ROWS * FP8_TEST_K];
+    uint8_t  X[2][FP8_TEST_K], W[2][SUBARRAY_ROWS * FP8_TEST_K];
+    uint8_t  w_lines[2][SUBARRAY_ROWS * FP8_TEST_K];
+    uint8_t  ws[2][SUBARRAY_ROWS * FP8_TEST_KB], xs[2][FP8_TEST_KB];
+    uint32_t Y[2][SUBARRAY_ROWS];
+
+    srand(seed);
+    for (int t = 0; t < 2; t++) {
+        int e5m2 = t;
+        for (int k = 0; k < FP8_TEST_K; k++)
+            xf[k] = ldexpf(2.0f * (float)rand() / RAND_MAX - 1.0f, t ? (k / MX_BLOCK) * 3 - 4 : 2);
+        for (int i = 0; i < SUBARRAY_ROWS * FP8_TEST_K; i++)
+            wf[i] = ldexpf(2.0f * (float)rand() / RAND_MAX - 1.0f, t ? i / FP8_TEST_K % 8 - 6 : 0);
+        if (t == 0) {
+            for (int k = 0; k < FP8_TEST_K; k++)
+                X[t][k] = ref_f32_to_fp8(xf[k], e5m2);
+            for (int i = 0; i < SUBARRAY_ROWS * FP8_TEST_K; i++)
+                W[t][i] = ref_f32_to_fp8(wf[i], e5m2);
+            memset(ws[t], MX_SCALE_ONE, sizeof(ws[t]));
+            memset(xs[t], MX_SCALE_ONE, sizeof(xs[t]));
+        } else {
+            ref_mx_quantize(xf, FP8_TEST_K, e5m2, X[t], xs[t]);
+            for (int r = 0; r < SUBARRAY_ROWS; r++)
+                ref_mx_quantize(wf + r * FP8_TEST_K, FP8_TEST_K, e5m2,
+                                W[t] + r * FP8_TEST_K, ws[t] + r * FP8_TEST_KB);
+        }
+        ref_gemm_fp8(W[t], X[t], ws[t], xs[t], Y[t], SUBARRAY_ROWS, FP8_TEST_K, 1, e5m2);
+
+        for (int l = 0; l < FP8_TEST_LINES; l++)
+            for (int r = 0; r < SUBARRAY_ROWS; r++)
+                memcpy(&w_lines[t][(l * SUBARRAY_ROWS + r) * SUBARRAY_COLS],
+                       &W[t][r * FP8_TEST_K + l * SUBARRAY_COLS], SUBARRAY_COLS);
+        printf("  %s: K=%d, X scales %d..%d, row 0 = %08X (%g)\n",
+               t ? "E5M2 MX" : "E4M3", FP8_TEST_K, xs[t][0], xs[t][FP8_TEST_KB - 1],
+               Y[t][0], ref_u32_to_f32(Y[t][0]));
+    }
+
+    dump_to_hex_file(HEX_DIR "fp8_test_input.hex",  X, 2 * FP8_TEST_K, 8);
+    dump_to_hex_file(HEX_DIR "fp8_test_weight.hex", w_lines, 2 * SUBARRAY_ROWS * FP8_TEST_K, 8);
+    dump_to_hex_file(HEX_DIR "fp8_test_wscale.hex", ws, 2 * SUBARRAY_ROWS * FP8_TEST_KB, 8);
+    dump_to_hex_file(HEX_DIR "fp8_test_xscale.hex", xs, 2 * FP8_TEST_KB, 8);
+    dump_to_hex_file(HEX_DIR "fp8_test_output.hex", Y, 2 * SUBARRAY_ROWS, 32);
+}
+
 //=============================================================================
 // GEMV TEST (seed-based random, with tiled vs direct verification)
 //=============================================================================
@@ -389,6 +1048,8 @@ void test_gemm(int seed, int M, int K, int N) {
     dump_to_hex_file(fname, B, K * N, 8);
     sprintf(fname, HEX_DIR "gemm_s%d_c.hex", seed);
     dump_to_hex_file(fname, C_tiled, M * N, 32);
+    sprintf(fname, HEX_DIR "gemm_s%d_c_hash.hex", seed);
+    dump_gemm_tile_hash_file(fname, C_tiled, M, N, SUBARRAY_ROWS);
 
     free(A);
     free(B);
@@ -397,49 +1058,2887 @@ void test_gemm(int seed, int M, int K, int N) {
 }
 
 //=============================================================================
-// MAIN
+// TILE HASH TEST (compare-by-hash golden outputs)
 //=============================================================================
 
-int main(int argc, char* argv[]) {
-    int seed = 42;
-    if (argc > 1) seed = atoi(argv[1]);
-
-    printf("\n");
-    printf("*************************************************************\n");
-    printf("*     NPU Reference Model - Seed-based Test Generator       *\n");
-    printf("*************************************************************\n");
+void test_tile_hash(int seed, int M, int K, int N) {
     printf("\n");
-    printf("  Seed: %d\n", seed);
-    printf("  Sub-array: %d x %d\n", SUBARRAY_ROWS, SUBARRAY_COLS);
-    printf("  Data types: INT8 input/weight, INT32 accumulator\n");
+    printf("=============================================================\n");
+    printf("Tile Hash Test (seed=%d, M=%d, K=%d, N=%d)\n", seed, M, K, N);
+    printf("=============================================================\n");
 
-    //=========================================================================
-    // MAC Unit Hex Generation
-    //=========================================================================
-    printf("\n\n>>> MAC UNIT HEX GENERATION <<<\n");
-    generate_mac_test_hex(seed);
+    int8_t* A = (int8_t*)calloc(M * K, sizeof(int8_t));
+    int8_t* B = (int8_t*)calloc(K * N, sizeof(int8_t));
+    int32_t* C = (int32_t*)calloc(M * N, sizeof(int32_t));
+    int m_tiles = (M + SUBARRAY_ROWS - 1) / SUBARRAY_ROWS;
+    int num_tiles = m_tiles * N;
+    int32_t* hashes = (int32_t*)calloc(num_tiles, sizeof(int32_t));
+    int32_t tile[SUBARRAY_ROWS];
 
-    //=========================================================================
-    // GEMV Sub-array Hex Generation (for gemv_subarray_tb)
-    //=========================================================================
-    printf("\n\n>>> GEMV SUB-ARRAY HEX GENERATION <<<\n");
-    generate_gemv_subarray_test_hex(seed);
+    generate_random_i8(A, M * K, seed);
+    generate_random_i8(B, K * N, seed + 2000);
+    ref_gemm_tiled(A, B, C, M, K, N);
 
-    //=========================================================================
-    // GEMV Ctrl Test Hex Generation (for gemv_ctrl_tb)
-    //=========================================================================
-    printf("\n\n>>> GEMV CTRL TEST HEX GENERATION <<<\n");
-    generate_gemv_ctrl_test_hex(seed);
+    char fname[128];
+    sprintf(fname, HEX_DIR "gemm_hash_s%d_c_hash.hex", seed);
+    dump_gemm_tile_hash_file(fname, C, M, N, SUBARRAY_ROWS);
+    int loaded = load_from_hex_file(fname, hashes, num_tiles, 32);
+
+    // Drain order: tile t = (m_tile, n) holds the subarray's output column
+    // for input column n, rebuilt here straight from A and B
+    int order_ok = (loaded == num_tiles);
+    for (int t = 0; t < num_tiles && order_ok; t++) {
+        int m_tile = (t / N) * SUBARRAY_ROWS;
+        int n = t % N;
+        for (int r = 0; r < SUBARRAY_ROWS; r++) {
+            int32_t sum = 0;
+            for (int k = 0; k < K && m_tile + r < M; k++)
+                sum += (int32_t)A[(m_tile + r) * K + k] * (int32_t)B[k * N + n];
+            tile[r] = sum;
+        }
+        if (ref_hash_i32(REF_HASH_INIT, tile, SUBARRAY_ROWS) != (uint32_t)hashes[t])
+            order_ok = 0;
+    }
 
-    //=========================================================================
-    // GEMV Tests (various dimensions, tiled vs direct verification)
-    //=========================================================================
-    printf("\n\n>>> GEMV TESTS <<<\n");
+    char msg[128];
+    sprintf(msg, "Tile hashes follow (m_tile, n) drain order (seed=%d)", seed);
+    TEST_ASSERT(order_ok, msg);
+
+    // Stream C tile by tile (as a TB would) with one corrupted element
+    int bad_m = M / 2 + 3, bad_n = N / 3;
+    C[bad_m * N + bad_n] ^= 1;
+    int mismatches = 0, bad_tile = -1;
+    for (int t = 0; t < num_tiles; t++) {
+        ref_gemm_drain_tile(C, M, N, (t / N) * SUBARRAY_ROWS, t % N, tile, SUBARRAY_ROWS);
+        if (ref_hash_i32(REF_HASH_INIT, tile, SUBARRAY_ROWS) != (uint32_t)hashes[t]) {
+            mismatches++;
+            bad_tile = t;
+        }
+    }
+    printf("  %d tile hashes (%d bytes vs %d bytes full dump)\n",
+           num_tiles, num_tiles * 9, M * N * 9);
 
-    // Single sub-array size (32x8)
-    test_gemv(seed,     SUBARRAY_COLS, SUBARRAY_ROWS);
-    // Tiling in input dimension (32x32)
-    test_gemv(seed + 1, 32, SUBARRAY_ROWS);
+    sprintf(msg, "Tile hash localizes corrupted tile (seed=%d)", seed);
+    TEST_ASSERT(loaded == num_tiles && mismatches == 1 &&
+                bad_tile == (bad_m / SUBARRAY_ROWS) * N + bad_n, msg);
+
+    free(A);
+    free(B);
+    free(C);
+    free(hashes);
+}
+
+//=============================================================================
+// INCREMENTAL GEMM TEST (dirty-tile recompute + in-place hex/bin patch)
+//=============================================================================
+
+void test_gemm_incremental(int seed, int M, int K, int N) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Incremental GEMM Test (seed=%d, M=%d, K=%d, N=%d)\n", seed, M, K, N);
+    printf("=============================================================\n");
+
+    int8_t* A = (int8_t*)calloc(M * K, sizeof(int8_t));
+    int8_t* B = (int8_t*)calloc(K * N, sizeof(int8_t));
+    int32_t* C_incr = (int32_t*)calloc(M * N, sizeof(int32_t));
+    int32_t* C_full = (int32_t*)calloc(M * N, sizeof(int32_t));
+    int32_t* C_file = (int32_t*)calloc(M * N, sizeof(int32_t));
+
+    generate_random_i8(A, M * K, seed);
+    generate_random_i8(B, K * N, seed + 2000);
+    ref_gemm_tiled(A, B, C_incr, M, K, N);
+
+    char hex_name[128], bin_name[128];
+    sprintf(hex_name, HEX_DIR "gemm_incr_s%d_c.hex", seed);
+    sprintf(bin_name, HEX_DIR "gemm_incr_s%d_c.bin", seed);
+    dump_to_hex_file(hex_name, C_incr, M * N, 32);
+    dump_to_bin_file(bin_name, C_incr, M * N, 32);
+
+    // Change a few rows of A (straddling an M-tile boundary) and cols of B
+    GemmDirty dirty = { SUBARRAY_ROWS + 1, SUBARRAY_ROWS + 8, N / 2, N / 2 + 4 };
+    srand(seed + 3000);
+    for (int m = dirty.a_row_begin; m < dirty.a_row_end; m++)
+        for (int k = 0; k < K; k++)
+            A[m * K + k] = (int8_t)((rand() % 256) - 128);
+    for (int k = 0; k < K; k++)
+        for (int n = dirty.b_col_begin; n < dirty.b_col_end; n++)
+            B[k * N + n] = (int8_t)((rand() % 256) - 128);
+
+    // Patch hex and binary outputs in place (separate copies of stale C)
+    memcpy(C_file, C_incr, M * N * sizeof(int32_t));
+    int recomputed = ref_gemm_update(A, B, C_incr, M, K, N, &dirty, hex_name, 0);
+    int bin_ret = ref_gemm_update(A, B, C_file, M, K, N, &dirty, bin_name, 1);
+    printf("  Recomputed %d / %d C elements (%.1f%%)\n",
+           recomputed, M * N, 100.0 * recomputed / (M * N));
+
+    ref_gemm_tiled(A, B, C_full, M, K, N);
+
+    char msg[128];
+    sprintf(msg, "GEMM incremental vs full (seed=%d, %dx%dx%d)", seed, M, K, N);
+    TEST_ASSERT(recomputed > 0 && recomputed < M * N &&
+                memcmp(C_incr, C_full, M * N * sizeof(int32_t)) == 0, msg);
+
+    int loaded = load_from_hex_file(hex_name, C_file, M * N, 32);
+    sprintf(msg, "GEMM incremental hex patch (seed=%d)", seed);
+    TEST_ASSERT(loaded == M * N &&
+                memcmp(C_file, C_full, M * N * sizeof(int32_t)) == 0, msg);
+
+    FILE* fp = fopen(bin_name, "rb");
+    size_t got = 0;
+    if (fp) {
+        got = fread(C_file, sizeof(int32_t), M * N, fp);
+        fclose(fp);
+    }
+    sprintf(msg, "GEMM incremental bin patch (seed=%d)", seed);
+    TEST_ASSERT(bin_ret == recomputed && got == (size_t)(M * N) &&
+                memcmp(C_file, C_full, M * N * sizeof(int32_t)) == 0, msg);
+
+    free(A);
+    free(B);
+    free(C_incr);
+    free(C_full);
+    free(C_file);
+}
+
+//=============================================================================
+// SHARDED GEMM TEST (forked workers, per-shard checksums, resume)
+//=============================================================================
+
+void test_gemm_sharded(int seed, int M, int K, int N) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Sharded GEMM Test (seed=%d, M=%d, K=%d, N=%d)\n", seed, M, K, N);
+    printf("=============================================================\n");
+
+    char prefix[128], fname[160];
+    sprintf(prefix, HEX_DIR "gemm_shard_s%d", seed);
+    ShardJob job = { M, K, N, seed, 2, 3, prefix };
+
+    int computed = shard_generate(&job, 0);
+
+    // Single-process golden from the same counter-based streams
+    int8_t* A = (int8_t*)calloc(M * K, sizeof(int8_t));
+    int8_t* B = (int8_t*)calloc(K * N, sizeof(int8_t));
+    int32_t* C_ref  = (int32_t*)calloc(M * N, sizeof(int32_t));
+    int32_t* C_file = (int32_t*)calloc(M * N, sizeof(int32_t));
+    for (int i = 0; i < M * K; i++) A[i] = generate_random_i8_at(seed, i);
+    for (int i = 0; i < K * N; i++) B[i] = generate_random_i8_at(seed + 2000, i);
+    ref_gemm_tiled(A, B, C_ref, M, K, N);
+
+    sprintf(fname, "%s_c.hex", prefix);
+    int loaded = load_from_hex_file(fname, C_file, M * N, 32);
+
+    char msg[128];
+    sprintf(msg, "Sharded GEMM vs single process (seed=%d, %lld shards)",
+            seed, (long long)shard_count(&job));
+    TEST_ASSERT(computed == shard_count(&job) && loaded == M * N &&
+                memcmp(C_file, C_ref, M * N * sizeof(int32_t)) == 0, msg);
+
+    // Resume after completion: every shard verifies, nothing recomputed
+    computed = shard_generate(&job, 1);
+    sprintf(msg, "Sharded GEMM resume (complete, seed=%d)", seed);
+    TEST_ASSERT(computed == 0, msg);
+
+    // Resume after losing the last progress record: only that shard reruns
+    sprintf(fname, "%s.progress", prefix);
+    FILE* fp = fopen(fname, "r");
+    char lines[64][128];
+    int num_lines = 0;
+    while (fp && num_lines < 64 && fgets(lines[num_lines], 128, fp)) num_lines++;
+    if (fp) fclose(fp);
+    fp = fopen(fname, "w");
+    for (int i = 0; fp && i < num_lines - 1; i++) fputs(lines[i], fp);
+    if (fp) fclose(fp);
+
+    computed = shard_generate(&job, 1);
+    sprintf(fname, "%s_c.hex", prefix);
+    loaded = load_from_hex_file(fname, C_file, M * N, 32);
+    sprintf(msg, "Sharded GEMM resume (1 shard lost, seed=%d)", seed);
+    TEST_ASSERT(computed == 1 && loaded == M * N &&
+                memcmp(C_file, C_ref, M * N * sizeof(int32_t)) == 0, msg);
+
+    free(A);
+    free(B);
+    free(C_ref);
+    free(C_file);
+}
+
+//=============================================================================
+// EMULATOR TEST (command stream → register map → DMA → cluster)
+//=============================================================================
+
+#define EMU_TEST_MEM_SIZE (4u << 20)
+
+void test_emu(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("NPU Emulator Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    static const int shapes[][3] = {
+        { SUBARRAY_ROWS, SUBARRAY_COLS, 1 },  // Single tile
+        { 128, 64, 1 },                       // GEMV, M/K tiling
+        { 600, 100, 1 },                      // Partial M/K tiles, >16 M tiles
+        { 96, 40, 3 },                        // Small batch (N>1)
+    };
+    int num_shapes = (int)(sizeof(shapes) / sizeof(shapes[0]));
+
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, EMU_TEST_MEM_SIZE);
+    npu_emu_init(&emu, &mem);
+
+    for (int i = 0; i < num_shapes; i++) {
+        int M = shapes[i][0], K = shapes[i][1], N = shapes[i][2];
+        uint32_t w_addr = 0x00000;
+        uint32_t x_addr = 0x80000;
+        uint32_t y_addr = 0x90000;
+
+        int8_t*  W     = (int8_t*)calloc(M * K, sizeof(int8_t));
+        int8_t*  X     = (int8_t*)calloc(K * N, sizeof(int8_t));
+        int32_t* Y_ref = (int32_t*)calloc(M * N, sizeof(int32_t));
+        int32_t* Y_emu = (int32_t*)calloc(M * N, sizeof(int32_t));
+
+        generate_random_i8(W, M * K, seed + i);
+        generate_random_i8(X, K * N, seed + i + 1000);
+        ref_gemm_tiled(W, X, Y_ref, M, K, N);
+
+        npu_mem_write(&mem, w_addr, W, M * K);
+        npu_mem_write(&mem, x_addr, X, K * N);
+
+        NpuCmd cmds[16];
+        int n = npu_cmd_gemm(cmds, w_addr, x_addr, y_addr, M, K, N);
+        int ret = npu_emu_run(&emu, cmds, n);
+        npu_mem_read(&mem, y_addr, Y_emu, M * N * sizeof(int32_t));
+
+        char msg[128];
+        sprintf(msg, "Emulator vs tiled ref (%dx%dx%d, %llu cycles)", M, K, N,
+                (unsigned long long)emu.stats.last_job_cycles);
+        TEST_ASSERT(ret == 0 && memcmp(Y_emu, Y_ref, M * N * sizeof(int32_t)) == 0, msg);
+
+        free(W);
+        free(X);
+        free(Y_ref);
+        free(Y_emu);
+    }
+
+    // Out-of-range output must raise STATUS.error, not corrupt memory
+    NpuCmd cmds[16];
+    int n = npu_cmd_gemm(cmds, 0, 0, EMU_TEST_MEM_SIZE - 4, 64, 8, 1);
+    int ret = npu_emu_run(&emu, cmds, n);
+    TEST_ASSERT(ret != 0 && (npu_emu_read_reg(&emu, NPU_REG_STATUS) & NPU_STATUS_ERROR),
+                "Emulator flags out-of-range DMA");
+
+    npu_emu_print_stats(&emu, "test_emu");
+    npu_mem_free(&mem);
+}
+
+//=============================================================================
+// EMULATOR DECODER BENCHMARK (LLaMA-style decode step, GEMV per projection)
+//=============================================================================
+
+// One decode step: per layer Q, K, V, O (hidden x hidden), gate, up
+// (inter x hidden) and down (hidden x inter). Weights of one layer are reused
+// by every layer (timing only depends on shapes); activations are random INT8.
+// fused: Q/K/V and gate/up run as horizontally fused jobs (one input load);
+// their weights are already adjacent in the layout, so no repacking is needed.
+void bench_emu_decoder(int hidden, int inter, int layers, int fused, const char* label) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Emulator Decode Benchmark: %s%s (hidden=%d, inter=%d, layers=%d)\n",
+           label, fused ? " fused" : "", hidden, inter, layers);
+    printf("=============================================================\n");
+
+    uint64_t w_attn  = (uint64_t)hidden * hidden;
+    uint64_t w_mlp   = (uint64_t)inter * hidden;
+    uint64_t w_total = 4 * w_attn + 3 * w_mlp;
+
+    // Layout: [Wq Wk Wv Wo Wgate Wup Wdown][x][h][y0 y1 y2]
+    uint64_t x_addr = w_total;
+    uint64_t h_addr = x_addr + inter;
+    uint64_t y_addr = (h_addr + inter + 3) & ~3ull;
+    uint64_t y_size = (uint64_t)inter * sizeof(int32_t);
+
+    NpuMem mem;
+    NpuEmu emu;
+    if (npu_mem_init(&mem, y_addr + 3 * y_size) != 0) {
+        printf("  ERROR: Cannot allocate emulator memory\n");
+        return;
+    }
+    npu_emu_init(&emu, &mem);
+
+    for (uint64_t i = 0; i < w_total + 2 * (uint64_t)inter; i++)
+        mem.data[i] = (uint8_t)generate_random_i8_at(7, (int64_t)i);
+
+    struct { uint64_t w; int M, K; uint64_t x; } proj[7] = {
+        { 0,                       hidden, hidden, x_addr },  // Q
+        { w_attn,                  hidden, hidden, x_addr },  // K
+        { 2 * w_attn,              hidden, hidden, x_addr },  // V
+        { 3 * w_attn,              hidden, hidden, x_addr },  // O
+        { 4 * w_attn,              inter,  hidden, x_addr },  // gate
+        { 4 * w_attn + w_mlp,      inter,  hidden, x_addr },  // up
+        { 4 * w_attn + 2 * w_mlp,  hidden, inter,  h_addr },  // down
+    };
+
+    NpuCmd cmds[7 * 8 + 2 * 17];
+    int n = 0;
+    if (fused) {
+        uint32_t ys[3] = { (uint32_t)y_addr, (uint32_t)(y_addr + y_size),
+                           (uint32_t)(y_addr + 2 * y_size) };
+        int qkv_m[3] = { hidden, hidden, hidden };
+        int mlp_m[2] = { inter, inter };
+        n += npu_cmd_gemm_fused(&cmds[n], (uint32_t)proj[0].w, (uint32_t)x_addr,
+                                ys, qkv_m, 3, hidden, 1);
+        n += npu_cmd_gemm(&cmds[n], (uint32_t)proj[3].w, (uint32_t)x_addr,
+                          (uint32_t)y_addr, hidden, hidden, 1);
+        n += npu_cmd_gemm_fused(&cmds[n], (uint32_t)proj[4].w, (uint32_t)x_addr,
+                                ys, mlp_m, 2, hidden, 1);
+        n += npu_cmd_gemm(&cmds[n], (uint32_t)proj[6].w, (uint32_t)h_addr,
+                          (uint32_t)y_addr, hidden, inter, 1);
+    } else {
+        for (int p = 0; p < 7; p++)
+            n += npu_cmd_gemm(&cmds[n], (uint32_t)proj[p].w, (uint32_t)proj[p].x,
+                              (uint32_t)y_addr, proj[p].M, proj[p].K, 1);
+    }
+
+    clock_t t0 = clock();
+    int ret = 0;
+    for (int l = 0; l < layers && ret == 0; l++)
+        ret = npu_emu_run(&emu, cmds, n);
+    double wall_ms = 1000.0 * (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+    double hw_ms = (double)emu.stats.cycles / (EMU_CLOCK_MHZ * 1000.0);
+    printf("  Emulation wall time : %.1f ms\n", wall_ms);
+    printf("  Modelled HW time    : %.3f ms/token  (%.1f tokens/s)\n",
+           hw_ms, hw_ms > 0 ? 1000.0 / hw_ms : 0.0);
+    npu_emu_print_stats(&emu, label);
+
+    npu_mem_free(&mem);
+}
+
+//=============================================================================
+// FUSED GEMV TEST (QKV / gate-up: one input load, scattered outputs)
+//=============================================================================
+
+void test_gemv_fused(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Fused GEMV Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    static const struct { int num_segs; int seg_m[NPU_FUSE_MAX_SEGS]; int K; } cases[] = {
+        { 3, { 128, 128, 128 },  96 },   // QKV
+        { 3, { 128,  40,  40 }, 100 },   // GQA-style: K/V narrower than Q
+        { 2, { 344, 344 },       64 },   // gate/up, segments straddle tiles
+    };
+    int num_cases = (int)(sizeof(cases) / sizeof(cases[0]));
+
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, EMU_TEST_MEM_SIZE);
+    npu_emu_init(&emu, &mem);
+
+    for (int i = 0; i < num_cases; i++) {
+        int S = cases[i].num_segs, K = cases[i].K, M = 0;
+        for (int s = 0; s < S; s++) M += cases[i].seg_m[s];
+
+        int8_t* W = (int8_t*)calloc(M * K, sizeof(int8_t));
+        int8_t* x = (int8_t*)calloc(K, sizeof(int8_t));
+        int32_t* y_ref[NPU_FUSE_MAX_SEGS];
+        int32_t* y_sep = (int32_t*)calloc(M, sizeof(int32_t));
+        int32_t* y_emu = (int32_t*)calloc(M, sizeof(int32_t));
+        for (int s = 0; s < S; s++)
+            y_ref[s] = (int32_t*)calloc(cases[i].seg_m[s], sizeof(int32_t));
+
+        generate_random_i8(W, M * K, seed + i);
+        generate_random_i8(x, K, seed + i + 1000);
+
+        // Fused reference vs one ref_gemv_tiled per segment
+        ref_gemv_fused(x, W, y_ref, cases[i].seg_m, S, K);
+        int row = 0, ref_ok = 1;
+        for (int s = 0; s < S; s++) {
+            ref_gemv_tiled(x, W + row * K, y_sep, K, cases[i].seg_m[s]);
+            ref_ok &= (memcmp(y_sep, y_ref[s], cases[i].seg_m[s] * sizeof(int32_t)) == 0);
+            row += cases[i].seg_m[s];
+        }
+
+        // Emulator: one fused job, outputs at separate (non-adjacent) addresses
+        uint32_t w_addr = 0x00000, x_addr = 0x80000;
+        uint32_t y_addrs[NPU_FUSE_MAX_SEGS];
+        for (int s = 0; s < S; s++)
+            y_addrs[s] = 0x90000 + s * 0x4000;
+        npu_mem_write(&mem, w_addr, W, M * K);
+        npu_mem_write(&mem, x_addr, x, K);
+
+        NpuCmd cmds[24];
+        int n = npu_cmd_gemm_fused(cmds, w_addr, x_addr, y_addrs, cases[i].seg_m, S, K, 1);
+        uint64_t bytes_before = emu.stats.dma_bytes;
+        int ret = npu_emu_run(&emu, cmds, n);
+        uint64_t fused_cycles = emu.stats.last_job_cycles;
+        uint64_t fused_bytes  = emu.stats.dma_bytes - bytes_before;
+
+        int emu_ok = (ret == 0);
+        for (int s = 0; s < S; s++) {
+            npu_mem_read(&mem, y_addrs[s], y_emu, cases[i].seg_m[s] * sizeof(int32_t));
+            emu_ok &= (memcmp(y_emu, y_ref[s], cases[i].seg_m[s] * sizeof(int32_t)) == 0);
+        }
+
+        // Same work as separate jobs (after the fused job FUSE_CNT is back to 0)
+        uint64_t sep_cycles = 0, sep_bytes = 0;
+        row = 0;
+        for (int s = 0; s < S; s++) {
+            bytes_before = emu.stats.dma_bytes;
+            n = npu_cmd_gemm(cmds, w_addr + row * K, x_addr, y_addrs[s],
+                             cases[i].seg_m[s], K, 1);
+            ret |= npu_emu_run(&emu, cmds, n);
+            sep_cycles += emu.stats.last_job_cycles;
+            sep_bytes  += emu.stats.dma_bytes - bytes_before;
+            row += cases[i].seg_m[s];
+        }
+
+        char msg[160];
+        sprintf(msg, "Fused ref == per-segment GEMV (%d segs, M=%d, K=%d)", S, M, K);
+        TEST_ASSERT(ref_ok, msg);
+        sprintf(msg, "Fused emulator job (%llu vs %llu cycles, %llu vs %llu bytes)",
+                (unsigned long long)fused_cycles, (unsigned long long)sep_cycles,
+                (unsigned long long)fused_bytes, (unsigned long long)sep_bytes);
+        TEST_ASSERT(emu_ok && ret == 0 && fused_cycles < sep_cycles &&
+                    fused_bytes == sep_bytes - (uint64_t)(S - 1) * K, msg);
+
+        for (int s = 0; s < S; s++) free(y_ref[s]);
+        free(W);
+        free(x);
+        free(y_sep);
+        free(y_emu);
+    }
+
+    npu_mem_free(&mem);
+}
+
+//=============================================================================
+// LAYER CHAINING TEST (requantised outputs → on-chip input buffer)
+//=============================================================================
+
+#define CHAIN_LAYERS 4
+
+// MLP stack x → L0 → L1 → L2 → L3 run twice on the emulator:
+//   chained:    CONFIG.chain_out/chain_in, only the last layer writes DRAM
+//   round trip: every layer writes INT32, host requantises and writes X back
+// Both must match ref_gemv_tiled + ref_requant layer by layer.
+void test_layer_chain(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Layer Chaining Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    static const int dims[CHAIN_LAYERS + 1] = { 64, 96, 256, 128, 40 };
+    static const struct { int16_t scale; int shift; int relu; } rq[CHAIN_LAYERS] = {
+        { 5, 12, 1 }, { 3, 11, 1 }, { -7, 13, 0 }, { 1, 0, 0 },  // last unused
+    };
+
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, EMU_TEST_MEM_SIZE);
+    npu_emu_init(&emu, &mem);
+
+    // Weights back to back, then x, then y (int32)
+    uint32_t w_addr[CHAIN_LAYERS];
+    uint32_t addr = 0;
+    int8_t* W[CHAIN_LAYERS];
+    for (int l = 0; l < CHAIN_LAYERS; l++) {
+        W[l] = (int8_t*)calloc(dims[l + 1] * dims[l], sizeof(int8_t));
+        generate_random_i8(W[l], dims[l + 1] * dims[l], seed + l);
+        w_addr[l] = addr;
+        npu_mem_write(&mem, addr, W[l], dims[l + 1] * dims[l]);
+        addr += (dims[l + 1] * dims[l] + 63) & ~63;
+    }
+    uint32_t x_addr = addr;
+    uint32_t y_addr = addr + 1024;
+
+    // Reference
+    int8_t  act[256];
+    int32_t acc[256];
+    generate_random_i8(act, dims[0], seed + 100);
+    npu_mem_write(&mem, x_addr, act, dims[0]);
+    for (int l = 0; l < CHAIN_LAYERS; l++) {
+        ref_gemv_tiled(act, W[l], acc, dims[l], dims[l + 1]);
+        if (l < CHAIN_LAYERS - 1)
+            ref_requant(acc, act, dims[l + 1], rq[l].scale, rq[l].shift, rq[l].relu);
+    }
+
+    // Chained run
+    NpuCmd cmds[CHAIN_LAYERS * 10];
+    int n = 0;
+    for (int l = 0; l < CHAIN_LAYERS; l++) {
+        uint32_t cfg = (l > 0 ? NPU_CFG_CHAIN_IN : 0);
+        if (l < CHAIN_LAYERS - 1)
+            cfg |= NPU_CFG_CHAIN_OUT | NPU_CFG_RQ(rq[l].scale, rq[l].shift, rq[l].relu);
+        cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CONFIG, cfg };
+        n += npu_cmd_gemm(&cmds[n], w_addr[l], x_addr, y_addr, dims[l + 1], dims[l], 1);
+    }
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CONFIG, 0 };
+
+    NpuEmuStats before = emu.stats;
+    int ret = npu_emu_run(&emu, cmds, n);
+    uint64_t chain_cycles = emu.stats.cycles - before.cycles;
+    uint64_t chain_bytes  = emu.stats.dma_bytes - before.dma_bytes;
+
+    int32_t y_emu[256];
+    npu_mem_read(&mem, y_addr, y_emu, dims[CHAIN_LAYERS] * sizeof(int32_t));
+    int chain_ok = (ret == 0 &&
+                    memcmp(y_emu, acc, dims[CHAIN_LAYERS] * sizeof(int32_t)) == 0);
+
+    // Host round trip: DMA out INT32, requantise on the host, DMA in INT8
+    int8_t x[256];
+    generate_random_i8(x, dims[0], seed + 100);
+    npu_mem_write(&mem, x_addr, x, dims[0]);
+    before = emu.stats;
+    for (int l = 0; l < CHAIN_LAYERS && ret == 0; l++) {
+        n = npu_cmd_gemm(cmds, w_addr[l], x_addr, y_addr, dims[l + 1], dims[l], 1);
+        ret = npu_emu_run(&emu, cmds, n);
+        npu_mem_read(&mem, y_addr, y_emu, dims[l + 1] * sizeof(int32_t));
+        if (l < CHAIN_LAYERS - 1) {
+            ref_requant(y_emu, x, dims[l + 1], rq[l].scale, rq[l].shift, rq[l].relu);
+            npu_mem_write(&mem, x_addr, x, dims[l + 1]);
+        }
+    }
+    uint64_t trip_cycles = emu.stats.cycles - before.cycles;
+    uint64_t trip_bytes  = emu.stats.dma_bytes - before.dma_bytes;
+    int trip_ok = (ret == 0 &&
+                   memcmp(y_emu, acc, dims[CHAIN_LAYERS] * sizeof(int32_t)) == 0);
+
+    char msg[160];
+    sprintf(msg, "Chained %d-layer MLP matches reference (%llu cycles, %llu DMA bytes)",
+            CHAIN_LAYERS, (unsigned long long)chain_cycles, (unsigned long long)chain_bytes);
+    TEST_ASSERT(chain_ok, msg);
+    sprintf(msg, "Host round trip matches and moves more data (%llu cycles, %llu bytes)",
+            (unsigned long long)trip_cycles, (unsigned long long)trip_bytes);
+    TEST_ASSERT(trip_ok && trip_bytes > chain_bytes && trip_cycles > chain_cycles, msg);
+
+    // chain_in without a preceding chain_out of matching size is an error
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_CHAIN_IN);
+    n = npu_cmd_gemm(cmds, w_addr[0], x_addr, y_addr, dims[1], dims[0], 1);
+    ret = npu_emu_run(&emu, cmds, n);
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+    TEST_ASSERT(ret != 0, "chain_in with mismatched input buffer length flags error");
+
+    for (int l = 0; l < CHAIN_LAYERS; l++) free(W[l]);
+    npu_mem_free(&mem);
+}
+
+//=============================================================================
+// WEIGHT STREAMING TEST (batch-1 GEMV, weight buffer bypass)
+//=============================================================================
+
+void test_weight_stream(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Weight Streaming Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    static const int shapes[][2] = {
+        { 128, 64 },
+        { 600, 100 },
+        { LLAMA_HIDDEN_DIM, LLAMA_HIDDEN_DIM },   // LLaMA-7B Q/K/V/O
+    };
+    int num_shapes = (int)(sizeof(shapes) / sizeof(shapes[0]));
+
+    uint64_t mem_size = (uint64_t)LLAMA_HIDDEN_DIM * LLAMA_HIDDEN_DIM + (1u << 20);
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, mem_size);
+    npu_emu_init(&emu, &mem);
+
+    for (int i = 0; i < num_shapes; i++) {
+        int M = shapes[i][0], K = shapes[i][1];
+        uint32_t x_addr = (uint32_t)((uint64_t)M * K);
+        uint32_t y_addr = (x_addr + K + 63) & ~63u;
+
+        int8_t*  W     = (int8_t*)calloc((size_t)M * K, sizeof(int8_t));
+        int8_t*  x     = (int8_t*)calloc(K, sizeof(int8_t));
+        int32_t* Y_ref = (int32_t*)calloc(M, sizeof(int32_t));
+        int32_t* Y_emu = (int32_t*)calloc(M, sizeof(int32_t));
+
+        generate_random_i8(W, M * K, seed + i);
+        generate_random_i8(x, K, seed + i + 1000);
+        ref_gemm_fast(W, x, Y_ref, M, K, 1);
+        npu_mem_write(&mem, 0, W, (uint64_t)M * K);
+        npu_mem_write(&mem, x_addr, x, K);
+
+        NpuCmd cmds[16];
+        int n = npu_cmd_gemm(cmds, 0, x_addr, y_addr, M, K, 1);
+        int ret = npu_emu_run(&emu, cmds, n);
+        uint64_t staged = emu.stats.last_job_cycles;
+
+        npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_WSTREAM);
+        ret |= npu_emu_run(&emu, cmds, n);
+        npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+        uint64_t streamed = emu.stats.last_job_cycles;
+        npu_mem_read(&mem, y_addr, Y_emu, M * sizeof(int32_t));
+
+        // Line rate: weight bytes / DMA bytes-per-cycle over the whole job
+        double line_rate = 100.0 * ((double)M * K / EMU_DMA_BYTES_PER_CYCLE) / streamed;
+
+        char msg[160];
+        sprintf(msg, "Streamed GEMV %dx%d (%llu vs %llu staged cycles, %.1f%% of line rate)",
+                M, K, (unsigned long long)streamed, (unsigned long long)staged, line_rate);
+        TEST_ASSERT(ret == 0 && streamed < staged &&
+                    memcmp(Y_emu, Y_ref, M * sizeof(int32_t)) == 0, msg);
+
+        free(W);
+        free(x);
+        free(Y_ref);
+        free(Y_emu);
+    }
+
+    // Streaming is batch-1 only: weights would be re-streamed per column
+    NpuCmd cmds[16];
+    int n = npu_cmd_gemm(cmds, 0, 0x1000, 0x2000, 32, 8, 3);
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_WSTREAM);
+    int ret = npu_emu_run(&emu, cmds, n);
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+    TEST_ASSERT(ret != 0, "Weight streaming rejects N > 1");
+
+    npu_mem_free(&mem);
+}
+
+//=============================================================================
+// WEIGHT PREFETCH TEST (job queue lookahead)
+//=============================================================================
+
+#define PREFETCH_JOBS 6
+
+// The same layer sequence three ways: one start per job, queued without
+// prefetch (must cost the same), queued with prefetch (first-fill bubble
+// between layers hidden). Outputs must match the reference in all runs.
+void test_weight_prefetch(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Weight Prefetch Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    static const int shapes[PREFETCH_JOBS][3] = {   // M, K, N
+        { 256, 256, 4 }, { 256, 256, 4 }, { 688, 256, 1 },
+        { 256, 688, 1 }, { 100,  60, 2 }, { 512, 512, 4 },
+    };
+
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, EMU_TEST_MEM_SIZE);
+    npu_emu_init(&emu, &mem);
+
+    uint32_t w_addr[PREFETCH_JOBS], x_addr[PREFETCH_JOBS], y_addr[PREFETCH_JOBS];
+    int32_t* Y_ref[PREFETCH_JOBS];
+    uint32_t top = 0;
+    for (int j = 0; j < PREFETCH_JOBS; j++) {
+        int M = shapes[j][0], K = shapes[j][1], N = shapes[j][2];
+        int8_t* W = (int8_t*)calloc((size_t)M * K, sizeof(int8_t));
+        int8_t* X = (int8_t*)calloc((size_t)K * N, sizeof(int8_t));
+        Y_ref[j]  = (int32_t*)calloc((size_t)M * N, sizeof(int32_t));
+
+        generate_random_i8(W, M * K, seed + j);
+        generate_random_i8(X, K * N, seed + j + 1000);
+        ref_gemm_fast(W, X, Y_ref[j], M, K, N);
+
+        w_addr[j] = top;  top = (top + M * K + 63) & ~63u;
+        x_addr[j] = top;  top = (top + K * N + 63) & ~63u;
+        y_addr[j] = top;  top = (top + M * N * 4 + 63) & ~63u;
+        npu_mem_write(&mem, w_addr[j], W, (uint64_t)M * K);
+        npu_mem_write(&mem, x_addr[j], X, (uint64_t)K * N);
+        free(W);
+        free(X);
+    }
+
+    uint64_t run_cycles[3];
+    int      run_ok[3];
+    NpuCmd   cmds[PREFETCH_JOBS * 8 + 2];
+
+    for (int r = 0; r < 3; r++) {
+        uint64_t before = emu.stats.cycles;
+        int ret = 0, n = 0;
+
+        if (r == 0) {
+            for (int j = 0; j < PREFETCH_JOBS; j++) {
+                n = npu_cmd_gemm(cmds, w_addr[j], x_addr[j], y_addr[j],
+                                 shapes[j][0], shapes[j][1], shapes[j][2]);
+                ret |= npu_emu_run(&emu, cmds, n);
+            }
+        } else {
+            npu_emu_write_reg(&emu, NPU_REG_QUEUE, (r == 2) ? NPU_QUEUE_PREFETCH : 0);
+            for (int j = 0; j < PREFETCH_JOBS; j++)
+                n += npu_cmd_enqueue_gemm(cmds + n, w_addr[j], x_addr[j], y_addr[j],
+                                          shapes[j][0], shapes[j][1], shapes[j][2]);
+            ret |= npu_emu_run(&emu, cmds, n);
+            ret |= (NPU_QUEUE_COUNT(npu_emu_read_reg(&emu, NPU_REG_QUEUE)) != PREFETCH_JOBS);
+            npu_emu_write_reg(&emu, NPU_REG_CTRL, NPU_CTRL_START);
+            ret |= (npu_emu_read_reg(&emu, NPU_REG_STATUS) & NPU_STATUS_ERROR) != 0;
+            ret |= (NPU_QUEUE_COUNT(npu_emu_read_reg(&emu, NPU_REG_QUEUE)) != 0);
+        }
+
+        run_ok[r] = (ret == 0);
+        for (int j = 0; j < PREFETCH_JOBS; j++) {
+            uint64_t bytes = (uint64_t)shapes[j][0] * shapes[j][2] * sizeof(int32_t);
+            run_ok[r] &= (memcmp(mem.data + y_addr[j], Y_ref[j], bytes) == 0);
+            memset(mem.data + y_addr[j], 0, bytes);
+        }
+        run_cycles[r] = emu.stats.cycles - before;
+    }
+    npu_emu_write_reg(&emu, NPU_REG_QUEUE, 0);
+
+    char msg[160];
+    sprintf(msg, "Queued jobs, no prefetch (%llu cycles, same as %llu one-by-one)",
+            (unsigned long long)run_cycles[1], (unsigned long long)run_cycles[0]);
+    TEST_ASSERT(run_ok[0] && run_ok[1] && run_cycles[1] == run_cycles[0], msg);
+    sprintf(msg, "Queued jobs with prefetch (%llu cycles, %llu hidden per layer boundary)",
+            (unsigned long long)run_cycles[2],
+            (unsigned long long)(run_cycles[1] - run_cycles[2]) / (PREFETCH_JOBS - 1));
+    TEST_ASSERT(run_ok[2] && run_cycles[2] < run_cycles[1] &&
+                emu.stats.prefetch_cycles == run_cycles[1] - run_cycles[2], msg);
+
+    // Enqueue past the queue depth: dropped with STATUS.error
+    for (int j = 0; j <= EMU_JOBQ_DEPTH; j++)
+        npu_emu_write_reg(&emu, NPU_REG_CTRL, NPU_CTRL_ENQUEUE);
+    int overflow = (npu_emu_read_reg(&emu, NPU_REG_STATUS) & NPU_STATUS_ERROR) != 0;
+    int count    = NPU_QUEUE_COUNT(npu_emu_read_reg(&emu, NPU_REG_QUEUE));
+    npu_emu_write_reg(&emu, NPU_REG_CTRL, NPU_CTRL_CLEAR);
+    count |= NPU_QUEUE_COUNT(npu_emu_read_reg(&emu, NPU_REG_QUEUE)) << 8;
+    TEST_ASSERT(overflow && count == EMU_JOBQ_DEPTH, "Job queue overflow flags error, clear flushes");
+
+    for (int j = 0; j < PREFETCH_JOBS; j++)
+        free(Y_ref[j]);
+    npu_mem_free(&mem);
+}
+
+//=============================================================================
+// PAGED KV-CACHE TEST (block-table walker in the DMA)
+//=============================================================================
+
+#define KV_HEAD_DIM     128
+#define KV_TOKENS       100    // Last block partially filled
+#define KV_BLOCK_SHIFT  4      // 16 tokens per block
+#define KV_POOL_BLOCKS  32
+
+// One attention head over a KV cache scattered across a block pool:
+//   scores = K[T][D] * q        (CONFIG.kv_w: W rows are tokens)
+//   ctx    = p[1][T] * V[T][D]  (CONFIG.kv_x: X rows are tokens)
+// Paged jobs must match the contiguous reference and cost only the table
+// fetch over the same job on a contiguous copy (no host gather needed).
+void test_kv_paged(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Paged KV-Cache Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    int D = KV_HEAD_DIM, T = KV_TOKENS;
+    int block_rows  = 1 << KV_BLOCK_SHIFT;
+    int blocks      = (T + block_rows - 1) / block_rows;
+    int block_bytes = block_rows * D;
+
+    // Memory layout: K pool | V pool | tables | q, p | contiguous K, V | Y
+    uint32_t k_pool  = 0;
+    uint32_t v_pool  = k_pool + KV_POOL_BLOCKS * block_bytes;
+    uint32_t k_table = v_pool + KV_POOL_BLOCKS * block_bytes;
+    uint32_t v_table = k_table + 0x100;
+    uint32_t q_addr  = v_table + 0x100;
+    uint32_t p_addr  = q_addr + 0x100;
+    uint32_t k_cont  = p_addr + 0x100;
+    uint32_t v_cont  = k_cont + T * D;
+    uint32_t y_addr  = (v_cont + T * D + 63) & ~63u;
+
+    int8_t*  Kc    = (int8_t*)calloc((size_t)T * D, sizeof(int8_t));
+    int8_t*  Vc    = (int8_t*)calloc((size_t)T * D, sizeof(int8_t));
+    int8_t*  q     = (int8_t*)calloc(D, sizeof(int8_t));
+    int8_t*  p     = (int8_t*)calloc(T, sizeof(int8_t));
+    int32_t* s_ref = (int32_t*)calloc(T, sizeof(int32_t));
+    int32_t* c_ref = (int32_t*)calloc(D, sizeof(int32_t));
+    int32_t* y_emu = (int32_t*)calloc(T > D ? T : D, sizeof(int32_t));
+
+    generate_random_i8(Kc, T * D, seed);
+    generate_random_i8(Vc, T * D, seed + 1);
+    generate_random_i8(q, D, seed + 2);
+    generate_random_i8(p, T, seed + 3);
+    ref_gemm_fast(Kc, q, s_ref, T, D, 1);
+    ref_gemm_fast(p, Vc, c_ref, 1, T, D);
+
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, EMU_TEST_MEM_SIZE);
+    npu_emu_init(&emu, &mem);
+
+    // Scatter logical blocks over the pool (K and V use different pages)
+    srand(seed);
+    int perm[KV_POOL_BLOCKS];
+    for (int b = 0; b < KV_POOL_BLOCKS; b++) perm[b] = b;
+    for (int b = KV_POOL_BLOCKS - 1; b > 0; b--) {
+        int j = rand() % (b + 1);
+        int t = perm[b]; perm[b] = perm[j]; perm[j] = t;
+    }
+    for (int b = 0; b < blocks; b++) {
+        int rows = (T - b * block_rows < block_rows) ? T - b * block_rows : block_rows;
+        uint32_t k_phys = k_pool + (uint32_t)perm[b] * block_bytes;
+        uint32_t v_phys = v_pool + (uint32_t)perm[KV_POOL_BLOCKS - 1 - b] * block_bytes;
+        npu_mem_write(&mem, k_table + 4 * b, &k_phys, 4);
+        npu_mem_write(&mem, v_table + 4 * b, &v_phys, 4);
+        npu_mem_write(&mem, k_phys, Kc + b * block_bytes, (uint64_t)rows * D);
+        npu_mem_write(&mem, v_phys, Vc + b * block_bytes, (uint64_t)rows * D);
+    }
+    npu_mem_write(&mem, q_addr, q, D);
+    npu_mem_write(&mem, p_addr, p, T);
+    npu_mem_write(&mem, k_cont, Kc, (uint64_t)T * D);
+    npu_mem_write(&mem, v_cont, Vc, (uint64_t)T * D);
+
+    NpuCmd cmds[16];
+    int n, ret;
+    uint64_t paged, contig;
+    char msg[160];
+
+    // Scores: W = K cache rows
+    n = npu_cmd_gemm(cmds, k_cont, q_addr, y_addr, T, D, 1);
+    ret = npu_emu_run(&emu, cmds, n);
+    contig = emu.stats.last_job_cycles;
+
+    npu_emu_write_reg(&emu, NPU_REG_KV_TABLE, k_table);
+    npu_emu_write_reg(&emu, NPU_REG_KV_BLOCK, KV_BLOCK_SHIFT);
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG,   NPU_CFG_KV_W);
+    n = npu_cmd_gemm(cmds, 0, q_addr, y_addr, T, D, 1);
+    ret |= npu_emu_run(&emu, cmds, n);
+    paged = emu.stats.last_job_cycles;
+    npu_mem_read(&mem, y_addr, y_emu, T * sizeof(int32_t));
+
+    sprintf(msg, "Paged K scores %dx%d, %d blocks (%llu vs %llu contiguous cycles)",
+            T, D, blocks, (unsigned long long)paged, (unsigned long long)contig);
+    TEST_ASSERT(ret == 0 && memcmp(y_emu, s_ref, T * sizeof(int32_t)) == 0 &&
+                paged - contig <= EMU_DMA_SETUP_CYCLES + (uint64_t)blocks, msg);
+
+    // Context: X = V cache rows
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+    n = npu_cmd_gemm(cmds, p_addr, v_cont, y_addr, 1, T, D);
+    ret = npu_emu_run(&emu, cmds, n);
+    contig = emu.stats.last_job_cycles;
+
+    npu_emu_write_reg(&emu, NPU_REG_KV_TABLE, v_table);
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG,   NPU_CFG_KV_X);
+    n = npu_cmd_gemm(cmds, p_addr, 0, y_addr, 1, T, D);
+    ret |= npu_emu_run(&emu, cmds, n);
+    paged = emu.stats.last_job_cycles;
+    npu_mem_read(&mem, y_addr, y_emu, D * sizeof(int32_t));
+
+    sprintf(msg, "Paged V context 1x%dx%d, %d blocks (%llu vs %llu contiguous cycles)",
+            T, D, blocks, (unsigned long long)paged, (unsigned long long)contig);
+    TEST_ASSERT(ret == 0 && memcmp(y_emu, c_ref, D * sizeof(int32_t)) == 0 &&
+                paged - contig <= EMU_DMA_SETUP_CYCLES + (uint64_t)blocks, msg);
+
+    // Table entry pointing outside memory, and both operands paged
+    uint32_t bad = (uint32_t)EMU_TEST_MEM_SIZE;
+    npu_mem_write(&mem, v_table + 4 * (blocks - 1), &bad, 4);
+    ret = npu_emu_run(&emu, cmds, n);
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_KV_W | NPU_CFG_KV_X);
+    n = npu_cmd_gemm(cmds, 0, 0, y_addr, T, D, 1);
+    int both = npu_emu_run(&emu, cmds, n);
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+    TEST_ASSERT(ret != 0 && both != 0, "Paged job flags bad table entry / two paged operands");
+
+    free(Kc);
+    free(Vc);
+    free(q);
+    free(p);
+    free(s_ref);
+    free(c_ref);
+    free(y_emu);
+    npu_mem_free(&mem);
+}
+
+//=============================================================================
+// ZERO-COPY DMA TEST (IOMMU TLB + scatter-gather chains)
+//=============================================================================
+
+#define ZC_M         512
+#define ZC_K         512
+#define ZC_POOL      0x100000   // Physical page pool (shuffled)
+#define ZC_POOL_PAGES 512
+#define ZC_IOVA      0x200000   // Device-visible contiguous view
+#define ZC_SG_SLOTS  0x300000   // SG chunks, one per 8 KB slot
+#define ZC_PT        0x3F0000
+#define ZC_DESC      0x3E0000
+
+// The same GEMV with W/X/Y in page-fragmented memory, reached through the
+// IOMMU (contiguous IOVAs over shuffled pages), SG chains (no IOMMU), and
+// both. Reports TLB hit rate and throughput relative to contiguous buffers.
+void test_zero_copy(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Zero-Copy DMA Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    int M = ZC_M, K = ZC_K;
+    uint32_t w_bytes = M * K, x_bytes = K, y_bytes = M * 4;
+
+    int8_t*  W     = (int8_t*)calloc(w_bytes, 1);
+    int8_t*  x     = (int8_t*)calloc(x_bytes, 1);
+    int32_t* Y_ref = (int32_t*)calloc(M, sizeof(int32_t));
+    int32_t* Y_emu = (int32_t*)calloc(M, sizeof(int32_t));
+    generate_random_i8(W, w_bytes, seed);
+    generate_random_i8(x, x_bytes, seed + 1000);
+    ref_gemm_fast(W, x, Y_ref, M, K, 1);
+
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, EMU_TEST_MEM_SIZE);
+    npu_emu_init(&emu, &mem);
+
+    // Contiguous baseline (physical, no translation)
+    npu_mem_write(&mem, 0, W, w_bytes);
+    npu_mem_write(&mem, w_bytes, x, x_bytes);
+    NpuCmd cmds[16];
+    int n = npu_cmd_gemm(cmds, 0, w_bytes, w_bytes + 0x1000, M, K, 1);
+    int ret = npu_emu_run(&emu, cmds, n);
+    uint64_t contig = emu.stats.last_job_cycles;
+
+    // "User" allocation: W | x | Y laid out at one IOVA range, backed by
+    // shuffled physical pages
+    uint32_t x_off = w_bytes, y_off = w_bytes + NPU_PAGE_SIZE;
+    int pages = (int)((y_off + y_bytes + NPU_PAGE_SIZE - 1) / NPU_PAGE_SIZE);
+    uint32_t page_addr[ZC_POOL_PAGES];
+    srand(seed);
+    for (int i = 0; i < ZC_POOL_PAGES; i++) page_addr[i] = ZC_POOL + i * NPU_PAGE_SIZE;
+    for (int i = ZC_POOL_PAGES - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        uint32_t t = page_addr[i]; page_addr[i] = page_addr[j]; page_addr[j] = t;
+    }
+    ret |= npu_iommu_map(&mem, ZC_PT, ZC_IOVA, page_addr, pages);
+    for (uint32_t off = 0; off < w_bytes; off += NPU_PAGE_SIZE)
+        npu_mem_write(&mem, page_addr[off / NPU_PAGE_SIZE], W + off, NPU_PAGE_SIZE);
+    npu_mem_write(&mem, page_addr[x_off / NPU_PAGE_SIZE], x, x_bytes);
+
+    npu_emu_write_reg(&emu, NPU_REG_IOMMU_PT,    ZC_PT);
+    npu_emu_write_reg(&emu, NPU_REG_IOMMU_PAGES, (ZC_IOVA >> NPU_PAGE_SHIFT) + pages);
+    npu_emu_write_reg(&emu, NPU_REG_IOMMU_CTRL,  NPU_IOMMU_EN | NPU_IOMMU_FLUSH);
+
+    //-------------------------------------------------------------------------
+    // IOMMU: contiguous IOVAs over fragmented pages
+    //-------------------------------------------------------------------------
+    uint64_t hits0 = emu.stats.tlb_hits, miss0 = emu.stats.tlb_misses;
+    n = npu_cmd_gemm(cmds, ZC_IOVA, ZC_IOVA + x_off, ZC_IOVA + y_off, M, K, 1);
+    ret |= npu_emu_run(&emu, cmds, n);
+    uint64_t iommu = emu.stats.last_job_cycles;
+    uint64_t hits = emu.stats.tlb_hits - hits0, miss = emu.stats.tlb_misses - miss0;
+    memset(Y_emu, 0xA5, y_bytes);
+    for (uint32_t off = 0; off < y_bytes; off += NPU_PAGE_SIZE)
+        npu_mem_read(&mem, page_addr[(y_off + off) / NPU_PAGE_SIZE], (int8_t*)Y_emu + off,
+                     (y_bytes - off < NPU_PAGE_SIZE) ? y_bytes - off : NPU_PAGE_SIZE);
+
+    char msg[192];
+    double hit_rate = 100.0 * (double)hits / (double)(hits + miss);
+    sprintf(msg, "IOMMU GEMV %dx%d over %d pages (TLB %.1f%% hits, %.1f%% of contiguous throughput)",
+            M, K, pages, hit_rate, 100.0 * (double)contig / (double)iommu);
+    TEST_ASSERT(ret == 0 && memcmp(Y_emu, Y_ref, y_bytes) == 0 &&
+                miss == (uint64_t)pages && hit_rate > 90.0, msg);
+
+    //-------------------------------------------------------------------------
+    // SG chains, IOMMU off: W in uneven chunks, Y split in two
+    //-------------------------------------------------------------------------
+    npu_emu_write_reg(&emu, NPU_REG_IOMMU_CTRL, 0);
+    uint32_t chunk_addr[64], chunk_len[64];
+    int chunks = 0;
+    for (uint32_t off = 0; off < w_bytes; chunks++) {
+        uint32_t len = 4096 + (uint32_t)(rand() % 4) * 1024 + (uint32_t)(rand() % 64);
+        if (len > w_bytes - off) len = w_bytes - off;
+        chunk_addr[chunks] = ZC_SG_SLOTS + chunks * 0x2000 + (uint32_t)(rand() % 16) * 64;
+        chunk_len[chunks]  = len;
+        npu_mem_write(&mem, chunk_addr[chunks], W + off, len);
+        off += len;
+    }
+    uint32_t y_chunk_addr[2] = { ZC_SG_SLOTS + chunks * 0x2000,
+                                 ZC_SG_SLOTS + (chunks + 1) * 0x2000 + 256 };
+    uint32_t y_chunk_len[2]  = { 1000, y_bytes - 1000 };
+    ret  = npu_sg_build(&mem, ZC_DESC, chunk_addr, chunk_len, chunks);
+    ret |= npu_sg_build(&mem, ZC_DESC + 0x1000, y_chunk_addr, y_chunk_len, 2);
+
+    npu_emu_write_reg(&emu, NPU_REG_SG, NPU_SG_W | NPU_SG_Y);
+    uint64_t descs0 = emu.stats.sg_descs;
+    n = npu_cmd_gemm(cmds, ZC_DESC, w_bytes, ZC_DESC + 0x1000, M, K, 1);
+    ret |= npu_emu_run(&emu, cmds, n);
+    uint64_t sg_cycles = emu.stats.last_job_cycles;
+    npu_mem_read(&mem, y_chunk_addr[0], Y_emu, y_chunk_len[0]);
+    npu_mem_read(&mem, y_chunk_addr[1], (int8_t*)Y_emu + y_chunk_len[0], y_chunk_len[1]);
+
+    sprintf(msg, "SG GEMV, W in %d chunks + Y in 2 (%llu descriptors, %.1f%% of contiguous throughput)",
+            chunks, (unsigned long long)(emu.stats.sg_descs - descs0),
+            100.0 * (double)contig / (double)sg_cycles);
+    TEST_ASSERT(ret == 0 && memcmp(Y_emu, Y_ref, y_bytes) == 0 &&
+                emu.stats.sg_descs - descs0 == (uint64_t)chunks + 2, msg);
+
+    // SG + IOMMU: chain of IOVAs; the descriptors are read through the TLB
+    // too (identity-mapped page so the chain links stay valid)
+    uint32_t desc_iova = ZC_DESC + 0x2000;
+    uint32_t iova_addr[2] = { ZC_IOVA, ZC_IOVA + x_off / 2 };
+    uint32_t iova_len[2]  = { x_off / 2, x_off - x_off / 2 };
+    ret  = npu_sg_build(&mem, desc_iova, iova_addr, iova_len, 2);
+    ret |= npu_iommu_map(&mem, ZC_PT, desc_iova, &desc_iova, 1);
+    npu_emu_write_reg(&emu, NPU_REG_IOMMU_PAGES, (desc_iova >> NPU_PAGE_SHIFT) + 1);
+    npu_emu_write_reg(&emu, NPU_REG_IOMMU_CTRL,  NPU_IOMMU_EN | NPU_IOMMU_FLUSH);
+    npu_emu_write_reg(&emu, NPU_REG_SG, NPU_SG_W);
+    memset(Y_emu, 0, y_bytes);
+    n = npu_cmd_gemm(cmds, desc_iova, ZC_IOVA + x_off, ZC_IOVA + y_off, M, K, 1);
+    ret |= npu_emu_run(&emu, cmds, n);
+    for (uint32_t off = 0; off < y_bytes; off += NPU_PAGE_SIZE)
+        npu_mem_read(&mem, page_addr[(y_off + off) / NPU_PAGE_SIZE], (int8_t*)Y_emu + off,
+                     (y_bytes - off < NPU_PAGE_SIZE) ? y_bytes - off : NPU_PAGE_SIZE);
+    TEST_ASSERT(ret == 0 && memcmp(Y_emu, Y_ref, y_bytes) == 0,
+                "SG chain of IOVAs through the IOMMU");
+
+    // Faults: unmapped IOVA, SG chain shorter than the operand
+    npu_emu_write_reg(&emu, NPU_REG_SG, 0);
+    n = npu_cmd_gemm(cmds, ZC_IOVA + pages * NPU_PAGE_SIZE, ZC_IOVA + x_off,
+                     ZC_IOVA + y_off, M, K, 1);
+    int fault = npu_emu_run(&emu, cmds, n);
+    npu_emu_write_reg(&emu, NPU_REG_IOMMU_CTRL, 0);
+    npu_emu_write_reg(&emu, NPU_REG_SG, NPU_SG_W);
+    n = npu_cmd_gemm(cmds, ZC_DESC, w_bytes, w_bytes + 0x1000, M + 32, K, 1);
+    int short_chain = npu_emu_run(&emu, cmds, n);
+    npu_emu_write_reg(&emu, NPU_REG_SG, 0);
+    TEST_ASSERT(fault != 0 && short_chain != 0, "IOMMU fault / short SG chain flag error");
+
+    free(W);
+    free(x);
+    free(Y_ref);
+    free(Y_emu);
+    npu_mem_free(&mem);
+}
+
+//=============================================================================
+// EMBEDDING GATHER TEST (token ids → input buffer, CONFIG.gather)
+//=============================================================================
+
+#define EMBED_HIDDEN  (LLAMA_HIDDEN_DIM / 8)   // 1/8-scale hidden, full vocab
+#define EMBED_TOKENS  8                         // Sequences in the decode batch
+
+// First decode step of a batch: the host gathers embedding rows into X and
+// the Q projection loads it, versus a gather job that fills the input
+// buffer from the token ids and a chain_in projection.
+void test_embed_gather(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Embedding Gather Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    int V = LLAMA_VOCAB, H = EMBED_HIDDEN, T = EMBED_TOKENS;
+    uint64_t table_bytes = (uint64_t)V * H;
+    uint32_t wq_addr  = (uint32_t)table_bytes;
+    uint32_t x_addr   = wq_addr + H * H;
+    uint32_t ids_addr = x_addr + H * T;
+    uint32_t y_addr   = (ids_addr + T * 4 + 63) & ~63u;
+
+    int8_t*  table = (int8_t*)calloc(table_bytes, 1);
+    int8_t*  Wq    = (int8_t*)calloc((size_t)H * H, 1);
+    int8_t*  X     = (int8_t*)calloc((size_t)H * T, 1);
+    int32_t* Y_ref = (int32_t*)calloc((size_t)H * T, sizeof(int32_t));
+    int32_t* Y_emu = (int32_t*)calloc((size_t)H * T, sizeof(int32_t));
+    uint32_t ids[EMBED_TOKENS];
+    generate_random_i8(table, (int)table_bytes, seed);
+    generate_random_i8(Wq, H * H, seed + 1);
+
+    srand(seed);
+    for (int n = 0; n < T; n++)
+        ids[n] = (uint32_t)(rand() % V);
+    ids[T - 1] = ids[0];   // Two sequences on the same token
+
+    // Host gather: X[k][n] = table[ids[n]][k]
+    for (int n = 0; n < T; n++)
+        for (int k = 0; k < H; k++)
+            X[k * T + n] = table[(uint64_t)ids[n] * H + k];
+    ref_gemm_fast(Wq, X, Y_ref, H, H, T);
+
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, table_bytes + (1u << 20));
+    npu_emu_init(&emu, &mem);
+    npu_mem_write(&mem, 0, table, table_bytes);
+    npu_mem_write(&mem, wq_addr, Wq, (uint64_t)H * H);
+
+    // Host path: X written by the host, loaded by the projection
+    NpuCmd cmds[16];
+    npu_mem_write(&mem, x_addr, X, (uint64_t)H * T);
+    int n = npu_cmd_gemm(cmds, wq_addr, x_addr, y_addr, H, H, T);
+    int ret = npu_emu_run(&emu, cmds, n);
+    uint64_t host_cycles = emu.stats.last_job_cycles;
+
+    // Device path: ids only, gather + chain_in projection
+    memset(Y_emu, 0, (size_t)H * T * sizeof(int32_t));
+    npu_mem_write(&mem, y_addr, Y_emu, (uint64_t)H * T * sizeof(int32_t));
+    npu_mem_write(&mem, ids_addr, ids, sizeof(ids));
+    n = npu_cmd_embed_gather(cmds, 0, ids_addr, V, H, T);
+    ret |= npu_emu_run(&emu, cmds, n);
+    uint64_t gather_cycles = emu.stats.last_job_cycles;
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_CHAIN_IN);
+    n = npu_cmd_gemm(cmds, wq_addr, 0, y_addr, H, H, T);
+    ret |= npu_emu_run(&emu, cmds, n);
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+    uint64_t dev_cycles = gather_cycles + emu.stats.last_job_cycles;
+    npu_mem_read(&mem, y_addr, Y_emu, (uint64_t)H * T * sizeof(int32_t));
+
+    char msg[200];
+    sprintf(msg, "Gather %d tokens x %d + Q proj (%llu vs %llu cycles, host writes %d vs %d B)",
+            T, H, (unsigned long long)dev_cycles, (unsigned long long)host_cycles,
+            (int)sizeof(ids), H * T);
+    TEST_ASSERT(ret == 0 &&
+                memcmp(Y_emu, Y_ref, (size_t)H * T * sizeof(int32_t)) == 0, msg);
+
+    // Rejected: id past the vocabulary, batch over the input buffer,
+    // gather combined with another mode
+    int rejected = 0;
+    ids[3] = (uint32_t)V;
+    npu_mem_write(&mem, ids_addr, ids, sizeof(ids));
+    n = npu_cmd_embed_gather(cmds, 0, ids_addr, V, H, T);
+    rejected += npu_emu_run(&emu, cmds, n) != 0;
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+    n = npu_cmd_embed_gather(cmds, 0, ids_addr, V, H, EMU_IBUF_BYTES / H + 1);
+    rejected += npu_emu_run(&emu, cmds, n) != 0;
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+    n = npu_cmd_embed_gather(cmds, 0, ids_addr, V, H, 2);
+    cmds[0].data |= NPU_CFG_CHAIN_OUT;
+    rejected += npu_emu_run(&emu, cmds, n) != 0;
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+    TEST_ASSERT(rejected == 3, "Gather rejects out-of-vocab id, oversize batch, mixed mode");
+
+    npu_mem_free(&mem);
+    free(table);
+    free(Wq);
+    free(X);
+    free(Y_ref);
+    free(Y_emu);
+}
+
+//=============================================================================
+// ROPE TEST (rotary embedding on the Q/K output path, CONFIG.rope)
+//=============================================================================
+
+#define ROPE_HEADS   4
+#define ROPE_TOKENS  4      // Prefill chunk: columns at positions pos0..pos0+3
+#define ROPE_POS0    1000
+
+// Q projection of ROPE_HEADS heads with the rotation on the output path,
+// against GEMM + ref_rope (bit-exact) and a double-precision rotation
+// (error bound), then the chained variant (rotate → requant → input
+// buffer) and the rejected shapes.
+void test_rope(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("RoPE Output Path Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    int M = ROPE_HEADS * LLAMA_HEAD_DIM, K = LLAMA_HIDDEN_DIM / 8, N = ROPE_TOKENS;
+    int head_pairs = LLAMA_HEAD_DIM / 2;
+    uint32_t x_addr     = (uint32_t)(M * K);
+    uint32_t y_addr     = x_addr + K * N;
+    uint32_t table_addr = (y_addr + M * N * 4 + 0xFFF) & ~0xFFFu;
+    int positions = ROPE_POS0 + N;
+
+    int8_t*   W     = (int8_t*)calloc((size_t)M * K, 1);
+    int8_t*   X     = (int8_t*)calloc((size_t)K * N, 1);
+    int32_t*  Y_raw = (int32_t*)calloc((size_t)M * N, sizeof(int32_t));
+    int32_t*  Y_ref = (int32_t*)calloc((size_t)M * N, sizeof(int32_t));
+    int32_t*  Y_emu = (int32_t*)calloc((size_t)M * N, sizeof(int32_t));
+    int8_t*   q_ref = (int8_t*)calloc((size_t)M * N, 1);
+    uint32_t* table = (uint32_t*)calloc((size_t)positions * head_pairs, sizeof(uint32_t));
+    generate_random_i8(W, M * K, seed);
+    generate_random_i8(X, K * N, seed + 1000);
+    ref_gemm_fast(W, X, Y_raw, M, K, N);
+    memcpy(Y_ref, Y_raw, (size_t)M * N * sizeof(int32_t));
+    ref_rope_table(table, positions, LLAMA_HEAD_DIM);
+    ref_rope(Y_ref, M, N, LLAMA_HEAD_DIM, table, ROPE_POS0);
+
+    // Fixed point vs exact rotation: within the cos/sin rounding
+    // ((|x0|+|x1|) * 2^-15) plus the output rounding
+    int bound_ok = 1;
+    double max_err = 0.0;
+    for (int n = 0; n < N; n++) {
+        for (int m = 0; m < M; m += 2) {
+            int i = (m % LLAMA_HEAD_DIM) / 2;
+            double a  = (ROPE_POS0 + n) * pow(ROPE_THETA, -2.0 * i / LLAMA_HEAD_DIM);
+            double x0 = Y_raw[m * N + n], x1 = Y_raw[(m + 1) * N + n];
+            double e0 = fabs(Y_ref[m * N + n]       - (x0 * cos(a) - x1 * sin(a)));
+            double e1 = fabs(Y_ref[(m + 1) * N + n] - (x0 * sin(a) + x1 * cos(a)));
+            double bound = (fabs(x0) + fabs(x1)) / (1 << (ROPE_FRAC_BITS + 1)) + 1.0;
+            bound_ok &= (e0 <= bound && e1 <= bound);
+            if (e0 > max_err) max_err = e0;
+            if (e1 > max_err) max_err = e1;
+        }
+    }
+
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, EMU_TEST_MEM_SIZE);
+    npu_emu_init(&emu, &mem);
+    npu_mem_write(&mem, 0, W, (uint64_t)M * K);
+    npu_mem_write(&mem, x_addr, X, (uint64_t)K * N);
+    npu_mem_write(&mem, table_addr, table, (uint64_t)positions * head_pairs * 4);
+
+    NpuCmd cmds[16];
+    int n = npu_cmd_gemm(cmds, 0, x_addr, y_addr, M, K, N);
+    int ret = npu_emu_run(&emu, cmds, n);
+    uint64_t plain = emu.stats.last_job_cycles;
+
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_ROPE);
+    npu_emu_write_reg(&emu, NPU_REG_ROPE_TABLE, table_addr);
+    npu_emu_write_reg(&emu, NPU_REG_ROPE_POS, ROPE_POS0);
+    ret |= npu_emu_run(&emu, cmds, n);
+    uint64_t rotated = emu.stats.last_job_cycles;
+    npu_mem_read(&mem, y_addr, Y_emu, (uint64_t)M * N * sizeof(int32_t));
+
+    char msg[200];
+    sprintf(msg, "Q proj %dx%dx%d + RoPE @ pos %d (+%llu cycles, host round trip %d B)",
+            M, K, N, ROPE_POS0, (unsigned long long)(rotated - plain), 2 * M * N * 4);
+    TEST_ASSERT(ret == 0 && memcmp(Y_emu, Y_ref, (size_t)M * N * sizeof(int32_t)) == 0, msg);
+    sprintf(msg, "RoPE fixed point vs exact rotation (max error %.2f)", max_err);
+    TEST_ASSERT(bound_ok, msg);
+
+    // Chained: rotate, then requantise into the input buffer
+    int16_t scale = 1;
+    int shift = 10;
+    ref_requant(Y_ref, q_ref, M * N, scale, shift, 0);
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG,
+                      NPU_CFG_ROPE | NPU_CFG_CHAIN_OUT | NPU_CFG_RQ(scale, shift, 0));
+    ret = npu_emu_run(&emu, cmds, n);
+    TEST_ASSERT(ret == 0 && emu.ibuf_len == (uint32_t)(M * N) &&
+                memcmp(emu.ibuf, q_ref, (size_t)M * N) == 0,
+                "Chained RoPE output (rotate before requant)");
+
+    // Rejected: partial head, top-k logits
+    int rejected = 0;
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_ROPE);
+    n = npu_cmd_gemm(cmds, 0, x_addr, y_addr, LLAMA_HEAD_DIM + 32, K, 1);
+    rejected += npu_emu_run(&emu, cmds, n) != 0;
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_ROPE | NPU_CFG_TOPK);
+    npu_emu_write_reg(&emu, NPU_REG_TOPK, 1);
+    n = npu_cmd_gemm(cmds, 0, x_addr, y_addr, M, K, 1);
+    rejected += npu_emu_run(&emu, cmds, n) != 0;
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+    TEST_ASSERT(rejected == 2, "RoPE rejects partial heads and top-k");
+
+    npu_mem_free(&mem);
+    free(W);
+    free(X);
+    free(Y_raw);
+    free(Y_ref);
+    free(Y_emu);
+    free(q_ref);
+    free(table);
+}
+
+//=============================================================================
+// PREEMPTION TEST (tile-boundary preemption of a prefill GEMM)
+//=============================================================================
+
+#define PRE_BG_M    1024   // Prefill GEMM (background)
+#define PRE_BG_K    1024
+#define PRE_BG_N    16
+#define PRE_HI_M    512    // Decode GEMV (urgent)
+
+// Background prefill GEMM preempted by a decode GEMV through
+// npu_run_urgent(): the context goes to DRAM and back, both results must
+// match the reference for requests during the load phase, mid column, at
+// repeated preemptions and after the end; then the urgent job's latency
+// with and without preemption and the worst preemption latency over a
+// sweep of arrival times
+void test_preemption(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Preemption Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    int M = PRE_BG_M, K = PRE_BG_K, N = PRE_BG_N, Mh = PRE_HI_M;
+    uint32_t w_addr   = 0;
+    uint32_t x_addr   = w_addr + M * K;
+    uint32_t y_addr   = x_addr + K * N;
+    uint32_t wh_addr  = y_addr + M * N * 4;
+    uint32_t xh_addr  = wh_addr + Mh * K;
+    uint32_t yh_addr  = xh_addr + K;
+    uint32_t ctx_addr = (yh_addr + Mh * 4 + 0xFF) & ~0xFFu;
+
+    int8_t*  W     = (int8_t*)calloc((size_t)M * K, 1);
+    int8_t*  X     = (int8_t*)calloc((size_t)K * N, 1);
+    int8_t*  Wh    = (int8_t*)calloc((size_t)Mh * K, 1);
+    int8_t*  xh    = (int8_t*)calloc(K, 1);
+    int32_t* Y_ref = (int32_t*)calloc((size_t)M * N, sizeof(int32_t));
+    int32_t* Y_emu = (int32_t*)calloc((size_t)M * N, sizeof(int32_t));
+    int32_t* yh_ref = (int32_t*)calloc(Mh, sizeof(int32_t));
+    int32_t* yh_emu = (int32_t*)calloc(Mh, sizeof(int32_t));
+    generate_random_i8(W, M * K, seed);
+    generate_random_i8(X, K * N, seed + 1000);
+    generate_random_i8(Wh, Mh * K, seed + 2000);
+    generate_random_i8(xh, K, seed + 3000);
+    ref_gemm_fast(W, X, Y_ref, M, K, N);
+    ref_gemm_fast(Wh, xh, yh_ref, Mh, K, 1);
+
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, EMU_TEST_MEM_SIZE);
+    npu_emu_init(&emu, &mem);
+    npu_mem_write(&mem, w_addr, W, (uint64_t)M * K);
+    npu_mem_write(&mem, x_addr, X, (uint64_t)K * N);
+    npu_mem_write(&mem, wh_addr, Wh, (uint64_t)Mh * K);
+    npu_mem_write(&mem, xh_addr, xh, K);
+
+    NpuCmd bg[16], hi[16], cmds[8];
+    int bg_n = npu_cmd_gemm(bg, w_addr, x_addr, y_addr, M, K, N);
+    int hi_n = npu_cmd_gemm(hi, wh_addr, xh_addr, yh_addr, Mh, K, 1);
+    int ret = npu_emu_run(&emu, bg, bg_n);
+    uint64_t plain = emu.stats.last_job_cycles;
+    uint64_t compute = emu.stats.compute_cycles;
+    uint64_t load_end = plain - compute - (EMU_DMA_SETUP_CYCLES + (uint64_t)M * N * 4 / EMU_DMA_BYTES_PER_CYCLE);
+    ret |= npu_emu_run(&emu, hi, hi_n);
+    uint64_t hi_cycles = emu.stats.last_job_cycles;
+
+    // Arrival during the loads, mid column, on a column boundary, after the end
+    uint64_t arrivals[4] = { 1000, load_end + 12345,
+                             load_end + 3 * (uint64_t)(K / SUBARRAY_COLS) * EMU_TILE_CYCLES,
+                             plain + 1 };
+    char msg[200];
+    for (int a = 0; a < 4; a++) {
+        uint64_t latency;
+        memset(mem.data + y_addr, 0, (size_t)M * N * 4);
+        memset(mem.data + yh_addr, 0, (size_t)Mh * 4);
+        uint64_t before = emu.stats.preemptions;
+        ret = npu_run_urgent(&emu, bg, bg_n, hi, hi_n, ctx_addr, arrivals[a], 1, &latency);
+        npu_mem_read(&mem, y_addr, Y_emu, (uint64_t)M * N * 4);
+        npu_mem_read(&mem, yh_addr, yh_emu, (uint64_t)Mh * 4);
+        int preempted = emu.stats.preemptions != before;
+        sprintf(msg, "Arrival @%llu: %s, both results exact (urgent latency %llu cycles)",
+                (unsigned long long)arrivals[a], preempted ? "preempted" : "ran to completion",
+                (unsigned long long)latency);
+        TEST_ASSERT(ret == 0 && preempted == (a < 3) &&
+                    memcmp(Y_emu, Y_ref, (size_t)M * N * 4) == 0 &&
+                    memcmp(yh_emu, yh_ref, (size_t)Mh * 4) == 0, msg);
+    }
+
+    // Preempted twice: the second context continues the restored partial sums
+    int n = npu_cmd_preempt(cmds, ctx_addr, (uint32_t)(load_end + 5000));
+    memset(mem.data + y_addr, 0, (size_t)M * N * 4);
+    ret  = npu_emu_run(&emu, cmds, n);
+    ret |= npu_emu_run(&emu, bg, bg_n);
+    ret |= npu_emu_run(&emu, hi, hi_n);
+    n = npu_cmd_preempt(cmds, ctx_addr, 300);
+    ret |= npu_emu_run(&emu, cmds, n);
+    n = npu_cmd_resume(cmds, ctx_addr);
+    ret |= npu_emu_run(&emu, cmds, n);
+    int twice = (npu_emu_read_reg(&emu, NPU_REG_STATUS) & NPU_STATUS_PREEMPTED) != 0;
+    ret |= npu_emu_run(&emu, hi, hi_n);
+    ret |= npu_emu_run(&emu, cmds, n);
+    npu_mem_read(&mem, y_addr, Y_emu, (uint64_t)M * N * 4);
+    TEST_ASSERT(ret == 0 && twice && memcmp(Y_emu, Y_ref, (size_t)M * N * 4) == 0,
+                "Resumed job preempted again, result exact");
+
+    // A context restored with K past MAX_K is rejected like a started job
+    // (M shrunk so the job would otherwise fit in memory and run)
+    NpuCtx ctx;
+    n = npu_cmd_preempt(cmds, ctx_addr, (uint32_t)(load_end + 5000));
+    ret  = npu_emu_run(&emu, cmds, n);
+    ret |= npu_emu_run(&emu, bg, bg_n);
+    npu_mem_read(&mem, ctx_addr, &ctx, NPU_CTX_HDR_BYTES);
+    ctx.job[1] = SUBARRAY_ROWS;
+    ctx.job[2] = MAX_K + SUBARRAY_COLS;
+    ctx.wave = ctx.n = ctx.k_tile = 0;
+    npu_mem_write(&mem, ctx_addr, &ctx, NPU_CTX_HDR_BYTES);
+    n = npu_cmd_resume(cmds, ctx_addr);
+    int k_err = npu_emu_run(&emu, cmds, n) != 0;
+    TEST_ASSERT(ret == 0 && k_err &&
+                (npu_emu_read_reg(&emu, NPU_REG_STATUS) & NPU_STATUS_ERROR),
+                "Resume with K > MAX_K sets the error status");
+
+    // Urgent latency, and the worst preemption latency over the compute phase
+    uint64_t wait_lat, pre_lat, worst = 0;
+    uint64_t mid = load_end + compute / 2 + 3;
+    ret  = npu_run_urgent(&emu, bg, bg_n, hi, hi_n, ctx_addr, mid, 0, &wait_lat);
+    ret |= npu_run_urgent(&emu, bg, bg_n, hi, hi_n, ctx_addr, mid, 1, &pre_lat);
+    for (uint64_t at = load_end; at < load_end + compute; at += 613) {
+        uint64_t lat;
+        ret |= npu_run_urgent(&emu, bg, bg_n, hi, hi_n, ctx_addr, at, 1, &lat);
+        if (emu.stats.preempt_latency > worst)
+            worst = emu.stats.preempt_latency;
+    }
+    sprintf(msg, "Urgent job latency: %llu cycles preempting vs %llu waiting (job alone %llu)",
+            (unsigned long long)pre_lat, (unsigned long long)wait_lat,
+            (unsigned long long)hi_cycles);
+    TEST_ASSERT(ret == 0 && pre_lat < wait_lat, msg);
+    sprintf(msg, "Worst preemption latency %llu cycles (tile %d + output flush + context)",
+            (unsigned long long)worst, EMU_TILE_CYCLES);
+    uint64_t bound = EMU_TILE_CYCLES + 2 * EMU_DMA_SETUP_CYCLES +
+                     ((uint64_t)M * N * 4 + sizeof(NpuCtx)) / EMU_DMA_BYTES_PER_CYCLE + 1;
+    TEST_ASSERT(worst > 0 && worst <= bound, msg);
+
+    // Jobs with on-chip state ignore the request
+    n = npu_cmd_preempt(cmds, ctx_addr, 0);
+    ret = npu_emu_run(&emu, cmds, n);
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_CHAIN_OUT | NPU_CFG_RQ(1, 10, 0));
+    n = npu_cmd_gemm(cmds, wh_addr, xh_addr, yh_addr, Mh, K, 1);
+    ret |= npu_emu_run(&emu, cmds, n);
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+    TEST_ASSERT(ret == 0 && (npu_emu_read_reg(&emu, NPU_REG_STATUS) & NPU_STATUS_DONE),
+                "Chained job runs to completion despite the request");
+
+    npu_emu_print_stats(&emu, "preemption");
+
+    npu_mem_free(&mem);
+    free(W);
+    free(X);
+    free(Wh);
+    free(xh);
+    free(Y_ref);
+    free(Y_emu);
+    free(yh_ref);
+    free(yh_emu);
+}
+
+//=============================================================================
+// SERVING TEST (continuous batching runtime)
+//=============================================================================
+
+#define SRV_VOCAB     512
+#define SRV_HIDDEN    128
+#define SRV_LAYERS    2
+#define SRV_REQUESTS  64
+#define SRV_MAX_PROMPT 8
+#define SRV_GAP       3000   // Mean request inter-arrival (cycles)
+
+// Serve one workload with the given policy; returns 0 if every request
+// produced the reference tokens
+static int serve_workload(NpuEmu* emu, const NpuModel* model, uint32_t ids_addr,
+                          uint32_t logits_addr, NpuBatchPolicy policy, int overlap,
+                          uint32_t prompts[][SRV_MAX_PROMPT], const int* prompt_len,
+                          const int* max_new, const uint64_t* arrival,
+                          const uint32_t* next_ref, NpuServe* srv) {
+    int ret = npu_serve_init(srv, emu, model, ids_addr, logits_addr,
+                             NPU_SERVE_MAX_BATCH, policy, overlap);
+    for (int r = 0; r < SRV_REQUESTS && ret == 0; r++)
+        ret = npu_serve_submit(srv, prompts[r], prompt_len[r], max_new[r], arrival[r]) < 0;
+    if (ret == 0)
+        ret = npu_serve_run(srv);
+
+    // Greedy decode of a memoryless model: token i+1 = next_ref[token i]
+    for (int r = 0; r < SRV_REQUESTS && ret == 0; r++) {
+        const NpuSeq* s = &srv->seq[r];
+        uint32_t tok = prompts[r][prompt_len[r] - 1];
+        ret = s->state != NPU_SEQ_DONE || s->generated != max_new[r] ||
+              s->first_token < arrival[r];
+        for (int i = 0; i < s->generated && ret == 0; i++) {
+            tok = next_ref[tok];
+            ret = s->out[i] != tok;
+        }
+    }
+    return ret;
+}
+
+// Decode requests arriving while others run: continuous batching must
+// give every sequence the same tokens as decoding it alone, with higher
+// throughput than a static batch and lower step latency with the host
+// streaming overlapped with the NPU
+void test_serving(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Serving Runtime Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    int V = SRV_VOCAB, H = SRV_HIDDEN, L = SRV_LAYERS;
+    NpuModel model;
+    memset(&model, 0, sizeof(model));
+    model.vocab      = V;
+    model.hidden     = H;
+    model.layers     = L;
+    model.embed_addr = 0;
+    for (int l = 0; l < L; l++)
+        model.layer_addr[l] = (uint32_t)(V * H + l * H * H);
+    model.head_addr  = (uint32_t)(V * H + L * H * H);
+    model.rq_cfg     = NPU_CFG_RQ(1, 9, 0);
+    uint32_t ids_addr    = model.head_addr + V * H;
+    uint32_t logits_addr = ids_addr + NPU_SERVE_MAX_BATCH * 4;
+
+    int8_t*   E      = (int8_t*)calloc((size_t)V * H, 1);
+    int8_t*   Wl     = (int8_t*)calloc((size_t)L * H * H, 1);
+    int8_t*   Wh     = (int8_t*)calloc((size_t)V * H, 1);
+    int8_t*   x      = (int8_t*)calloc(H, 1);
+    int32_t*  y      = (int32_t*)calloc(V, sizeof(int32_t));
+    uint32_t* next_ref = (uint32_t*)calloc(V, sizeof(uint32_t));
+    generate_random_i8(E, V * H, seed);
+    generate_random_i8(Wl, L * H * H, seed + 1000);
+    generate_random_i8(Wh, V * H, seed + 2000);
+
+    // Reference next token of every token id
+    for (int v = 0; v < V; v++) {
+        memcpy(x, E + (size_t)v * H, H);
+        for (int l = 0; l < L; l++) {
+            ref_gemm_fast(Wl + (size_t)l * H * H, x, y, H, H, 1);
+            ref_requant(y, x, H, NPU_CFG_SCALE(model.rq_cfg), NPU_CFG_SHIFT(model.rq_cfg), 0);
+        }
+        ref_gemm_fast(Wh, x, y, V, H, 1);
+        next_ref[v] = 0;
+        for (int t = 1; t < V; t++)
+            if (y[t] > y[next_ref[v]])
+                next_ref[v] = (uint32_t)t;
+    }
+
+    // Workload: random prompt/output lengths, arrivals faster than steps
+    static uint32_t prompts[SRV_REQUESTS][SRV_MAX_PROMPT];
+    int prompt_len[SRV_REQUESTS], max_new[SRV_REQUESTS];
+    uint64_t arrival[SRV_REQUESTS], t = 0;
+    srand(seed);
+    for (int r = 0; r < SRV_REQUESTS; r++) {
+        prompt_len[r] = 1 + rand() % SRV_MAX_PROMPT;
+        max_new[r]    = 4 + rand() % 29;
+        for (int i = 0; i < prompt_len[r]; i++)
+            prompts[r][i] = (uint32_t)(rand() % V);
+        arrival[r] = t;
+        t += (uint64_t)(rand() % (2 * SRV_GAP));
+    }
+
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, EMU_TEST_MEM_SIZE);
+    npu_emu_init(&emu, &mem);
+    npu_mem_write(&mem, model.embed_addr, E, (uint64_t)V * H);
+    npu_mem_write(&mem, model.layer_addr[0], Wl, (uint64_t)L * H * H);
+    npu_mem_write(&mem, model.head_addr, Wh, (uint64_t)V * H);
+
+    NpuServe* cont   = (NpuServe*)calloc(1, sizeof(NpuServe));
+    NpuServe* serial = (NpuServe*)calloc(1, sizeof(NpuServe));
+    NpuServe* stat   = (NpuServe*)calloc(1, sizeof(NpuServe));
+    int ret;
+    char msg[200];
+
+    ret = serve_workload(&emu, &model, ids_addr, logits_addr, NPU_BATCH_CONTINUOUS, 1,
+                         prompts, prompt_len, max_new, arrival, next_ref, cont);
+    sprintf(msg, "Continuous: %d requests, %llu tokens match the reference (mean batch %.1f)",
+            SRV_REQUESTS, (unsigned long long)cont->tokens,
+            cont->steps ? (double)cont->batch_sum / (double)cont->steps : 0.0);
+    TEST_ASSERT(ret == 0, msg);
+
+    ret = serve_workload(&emu, &model, ids_addr, logits_addr, NPU_BATCH_CONTINUOUS, 0,
+                         prompts, prompt_len, max_new, arrival, next_ref, serial);
+    sprintf(msg, "Host overlap: p99 step %llu vs %llu cycles, %.0f vs %.0f tokens/s",
+            (unsigned long long)npu_serve_p99_step(cont),
+            (unsigned long long)npu_serve_p99_step(serial),
+            npu_serve_tokens_per_sec(cont), npu_serve_tokens_per_sec(serial));
+    TEST_ASSERT(ret == 0 && npu_serve_p99_step(cont) < npu_serve_p99_step(serial) &&
+                npu_serve_tokens_per_sec(cont) > npu_serve_tokens_per_sec(serial), msg);
+
+    ret = serve_workload(&emu, &model, ids_addr, logits_addr, NPU_BATCH_STATIC, 1,
+                         prompts, prompt_len, max_new, arrival, next_ref, stat);
+    sprintf(msg, "Continuous vs static batching: %.0f vs %.0f tokens/s",
+            npu_serve_tokens_per_sec(cont), npu_serve_tokens_per_sec(stat));
+    TEST_ASSERT(ret == 0 && npu_serve_tokens_per_sec(cont) > npu_serve_tokens_per_sec(stat), msg);
+
+    npu_serve_print_stats(cont, "continuous");
+    npu_serve_print_stats(serial, "continuous, no overlap");
+    npu_serve_print_stats(stat, "static");
+
+    npu_serve_free(cont);
+    npu_serve_free(serial);
+    npu_serve_free(stat);
+    free(cont);
+    free(serial);
+    free(stat);
+    npu_mem_free(&mem);
+    free(E);
+    free(Wl);
+    free(Wh);
+    free(x);
+    free(y);
+    free(next_ref);
+}
+
+//=============================================================================
+// MEMORY PLAN TEST (liveness-based activation arena)
+//=============================================================================
+
+#define PLAN_HIDDEN   256
+#define PLAN_OUT      128
+#define PLAN_BATCH    4
+
+// Decoder layers in graph form; x is the INT8 layer input, returns the
+// INT8 layer output
+static int plan_decoder_layer(NpuGraph* g, int x, int H, int I, int N, int last) {
+    int q = npu_graph_tensor(g, (uint64_t)H * N, 4, 0);
+    int k = npu_graph_tensor(g, (uint64_t)H * N, 4, 0);
+    int v = npu_graph_tensor(g, (uint64_t)H * N, 4, 0);
+    int a = npu_graph_tensor(g, (uint64_t)H * N, 1, 0);
+    int o = npu_graph_tensor(g, (uint64_t)H * N, 4, 0);
+    int h = npu_graph_tensor(g, (uint64_t)H * N, 1, 0);
+    int gt = npu_graph_tensor(g, (uint64_t)I * N, 4, 0);
+    int up = npu_graph_tensor(g, (uint64_t)I * N, 4, 0);
+    int m = npu_graph_tensor(g, (uint64_t)I * N, 1, 0);
+    int d = npu_graph_tensor(g, (uint64_t)H * N, 4, 0);
+    int y = npu_graph_tensor(g, (uint64_t)H * N, 1, last ? NPU_TENSOR_OUTPUT : 0);
+    int qkv[3] = { q, k, v }, xo[2] = { x, o }, gu[2] = { gt, up }, hd[2] = { h, d };
+
+    npu_graph_op(g, NPU_OP_GEMM, &x, 1, q);
+    npu_graph_op(g, NPU_OP_GEMM, &x, 1, k);
+    npu_graph_op(g, NPU_OP_GEMM, &x, 1, v);
+    npu_graph_op(g, NPU_OP_HOST, qkv, 3, a);    // Attention
+    npu_graph_op(g, NPU_OP_GEMM, &a, 1, o);
+    npu_graph_op(g, NPU_OP_HOST, xo, 2, h);     // Residual + norm
+    npu_graph_op(g, NPU_OP_GEMM, &h, 1, gt);
+    npu_graph_op(g, NPU_OP_GEMM, &h, 1, up);
+    npu_graph_op(g, NPU_OP_HOST, gu, 2, m);     // SiLU(gate) * up
+    npu_graph_op(g, NPU_OP_GEMM, &m, 1, d);
+    npu_graph_op(g, NPU_OP_HOST, hd, 2, y);     // Residual + norm
+    return y;
+}
+
+static uint64_t plan_decoder(NpuGraph* g, int layers, int onchip) {
+    int H = LLAMA_HIDDEN_DIM, I = LLAMA_INTERMEDIATE;
+    npu_graph_init(g);
+    int x = npu_graph_tensor(g, H, 1, NPU_TENSOR_INPUT);
+    for (int l = 0; l < layers; l++)
+        x = plan_decoder_layer(g, x, H, I, 1, l == layers - 1);
+    return npu_plan(g, onchip);
+}
+
+// Every pair of DRAM tensors live at the same time has disjoint ranges, and
+// the arena holds the peak of simultaneously live bytes
+static int plan_valid(const NpuGraph* g) {
+    for (int i = 0; i < g->num_tensors; i++) {
+        const NpuTensor* a = &g->t[i];
+        if (a->where != NPU_MEM_DRAM)
+            continue;
+        if (a->offset + a->elems * a->elem_bytes > g->arena_bytes)
+            return 0;
+        for (int j = i + 1; j < g->num_tensors; j++) {
+            const NpuTensor* b = &g->t[j];
+            if (b->where == NPU_MEM_DRAM && a->first <= b->last && b->first <= a->last &&
+                a->offset < b->offset + b->elems * b->elem_bytes &&
+                b->offset < a->offset + a->elems * a->elem_bytes)
+                return 0;
+        }
+    }
+    for (int op = 0; op < g->num_ops; op++) {
+        uint64_t live = 0;
+        for (int i = 0; i < g->num_tensors; i++)
+            if (g->t[i].where == NPU_MEM_DRAM && g->t[i].first <= op && op <= g->t[i].last)
+                live += g->t[i].elems * g->t[i].elem_bytes;
+        if (live > g->arena_bytes)
+            return 0;
+    }
+    return 1;
+}
+
+// Plans of a decoder (DRAM only: every GEMM feeds a host op) and of a GEMM
+// chain whose planned CONFIG bits are executed on the emulator
+void test_memory_plan(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Memory Plan Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    NpuGraph* g  = (NpuGraph*)calloc(1, sizeof(NpuGraph));
+    NpuGraph* g4 = (NpuGraph*)calloc(1, sizeof(NpuGraph));
+    char msg[200];
+
+    uint64_t arena  = plan_decoder(g, 2, 1);
+    uint64_t arena4 = plan_decoder(g4, 4, 1);
+    sprintf(msg, "LLaMA-7B decoder x2: arena %llu of %llu bytes, no live overlap",
+            (unsigned long long)arena, (unsigned long long)g->naive_bytes);
+    TEST_ASSERT(arena != NPU_PLAN_FAIL && plan_valid(g) && arena < g->naive_bytes / 2, msg);
+    sprintf(msg, "Arena independent of depth: %llu bytes for 4 layers",
+            (unsigned long long)arena4);
+    TEST_ASSERT(arena4 == arena && plan_valid(g4), msg);
+    npu_plan_print(g, "LLaMA-7B decoder x2");
+
+    // GEMM chain with a shared tensor: x → A → t1 → B → t2 → {C → y, D → z}
+    int K = PLAN_HIDDEN, Mo = PLAN_OUT, N = PLAN_BATCH;
+    npu_graph_init(g);
+    int x  = npu_graph_tensor(g, (uint64_t)K * N, 1, NPU_TENSOR_INPUT);
+    int t1 = npu_graph_tensor(g, (uint64_t)K * N, 1, 0);
+    int t2 = npu_graph_tensor(g, (uint64_t)K * N, 1, 0);
+    int y  = npu_graph_tensor(g, (uint64_t)Mo * N, 4, NPU_TENSOR_OUTPUT);
+    npu_graph_op(g, NPU_OP_GEMM, &x, 1, t1);
+    npu_graph_op(g, NPU_OP_GEMM, &t1, 1, t2);
+    npu_graph_op(g, NPU_OP_GEMM, &t2, 1, y);
+    *g4 = *g;
+    int z = npu_graph_tensor(g4, (uint64_t)Mo * N, 4, NPU_TENSOR_OUTPUT);
+    npu_graph_op(g4, NPU_OP_GEMM, &t2, 1, z);
+    npu_plan(g, 1);
+    npu_plan(g4, 1);
+    TEST_ASSERT(g->onchip == 2 && g->t[t1].where == NPU_MEM_ONCHIP &&
+                g->t[t2].where == NPU_MEM_ONCHIP && g4->onchip == 1 &&
+                g4->t[t2].where == NPU_MEM_DRAM && plan_valid(g) && plan_valid(g4),
+                "Chained tensors on chip, shared tensor stays in DRAM");
+
+    // Execute the chain with the planned placement
+    uint32_t w_addr[3], arena_addr;
+    int8_t*  W = (int8_t*)calloc((size_t)3 * K * K, 1);
+    int8_t*  X = (int8_t*)calloc((size_t)K * N, 1);
+    int8_t*  h = (int8_t*)calloc((size_t)K * N, 1);
+    int32_t* acc   = (int32_t*)calloc((size_t)K * N, sizeof(int32_t));
+    int32_t* Y_emu = (int32_t*)calloc((size_t)Mo * N, sizeof(int32_t));
+    int dims_m[3] = { K, K, Mo };
+    uint32_t rq = NPU_CFG_RQ(1, 9, 1);
+    generate_random_i8(W, 3 * K * K, seed);
+    generate_random_i8(X, K * N, seed + 1000);
+
+    memcpy(h, X, (size_t)K * N);
+    for (int l = 0; l < 3; l++) {
+        ref_gemm_fast(W + (size_t)l * K * K, h, acc, dims_m[l], K, N);
+        if (l < 2)
+            ref_requant(acc, h, K * N, NPU_CFG_SCALE(rq), NPU_CFG_SHIFT(rq), 1);
+    }
+
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, EMU_TEST_MEM_SIZE);
+    npu_emu_init(&emu, &mem);
+    for (int l = 0; l < 3; l++) {
+        w_addr[l] = (uint32_t)(l * K * K);
+        npu_mem_write(&mem, w_addr[l], W + (size_t)l * K * K, (uint64_t)K * K);
+    }
+    arena_addr = (uint32_t)(3 * K * K);
+    npu_mem_write(&mem, arena_addr + g->t[x].offset, X, (uint64_t)K * N);
+
+    NpuCmd cmds[3 * 10 + 1];
+    int n = 0;
+    for (int op = 0; op < g->num_ops; op++) {
+        uint32_t cfg = npu_plan_op_cfg(g, op);
+        if (cfg & NPU_CFG_CHAIN_OUT)
+            cfg |= rq;
+        cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CONFIG, cfg };
+        n += npu_cmd_gemm(&cmds[n], w_addr[op],
+                          arena_addr + (uint32_t)g->t[g->op[op].in[0]].offset,
+                          arena_addr + (uint32_t)g->t[g->op[op].out].offset,
+                          dims_m[op], K, N);
+    }
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CONFIG, 0 };
+    int ret = npu_emu_run(&emu, cmds, n);
+    npu_mem_read(&mem, arena_addr + g->t[y].offset, Y_emu, (uint64_t)Mo * N * 4);
+    sprintf(msg, "Planned chain on emulator matches reference (arena %llu bytes, %llu DMA bytes)",
+            (unsigned long long)g->arena_bytes, (unsigned long long)emu.stats.dma_bytes);
+    TEST_ASSERT(ret == 0 && memcmp(Y_emu, acc, (size_t)Mo * N * 4) == 0, msg);
+
+    // Read before write
+    npu_graph_init(g);
+    x  = npu_graph_tensor(g, 64, 1, 0);
+    t1 = npu_graph_tensor(g, 64, 1, NPU_TENSOR_OUTPUT);
+    npu_graph_op(g, NPU_OP_GEMM, &x, 1, t1);
+    TEST_ASSERT(npu_plan(g, 1) == NPU_PLAN_FAIL, "Tensor read before it is written is rejected");
+
+    npu_mem_free(&mem);
+    free(W);
+    free(X);
+    free(h);
+    free(acc);
+    free(Y_emu);
+    free(g);
+    free(g4);
+}
+
+//=============================================================================
+// EVENT TRACE TEST (emulator TRACE_* registers, npu_trace decoder)
+//=============================================================================
+
+#define TRACE_JOBS  3
+
+void test_trace(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Event Trace Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    int M = 128, K = 256, N = 4;
+    uint32_t w_addr = 0, x_addr = w_addr + M * K, y_addr = x_addr + K * N;
+    int8_t* W = (int8_t*)calloc((size_t)M * K, 1);
+    int8_t* X = (int8_t*)calloc((size_t)K * N, 1);
+    NpuTraceEvent* ev = (NpuTraceEvent*)calloc(NPU_TRACE_DEPTH, sizeof(NpuTraceEvent));
+    generate_random_i8(W, M * K, seed);
+    generate_random_i8(X, K * N, seed + 1000);
+
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, EMU_TEST_MEM_SIZE);
+    npu_emu_init(&emu, &mem);
+    npu_mem_write(&mem, w_addr, W, (uint64_t)M * K);
+    npu_mem_write(&mem, x_addr, X, (uint64_t)K * N);
+
+    NpuCmd cmds[16];
+    int n = npu_cmd_gemm(cmds, w_addr, x_addr, y_addr, M, K, N);
+    char msg[200];
+
+    // Jobs with a marker before each: MARK, JOB_START, JOB_END per job,
+    // job duration = cycle model
+    uint64_t job_cycles[TRACE_JOBS];
+    int ret = 0;
+    npu_emu_write_reg(&emu, NPU_REG_TRACE_CTRL, NPU_TRACE_EN | NPU_TRACE_CLEAR);
+    for (int j = 0; j < TRACE_JOBS; j++) {
+        npu_emu_write_reg(&emu, NPU_REG_TRACE_MARK, 0x100 + j);
+        npu_emu_write_reg(&emu, NPU_REG_CONFIG, j ? NPU_CFG_RELU : 0);
+        ret |= npu_emu_run(&emu, cmds, n);
+        job_cycles[j] = emu.stats.last_job_cycles;
+    }
+    int count = npu_trace_read(&emu, ev, NPU_TRACE_DEPTH);
+    int ok = (ret == 0 && count == 3 * TRACE_JOBS);
+    for (int j = 0; ok && j < TRACE_JOBS; j++) {
+        const NpuTraceEvent* e = &ev[3 * j];
+        ok = e[0].id == NPU_TRACE_EV_MARK && e[0].arg == 0x100u + j &&
+             e[1].id == NPU_TRACE_EV_JOB_START && e[1].arg == (j ? NPU_CFG_RELU : 0) &&
+             e[2].id == NPU_TRACE_EV_JOB_END && e[2].arg == NPU_STATUS_DONE &&
+             e[1].ts >= e[0].ts && e[2].ts - e[1].ts == job_cycles[j];
+    }
+    sprintf(msg, "Job events in order with cycle-model durations (%d events, %llu cycles/job)",
+            count, (unsigned long long)job_cycles[0]);
+    TEST_ASSERT(ok, msg);
+    npu_trace_print(stdout, ev, count);
+
+    // Disabled: no events, time frozen
+    npu_emu_write_reg(&emu, NPU_REG_TRACE_CTRL, 0);
+    ret = npu_emu_run(&emu, cmds, n);
+    npu_emu_write_reg(&emu, NPU_REG_TRACE_CTRL, NPU_TRACE_EN);
+    npu_emu_write_reg(&emu, NPU_REG_TRACE_MARK, 0x200);
+    count = npu_trace_read(&emu, ev, NPU_TRACE_DEPTH);
+    TEST_ASSERT(ret == 0 && count == 3 * TRACE_JOBS + 1 && ev[count - 1].ts == ev[count - 2].ts,
+                "Disabled trace records nothing and stops the timestamp");
+
+    // Filter + trigger: only job ends, from the first MARK on
+    npu_emu_write_reg(&emu, NPU_REG_TRACE_CTRL, NPU_TRACE_EN | NPU_TRACE_CLEAR | NPU_TRACE_TRIG_EN);
+    npu_emu_write_reg(&emu, NPU_REG_TRACE_FILTER, 1u << NPU_TRACE_EV_JOB_END);
+    npu_emu_write_reg(&emu, NPU_REG_TRACE_TRIG, NPU_TRACE_EV_MARK);
+    ret  = npu_emu_run(&emu, cmds, n);
+    npu_emu_write_reg(&emu, NPU_REG_TRACE_MARK, 0x300);
+    ret |= npu_emu_run(&emu, cmds, n);
+    uint32_t status = npu_emu_read_reg(&emu, NPU_REG_TRACE_STATUS);
+    count = npu_trace_read(&emu, ev, NPU_TRACE_DEPTH);
+    TEST_ASSERT(ret == 0 && count == 1 && ev[0].id == NPU_TRACE_EV_JOB_END &&
+                (status & NPU_TRACE_TRIGGERED) && ev[0].ts == 2 * emu.stats.last_job_cycles,
+                "Filter and MARK trigger keep only the job end after the marker");
+
+    // Wrap: the newest NPU_TRACE_DEPTH markers, oldest first
+    int marks = NPU_TRACE_DEPTH + 44;
+    npu_emu_write_reg(&emu, NPU_REG_TRACE_FILTER, 0xFF);
+    npu_emu_write_reg(&emu, NPU_REG_TRACE_CTRL, NPU_TRACE_EN | NPU_TRACE_CLEAR);
+    for (int i = 0; i < marks; i++)
+        npu_emu_write_reg(&emu, NPU_REG_TRACE_MARK, (uint32_t)i);
+    status = npu_emu_read_reg(&emu, NPU_REG_TRACE_STATUS);
+    count  = npu_trace_read(&emu, ev, NPU_TRACE_DEPTH);
+    sprintf(msg, "Wrapped ring keeps the newest %d events (wr_ptr=%u, oldest=%u)",
+            NPU_TRACE_DEPTH, NPU_TRACE_WR_PTR(status), ev[0].arg);
+    TEST_ASSERT(count == NPU_TRACE_DEPTH && (status & NPU_TRACE_WRAPPED) &&
+                !(status & NPU_TRACE_STOPPED) && ev[0].arg == (uint32_t)(marks - NPU_TRACE_DEPTH) &&
+                ev[count - 1].arg == (uint32_t)(marks - 1), msg);
+
+    // Stop when full: the first NPU_TRACE_DEPTH markers
+    npu_emu_write_reg(&emu, NPU_REG_TRACE_CTRL, NPU_TRACE_EN | NPU_TRACE_CLEAR | NPU_TRACE_STOP_FULL);
+    for (int i = 0; i < marks; i++)
+        npu_emu_write_reg(&emu, NPU_REG_TRACE_MARK, (uint32_t)i);
+    status = npu_emu_read_reg(&emu, NPU_REG_TRACE_STATUS);
+    count  = npu_trace_read(&emu, ev, NPU_TRACE_DEPTH);
+    TEST_ASSERT(count == NPU_TRACE_DEPTH && (status & NPU_TRACE_STOPPED) &&
+                ev[0].arg == 0 && ev[count - 1].arg == NPU_TRACE_DEPTH - 1,
+                "Stop-when-full ring keeps the first events");
+
+    // Timestamp unwrap across 2^32
+    uint32_t raw[6] = { 0xFFFFFF00u, 0x07000001u, 0xFFFFFFF0u, 0x07000002u,
+                        0x00000010u, 0x07000003u };
+    count = npu_trace_decode(raw, 3, NPU_TRACE_WRAPPED, ev);
+    TEST_ASSERT(count == 3 && ev[2].ts == 0x100000010ull && ev[1].ts == 0xFFFFFFF0ull,
+                "Decoder unwraps 32-bit timestamps");
+
+    npu_mem_free(&mem);
+    free(W);
+    free(X);
+    free(ev);
+}
+
+//=============================================================================
+// ACCUMULATOR WIDTH TEST (MAX_K guard bits, DIM_K bound in the emulator)
+//=============================================================================
+
+#define ACC_LLAMA_ROWS  64
+
+// Fill W[M][K] and X[K] with one value each
+static int acc_worst(int8_t* W, int8_t* X, int M, int K, int8_t w, int8_t x,
+                     int acc_bits, int col_bits, int32_t* y) {
+    memset(W, w, (size_t)M * K);
+    memset(X, x, (size_t)K);
+    return ref_gemv_acc(X, W, y, K, M, acc_bits, col_bits);
+}
+
+void test_acc_width(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Accumulator Width Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    char msg[200];
+    int w512 = ref_acc_bits(512);
+    printf("  Guard bits: K=1 %d, K=512 %d, K=MAX_K(%d) %d (columns %d)\n",
+           ref_acc_bits(1), w512, MAX_K, ref_acc_bits(MAX_K),
+           ref_acc_bits(MAX_K / SUBARRAY_COLS));
+    TEST_ASSERT(ref_acc_bits(1) == INPUT_WIDTH + WEIGHT_WIDTH &&
+                ref_acc_bits(MAX_K) == ACC_WIDTH &&
+                ref_acc_bits(MAX_K / SUBARRAY_COLS) == COL_ACC_WIDTH &&
+                ref_acc_bits(2 * MAX_K) == ACC_WIDTH + 1,
+                "ACC_WIDTH / COL_ACC_WIDTH = ref_acc_bits(MAX_K), one more bit at 2 * MAX_K");
+
+    // Worst case at MAX_K: exact with ACC_WIDTH, wraps with one bit less
+    int M = 4, K = MAX_K;
+    int8_t*  W = (int8_t*)malloc((size_t)ACC_LLAMA_ROWS * LLAMA_INTERMEDIATE);
+    int8_t*  X = (int8_t*)malloc(MAX_K);   // > LLAMA_INTERMEDIATE
+    int32_t* y_acc = (int32_t*)calloc(ACC_LLAMA_ROWS, sizeof(int32_t));
+    int32_t* y_ref = (int32_t*)calloc(ACC_LLAMA_ROWS, sizeof(int32_t));
+    int wrap_hi  = acc_worst(W, X, M, K, -128, -128, ACC_WIDTH, COL_ACC_WIDTH, y_acc);
+    int32_t top  = y_acc[0];
+    int wrap_lo  = acc_worst(W, X, M, K,  127, -128, ACC_WIDTH, COL_ACC_WIDTH, y_acc);
+    int32_t bot  = y_acc[0];
+    int wrap_1   = acc_worst(W, X, M, K, -128, -128, ACC_WIDTH - 1, COL_ACC_WIDTH, y_acc);
+    int wrap_c1  = acc_worst(W, X, M, K, -128, -128, ACC_WIDTH, COL_ACC_WIDTH - 1, y_acc);
+    sprintf(msg, "K=%d worst case exact in %d/%d bits (%d, %d), wraps with one bit less",
+            K, ACC_WIDTH, COL_ACC_WIDTH, top, bot);
+    TEST_ASSERT(wrap_hi == 0 && wrap_lo == 0 && top == K * 16384 && bot == -K * 16256 &&
+                wrap_1 == M && wrap_c1 == M, msg);
+
+    // K = 512: -128 * -128 needs the 25th bit; symmetric weights fit 24
+    int wrap_24  = acc_worst(W, X, M, 512, -128, -128, 24, 21, y_acc);
+    int wrap_sym = acc_worst(W, X, M, 512,  127, -128, 24, 21, y_acc) +
+                   acc_worst(W, X, M, 512, -127, -128, 24, 21, y_acc);
+    int wrap_25  = acc_worst(W, X, M, 512, -128, -128, w512, w512 - 3, y_acc);
+    sprintf(msg, "K=512: %d bits exact, 24 bits only for weights in [-127, 127]", w512);
+    TEST_ASSERT(w512 == 25 && wrap_25 == 0 && wrap_24 == M && wrap_sym == 0, msg);
+
+    // Random LLaMA-7B FFN down projection rows (K = 11008): bit-exact
+    generate_random_i8(W, ACC_LLAMA_ROWS * LLAMA_INTERMEDIATE, seed);
+    generate_random_i8(X, LLAMA_INTERMEDIATE, seed + 1000);
+    int wrap_rand = ref_gemv_acc(X, W, y_acc, LLAMA_INTERMEDIATE, ACC_LLAMA_ROWS,
+                                 ACC_WIDTH, COL_ACC_WIDTH);
+    ref_gemv_tiled(X, W, y_ref, LLAMA_INTERMEDIATE, ACC_LLAMA_ROWS);
+    sprintf(msg, "LLaMA-7B down projection (K=%d, %d rows): %d-bit accumulators bit-exact",
+            LLAMA_INTERMEDIATE, ACC_LLAMA_ROWS, ACC_WIDTH);
+    TEST_ASSERT(wrap_rand == 0 &&
+                memcmp(y_acc, y_ref, ACC_LLAMA_ROWS * sizeof(int32_t)) == 0, msg);
+
+    // Emulator: DIM_K up to MAX_K runs, beyond is rejected (DONE | ERROR)
+    NpuMem mem;
+    NpuEmu emu;
+    uint32_t x_addr = (uint32_t)SUBARRAY_ROWS * (MAX_K + 8), y_addr = x_addr + MAX_K + 8;
+    npu_mem_init(&mem, y_addr + 0x1000);
+    npu_emu_init(&emu, &mem);
+    NpuCmd cmds[16];
+    int n = npu_cmd_gemm(cmds, 0, x_addr, y_addr, SUBARRAY_ROWS, MAX_K, 1);
+    int ret_max = npu_emu_run(&emu, cmds, n);
+    n = npu_cmd_gemm(cmds, 0, x_addr, y_addr, SUBARRAY_ROWS, MAX_K + 1, 1);
+    int ret_over = npu_emu_run(&emu, cmds, n);
+    uint32_t status = npu_emu_read_reg(&emu, NPU_REG_STATUS);
+    TEST_ASSERT(ret_max == 0 && ret_over != 0 && (status & NPU_STATUS_ERROR),
+                "Emulator runs DIM_K = MAX_K, rejects DIM_K = MAX_K + 1");
+    npu_mem_free(&mem);
+
+    free(W);
+    free(X);
+    free(y_acc);
+    free(y_ref);
+}
+
+//=============================================================================
+// FLOATING-POINT MAC TEST (CONFIG.fmt BF16/FP16, FP32 accumulate)
+//=============================================================================
+
+#define FP_SOFT_PAIRS   100000
+#define FP_ACC_K        4096
+#define FP_ACC_ROWS     64
+
+// Random normal FP32 with exponent in [-e_range, e_range]
+static float fp_rand_f32(int e_range) {
+    float m = 1.0f + (float)rand() / ((float)RAND_MAX + 1.0f);
+    int   e = rand() % (2 * e_range + 1) - e_range;
+    return (rand() & 1 ? -m : m) * ldexpf(1.0f, e);
+}
+
+// RMS of (y - ref) relative to the RMS of ref
+static double fp_rel_err(const double* y, const double* ref, int n) {
+    double err = 0.0, mag = 0.0;
+    for (int i = 0; i < n; i++) {
+        err += (y[i] - ref[i]) * (y[i] - ref[i]);
+        mag += ref[i] * ref[i];
+    }
+    return sqrt(err / mag);
+}
+
+void test_fp_mac(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("FP MAC Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    char msg[200];
+    srand(seed);
+
+    // Softfloat vs host IEEE arithmetic (round to nearest even). Products
+    // of 8/11-bit significands are exact in FP32
+    int bad_add = 0, bad_bf = 0, bad_fp = 0;
+    for (int i = 0; i < FP_SOFT_PAIRS; i++) {
+        float a = fp_rand_f32(30), b = fp_rand_f32(30);
+        if (i % 4 == 0)
+            b = -a * (1.0f + ldexpf((float)(rand() % 8), -23));  // Cancellation
+        float sum = a + b;
+        if (fabsf(sum) >= FLT_MIN || sum == 0.0f)
+            bad_add += ref_fp32_add(ref_f32_to_u32(a), ref_f32_to_u32(b)) != ref_f32_to_u32(sum);
+
+        uint16_t ha = ref_f32_to_bf16(fp_rand_f32(30)), hb = ref_f32_to_bf16(fp_rand_f32(30));
+        float p = ref_bf16_to_f32(ha) * ref_bf16_to_f32(hb);
+        bad_bf += ref_fp_mul(ha, hb, FMT_BF16) != ref_f32_to_u32(p);
+
+        ha = ref_f32_to_fp16(fp_rand_f32(14));
+        hb = ref_f32_to_fp16(fp_rand_f32(14));
+        p  = ref_fp16_to_f32(ha) * ref_fp16_to_f32(hb);
+        bad_fp += ref_fp_mul(ha, hb, FMT_FP16) != ref_f32_to_u32(p);
+    }
+    sprintf(msg, "Softfloat matches IEEE: fp32_add %d, bf16 mul %d, fp16 mul %d mismatches / %d",
+            bad_add, bad_bf, bad_fp, FP_SOFT_PAIRS);
+    TEST_ASSERT(bad_add == 0 && bad_bf == 0 && bad_fp == 0, msg);
+
+    uint16_t fp16_min = 0x0001;   // 2^-24 (subnormal)
+    TEST_ASSERT(ref_fp_mul(0x7F80, 0x0000, FMT_BF16) == FP32_QNAN &&
+                ref_fp_mul(0x7F80, 0xBF80, FMT_BF16) == 0xFF800000u &&
+                ref_fp_mul(0x7C00, 0x3C00, FMT_FP16) == 0x7F800000u &&
+                ref_fp_mul(fp16_min, fp16_min, FMT_FP16) == ref_f32_to_u32(ldexpf(1.0f, -48)) &&
+                ref_fp32_add(0x80000000u, 0x80000000u) == 0x80000000u &&
+                ref_fp32_add(0x7F800000u, 0xFF800000u) == FP32_QNAN,
+                "Specials: inf * 0 = NaN, inf, FP16 subnormal product exact, -0 + -0, inf - inf");
+
+    // Emulator vs ref_gemm_fp, bit-exact
+    int M = 64, K = 256, N = 4;
+    size_t w_bytes = (size_t)M * K * 2, x_bytes = (size_t)K * N * 2, y_bytes = (size_t)M * N * 4;
+    uint32_t x_addr = (uint32_t)w_bytes, y_addr = x_addr + (uint32_t)x_bytes;
+    uint16_t* W  = (uint16_t*)malloc(w_bytes);
+    uint16_t* X  = (uint16_t*)malloc(x_bytes);
+    uint32_t* Y  = (uint32_t*)malloc(y_bytes);
+    uint32_t* Yr = (uint32_t*)malloc(y_bytes);
+    NpuMem mem;
+    NpuEmu emu;
+    NpuCmd cmds[16];
+    npu_mem_init(&mem, 4u << 20);
+    npu_emu_init(&emu, &mem);
+    for (int fmt = FMT_BF16; fmt <= FMT_FP16; fmt++) {
+        for (int i = 0; i < M * K; i++) W[i] = fp_random(fmt, 1.0f);
+        for (int i = 0; i < K * N; i++) X[i] = fp_random(fmt, 4.0f);
+        ref_gemm_fp(W, X, Yr, M, K, N, fmt);
+        npu_mem_write(&mem, 0, W, w_bytes);
+        npu_mem_write(&mem, x_addr, X, x_bytes);
+        npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_FMT_SET(fmt));
+        int n = npu_cmd_gemm(cmds, 0, x_addr, y_addr, M, K, N);
+        int ret = npu_emu_run(&emu, cmds, n);
+        npu_mem_read(&mem, y_addr, Y, y_bytes);
+        sprintf(msg, "Emulator %s GEMM %dx%dx%d bit-exact with ref_gemm_fp",
+                fmt == FMT_BF16 ? "BF16" : "FP16", M, K, N);
+        TEST_ASSERT(ret == 0 && memcmp(Y, Yr, y_bytes) == 0, msg);
+    }
+
+    // Rejected: FP with chain/top-k/streaming modes
+    uint32_t bad_cfg[3] = { NPU_CFG_FMT_SET(FMT_BF16) | NPU_CFG_CHAIN_OUT,
+                            NPU_CFG_FMT_SET(FMT_FP16) | NPU_CFG_TOPK,
+                            NPU_CFG_FMT_SET(FMT_FP8) | NPU_CFG_WSTREAM };
+    int rejected = 0;
+    for (int i = 0; i < 3; i++) {
+        npu_emu_write_reg(&emu, NPU_REG_CONFIG, bad_cfg[i]);
+        int n = npu_cmd_gemm(cmds, 0, x_addr, y_addr, M, K, 1);
+        rejected += npu_emu_run(&emu, cmds, n) != 0 &&
+                    (npu_emu_read_reg(&emu, NPU_REG_STATUS) & NPU_STATUS_ERROR);
+    }
+    TEST_ASSERT(rejected == 3, "FP with chain_out / topk / wstream rejected (DONE | ERROR)");
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+    npu_mem_free(&mem);
+    free(W);
+    free(X);
+    free(Y);
+    free(Yr);
+
+    // Accuracy vs a double reference: INT8 (per-tensor symmetric scales),
+    // BF16 and FP16, same real-valued GEMV
+    int Ka = FP_ACC_K, Ma = FP_ACC_ROWS;
+    float*    wf  = (float*)malloc((size_t)Ma * Ka * sizeof(float));
+    float*    xf  = (float*)malloc((size_t)Ka * sizeof(float));
+    int8_t*   w8  = (int8_t*)malloc((size_t)Ma * Ka);
+    int8_t*   x8  = (int8_t*)malloc((size_t)Ka);
+    int32_t*  y8  = (int32_t*)malloc(Ma * sizeof(int32_t));
+    uint16_t* wh  = (uint16_t*)malloc((size_t)Ma * Ka * 2);
+    uint16_t* xh  = (uint16_t*)malloc((size_t)Ka * 2);
+    uint32_t* yh  = (uint32_t*)malloc(Ma * sizeof(uint32_t));
+    double*   ref = (double*)malloc(Ma * sizeof(double));
+    double*   got = (double*)malloc(Ma * sizeof(double));
+    for (int i = 0; i < Ma * Ka; i++) wf[i] = fp_rand_f32(0) * 0.25f;
+    for (int i = 0; i < Ka; i++)      xf[i] = fp_rand_f32(2);
+    for (int m = 0; m < Ma; m++) {
+        ref[m] = 0.0;
+        for (int k = 0; k < Ka; k++)
+            ref[m] += (double)wf[(size_t)m * Ka + k] * xf[k];
+    }
+    float w_max = 0.0f, x_max = 0.0f;
+    for (int i = 0; i < Ma * Ka; i++) w_max = fmaxf(w_max, fabsf(wf[i]));
+    for (int i = 0; i < Ka; i++)      x_max = fmaxf(x_max, fabsf(xf[i]));
+    float w_scale = w_max / 127.0f, x_scale = x_max / 127.0f;
+    for (int i = 0; i < Ma * Ka; i++) w8[i] = (int8_t)lrintf(wf[i] / w_scale);
+    for (int i = 0; i < Ka; i++)      x8[i] = (int8_t)lrintf(xf[i] / x_scale);
+    ref_gemv_tiled(x8, w8, y8, Ka, Ma);
+    for (int m = 0; m < Ma; m++) got[m] = (double)y8[m] * w_scale * x_scale;
+    double err_int8 = fp_rel_err(got, ref, Ma);
+    double err_fmt[3] = { 0.0 };
+    for (int fmt = FMT_BF16; fmt <= FMT_FP16; fmt++) {
+        for (int i = 0; i < Ma * Ka; i++)
+            wh[i] = fmt == FMT_BF16 ? ref_f32_to_bf16(wf[i]) : ref_f32_to_fp16(wf[i]);
+        for (int i = 0; i < Ka; i++)
+            xh[i] = fmt == FMT_BF16 ? ref_f32_to_bf16(xf[i]) : ref_f32_to_fp16(xf[i]);
+        ref_gemm_fp(wh, xh, yh, Ma, Ka, 1, fmt);
+        for (int m = 0; m < Ma; m++) got[m] = ref_u32_to_f32(yh[m]);
+        err_fmt[fmt] = fp_rel_err(got, ref, Ma);
+    }
+    printf("  GEMV %dx%d relative RMS error: INT8 %.2e, BF16 %.2e, FP16 %.2e\n",
+           Ma, Ka, err_int8, err_fmt[FMT_BF16], err_fmt[FMT_FP16]);
+    TEST_ASSERT(err_fmt[FMT_FP16] < err_fmt[FMT_BF16] && err_fmt[FMT_BF16] < 1e-2 &&
+                err_fmt[FMT_FP16] < 1e-3,
+                "FP16 more accurate than BF16, both within 1e-2 / 1e-3 of FP64");
+    free(wf); free(xf); free(w8); free(x8); free(y8);
+    free(wh); free(xh); free(yh); free(ref); free(got);
+
+    // Throughput: same job in INT8 and BF16. Half the elements per line
+    // doubles the compute tiles; the W/X DMA doubles with the element size
+    int Mt = 512, Kt = 1024, Nt = 8;
+    uint32_t xt = (uint32_t)Mt * Kt * 2, yt = xt + (uint32_t)Kt * Nt * 2;
+    uint64_t cyc[2], comp[2];
+    npu_mem_init(&mem, yt + (uint64_t)Mt * Nt * 4);
+    npu_emu_init(&emu, &mem);
+    for (int f = 0; f < 2; f++) {
+        npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_FMT_SET(f ? FMT_BF16 : FMT_INT8));
+        uint64_t c0 = emu.stats.cycles, k0 = emu.stats.compute_cycles;
+        int n = npu_cmd_gemm(cmds, 0, xt, yt, Mt, Kt, Nt);
+        npu_emu_run(&emu, cmds, n);
+        cyc[f]  = emu.stats.cycles - c0;
+        comp[f] = emu.stats.compute_cycles - k0;
+    }
+    double macs = (double)Mt * Kt * Nt;
+    printf("  %dx%dx%d: INT8 %llu cycles (%.0f MAC/cycle compute), BF16 %llu cycles (%.0f MAC/cycle compute)\n",
+           Mt, Kt, Nt, (unsigned long long)cyc[0], macs / comp[0],
+           (unsigned long long)cyc[1], macs / comp[1]);
+    TEST_ASSERT(comp[1] == 2 * comp[0] && cyc[1] > cyc[0],
+                "BF16/FP16 at half the INT8 MAC rate (2x compute cycles)");
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+    npu_mem_free(&mem);
+}
+
+//=============================================================================
+// FP8 / MX TEST (CONFIG.fmt FP8, REG_FP8, MX block scales)
+//=============================================================================
+
+#define FP8_ACC_K       4096
+#define FP8_ACC_ROWS    64
+
+// RMS over rows of |y - ref| / ||w_m * x||: quantisation error relative
+// to each row's own magnitude
+static double fp8_row_err(const double* y, const double* ref, const double* norm, int n) {
+    double err = 0.0;
+    for (int i = 0; i < n; i++)
+        err += (y[i] - ref[i]) * (y[i] - ref[i]) / (norm[i] * norm[i]);
+    return sqrt(err / n);
+}
+
+static int fp8_is_nan(uint8_t c, int e5m2) {
+    return e5m2 ? ((c & 0x7C) == 0x7C && (c & 3)) : (c & 0x7F) == 0x7F;
+}
+
+void test_fp8_mx(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("FP8 / MX Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    char msg[200];
+    srand(seed);
+
+    // Every finite code round-trips; encoding is round-to-nearest-even
+    // over the code table and saturates
+    int bad_rt = 0, bad_rne = 0, bad_sat = 0;
+    for (int e5m2 = 0; e5m2 < 2; e5m2++) {
+        for (int c = 0; c < 256; c++) {
+            float v = ref_fp8_to_f32((uint8_t)c, e5m2);
+            if (!fp8_is_nan((uint8_t)c, e5m2) && !isinf(v) && c != 0x80)
+                bad_rt += ref_f32_to_fp8(v, e5m2) != c;
+        }
+        for (int i = 0; i < 20000; i++) {
+            float f = fp_rand_f32(e5m2 ? 18 : 10);
+            int best = -1;
+            float best_d = INFINITY;
+            for (int c = 0; c < 128; c++) {
+                float v = ref_fp8_to_f32((uint8_t)(c | (f < 0 ? 0x80 : 0)), e5m2);
+                if (isnan(v) || isinf(v))
+                    continue;
+                float d = fabsf(v - f);
+                if (d < best_d || (d == best_d && !(c & 1))) {
+                    best_d = d;
+                    best = c | (f < 0 ? 0x80 : 0);
+                }
+            }
+            bad_rne += ref_f32_to_fp8(f, e5m2) != best;
+        }
+        uint8_t max = e5m2 ? 0x7B : 0x7E;
+        bad_sat += ref_f32_to_fp8(1e9f, e5m2) != max || ref_f32_to_fp8(-INFINITY, e5m2) != (0x80 | max);
+    }
+    sprintf(msg, "FP8 encode/decode: round trip %d, RNE %d, saturation %d mismatches",
+            bad_rt, bad_rne, bad_sat);
+    TEST_ASSERT(bad_rt == 0 && bad_rne == 0 && bad_sat == 0, msg);
+    TEST_ASSERT(ref_fp8_to_f32(0x7E, 0) == 448.0f && ref_fp8_to_f32(0x7B, 1) == 57344.0f &&
+                ref_fp8_to_f32(0x01, 0) == ldexpf(1.0f, -9) &&
+                ref_fp8_to_f32(0x01, 1) == ldexpf(1.0f, -16),
+                "E4M3 max 448, E5M2 max 57344, smallest subnormals 2^-9 / 2^-16");
+
+    // Products are exact in FP32: all code pairs vs the host, with scales
+    int bad_mul = 0;
+    for (int e5m2 = 0; e5m2 < 2; e5m2++) {
+        for (int a = 0; a < 256; a++) {
+            for (int b = 0; b < 256; b++) {
+                float fa = ref_fp8_to_f32((uint8_t)a, e5m2), fb = ref_fp8_to_f32((uint8_t)b, e5m2);
+                int sc = (a + b) % 41 - 20;
+                uint32_t got = ref_fp8_mul((uint8_t)a, (uint8_t)b, e5m2, sc);
+                float p = ldexpf(fa * fb, sc);
+                if (isnan(p))
+                    bad_mul += got != FP32_QNAN;
+                else if (p == 0.0f || isinf(p) || fabsf(p) >= FLT_MIN)
+                    bad_mul += got != ref_f32_to_u32(p);
+            }
+        }
+    }
+    sprintf(msg, "ref_fp8_mul exact on all E4M3 / E5M2 pairs with scales (%d mismatches)", bad_mul);
+    TEST_ASSERT(bad_mul == 0, msg);
+
+    // Emulator vs ref_gemm_fp8: E4M3 plain, E5M2 MX (K not a multiple of
+    // the line or block), NaN scale
+    int M = 64, K = 200, N = 3, kb = (K + MX_BLOCK - 1) / MX_BLOCK;
+    uint32_t x_addr = (uint32_t)(M * K), y_addr = x_addr + (uint32_t)(K * N);
+    uint32_t ws_addr = y_addr + (uint32_t)(M * N * 4), xs_addr = ws_addr + (uint32_t)(M * kb);
+    uint8_t*  W  = (uint8_t*)malloc((size_t)M * K);
+    uint8_t*  X  = (uint8_t*)malloc((size_t)K * N);
+    uint8_t*  ws = (uint8_t*)malloc((size_t)M * kb);
+    uint8_t*  xs = (uint8_t*)malloc((size_t)kb * N);
+    uint32_t* Y  = (uint32_t*)malloc((size_t)M * N * 4);
+    uint32_t* Yr = (uint32_t*)malloc((size_t)M * N * 4);
+    NpuMem mem;
+    NpuEmu emu;
+    NpuCmd cmds[16];
+    npu_mem_init(&mem, 1u << 20);
+    npu_emu_init(&emu, &mem);
+    for (int e5m2 = 0; e5m2 < 2; e5m2++) {
+        int mx = e5m2;
+        for (int i = 0; i < M * K; i++) W[i] = ref_f32_to_fp8(fp_rand_f32(3), e5m2);
+        for (int i = 0; i < K * N; i++) X[i] = ref_f32_to_fp8(fp_rand_f32(3), e5m2);
+        for (int i = 0; i < M * kb; i++) ws[i] = (uint8_t)(MX_SCALE_ONE - 8 + rand() % 17);
+        for (int i = 0; i < kb * N; i++) xs[i] = (uint8_t)(MX_SCALE_ONE - 8 + rand() % 17);
+        ref_gemm_fp8(W, X, mx ? ws : NULL, mx ? xs : NULL, Yr, M, K, N, e5m2);
+        npu_mem_write(&mem, 0, W, (size_t)M * K);
+        npu_mem_write(&mem, x_addr, X, (size_t)K * N);
+        npu_mem_write(&mem, ws_addr, ws, (size_t)M * kb);
+        npu_mem_write(&mem, xs_addr, xs, (size_t)kb * N);
+        npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_FMT_SET(FMT_FP8));
+        npu_emu_write_reg(&emu, NPU_REG_FP8, (e5m2 ? NPU_FP8_E5M2 : 0) | (mx ? NPU_FP8_MX : 0));
+        npu_emu_write_reg(&emu, NPU_REG_MX_W_SCALE, ws_addr);
+        npu_emu_write_reg(&emu, NPU_REG_MX_X_SCALE, xs_addr);
+        int n = npu_cmd_gemm(cmds, 0, x_addr, y_addr, M, K, N);
+        int ret = npu_emu_run(&emu, cmds, n);
+        npu_mem_read(&mem, y_addr, Y, (size_t)M * N * 4);
+        sprintf(msg, "Emulator %s GEMM %dx%dx%d bit-exact with ref_gemm_fp8",
+                e5m2 ? "E5M2 MX" : "E4M3", M, K, N);
+        TEST_ASSERT(ret == 0 && memcmp(Y, Yr, (size_t)M * N * 4) == 0, msg);
+    }
+    ws[5 * kb + 2] = MX_SCALE_NAN;
+    ref_gemm_fp8(W, X, ws, xs, Yr, M, K, N, 1);
+    TEST_ASSERT(Yr[5 * N] == FP32_QNAN && Yr[5 * N + 2] == FP32_QNAN && Yr[4 * N] != FP32_QNAN,
+                "NaN block scale makes its row NaN only");
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+    npu_emu_write_reg(&emu, NPU_REG_FP8, 0);
+    npu_mem_free(&mem);
+    free(W); free(X); free(ws); free(xs); free(Y); free(Yr);
+
+    // Accuracy vs FP64 with weight magnitudes varying by row (2^0..2^-7)
+    // and by block (outlier blocks x8): INT8 per-tensor, E4M3 unscaled,
+    // E4M3/E5M2 MX
+    int Ka = FP8_ACC_K, Ma = FP8_ACC_ROWS, kba = Ka / MX_BLOCK;
+    float*    wf  = (float*)malloc((size_t)Ma * Ka * sizeof(float));
+    float*    xf  = (float*)malloc((size_t)Ka * sizeof(float));
+    int8_t*   w8  = (int8_t*)malloc((size_t)Ma * Ka);
+    int8_t*   x8  = (int8_t*)malloc((size_t)Ka);
+    int32_t*  y8  = (int32_t*)malloc(Ma * sizeof(int32_t));
+    uint8_t*  wq  = (uint8_t*)malloc((size_t)Ma * Ka);
+    uint8_t*  xq  = (uint8_t*)malloc((size_t)Ka);
+    uint8_t*  wsa = (uint8_t*)malloc((size_t)Ma * kba);
+    uint8_t*  xsa = (uint8_t*)malloc((size_t)kba);
+    uint32_t* yq  = (uint32_t*)malloc(Ma * sizeof(uint32_t));
+    double*   ref = (double*)malloc(Ma * sizeof(double));
+    double*   got = (double*)malloc(Ma * sizeof(double));
+    double*   nrm = (double*)malloc(Ma * sizeof(double));
+    for (int i = 0; i < Ma * Ka; i++)
+        wf[i] = fp_rand_f32(0) * ldexpf(1.0f, -(i / Ka) % 8 + ((i / MX_BLOCK) % 7 == 0 ? 3 : 0));
+    for (int i = 0; i < Ka; i++)
+        xf[i] = fp_rand_f32(2);
+    for (int m = 0; m < Ma; m++) {
+        ref[m] = 0.0;
+        nrm[m] = 0.0;
+        for (int k = 0; k < Ka; k++) {
+            double p = (double)wf[(size_t)m * Ka + k] * xf[k];
+            ref[m] += p;
+            nrm[m] += p * p;
+        }
+        nrm[m] = sqrt(nrm[m]);
+    }
+    float w_max = 0.0f, x_max = 0.0f;
+    for (int i = 0; i < Ma * Ka; i++) w_max = fmaxf(w_max, fabsf(wf[i]));
+    for (int i = 0; i < Ka; i++)      x_max = fmaxf(x_max, fabsf(xf[i]));
+    float w_scale = w_max / 127.0f, x_scale = x_max / 127.0f;
+    for (int i = 0; i < Ma * Ka; i++) w8[i] = (int8_t)lrintf(wf[i] / w_scale);
+    for (int i = 0; i < Ka; i++)      x8[i] = (int8_t)lrintf(xf[i] / x_scale);
+    ref_gemv_tiled(x8, w8, y8, Ka, Ma);
+    for (int m = 0; m < Ma; m++) got[m] = (double)y8[m] * w_scale * x_scale;
+    double err_int8 = fp8_row_err(got, ref, nrm, Ma);
+
+    for (int i = 0; i < Ma * Ka; i++) wq[i] = ref_f32_to_fp8(wf[i], 0);
+    for (int i = 0; i < Ka; i++)      xq[i] = ref_f32_to_fp8(xf[i], 0);
+    ref_gemm_fp8(wq, xq, NULL, NULL, yq, Ma, Ka, 1, 0);
+    for (int m = 0; m < Ma; m++) got[m] = ref_u32_to_f32(yq[m]);
+    double err_e4m3 = fp8_row_err(got, ref, nrm, Ma);
+
+    double err_mx[2];
+    for (int e5m2 = 0; e5m2 < 2; e5m2++) {
+        for (int m = 0; m < Ma; m++)
+            ref_mx_quantize(wf + (size_t)m * Ka, Ka, e5m2, wq + (size_t)m * Ka, wsa + m * kba);
+        ref_mx_quantize(xf, Ka, e5m2, xq, xsa);
+        ref_gemm_fp8(wq, xq, wsa, xsa, yq, Ma, Ka, 1, e5m2);
+        for (int m = 0; m < Ma; m++) got[m] = ref_u32_to_f32(yq[m]);
+        err_mx[e5m2] = fp8_row_err(got, ref, nrm, Ma);
+    }
+    printf("  GEMV %dx%d row-relative RMS error: INT8 %.2e, E4M3 %.2e, MX E4M3 %.2e, MX E5M2 %.2e\n",
+           Ma, Ka, err_int8, err_e4m3, err_mx[0], err_mx[1]);
+    TEST_ASSERT(err_mx[0] < err_int8 && err_mx[0] < err_mx[1] && err_mx[0] < 5e-2,
+                "MX E4M3 beats per-tensor INT8 and MX E5M2 on row/block-varying weights");
+    free(wf); free(xf); free(w8); free(x8); free(y8);
+    free(wq); free(xq); free(wsa); free(xsa); free(yq); free(ref); free(got); free(nrm);
+
+    // Bandwidth: MX FP8 moves INT8 bytes plus one scale per 32 elements,
+    // at the INT8 compute rate
+    int Mt = 512, Kt = 1024, Nt = 1, kbt = Kt / MX_BLOCK;
+    uint32_t xt = (uint32_t)Mt * Kt * 2, yt = xt + (uint32_t)Kt * Nt * 2;
+    uint32_t st = yt + (uint32_t)Mt * Nt * 4;
+    uint64_t bytes[3], comp[3], cyc[3];
+    uint32_t cfg[3] = { NPU_CFG_FMT_SET(FMT_INT8), NPU_CFG_FMT_SET(FMT_FP8),
+                        NPU_CFG_FMT_SET(FMT_BF16) };
+    npu_mem_init(&mem, st + (uint64_t)(Mt + Nt) * kbt);
+    npu_emu_init(&emu, &mem);
+    npu_emu_write_reg(&emu, NPU_REG_FP8, NPU_FP8_MX);
+    npu_emu_write_reg(&emu, NPU_REG_MX_W_SCALE, st);
+    npu_emu_write_reg(&emu, NPU_REG_MX_X_SCALE, st + (uint32_t)(Mt * kbt));
+    memset(mem.data + st, MX_SCALE_ONE, (size_t)(Mt + Nt) * kbt);
+    for (int f = 0; f < 3; f++) {
+        npu_emu_write_reg(&emu, NPU_REG_CONFIG, cfg[f]);
+        uint64_t b0 = emu.stats.dma_bytes, k0 = emu.stats.compute_cycles, c0 = emu.stats.cycles;
+        int n = npu_cmd_gemm(cmds, 0, xt, yt, Mt, Kt, Nt);
+        npu_emu_run(&emu, cmds, n);
+        bytes[f] = emu.stats.dma_bytes - b0;
+        comp[f]  = emu.stats.compute_cycles - k0;
+        cyc[f]   = emu.stats.cycles - c0;
+    }
+    printf("  GEMV %dx%d: INT8 %llu B / %llu cycles, MX FP8 %llu B / %llu cycles, BF16 %llu B / %llu cycles\n",
+           Mt, Kt, (unsigned long long)bytes[0], (unsigned long long)cyc[0],
+           (unsigned long long)bytes[1], (unsigned long long)cyc[1],
+           (unsigned long long)bytes[2], (unsigned long long)cyc[2]);
+    TEST_ASSERT(comp[1] == comp[0] && comp[2] == 2 * comp[0] &&
+                bytes[1] == bytes[0] + (uint64_t)(Mt + Nt) * kbt,
+                "MX FP8 at the INT8 compute rate (BF16 half), INT8 bytes + one scale per 32");
+    npu_mem_free(&mem);
+}
+
+//=============================================================================
+// GEMV FAN-OUT PIPELINE TEST (gemv_subarray FANOUT_STAGES)
+//=============================================================================
+
+// The fan-out register stages cost EMU_GEMV_FANOUT_STAGES cycles per
+// buffered tile and once per streamed job (drain); report the clock gain
+// each needs to break even
+void test_gemv_fanout(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("GEMV Fan-out Pipeline Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    static const int shapes[][4] = {
+        { 256, 512, 4, 0 },                              // Buffered tiles
+        { LLAMA_HIDDEN_DIM, LLAMA_HIDDEN_DIM, 1, 1 },    // Streamed GEMV
+    };
+    int num_shapes = (int)(sizeof(shapes) / sizeof(shapes[0]));
+
+    uint64_t mem_size = (uint64_t)LLAMA_HIDDEN_DIM * LLAMA_HIDDEN_DIM + (1u << 20);
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, mem_size);
+    npu_emu_init(&emu, &mem);
+
+    for (int i = 0; i < num_shapes; i++) {
+        int M = shapes[i][0], K = shapes[i][1], N = shapes[i][2], stream = shapes[i][3];
+        uint32_t x_addr = (uint32_t)((uint64_t)M * K);
+        uint32_t y_addr = (x_addr + K * N + 63) & ~63u;
+
+        int8_t*  W     = (int8_t*)calloc((size_t)M * K, sizeof(int8_t));
+        int8_t*  X     = (int8_t*)calloc((size_t)K * N, sizeof(int8_t));
+        int32_t* Y_ref = (int32_t*)calloc((size_t)M * N, sizeof(int32_t));
+        int32_t* Y_emu = (int32_t*)calloc((size_t)M * N, sizeof(int32_t));
+
+        generate_random_i8(W, M * K, seed + i);
+        generate_random_i8(X, K * N, seed + i + 1000);
+        ref_gemm_tiled(W, X, Y_ref, M, K, N);
+        npu_mem_write(&mem, 0, W, (uint64_t)M * K);
+        npu_mem_write(&mem, x_addr, X, (uint64_t)K * N);
+
+        NpuCmd cmds[16];
+        int n = npu_cmd_gemm(cmds, 0, x_addr, y_addr, M, K, N);
+        uint64_t before = emu.stats.compute_cycles;
+        npu_emu_write_reg(&emu, NPU_REG_CONFIG, stream ? NPU_CFG_WSTREAM : 0);
+        int ret = npu_emu_run(&emu, cmds, n);
+        npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+        uint64_t compute = emu.stats.compute_cycles - before;
+        uint64_t job     = emu.stats.last_job_cycles;
+        npu_mem_read(&mem, y_addr, Y_emu, (uint64_t)M * N * sizeof(int32_t));
+
+        // Cycles the stages add to this job, and the clock ratio that
+        // makes the pipelined job as fast as the unpipelined one
+        uint64_t tiles = (uint64_t)((M + SUBARRAY_ROWS - 1) / SUBARRAY_ROWS + TOTAL_PE_UNITS - 1) /
+                         TOTAL_PE_UNITS * N * ((K + SUBARRAY_COLS - 1) / SUBARRAY_COLS);
+        uint64_t extra = (uint64_t)EMU_GEMV_FANOUT_STAGES * (stream ? 1 : tiles);
+        double   gain  = 100.0 * ((double)job / (double)(job - extra) - 1.0);
+
+        char msg[200];
+        sprintf(msg, "%s %dx%dx%d: +%llu of %llu cycles, break-even at %.2f%% higher Fmax",
+                stream ? "Streamed" : "Buffered", M, K, N, (unsigned long long)extra,
+                (unsigned long long)job, gain);
+        TEST_ASSERT(ret == 0 && memcmp(Y_emu, Y_ref, (size_t)M * N * sizeof(int32_t)) == 0 &&
+                    compute == (stream ? (uint64_t)EMU_STREAM_DRAIN_CYCLES
+                                       : tiles * EMU_TILE_CYCLES) &&
+                    (stream ? gain < 0.01 : gain > 0.0), msg);
+
+        free(W);
+        free(X);
+        free(Y_ref);
+        free(Y_emu);
+    }
+    npu_mem_free(&mem);
+}
+
+//=============================================================================
+// TOP-K SAMPLING TEST (LM head, CONFIG.topk)
+//=============================================================================
+
+#define TOPK_HIDDEN  (LLAMA_HIDDEN_DIM / 8)   // 1/8-scale hidden, full vocab
+
+// LM-head GEMV over the full vocabulary: read back all logits and pick on
+// the host, versus the on-chip top-k returning K pairs. Also checks ties
+// (duplicated weight rows), batch-1 streaming with K = 1 (argmax) and the
+// rejected configurations.
+void test_topk_sampling(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Top-K Sampling Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    int M = LLAMA_VOCAB, K = TOPK_HIDDEN;
+    uint64_t w_bytes = (uint64_t)M * K;
+    uint32_t x_addr = (uint32_t)w_bytes;
+    uint32_t y_addr = x_addr + 0x1000;
+
+    int8_t*  W     = (int8_t*)calloc(w_bytes, 1);
+    int8_t*  x     = (int8_t*)calloc(K, 1);
+    int32_t* Y_ref = (int32_t*)calloc(M, sizeof(int32_t));
+    int32_t* Y_emu = (int32_t*)calloc(M, sizeof(int32_t));
+    generate_random_i8(W, (int)w_bytes, seed);
+    generate_random_i8(x, K, seed + 1000);
+    ref_gemm_fast(W, x, Y_ref, M, K, 1);
+
+    int32_t ref_idx[NPU_TOPK_MAX], ref_val[NPU_TOPK_MAX];
+    ref_topk(Y_ref, M, NPU_TOPK_MAX, ref_idx, ref_val);
+
+    NpuMem mem;
+    NpuEmu emu;
+    npu_mem_init(&mem, w_bytes + (1u << 20));
+    npu_emu_init(&emu, &mem);
+    npu_mem_write(&mem, 0, W, w_bytes);
+    npu_mem_write(&mem, x_addr, x, K);
+
+    // Full logits, argmax on the host
+    NpuCmd cmds[16];
+    int n = npu_cmd_gemm(cmds, 0, x_addr, y_addr, M, K, 1);
+    uint64_t bytes0 = emu.stats.dma_bytes;
+    int ret = npu_emu_run(&emu, cmds, n);
+    uint64_t full_cycles = emu.stats.last_job_cycles;
+    uint64_t full_bytes  = emu.stats.dma_bytes - bytes0 - w_bytes - K;
+    npu_mem_read(&mem, y_addr, Y_emu, (uint64_t)M * sizeof(int32_t));
+    int argmax = 0;
+    for (int i = 1; i < M; i++)
+        if (Y_emu[i] > Y_emu[argmax]) argmax = i;
+
+    // On-chip top-k
+    int32_t pairs[2 * NPU_TOPK_MAX];
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_TOPK);
+    npu_emu_write_reg(&emu, NPU_REG_TOPK, NPU_TOPK_MAX);
+    bytes0 = emu.stats.dma_bytes;
+    ret |= npu_emu_run(&emu, cmds, n);
+    uint64_t topk_cycles = emu.stats.last_job_cycles;
+    uint64_t topk_bytes  = emu.stats.dma_bytes - bytes0 - w_bytes - K;
+    npu_mem_read(&mem, y_addr, pairs, sizeof(pairs));
+
+    int match = 1;
+    for (int i = 0; i < NPU_TOPK_MAX; i++)
+        match &= (pairs[2 * i] == ref_idx[i] && pairs[2 * i + 1] == ref_val[i]);
+
+    char msg[200];
+    sprintf(msg, "LM head %dx%d top-%d: %llu B readback vs %llu B (%llu vs %llu cycles)",
+            M, K, NPU_TOPK_MAX, (unsigned long long)topk_bytes,
+            (unsigned long long)full_bytes, (unsigned long long)topk_cycles,
+            (unsigned long long)full_cycles);
+    TEST_ASSERT(ret == 0 && match && pairs[0] == argmax &&
+                topk_bytes == NPU_TOPK_MAX * 8 && topk_cycles < full_cycles, msg);
+
+    // Batch-1 streaming, K = 1: argmax only
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_TOPK | NPU_CFG_WSTREAM);
+    npu_emu_write_reg(&emu, NPU_REG_TOPK, 1);
+    ret = npu_emu_run(&emu, cmds, n);
+    npu_mem_read(&mem, y_addr, pairs, 8);
+    sprintf(msg, "Streamed LM head argmax (token %d, %llu cycles)",
+            pairs[0], (unsigned long long)emu.stats.last_job_cycles);
+    TEST_ASSERT(ret == 0 && pairs[0] == argmax && pairs[1] == Y_ref[argmax], msg);
+
+    // Ties: rows 2i and 2i+1 identical, the lower index must come first
+    int tm = 64, tk = 32;
+    int32_t Y_tie[64], tie_idx[NPU_TOPK_MAX], tie_val[NPU_TOPK_MAX];
+    for (int r = 1; r < tm; r += 2)
+        memcpy(&W[r * tk], &W[(r - 1) * tk], tk);
+    ref_gemm_fast(W, x, Y_tie, tm, tk, 1);
+    ref_topk(Y_tie, tm, NPU_TOPK_MAX, tie_idx, tie_val);
+    npu_mem_write(&mem, 0, W, (uint64_t)tm * tk);
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, NPU_CFG_TOPK);
+    npu_emu_write_reg(&emu, NPU_REG_TOPK, NPU_TOPK_MAX);
+    n = npu_cmd_gemm(cmds, 0, x_addr, y_addr, tm, tk, 1);
+    ret = npu_emu_run(&emu, cmds, n);
+    npu_mem_read(&mem, y_addr, pairs, sizeof(pairs));
+    match = 1;
+    for (int i = 0; i < NPU_TOPK_MAX; i++)
+        match &= (pairs[2 * i] == tie_idx[i] && pairs[2 * i + 1] == tie_val[i]);
+    TEST_ASSERT(ret == 0 && match && (tie_idx[0] & 1) == 0 &&
+                tie_idx[1] == tie_idx[0] + 1, "Tied logits: lower index first");
+
+    // Rejected: K out of range, N > 1, top-k with chained output
+    static const uint32_t bad[][3] = {
+        { NPU_CFG_TOPK, 0, 1 },
+        { NPU_CFG_TOPK, NPU_TOPK_MAX + 1, 1 },
+        { NPU_CFG_TOPK, 4, 2 },
+        { NPU_CFG_TOPK | NPU_CFG_CHAIN_OUT, 4, 1 },
+    };
+    int rejected = 0;
+    for (int i = 0; i < 4; i++) {
+        npu_emu_write_reg(&emu, NPU_REG_CONFIG, bad[i][0]);
+        npu_emu_write_reg(&emu, NPU_REG_TOPK, bad[i][1]);
+        n = npu_cmd_gemm(cmds, 0, x_addr, y_addr, tm, tk, (int)bad[i][2]);
+        rejected += npu_emu_run(&emu, cmds, n) != 0;
+    }
+    npu_emu_write_reg(&emu, NPU_REG_CONFIG, 0);
+    TEST_ASSERT(rejected == 4, "Top-k rejects K = 0, K > max, N > 1 and chain_out");
+
+    npu_mem_free(&mem);
+    free(W);
+    free(x);
+    free(Y_ref);
+    free(Y_emu);
+}
+
+//=============================================================================
+// MULTI-NPU TEST (system address decode + tensor-parallel GEMV)
+//=============================================================================
+
+#define MULTI_TEST_MEM_SIZE (4u << 20)
+
+void test_multi_npu(int seed) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Multi-NPU Tensor-Parallel Test (seed=%d)\n", seed);
+    printf("=============================================================\n");
+
+    NpuMem mem;
+    NpuSystem sys;
+    npu_mem_init(&mem, MULTI_TEST_MEM_SIZE);
+    npu_sys_init(&sys, &mem, 4);
+
+    // Register windows: instance i at i << NPU_DEV_ADDR_SHIFT
+    npu_sys_write_reg(&sys, (2u << NPU_DEV_ADDR_SHIFT) | NPU_REG_DIM_M, 123);
+    npu_sys_write_reg(&sys, (6u << NPU_DEV_ADDR_SHIFT) | NPU_REG_DIM_M, 77);
+    TEST_ASSERT(npu_emu_read_reg(&sys.dev[2], NPU_REG_DIM_M) == 123 &&
+                npu_emu_read_reg(&sys.dev[1], NPU_REG_DIM_M) == 0 &&
+                npu_sys_read_reg(&sys, (6u << NPU_DEV_ADDR_SHIFT) | NPU_REG_DIM_M) == 0,
+                "System address decode (instance select, unmapped window)");
+
+    static const struct { NpuSplit split; int parts; int M, K; } cases[] = {
+        { NPU_SPLIT_COL, 4, 300, 200 },   // Ragged row shards
+        { NPU_SPLIT_COL, 3, 256, 64 },
+        { NPU_SPLIT_ROW, 4, 300, 200 },   // Ragged K shards + reduce
+        { NPU_SPLIT_ROW, 2, 96, 1000 },
+        { NPU_SPLIT_ROW, 1, 64, 40 },     // Single shard: no reduce
+    };
+    int num_cases = (int)(sizeof(cases) / sizeof(cases[0]));
+
+    for (int i = 0; i < num_cases; i++) {
+        int M = cases[i].M, K = cases[i].K;
+
+        int8_t*  W     = (int8_t*)calloc(M * K, sizeof(int8_t));
+        int8_t*  x     = (int8_t*)calloc(K, sizeof(int8_t));
+        int32_t* Y_ref = (int32_t*)calloc(M, sizeof(int32_t));
+        int32_t* Y_sys = (int32_t*)calloc(M, sizeof(int32_t));
+
+        generate_random_i8(W, M * K, seed + i);
+        generate_random_i8(x, K, seed + i + 1000);
+        ref_gemm_tiled(W, x, Y_ref, M, K, 1);
+
+        npu_heap_init(&sys.heap, 0, mem.size);
+        uint64_t x_addr = npu_heap_alloc(&sys.heap, K, 64);
+        uint64_t y_addr = npu_heap_alloc(&sys.heap, M * sizeof(int32_t), 64);
+        npu_mem_write(&mem, x_addr, x, K);
+
+        NpuTpLayer layer;
+        int ret = npu_tp_layer_init(&sys, &layer, W, M, K, cases[i].split, cases[i].parts);
+        if (ret == 0) ret = npu_tp_gemv(&sys, &layer, x_addr, y_addr);
+        npu_mem_read(&mem, y_addr, Y_sys, M * sizeof(int32_t));
+
+        char msg[128];
+        sprintf(msg, "%s split x%d vs tiled ref (%dx%d)",
+                cases[i].split == NPU_SPLIT_COL ? "Column" : "Row",
+                cases[i].parts, M, K);
+        TEST_ASSERT(ret == 0 && memcmp(Y_sys, Y_ref, M * sizeof(int32_t)) == 0, msg);
+
+        free(W);
+        free(x);
+        free(Y_ref);
+        free(Y_sys);
+    }
+
+    npu_sys_print_stats(&sys, "test_multi_npu");
+    npu_mem_free(&mem);
+}
+
+//=============================================================================
+// MULTI-NPU SCALING BENCHMARK (one decoder layer, 1/2/4/8 instances)
+//=============================================================================
+
+// Megatron-style partitioning: Q/K/V/gate/up column split (no communication),
+// O/down row split (partial sums reduced over the bus). Weights are left
+// zero: timing only depends on shapes.
+// Speedup at 2/4/8 instances: ./npu_ref --bench-scaling (LLaMA-7B) prints
+// 2.00x / 3.99x / 4.13x, the default run (1/8 scale) 1.94x / 3.78x / 4.04x
+void bench_multi_scaling(int hidden, int inter, const char* label) {
+    printf("\n");
+    printf("=============================================================\n");
+    printf("Multi-NPU Scaling Benchmark: %s (hidden=%d, inter=%d)\n",
+           label, hidden, inter);
+    printf("  Shared bus: %d B/cycle, per-instance DMA: %d B/cycle\n",
+           EMU_BUS_BYTES_PER_CYCLE, EMU_DMA_BYTES_PER_CYCLE);
+    printf("=============================================================\n");
+
+    struct { int M, K; NpuSplit split; int from_h; } proj[7] = {
+        { hidden, hidden, NPU_SPLIT_COL, 0 },  // Q
+        { hidden, hidden, NPU_SPLIT_COL, 0 },  // K
+        { hidden, hidden, NPU_SPLIT_COL, 0 },  // V
+        { hidden, hidden, NPU_SPLIT_ROW, 0 },  // O
+        { inter,  hidden, NPU_SPLIT_COL, 0 },  // gate
+        { inter,  hidden, NPU_SPLIT_COL, 0 },  // up
+        { hidden, inter,  NPU_SPLIT_ROW, 1 },  // down
+    };
+
+    uint64_t w_total  = 4 * (uint64_t)hidden * hidden + 3 * (uint64_t)inter * hidden;
+    uint64_t mem_size = w_total + 64 * ((uint64_t)hidden + inter) + (1u << 16);
+
+    static const int counts[] = { 1, 2, 4, 8 };
+    uint64_t base_cycles = 0;
+    int saturated_at = 0;
+
+    printf("  Instances | Cycles/layer | Speedup | Bus util | Bus stall | Reduce\n");
+    for (int c = 0; c < 4; c++) {
+        int n = counts[c];
+        NpuMem mem;
+        NpuSystem sys;
+        if (npu_mem_init(&mem, mem_size) != 0) {
+            printf("  ERROR: Cannot allocate emulator memory\n");
+            return;
+        }
+        npu_sys_init(&sys, &mem, n);
+
+        uint64_t x_addr = npu_heap_alloc(&sys.heap, inter, 64);
+        uint64_t h_addr = npu_heap_alloc(&sys.heap, inter, 64);
+        uint64_t y_addr = npu_heap_alloc(&sys.heap, (uint64_t)inter * sizeof(int32_t), 64);
+
+        int ret = 0;
+        for (int p = 0; p < 7 && ret == 0; p++) {
+            NpuTpLayer layer;
+            ret = npu_tp_layer_init(&sys, &layer, NULL, proj[p].M, proj[p].K,
+                                    proj[p].split, n);
+            if (ret == 0)
+                ret = npu_tp_gemv(&sys, &layer, proj[p].from_h ? h_addr : x_addr, y_addr);
+        }
+        if (ret != 0) {
+            printf("  ERROR: %d-instance run failed\n", n);
+            npu_mem_free(&mem);
+            return;
+        }
+
+        if (n == 1) base_cycles = sys.cycles;
+        double bus_util = 100.0 * (double)sys.bus_bytes /
+                          ((double)sys.cycles * EMU_BUS_BYTES_PER_CYCLE);
+        if (!saturated_at && sys.bus_stall_cycles * 20 > sys.cycles)
+            saturated_at = n;
+
+        printf("  %9d | %12llu | %6.2fx | %7.1f%% | %9llu | %llu\n", n,
+               (unsigned long long)sys.cycles, (double)base_cycles / sys.cycles,
+               bus_util, (unsigned long long)sys.bus_stall_cycles,
+               (unsigned long long)sys.reduce_cycles);
+        npu_mem_free(&mem);
+    }
+
+    if (saturated_at)
+        printf("  Interconnect saturates at %d instances (bus stall > 5%% of layer time)\n",
+               saturated_at);
+    else
+        printf("  Interconnect not saturated up to 8 instances\n");
+}
+
+//=============================================================================
+// MAIN
+//=============================================================================
+
+int main(int argc, char* argv[]) {
+    int seed = 42;
+
+    // Sharded golden-data generation mode
+    if (argc > 5 && strcmp(argv[1], "--shard") == 0) {
+        int resume = 0, tiles_per_shard = 4;
+        for (int i = 6; i < argc; i++) {
+            if (strcmp(argv[i], "--resume") == 0)
+                resume = 1;
+            else if (strcmp(argv[i], "--tiles") == 0 && i + 1 < argc)
+                tiles_per_shard = atoi(argv[++i]);
+            else
+                seed = atoi(argv[i]);
+        }
+        if (tiles_per_shard < 1) {
+            printf("Error: --tiles must be at least 1\n");
+            return 1;
+        }
+
+        char prefix[128];
+        sprintf(prefix, HEX_DIR "gemm_big_s%d", seed);
+        ShardJob job = { atoll(argv[2]), atoi(argv[3]), atoi(argv[4]),
+                         seed, tiles_per_shard, atoi(argv[5]), prefix };
+        return (shard_generate(&job, resume) < 0) ? 1 : 0;
+    }
+
+    // Full-size LLaMA-7B decode step on the functional emulator
+    if (argc > 1 && strcmp(argv[1], "--emu-llama") == 0) {
+        int layers = (argc > 2) ? atoi(argv[2]) : 32;
+        bench_emu_decoder(LLAMA_HIDDEN_DIM, LLAMA_INTERMEDIATE, layers, 0, "LLaMA-7B");
+        bench_emu_decoder(LLAMA_HIDDEN_DIM, LLAMA_INTERMEDIATE, layers, 1, "LLaMA-7B");
+        return 0;
+    }
+
+    // Multi-NPU tensor-parallel scaling on LLaMA-7B layer shapes
+    if (argc > 1 && strcmp(argv[1], "--bench-scaling") == 0) {
+        bench_multi_scaling(LLAMA_HIDDEN_DIM, LLAMA_INTERMEDIATE, "LLaMA-7B");
+        return 0;
+    }
+
+    // Trace dump (trace_unit_tb trace_dump.hex) → timeline
+    if (argc > 2 && strcmp(argv[1], "--trace-decode") == 0) {
+        static uint32_t ring[2 * NPU_TRACE_DEPTH];
+        static NpuTraceEvent ev[NPU_TRACE_DEPTH];
+        uint32_t status, dropped;
+        int depth = npu_trace_load_hex(argv[2], ring, NPU_TRACE_DEPTH, &status, &dropped);
+        if (depth <= 0)
+            return 1;
+        int count = npu_trace_decode(ring, depth, status, ev);
+        printf("# %d entries (depth %d), wrapped=%d triggered=%d stopped=%d dropped=%u\n",
+               count, depth, (status & NPU_TRACE_WRAPPED) != 0, (status & NPU_TRACE_TRIGGERED) != 0,
+               (status & NPU_TRACE_STOPPED) != 0, dropped);
+        npu_trace_print(stdout, ev, count);
+        return 0;
+    }
+
+    if (argc > 1) seed = atoi(argv[1]);
+
+    printf("\n");
+    printf("*************************************************************\n");
+    printf("*     NPU Reference Model - Seed-based Test Generator       *\n");
+    printf("*************************************************************\n");
+    printf("\n");
+    printf("  Seed: %d\n", seed);
+    printf("  Sub-array: %d x %d\n", SUBARRAY_ROWS, SUBARRAY_COLS);
+    printf("  Data types: INT8 input/weight, INT32 accumulator\n");
+
+    //=========================================================================
+    // MAC Unit Hex Generation
+    //=========================================================================
+    printf("\n\n>>> MAC UNIT HEX GENERATION <<<\n");
+    generate_mac_test_hex(seed);
+
+    //=========================================================================
+    // GEMV Sub-array Hex Generation (for gemv_subarray_tb)
+    //=========================================================================
+    printf("\n\n>>> GEMV SUB-ARRAY HEX GENERATION <<<\n");
+    generate_gemv_subarray_test_hex(seed);
+
+    //=========================================================================
+    // GEMV Ctrl Test Hex Generation (for gemv_ctrl_tb)
+    //=========================================================================
+    printf("\n\n>>> GEMV CTRL TEST HEX GENERATION <<<\n");
+    generate_gemv_ctrl_test_hex(seed);
+
+    //=========================================================================
+    // Requant Unit Hex Generation (for requant_unit_tb)
+    //=========================================================================
+    printf("\n\n>>> REQUANT UNIT HEX GENERATION <<<\n");
+    generate_requant_test_hex(seed);
+
+    printf("\n\n>>> KV BLOCK WALKER HEX GENERATION <<<\n");
+    generate_kv_walker_test_hex(seed);
+
+    printf("\n\n>>> IOMMU TLB HEX GENERATION <<<\n");
+    generate_iommu_tlb_test_hex(seed);
+
+    printf("\n\n>>> ROPE UNIT HEX GENERATION <<<\n");
+    generate_rope_test_hex(seed);
+
+    printf("\n\n>>> EMBEDDING GATHER HEX GENERATION <<<\n");
+    generate_embed_gather_test_hex(seed);
+
+    printf("\n\n>>> TOP-K UNIT HEX GENERATION <<<\n");
+    generate_topk_test_hex(seed);
+
+    printf("\n\n>>> PREEMPTION HEX GENERATION <<<\n");
+    generate_preempt_test_hex(seed);
+
+    printf("\n\n>>> TRACE UNIT HEX GENERATION <<<\n");
+    generate_trace_test_hex(seed);
+
+    printf("\n\n>>> AXI4 BUFFER WINDOW HEX GENERATION <<<\n");
+    generate_axi_buf_test_hex(seed);
+
+    printf("\n\n>>> ACCUMULATOR WIDTH HEX GENERATION <<<\n");
+    generate_acc_test_hex(seed);
+
+    printf("\n\n>>> FP MAC HEX GENERATION <<<\n");
+    generate_fp_test_hex(seed);
+
+    printf("\n\n>>> FP8 / MX HEX GENERATION <<<\n");
+    generate_fp8_test_hex(seed);
+
+    //=========================================================================
+    // GEMV Tests (various dimensions, tiled vs direct verification)
+    //=========================================================================
+    printf("\n\n>>> GEMV TESTS <<<\n");
+
+    // Single sub-array size (32x8)
+    test_gemv(seed,     SUBARRAY_COLS, SUBARRAY_ROWS);
+    // Tiling in input dimension (32x32)
+    test_gemv(seed + 1, 32, SUBARRAY_ROWS);
     // Tiling in both dimensions (64x128)
     test_gemv(seed + 2, 64, 128);
 
@@ -455,6 +3954,61 @@ int main(int argc, char* argv[]) {
     // Large
     test_gemm(seed + 2, 128, 64, 128);
 
+    //=========================================================================
+    // Tile hashes (compare-by-hash golden outputs)
+    //=========================================================================
+    printf("\n\n>>> TILE HASH TESTS <<<\n");
+
+    test_tile_hash(seed, 128, 64, 128);
+
+    //=========================================================================
+    // Incremental GEMM (dirty rows of A / cols of B only)
+    //=========================================================================
+    printf("\n\n>>> INCREMENTAL GEMM TESTS <<<\n");
+
+    test_gemm_incremental(seed, 128, 64, 128);
+
+    //=========================================================================
+    // Sharded GEMM generation (coordinator + forked workers)
+    //=========================================================================
+    printf("\n\n>>> SHARDED GEMM TESTS <<<\n");
+
+    test_gemm_sharded(seed, 200, 40, 24);
+
+    //=========================================================================
+    // Functional emulator (command stream execution + cycle model)
+    //=========================================================================
+    printf("\n\n>>> EMULATOR TESTS <<<\n");
+
+    test_emu(seed);
+    bench_emu_decoder(512, 1376, 2, 0, "LLaMA-shaped (1/8 scale)");
+    bench_emu_decoder(512, 1376, 2, 1, "LLaMA-shaped (1/8 scale)");
+    test_gemv_fused(seed);
+    test_layer_chain(seed);
+    test_weight_stream(seed);
+    test_weight_prefetch(seed);
+    test_kv_paged(seed);
+    test_zero_copy(seed);
+    test_embed_gather(seed);
+    test_rope(seed);
+    test_topk_sampling(seed);
+    test_preemption(seed);
+    test_serving(seed);
+    test_memory_plan(seed);
+    test_trace(seed);
+    test_acc_width(seed);
+    test_fp_mac(seed);
+    test_fp8_mx(seed);
+    test_gemv_fanout(seed);
+
+    //=========================================================================
+    // Multi-NPU (shared interconnect, tensor-parallel partitioning)
+    //=========================================================================
+    printf("\n\n>>> MULTI-NPU TESTS <<<\n");
+
+    test_multi_npu(seed);
+    bench_multi_scaling(512, 1376, "LLaMA-shaped (1/8 scale)");
+
     //=========================================================================
     // Summary
     //=========================================================================
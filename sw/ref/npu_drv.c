@@ -0,0 +1,295 @@
+//-----------------------------------------------------------------------------
+// NPU Multi-Instance Driver
+// Description: Register access, memory allocation and tensor-parallel GEMV
+//              on a system of NpuEmu instances sharing one NpuMem
+//              Per-instance timing comes from the emulator cycle model; the
+//              shared interconnect is modelled as one bandwidth limit over
+//              all instances running in the same phase
+//-----------------------------------------------------------------------------
+
+#include "npu_drv.h"
+
+//-----------------------------------------------------------------------------
+// Bump Allocator
+//-----------------------------------------------------------------------------
+
+void npu_heap_init(NpuHeap* heap, uint64_t base, uint64_t limit) {
+    heap->top   = base;
+    heap->limit = limit;
+}
+
+uint64_t npu_heap_alloc(NpuHeap* heap, uint64_t bytes, uint64_t align) {
+    uint64_t addr = (heap->top + align - 1) & ~(align - 1);
+    if (addr > heap->limit || bytes > heap->limit - addr)
+        return NPU_HEAP_FAIL;
+    heap->top = addr + bytes;
+    return addr;
+}
+
+//-----------------------------------------------------------------------------
+// System / Register Decode
+//-----------------------------------------------------------------------------
+
+#define DEV_ADDR_MASK ((1u << NPU_DEV_ADDR_SHIFT) - 1)
+
+int npu_sys_init(NpuSystem* sys, NpuMem* mem, int num_devs) {
+    if (num_devs < 1 || num_devs > NPU_MAX_DEVICES)
+        return -1;
+    memset(sys, 0, sizeof(*sys));
+    sys->num_devs = num_devs;
+    sys->mem      = mem;
+    for (int d = 0; d < num_devs; d++)
+        npu_emu_init(&sys->dev[d], mem);
+    npu_heap_init(&sys->heap, 0, mem->size);
+    return 0;
+}
+
+// Writes past the last instance are dropped (DECERR in hardware)
+void npu_sys_write_reg(NpuSystem* sys, uint32_t addr, uint32_t value) {
+    uint32_t d = addr >> NPU_DEV_ADDR_SHIFT;
+    if (d < (uint32_t)sys->num_devs)
+        npu_emu_write_reg(&sys->dev[d], addr & DEV_ADDR_MASK, value);
+}
+
+uint32_t npu_sys_read_reg(NpuSystem* sys, uint32_t addr) {
+    uint32_t d = addr >> NPU_DEV_ADDR_SHIFT;
+    if (d >= (uint32_t)sys->num_devs)
+        return 0;
+    return npu_emu_read_reg(&sys->dev[d], addr & DEV_ADDR_MASK);
+}
+
+// Issue a command stream to instance `d` through the system address map
+static int sys_run(NpuSystem* sys, int d, const NpuCmd* cmds, int count) {
+    uint32_t base = (uint32_t)d << NPU_DEV_ADDR_SHIFT;
+    for (int i = 0; i < count; i++) {
+        switch (cmds[i].op) {
+            case NPU_CMD_END:
+                return 0;
+            case NPU_CMD_WRITE_REG:
+                npu_sys_write_reg(sys, base | cmds[i].addr, cmds[i].data);
+                break;
+            case NPU_CMD_WAIT_DONE:
+                if (npu_sys_read_reg(sys, base | NPU_REG_STATUS) & NPU_STATUS_ERROR)
+                    return -1;
+                break;
+            default:
+                return -1;
+        }
+    }
+    return 0;
+}
+
+static uint64_t bus_cycles(uint64_t bytes) {
+    return (bytes + EMU_BUS_BYTES_PER_CYCLE - 1) / EMU_BUS_BYTES_PER_CYCLE;
+}
+
+//-----------------------------------------------------------------------------
+// Tensor-Parallel Layers
+//-----------------------------------------------------------------------------
+
+// Split in whole tiles (SUBARRAY_ROWS rows / SUBARRAY_COLS cols) so no
+// instance pays for a partial tile that another instance also pays for
+int npu_tp_layer_init(NpuSystem* sys, NpuTpLayer* layer, const int8_t* W,
+                      int M, int K, NpuSplit split, int parts) {
+    if (parts < 1 || parts > sys->num_devs || M <= 0 || K <= 0)
+        return -1;
+
+    memset(layer, 0, sizeof(*layer));
+    layer->split = split;
+    layer->parts = parts;
+    layer->M     = M;
+    layer->K     = K;
+
+    int dim   = (split == NPU_SPLIT_COL) ? M : K;
+    int unit  = (split == NPU_SPLIT_COL) ? SUBARRAY_ROWS : SUBARRAY_COLS;
+    int units = (dim + unit - 1) / unit;
+
+    for (int d = 0; d < parts; d++) {
+        int b = (int)((int64_t)units * d / parts) * unit;
+        int e = (int)((int64_t)units * (d + 1) / parts) * unit;
+        layer->begin[d] = (b < dim) ? b : dim;
+        layer->end[d]   = (e < dim) ? e : dim;
+
+        int len = layer->end[d] - layer->begin[d];
+        if (len == 0) continue;
+
+        uint64_t w_bytes = (uint64_t)len * ((split == NPU_SPLIT_COL) ? K : M);
+        layer->w_addr[d] = npu_heap_alloc(&sys->heap, w_bytes, 64);
+        if (layer->w_addr[d] == NPU_HEAP_FAIL)
+            return -1;
+
+        if (split == NPU_SPLIT_ROW) {
+            layer->p_addr[d] = npu_heap_alloc(&sys->heap, (uint64_t)M * sizeof(int32_t), 64);
+            if (layer->p_addr[d] == NPU_HEAP_FAIL)
+                return -1;
+        }
+
+        if (W == NULL) continue;
+
+        int8_t* dst = (int8_t*)(sys->mem->data + layer->w_addr[d]);
+        if (split == NPU_SPLIT_COL) {
+            memcpy(dst, W + (int64_t)layer->begin[d] * K, w_bytes);
+        } else {
+            for (int r = 0; r < M; r++)
+                memcpy(dst + (int64_t)r * len, W + (int64_t)r * K + layer->begin[d], len);
+        }
+    }
+    return 0;
+}
+
+int npu_tp_gemv(NpuSystem* sys, const NpuTpLayer* layer,
+                uint64_t x_addr, uint64_t y_addr) {
+    int active = 0;
+    for (int d = 0; d < layer->parts; d++)
+        active += (layer->end[d] > layer->begin[d]);
+    int reduce = (layer->split == NPU_SPLIT_ROW && active > 1);
+
+    //-------------------------------------------------------------------------
+    // Parallel phase: every instance runs its shard
+    //-------------------------------------------------------------------------
+    uint64_t slowest = 0;
+    uint64_t traffic = 0;
+
+    for (int d = 0; d < layer->parts; d++) {
+        int len = layer->end[d] - layer->begin[d];
+        if (len == 0) continue;
+
+        int M, K;
+        uint64_t x, y;
+        if (layer->split == NPU_SPLIT_COL) {
+            M = len;
+            K = layer->K;
+            x = x_addr;
+            y = y_addr + (uint64_t)layer->begin[d] * sizeof(int32_t);
+        } else {
+            M = layer->M;
+            K = len;
+            x = x_addr + (uint64_t)layer->begin[d];
+            y = reduce ? layer->p_addr[d] : y_addr;
+        }
+
+        NpuEmu* emu = &sys->dev[d];
+        uint64_t bytes_before = emu->stats.dma_bytes;
+
+        NpuCmd cmds[8];
+        int n = npu_cmd_gemm(cmds, (uint32_t)layer->w_addr[d], (uint32_t)x,
+                             (uint32_t)y, M, K, 1);
+        if (sys_run(sys, d, cmds, n) != 0)
+            return -1;
+
+        if (emu->stats.last_job_cycles > slowest)
+            slowest = emu->stats.last_job_cycles;
+        traffic += emu->stats.dma_bytes - bytes_before;
+    }
+
+    uint64_t phase = bus_cycles(traffic);
+    if (phase < slowest) phase = slowest;
+
+    sys->cycles           += phase;
+    sys->bus_bytes        += traffic;
+    sys->bus_stall_cycles += phase - slowest;
+    sys->phases++;
+
+    //-------------------------------------------------------------------------
+    // Reduce phase (row split): Y = sum of partials, streamed over the bus
+    //-------------------------------------------------------------------------
+    if (reduce) {
+        int32_t* Y = (int32_t*)(sys->mem->data + y_addr);
+        memset(Y, 0, (size_t)layer->M * sizeof(int32_t));
+        for (int d = 0; d < layer->parts; d++) {
+            if (layer->end[d] == layer->begin[d]) continue;
+            const int32_t* P = (const int32_t*)(sys->mem->data + layer->p_addr[d]);
+            for (int r = 0; r < layer->M; r++)
+                Y[r] += P[r];
+        }
+
+        uint64_t bytes = (uint64_t)(active + 1) * layer->M * sizeof(int32_t);
+        uint64_t cycles = EMU_REDUCE_SETUP_CYCLES + bus_cycles(bytes);
+        sys->cycles        += cycles;
+        sys->reduce_cycles += cycles;
+        sys->bus_bytes     += bytes;
+    }
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Zero-Copy Buffers
+//-----------------------------------------------------------------------------
+
+int npu_iommu_map(NpuMem* mem, uint64_t pt, uint32_t iova,
+                  const uint32_t* page_addr, int num_pages) {
+    if (iova & (NPU_PAGE_SIZE - 1))
+        return -1;
+    uint64_t vpn = iova >> NPU_PAGE_SHIFT;
+    for (int i = 0; i < num_pages; i++) {
+        if (page_addr[i] & (NPU_PAGE_SIZE - 1))
+            return -1;
+        uint32_t pte = page_addr[i] | NPU_PTE_VALID;
+        if (npu_mem_write(mem, pt + (vpn + i) * 4, &pte, 4) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+int npu_sg_build(NpuMem* mem, uint32_t desc_addr, const uint32_t* chunk_addr,
+                 const uint32_t* chunk_len, int count) {
+    for (int i = 0; i < count; i++) {
+        uint32_t here = desc_addr + (uint32_t)(i * sizeof(NpuSgDesc));
+        NpuSgDesc d = { chunk_addr[i], chunk_len[i],
+                        (i + 1 < count) ? here + (uint32_t)sizeof(NpuSgDesc) : 0, 0 };
+        if (npu_mem_write(mem, here, &d, sizeof(d)) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Priority Scheduling
+//-----------------------------------------------------------------------------
+
+int npu_run_urgent(NpuEmu* emu, const NpuCmd* bg, int bg_n,
+                   const NpuCmd* urgent, int urgent_n, uint32_t ctx_addr,
+                   uint64_t arrival, int preempt, uint64_t* latency) {
+    NpuCmd cmds[4];
+    int n = preempt ? npu_cmd_preempt(cmds, ctx_addr, (uint32_t)arrival) : 0;
+    if (npu_emu_run(emu, cmds, n) != 0 || npu_emu_run(emu, bg, bg_n) != 0)
+        return -1;
+
+    // Until the background job stops (preempted) or finishes
+    uint64_t bg_cycles = emu->stats.last_job_cycles;
+    int stopped = (npu_emu_read_reg(emu, NPU_REG_STATUS) & NPU_STATUS_PREEMPTED) != 0;
+    if (npu_emu_run(emu, urgent, urgent_n) != 0)
+        return -1;
+    *latency = (bg_cycles > arrival ? bg_cycles - arrival : 0) + emu->stats.last_job_cycles;
+
+    if (!stopped)
+        return 0;
+    n = npu_cmd_resume(cmds, ctx_addr);
+    return npu_emu_run(emu, cmds, n);
+}
+
+//-----------------------------------------------------------------------------
+// Reporting
+//-----------------------------------------------------------------------------
+
+void npu_sys_print_stats(const NpuSystem* sys, const char* label) {
+    uint64_t macs = 0;
+    for (int d = 0; d < sys->num_devs; d++)
+        macs += sys->dev[d].stats.macs;
+
+    double bus_util = sys->cycles ? 100.0 * (double)sys->bus_bytes /
+                      ((double)sys->cycles * EMU_BUS_BYTES_PER_CYCLE) : 0.0;
+    double mac_util = sys->cycles ? 100.0 * (double)macs /
+                      ((double)sys->cycles * TOTAL_MACS * sys->num_devs) : 0.0;
+
+    printf("  --- System Stats: %s (%d instances) ---\n", label, sys->num_devs);
+    printf("  Modelled cycles : %llu  (%.1f us @ %d MHz)\n",
+           (unsigned long long)sys->cycles,
+           (double)sys->cycles / EMU_CLOCK_MHZ, EMU_CLOCK_MHZ);
+    printf("  Bus stall       : %llu cycles\n", (unsigned long long)sys->bus_stall_cycles);
+    printf("  Reduce          : %llu cycles\n", (unsigned long long)sys->reduce_cycles);
+    printf("  Bus utilization : %.2f%%  (%llu bytes)\n",
+           bus_util, (unsigned long long)sys->bus_bytes);
+    printf("  MAC utilization : %.2f%%  (%llu MACs)\n",
+           mac_util, (unsigned long long)macs);
+}
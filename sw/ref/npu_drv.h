@@ -0,0 +1,107 @@
+//-----------------------------------------------------------------------------
+// NPU Multi-Instance Driver Header
+// Description: Host driver for npu_multi_top (several npu_top behind one
+//              axi_lite_interconnect, sharing one memory)
+//              - System register map: instance i at (i << NPU_DEV_ADDR_SHIFT)
+//              - Bump allocator over the shared memory model
+//              - Tensor-parallel GEMV: column split (output rows per
+//                instance) or row split (K slice per instance + reduce)
+//              - Parallel phases are timed as max(slowest instance,
+//                total traffic / shared bus bandwidth)
+//              - Zero-copy buffers: IOMMU page-table and SG-chain builders
+//              - Priority scheduling: urgent job preempting a long one
+//-----------------------------------------------------------------------------
+
+#ifndef NPU_DRV_H
+#define NPU_DRV_H
+
+#include "npu_emu.h"
+
+//-----------------------------------------------------------------------------
+// System Configuration
+//-----------------------------------------------------------------------------
+#define NPU_MAX_DEVICES          8
+#define NPU_DEV_ADDR_SHIFT       12     // npu_top AXI_ADDR_WIDTH (4 KB window)
+#define EMU_BUS_BYTES_PER_CYCLE  64     // Shared interconnect/DRAM (4 ports' worth)
+#define EMU_REDUCE_SETUP_CYCLES  32     // Host reduce: launch + first beat
+
+#define NPU_HEAP_FAIL            UINT64_MAX
+
+typedef enum {
+    NPU_SPLIT_COL = 0,   // W rows split: each instance owns Y[begin:end]
+    NPU_SPLIT_ROW = 1    // W cols (K) split: partial Y per instance, summed
+} NpuSplit;
+
+//-----------------------------------------------------------------------------
+// Data Structures
+//-----------------------------------------------------------------------------
+
+// Bump allocator (no free; reset by re-init)
+typedef struct {
+    uint64_t top;
+    uint64_t limit;
+} NpuHeap;
+
+typedef struct {
+    int       num_devs;
+    NpuEmu    dev[NPU_MAX_DEVICES];
+    NpuMem*   mem;               // Shared by all instances
+    NpuHeap   heap;
+
+    uint64_t  cycles;            // System time (phases run back to back)
+    uint64_t  bus_bytes;         // Traffic over the shared interconnect
+    uint64_t  bus_stall_cycles;  // Phase time added by bus saturation
+    uint64_t  reduce_cycles;     // Row-split partial-sum reduction
+    uint64_t  phases;
+} NpuSystem;
+
+// One layer partitioned across instances (weights sharded at load time)
+typedef struct {
+    NpuSplit split;
+    int      parts;
+    int      M, K;
+    int      begin[NPU_MAX_DEVICES];   // COL: row range, ROW: K range
+    int      end[NPU_MAX_DEVICES];
+    uint64_t w_addr[NPU_MAX_DEVICES];  // Contiguous weight shard
+    uint64_t p_addr[NPU_MAX_DEVICES];  // ROW: partial output (M int32)
+} NpuTpLayer;
+
+//-----------------------------------------------------------------------------
+// Function Prototypes
+//-----------------------------------------------------------------------------
+
+// Allocator
+void     npu_heap_init(NpuHeap* heap, uint64_t base, uint64_t limit);
+uint64_t npu_heap_alloc(NpuHeap* heap, uint64_t bytes, uint64_t align);
+
+// System (register accesses decoded like axi_lite_interconnect)
+int      npu_sys_init(NpuSystem* sys, NpuMem* mem, int num_devs);
+void     npu_sys_write_reg(NpuSystem* sys, uint32_t addr, uint32_t value);
+uint32_t npu_sys_read_reg(NpuSystem* sys, uint32_t addr);
+void     npu_sys_print_stats(const NpuSystem* sys, const char* label);
+
+// Tensor parallel: shard W[M][K] over `parts` instances (W may be NULL to
+// allocate shards only, e.g. for timing runs), then run Y = W * x
+int npu_tp_layer_init(NpuSystem* sys, NpuTpLayer* layer, const int8_t* W,
+                      int M, int K, NpuSplit split, int parts);
+int npu_tp_gemv(NpuSystem* sys, const NpuTpLayer* layer,
+                uint64_t x_addr, uint64_t y_addr);
+
+// Zero-copy buffers: map physical pages page_addr[0..n) at IOVA `iova` in the
+// page table at `pt` (uint32 PTE per page), or write an SG chain of `count`
+// descriptors at desc_addr (contiguous, linked in order)
+int npu_iommu_map(NpuMem* mem, uint64_t pt, uint32_t iova,
+                  const uint32_t* page_addr, int num_pages);
+int npu_sg_build(NpuMem* mem, uint32_t desc_addr, const uint32_t* chunk_addr,
+                 const uint32_t* chunk_len, int count);
+
+// Urgent job (e.g. decode) arriving `arrival` cycles into a background job
+// (e.g. prefill GEMM) on one instance. preempt = 1: the background job
+// stops at the next tile boundary (context at ctx_addr), the urgent job
+// runs and the background job resumes; preempt = 0: the urgent job waits.
+// *latency: arrival → urgent job done
+int npu_run_urgent(NpuEmu* emu, const NpuCmd* bg, int bg_n,
+                   const NpuCmd* urgent, int urgent_n, uint32_t ctx_addr,
+                   uint64_t arrival, int preempt, uint64_t* latency);
+
+#endif // NPU_DRV_H
@@ -0,0 +1,1149 @@
+//-----------------------------------------------------------------------------
+// NPU Functional Emulator
+// Description: Executes NPU command streams at near-native speed
+//              A job (CTRL.start) runs the controller loop of PLAN.md 3.4:
+//                DMA weight → DMA input → compute (M/K tiles on the cluster)
+//                → DMA output
+//              The arithmetic is done in one ref_gemm_fast() call; timing is
+//              accumulated from the tile/DMA cycle model in npu_emu.h
+//              CONFIG.chain_in/chain_out replace the input/output DMA with
+//              the on-chip input buffer (requantised INT8 activations)
+//              CONFIG.kv_w/kv_x read W or X rows through the block table
+//              (paged KV cache: row r at table[r >> shift] + (r & mask)*row)
+//              CONFIG.topk stores only the best TOPK (index, value) pairs
+//              of a GEMV instead of Y (LM-head sampling)
+//              CONFIG.gather is a DMA-only job: token ids select embedding
+//              rows that land in the input buffer for the next chain_in job
+//              CONFIG.rope rotates output pairs by the position of their
+//              column (Q/K projections) before the store or requant
+//              CONFIG.fmt = BF16/FP16 runs a plain GEMM through the FP MACs
+//              (ref_gemm_fp, half the INT8 elements per line); FP8 keeps
+//              the INT8 line rate, with optional MX scales (ref_gemm_fp8)
+//              With IOMMU_CTRL.enable every DMA address is translated page
+//              by page through a TLB; SG flags make ADDR_* point to a
+//              descriptor chain instead of a contiguous buffer
+//              Queued jobs (CTRL.enqueue) run back to back on CTRL.start;
+//              with QUEUE.prefetch the next job's first weight tiles are
+//              fetched into the free bank while the current job computes
+//              A preemption request (armed with NPU_CMD_PREEMPT) stops a
+//              plain job at the next tile boundary: finished outputs are
+//              stored and the context (loop position + partial sums) goes
+//              to CTX_ADDR; CTRL.resume reloads it and continues
+//-----------------------------------------------------------------------------
+
+#include "npu_emu.h"
+
+//-----------------------------------------------------------------------------
+// Memory Model
+//-----------------------------------------------------------------------------
+
+int npu_mem_init(NpuMem* mem, uint64_t size) {
+    mem->data = (uint8_t*)calloc(size, 1);
+    mem->size = mem->data ? size : 0;
+    return mem->data ? 0 : -1;
+}
+
+void npu_mem_free(NpuMem* mem) {
+    free(mem->data);
+    mem->data = NULL;
+    mem->size = 0;
+}
+
+static int mem_range_ok(const NpuMem* mem, uint64_t addr, uint64_t len) {
+    return addr <= mem->size && len <= mem->size - addr;
+}
+
+int npu_mem_write(NpuMem* mem, uint64_t addr, const void* src, uint64_t len) {
+    if (!mem_range_ok(mem, addr, len)) return -1;
+    memcpy(mem->data + addr, src, len);
+    return 0;
+}
+
+int npu_mem_read(NpuMem* mem, uint64_t addr, void* dst, uint64_t len) {
+    if (!mem_range_ok(mem, addr, len)) return -1;
+    memcpy(dst, mem->data + addr, len);
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Cycle Model Helpers
+//-----------------------------------------------------------------------------
+
+static uint64_t dma_cycles(uint64_t bytes) {
+    if (bytes == 0) return 0;
+    return EMU_DMA_SETUP_CYCLES +
+           (bytes + EMU_DMA_BYTES_PER_CYCLE - 1) / EMU_DMA_BYTES_PER_CYCLE;
+}
+
+// All PEs work on different M tiles; each (n, k_tile) step costs one tile op
+static uint64_t compute_cycles(int M, int K, int N) {
+    uint64_t m_tiles = (M + SUBARRAY_ROWS - 1) / SUBARRAY_ROWS;
+    uint64_t k_tiles = (K + SUBARRAY_COLS - 1) / SUBARRAY_COLS;
+    uint64_t waves   = (m_tiles + TOTAL_PE_UNITS - 1) / TOTAL_PE_UNITS;
+    return waves * (uint64_t)N * k_tiles * EMU_TILE_CYCLES;
+}
+
+#define REG(emu, off) ((emu)->regs[(off) / 4])
+
+//-----------------------------------------------------------------------------
+// DMA Address Translation (IOMMU TLB + scatter-gather)
+//-----------------------------------------------------------------------------
+
+static void tlb_flush(NpuTlb* tlb) {
+    tlb->valid = 0;
+    tlb->next  = 0;
+}
+
+// IOVA page → physical page for `bursts` consecutive bursts in that page;
+// the first lookup may miss (PTE read, round-robin refill), the rest hit
+static int iommu_translate(NpuEmu* emu, uint32_t vpn, uint64_t bursts, uint32_t* ppn) {
+    NpuTlb* tlb = &emu->tlb;
+    for (int i = 0; i < EMU_TLB_ENTRIES; i++) {
+        if (((tlb->valid >> i) & 1) && tlb->vpn[i] == vpn) {
+            *ppn = tlb->ppn[i];
+            emu->stats.tlb_hits += bursts;
+            return 0;
+        }
+    }
+
+    uint64_t pte_addr = REG(emu, NPU_REG_IOMMU_PT) + (uint64_t)vpn * 4;
+    if (vpn >= REG(emu, NPU_REG_IOMMU_PAGES) || !mem_range_ok(emu->mem, pte_addr, 4))
+        return -1;
+    uint32_t pte;
+    memcpy(&pte, emu->mem->data + pte_addr, 4);
+    emu->stats.tlb_misses++;
+    emu->stats.xlat_cycles += EMU_PTW_CYCLES;
+    if (!(pte & NPU_PTE_VALID))
+        return -1;
+
+    emu->stats.tlb_hits += bursts - 1;
+    tlb->vpn[tlb->next] = vpn;
+    tlb->ppn[tlb->next] = pte >> NPU_PAGE_SHIFT;
+    tlb->valid |= 1u << tlb->next;
+    tlb->next = (tlb->next + 1) % EMU_TLB_ENTRIES;
+    *ppn = pte >> NPU_PAGE_SHIFT;
+    return 0;
+}
+
+// One contiguous device-address range; split at page boundaries when the
+// IOMMU is on (bursts never cross a page, so no extra setup is charged)
+static int dma_copy(NpuEmu* emu, uint64_t addr, void* buf, uint64_t len, int write) {
+    uint8_t* p = (uint8_t*)buf;
+    if (!(REG(emu, NPU_REG_IOMMU_CTRL) & NPU_IOMMU_EN)) {
+        if (!mem_range_ok(emu->mem, addr, len))
+            return -1;
+        if (write) memcpy(emu->mem->data + addr, p, len);
+        else       memcpy(p, emu->mem->data + addr, len);
+        return 0;
+    }
+
+    while (len > 0) {
+        uint64_t off = addr & (NPU_PAGE_SIZE - 1);
+        uint64_t n   = NPU_PAGE_SIZE - off;
+        if (n > len) n = len;
+
+        uint64_t bursts = (off + n + EMU_DMA_BURST_BYTES - 1) / EMU_DMA_BURST_BYTES -
+                          off / EMU_DMA_BURST_BYTES;
+        uint32_t ppn;
+        if (addr >> 32 ||
+            iommu_translate(emu, (uint32_t)(addr >> NPU_PAGE_SHIFT), bursts, &ppn) != 0)
+            return -1;
+        uint64_t pa = ((uint64_t)ppn << NPU_PAGE_SHIFT) | off;
+        if (!mem_range_ok(emu->mem, pa, n))
+            return -1;
+        if (write) memcpy(emu->mem->data + pa, p, n);
+        else       memcpy(p, emu->mem->data + pa, n);
+
+        addr += n;
+        p    += n;
+        len  -= n;
+    }
+    return 0;
+}
+
+// Operand transfer: `addr` is either the buffer or the head of an SG chain
+// whose chunks are consumed in order until `len` bytes have moved
+static int dma_sg_copy(NpuEmu* emu, int sg, uint64_t addr, void* buf, uint64_t len,
+                       int write) {
+    if (!sg)
+        return dma_copy(emu, addr, buf, len, write);
+
+    uint8_t* p = (uint8_t*)buf;
+    for (int d = 0; len > 0; d++) {
+        NpuSgDesc desc;
+        if (d == EMU_SG_MAX_DESCS || dma_copy(emu, addr, &desc, sizeof(desc), 0) != 0)
+            return -1;
+        emu->stats.sg_descs++;
+        emu->stats.xlat_cycles += EMU_SG_DESC_CYCLES;
+
+        uint64_t n = (desc.len < len) ? desc.len : len;
+        if (dma_copy(emu, desc.addr, p, n, write) != 0)
+            return -1;
+        p   += n;
+        len -= n;
+        if (len > 0 && desc.next == 0)
+            return -1;    // Chain shorter than the operand
+        addr = desc.next;
+    }
+    return 0;
+}
+
+static int dma_translated(NpuEmu* emu, int sg) {
+    return sg || (REG(emu, NPU_REG_IOMMU_CTRL) & NPU_IOMMU_EN);
+}
+
+// Operand buffers: physical contiguous operands are used in place; others
+// are gathered into (or, for outputs, staged in) a temporary buffer
+static int8_t* map_in(NpuEmu* emu, int sg, uint64_t addr, uint64_t len, int8_t** tmp) {
+    *tmp = NULL;
+    if (!dma_translated(emu, sg))
+        return mem_range_ok(emu->mem, addr, len) ? (int8_t*)(emu->mem->data + addr) : NULL;
+    *tmp = (int8_t*)malloc(len ? len : 1);
+    if (*tmp == NULL || dma_sg_copy(emu, sg, addr, *tmp, len, 0) != 0) {
+        free(*tmp);
+        *tmp = NULL;
+        return NULL;
+    }
+    return *tmp;
+}
+
+static int32_t* map_out(NpuEmu* emu, int sg, uint64_t addr, uint64_t len, int32_t** tmp) {
+    *tmp = NULL;
+    if (!dma_translated(emu, sg))
+        return mem_range_ok(emu->mem, addr, len) ? (int32_t*)(emu->mem->data + addr) : NULL;
+    *tmp = (int32_t*)malloc(len ? len : 1);
+    return *tmp;
+}
+
+// Write a staged output back (no-op for in-place outputs)
+static int unmap_out(NpuEmu* emu, int sg, uint64_t addr, uint64_t len, int32_t* tmp) {
+    if (tmp == NULL)
+        return 0;
+    int ret = dma_sg_copy(emu, sg, addr, tmp, len, 1);
+    free(tmp);
+    return ret;
+}
+
+//-----------------------------------------------------------------------------
+// Event Trace
+//-----------------------------------------------------------------------------
+
+// Trace time: stats.cycles, frozen while the trace is disabled
+static uint32_t trace_now(NpuEmu* emu) {
+    NpuTrace* tr = &emu->trace;
+    if (REG(emu, NPU_REG_TRACE_CTRL) & NPU_TRACE_EN)
+        tr->ts += emu->stats.cycles - tr->seen;
+    tr->seen = emu->stats.cycles;
+    return (uint32_t)tr->ts;
+}
+
+// Same acceptance rules as trace_unit.sv. Events are issued one at a time,
+// so a slot is never found full (TRACE_DROP stays 0)
+static void trace_event(NpuEmu* emu, int id, uint32_t arg) {
+    NpuTrace* tr   = &emu->trace;
+    uint32_t  ctrl = REG(emu, NPU_REG_TRACE_CTRL);
+    uint32_t  ts   = trace_now(emu);
+
+    if (!(ctrl & NPU_TRACE_EN))
+        return;
+    if ((ctrl & NPU_TRACE_TRIG_EN) && id == (int)(REG(emu, NPU_REG_TRACE_TRIG) & 7))
+        tr->status |= NPU_TRACE_TRIGGERED;
+    if (!((REG(emu, NPU_REG_TRACE_FILTER) >> id) & 1) || (tr->status & NPU_TRACE_STOPPED) ||
+        ((ctrl & NPU_TRACE_TRIG_EN) && !(tr->status & NPU_TRACE_TRIGGERED)))
+        return;
+
+    tr->ring[tr->wr_ptr][0] = ts;
+    tr->ring[tr->wr_ptr][1] = ((uint32_t)id << 24) | (arg & 0xFFFFFFu);
+    if (tr->wr_ptr == NPU_TRACE_DEPTH - 1) {
+        tr->status |= NPU_TRACE_WRAPPED;
+        if (ctrl & NPU_TRACE_STOP_FULL)
+            tr->status |= NPU_TRACE_STOPPED;
+    }
+    tr->wr_ptr = (tr->wr_ptr + 1) % NPU_TRACE_DEPTH;
+}
+
+static void trace_write_ctrl(NpuEmu* emu, uint32_t value) {
+    NpuTrace* tr = &emu->trace;
+    trace_now(emu);
+    if (value & NPU_TRACE_CLEAR) {
+        memset(tr->ring, 0, sizeof(tr->ring));
+        tr->wr_ptr = 0;
+        tr->status = 0;
+        tr->ts     = 0;
+    }
+    REG(emu, NPU_REG_TRACE_CTRL) = value & (NPU_TRACE_EN | NPU_TRACE_STOP_FULL | NPU_TRACE_TRIG_EN);
+}
+
+//-----------------------------------------------------------------------------
+// Controller: tile-boundary preemption
+//-----------------------------------------------------------------------------
+
+// Plain jobs only: the other modes keep state outside the accumulators
+// (input buffer, top-k lists, walkers, SG chains) and run to completion
+static int job_preemptible(NpuEmu* emu) {
+    uint32_t modes = (0xFFu & ~NPU_CFG_RELU) | NPU_CFG_ROPE | NPU_CFG_FMT_MASK;
+    return REG(emu, NPU_REG_FUSE_CNT) <= 1 && REG(emu, NPU_REG_SG) == 0 &&
+           (REG(emu, NPU_REG_CONFIG) & modes) == 0;
+}
+
+// Partial sum of output (r, n) over k in [k0, k1)
+static int32_t dot_range(const int8_t* W, const int8_t* X, int K, int N,
+                         int r, int n, int k0, int k1) {
+    int32_t sum = 0;
+    for (int k = k0; k < k1; k++)
+        sum += (int32_t)W[(size_t)r * K + k] * (int32_t)X[(size_t)k * N + n];
+    return sum;
+}
+
+// Plain job on the PLAN.md 3.4 loop, tile step s = (wave * N + n) * k_tiles
+// + k_tile, from step 0 or from a saved context. Column (wave, n) is
+// stored after its last k_tile. An armed request stops the job at the
+// first boundary after it arrives (during the load phase the loads are
+// dropped). Returns 0 when done, 1 when preempted, -1 on error
+static int emu_run_tiles(NpuEmu* emu, const NpuCtx* ctx) {
+    int M = (int)REG(emu, NPU_REG_DIM_M);
+    int K = (int)REG(emu, NPU_REG_DIM_K);
+    int N = (int)REG(emu, NPU_REG_DIM_N);
+    uint64_t w_addr = REG(emu, NPU_REG_ADDR_WEIGHT);
+    uint64_t x_addr = REG(emu, NPU_REG_ADDR_INPUT);
+    uint64_t y_addr = REG(emu, NPU_REG_ADDR_OUTPUT);
+    int armed = emu->preempt_armed;
+    emu->preempt_armed = 0;
+
+    if (M <= 0 || K <= 0 || N <= 0 || (y_addr & 3))
+        return -1;
+    int      wave_rows = TOTAL_PE_UNITS * SUBARRAY_ROWS;
+    uint64_t waves     = (uint64_t)(M + wave_rows - 1) / wave_rows;
+    uint64_t k_tiles   = (uint64_t)(K + SUBARRAY_COLS - 1) / SUBARRAY_COLS;
+    uint64_t steps     = waves * N * k_tiles;
+    if (ctx && (ctx->wave >= waves || ctx->n >= (uint32_t)N || ctx->k_tile >= k_tiles))
+        return -1;
+    uint64_t s0 = ctx ? ((uint64_t)ctx->wave * N + ctx->n) * k_tiles + ctx->k_tile : 0;
+    int  restored = ctx && ctx->k_tile;      // First column continues from ctx->acc
+
+    // Load: context, weights from the current wave on (the buffers were
+    // reused by other jobs in between), input
+    uint64_t row0    = (s0 / k_tiles / N) * wave_rows;
+    uint64_t w_bytes = ((uint64_t)M - row0) * K;
+    uint64_t x_bytes = (uint64_t)K * N;
+    uint64_t ctx_in  = ctx ? NPU_CTX_HDR_BYTES + (restored ? sizeof(ctx->acc) : 0) : 0;
+    uint64_t xlat_before = emu->stats.xlat_cycles;
+
+    int8_t *w_tmp = NULL, *x_tmp = NULL;
+    const int8_t* W = map_in(emu, 0, w_addr, (uint64_t)M * K, &w_tmp);
+    const int8_t* X = map_in(emu, 0, x_addr, x_bytes, &x_tmp);
+    int32_t* Y = (int32_t*)malloc((size_t)M * N * sizeof(int32_t));
+    if (W == NULL || X == NULL || Y == NULL) {
+        free(w_tmp);
+        free(x_tmp);
+        free(Y);
+        return -1;
+    }
+    ref_gemm_fast(W, X, Y, M, K, N);
+
+    uint64_t load = EMU_JOB_SETUP_CYCLES + dma_cycles(ctx_in) + dma_cycles(w_bytes) +
+                    dma_cycles(x_bytes) + (emu->stats.xlat_cycles - xlat_before);
+
+    // Stop step and the cycle it is reached
+    uint64_t s1 = steps, at = emu->preempt_at, stop = 0;
+    if (armed) {
+        uint64_t s = (at < load) ? s0 : s0 + (at - load + EMU_TILE_CYCLES - 1) / EMU_TILE_CYCLES;
+        if (s < steps) {
+            s1   = s;
+            stop = (at < load) ? at : load + (s1 - s0) * EMU_TILE_CYCLES;
+        }
+    }
+    int preempted = (s1 < steps);
+
+    // Store the columns finished in this run
+    int err = 0;
+    uint64_t y_bytes = 0;
+    for (uint64_t c = s0 / k_tiles; c < s1 / k_tiles && !err; c++) {
+        int wave = (int)(c / N), n = (int)(c % N);
+        int r_end = (wave + 1) * wave_rows < M ? (wave + 1) * wave_rows : M;
+        for (int r = wave * wave_rows; r < r_end && !err; r++) {
+            int32_t y = Y[(size_t)r * N + n];
+            if (restored && c == s0 / k_tiles)
+                y = ctx->acc[r - wave * wave_rows] +
+                    dot_range(W, X, K, N, r, n, (int)ctx->k_tile * SUBARRAY_COLS, K);
+            err = dma_copy(emu, y_addr + ((uint64_t)r * N + n) * sizeof(int32_t),
+                           &y, sizeof(y), 1) != 0;
+            y_bytes += sizeof(int32_t);
+        }
+    }
+
+    // Context of the next tile: partial sums when it is mid column
+    uint64_t ctx_out  = 0;
+    uint32_t ctx_wave = 0;
+    if (!err && preempted) {
+        NpuCtx* save = (NpuCtx*)calloc(1, sizeof(NpuCtx));
+        uint64_t c1 = s1 / k_tiles;
+        err = (save == NULL);
+        if (!err) {
+            memcpy(save->job, &REG(emu, NPU_REG_CONFIG), sizeof(save->job));
+            save->wave   = (uint32_t)(c1 / N);
+            save->n      = (uint32_t)(c1 % N);
+            save->k_tile = (uint32_t)(s1 % k_tiles);
+            ctx_wave     = save->wave;
+            int base  = (int)save->wave * wave_rows;
+            int r_end = base + wave_rows < M ? base + wave_rows : M;
+            int k_end = (int)save->k_tile * SUBARRAY_COLS;
+            for (int r = base; save->k_tile && r < r_end; r++) {
+                int k_begin = (restored && c1 == s0 / k_tiles)
+                              ? (int)ctx->k_tile * SUBARRAY_COLS : 0;
+                save->acc[r - base] = (k_begin ? ctx->acc[r - base] : 0) +
+                                      dot_range(W, X, K, N, r, (int)save->n, k_begin, k_end);
+            }
+            ctx_out = NPU_CTX_HDR_BYTES + (save->k_tile ? sizeof(save->acc) : 0);
+            err = dma_copy(emu, REG(emu, NPU_REG_CTX_ADDR), save, ctx_out, 1) != 0;
+        }
+        free(save);
+    }
+    free(w_tmp);
+    free(x_tmp);
+    free(Y);
+    if (err)
+        return -1;
+
+    // Timing: load → tiles → store (+ context save); a request during the
+    // load phase drops the remaining loads
+    uint64_t compute = (s1 - s0) * EMU_TILE_CYCLES;
+    uint64_t run     = preempted ? stop : load + compute;
+    uint64_t dma     = (run > EMU_JOB_SETUP_CYCLES + compute ? run - EMU_JOB_SETUP_CYCLES - compute : 0) +
+                       dma_cycles(y_bytes) + dma_cycles(ctx_out);
+    uint64_t total   = run + dma_cycles(y_bytes) + dma_cycles(ctx_out);
+
+    emu->stats.dma_cycles      += dma;
+    emu->stats.dma_bytes       += w_bytes + x_bytes + y_bytes + ctx_in + ctx_out;
+    emu->stats.compute_cycles  += compute;
+    emu->stats.ctx_cycles      += dma_cycles(ctx_in) + dma_cycles(ctx_out);
+    emu->stats.cycles          += total;
+    emu->stats.last_job_cycles  = total;
+    if (preempted) {
+        emu->stats.preemptions++;
+        emu->stats.preempt_latency = total - at;
+        trace_event(emu, NPU_TRACE_EV_PREEMPT, ctx_wave);
+        return 1;
+    }
+    emu->stats.macs += (uint64_t)M * K * N;
+    emu->stats.jobs++;
+    return 0;
+}
+
+// Longer INT8 dot products would wrap the MAX_K-sized accumulators
+static int job_k_in_range(NpuEmu* emu) {
+    uint32_t cfg = REG(emu, NPU_REG_CONFIG);
+    return (cfg & NPU_CFG_GATHER) || NPU_CFG_FMT(cfg) != FMT_INT8 ||
+           REG(emu, NPU_REG_DIM_K) <= MAX_K;
+}
+
+// CTRL.resume: the context's job registers replace the current ones and are
+// validated like a started job's
+static int emu_resume(NpuEmu* emu) {
+    NpuCtx* ctx = (NpuCtx*)calloc(1, sizeof(NpuCtx));
+    uint64_t ctx_addr = REG(emu, NPU_REG_CTX_ADDR);
+    int ret = -1;
+    if (ctx != NULL && dma_copy(emu, ctx_addr, ctx, NPU_CTX_HDR_BYTES, 0) == 0 &&
+        (ctx->k_tile == 0 ||
+         dma_copy(emu, ctx_addr + NPU_CTX_HDR_BYTES, ctx->acc, sizeof(ctx->acc), 0) == 0)) {
+        memcpy(&REG(emu, NPU_REG_CONFIG), ctx->job, sizeof(ctx->job));
+        if (job_k_in_range(emu) && job_preemptible(emu))
+            ret = emu_run_tiles(emu, ctx);
+    }
+    free(ctx);
+    return ret;
+}
+
+//-----------------------------------------------------------------------------
+// Controller: one job
+//-----------------------------------------------------------------------------
+
+// Fused job: the concatenated segments form one M dimension for tiling and
+// compute; only the output DMA is split (one transfer per segment)
+static int emu_execute_fused(NpuEmu* emu, int num_segs) {
+    int K = (int)REG(emu, NPU_REG_DIM_K);
+    int N = (int)REG(emu, NPU_REG_DIM_N);
+    uint64_t w_addr = REG(emu, NPU_REG_ADDR_WEIGHT);
+    uint64_t x_addr = REG(emu, NPU_REG_ADDR_INPUT);
+    uint32_t sg     = REG(emu, NPU_REG_SG);
+
+    if (num_segs > NPU_FUSE_MAX_SEGS || K <= 0 || N <= 0)
+        return -1;
+
+    int M = 0;
+    for (int s = 0; s < num_segs; s++) {
+        int m = (int)REG(emu, NPU_REG_FUSE_M(s));
+        if (m <= 0 || (REG(emu, NPU_REG_FUSE_OUT(s)) & 3))
+            return -1;
+        M += m;
+    }
+
+    uint64_t w_bytes = (uint64_t)M * K;
+    uint64_t x_bytes = (uint64_t)K * N;
+    uint64_t xlat_before = emu->stats.xlat_cycles;
+
+    int8_t *w_tmp, *x_tmp;
+    const int8_t* W = map_in(emu, (sg & NPU_SG_W) != 0, w_addr, w_bytes, &w_tmp);
+    const int8_t* X = map_in(emu, (sg & NPU_SG_X) != 0, x_addr, x_bytes, &x_tmp);
+    int err = (W == NULL || X == NULL);
+
+    // Datapath: one pass per segment over its slice of the weights
+    uint64_t dma = dma_cycles(w_bytes) + dma_cycles(x_bytes);
+    uint64_t y_total = 0;
+    for (int s = 0; s < num_segs && !err; s++) {
+        int m = (int)REG(emu, NPU_REG_FUSE_M(s));
+        uint64_t y_addr  = REG(emu, NPU_REG_FUSE_OUT(s));
+        uint64_t y_bytes = (uint64_t)m * N * sizeof(int32_t);
+        int32_t* y_tmp;
+        int32_t* Y = map_out(emu, (sg & NPU_SG_Y) != 0, y_addr, y_bytes, &y_tmp);
+        if (Y == NULL) {
+            err = 1;
+            break;
+        }
+        ref_gemm_fast(W, X, Y, m, K, N);
+        err |= unmap_out(emu, (sg & NPU_SG_Y) != 0, y_addr, y_bytes, y_tmp) != 0;
+        W += (uint64_t)m * K;
+        dma += dma_cycles(y_bytes);
+        y_total += y_bytes;
+    }
+    free(w_tmp);
+    free(x_tmp);
+    if (err)
+        return -1;
+
+    dma += emu->stats.xlat_cycles - xlat_before;
+    uint64_t compute = compute_cycles(M, K, N);
+    uint64_t total   = EMU_JOB_SETUP_CYCLES + dma + compute;
+
+    emu->stats.dma_cycles      += dma;
+    emu->stats.dma_bytes       += w_bytes + x_bytes + y_total;
+    emu->stats.compute_cycles  += compute;
+    emu->stats.macs            += (uint64_t)M * K * N;
+    emu->stats.cycles          += total;
+    emu->stats.last_job_cycles  = total;
+    emu->stats.jobs++;
+    return 0;
+}
+
+// Chained output: requantised INT8 lines written into the input buffer by
+// every PE in parallel (one SUBARRAY_COLS-byte line per cycle per PE)
+static uint64_t chain_cycles(int M, int N) {
+    uint64_t lines = ((uint64_t)M * N + SUBARRAY_COLS - 1) / SUBARRAY_COLS;
+    return (lines + TOTAL_PE_UNITS - 1) / TOTAL_PE_UNITS;
+}
+
+// Paged operand: `rows` logical rows of `row_bytes` each, gathered through
+// the block table into dst. Each block is one contiguous burst; the walker
+// resolves the next block while the current one streams, so only the table
+// fetch is added to the DMA time (returned in *table_bytes).
+static int kv_gather(NpuEmu* emu, int8_t* dst, int rows, int row_bytes,
+                     uint64_t* table_bytes) {
+    uint64_t table = REG(emu, NPU_REG_KV_TABLE);
+    int shift = (int)(REG(emu, NPU_REG_KV_BLOCK) & 0x1F);
+    int block_rows = 1 << shift;
+    int blocks = (rows + block_rows - 1) / block_rows;
+
+    uint32_t* entry = (uint32_t*)malloc((size_t)blocks * 4);
+    int err = (entry == NULL || (table & 3) ||
+               dma_copy(emu, table, entry, (uint64_t)blocks * 4, 0) != 0);
+
+    for (int b = 0; b < blocks && !err; b++) {
+        int n = (rows - b * block_rows < block_rows) ? rows - b * block_rows : block_rows;
+        err = dma_copy(emu, entry[b], dst + (uint64_t)b * block_rows * row_bytes,
+                       (uint64_t)n * row_bytes, 0) != 0;
+    }
+    free(entry);
+    *table_bytes = (uint64_t)blocks * 4;
+    return err ? -1 : 0;
+}
+
+// Embedding gather: DIM_N token ids (uint32) at ADDR_INPUT, table
+// W[DIM_M][DIM_K] at ADDR_WEIGHT. Row of token n → input buffer column n
+// (X[k][n] = W[id][k]). One burst per row; the transposed buffer writes
+// keep up with the 16 B/cycle port, so only the DMA time is modelled.
+static int emu_gather(NpuEmu* emu) {
+    int vocab  = (int)REG(emu, NPU_REG_DIM_M);
+    int hidden = (int)REG(emu, NPU_REG_DIM_K);
+    int tokens = (int)REG(emu, NPU_REG_DIM_N);
+    uint64_t table = REG(emu, NPU_REG_ADDR_WEIGHT);
+    uint64_t ids   = REG(emu, NPU_REG_ADDR_INPUT);
+
+    if (vocab <= 0 || hidden <= 0 || tokens <= 0 || (ids & 3) ||
+        (uint64_t)hidden * tokens > EMU_IBUF_BYTES)
+        return -1;
+
+    uint64_t xlat_before = emu->stats.xlat_cycles;
+    uint32_t* id  = (uint32_t*)malloc((size_t)tokens * 4);
+    int8_t*   row = (int8_t*)malloc((size_t)hidden);
+    int err = (id == NULL || row == NULL ||
+               dma_copy(emu, ids, id, (uint64_t)tokens * 4, 0) != 0);
+
+    uint64_t dma = dma_cycles((uint64_t)tokens * 4);
+    for (int n = 0; n < tokens && !err; n++) {
+        // Out-of-vocabulary id: error, nothing past it is fetched
+        err = id[n] >= (uint32_t)vocab ||
+              dma_copy(emu, table + (uint64_t)id[n] * hidden, row, hidden, 0) != 0;
+        for (int k = 0; k < hidden && !err; k++)
+            emu->ibuf[(size_t)k * tokens + n] = row[k];
+        dma += dma_cycles(hidden);
+    }
+    free(id);
+    free(row);
+    if (err)
+        return -1;
+    emu->ibuf_len = (uint32_t)(hidden * tokens);
+
+    dma += emu->stats.xlat_cycles - xlat_before;
+    uint64_t total = EMU_JOB_SETUP_CYCLES + dma;
+    emu->stats.dma_cycles      += dma;
+    emu->stats.dma_bytes       += (uint64_t)tokens * (4 + hidden);
+    emu->stats.cycles          += total;
+    emu->stats.last_job_cycles  = total;
+    emu->stats.jobs++;
+    return 0;
+}
+
+// BF16/FP16 GEMM: 2-byte W/X elements, FP32 Y. A buffer line holds
+// FP_COLS elements, so the same K takes twice the INT8 k_tiles (and twice
+// the W/X bytes); the tile timing is the same. FP8: 1-byte elements at
+// the INT8 rate; with REG_FP8.mx the E8M0 block scales are loaded too
+static int emu_execute_fp(NpuEmu* emu, int fmt) {
+    int M = (int)REG(emu, NPU_REG_DIM_M);
+    int K = (int)REG(emu, NPU_REG_DIM_K);
+    int N = (int)REG(emu, NPU_REG_DIM_N);
+    uint64_t w_addr = REG(emu, NPU_REG_ADDR_WEIGHT);
+    uint64_t x_addr = REG(emu, NPU_REG_ADDR_INPUT);
+    uint64_t y_addr = REG(emu, NPU_REG_ADDR_OUTPUT);
+    uint32_t sg     = REG(emu, NPU_REG_SG);
+
+    uint32_t fp8    = REG(emu, NPU_REG_FP8);
+    int      elem   = fmt == FMT_FP8 ? 1 : 2;
+    int      mx     = fmt == FMT_FP8 && (fp8 & NPU_FP8_MX);
+
+    uint64_t w_bytes = (uint64_t)M * K * elem;
+    uint64_t x_bytes = (uint64_t)K * N * elem;
+    uint64_t y_bytes = (uint64_t)M * N * 4;
+    uint64_t kb      = (uint64_t)(K + MX_BLOCK - 1) / MX_BLOCK;
+    uint64_t s_bytes = mx ? (M + (uint64_t)N) * kb : 0;
+    if (M <= 0 || K <= 0 || N <= 0 || (elem == 2 && ((w_addr | x_addr) & 1)) || (y_addr & 3))
+        return -1;
+
+    // MX scales (plain DMA, no SG)
+    uint8_t* scales = NULL;
+    if (mx) {
+        scales = (uint8_t*)malloc(s_bytes);
+        if (scales == NULL ||
+            dma_copy(emu, REG(emu, NPU_REG_MX_W_SCALE), scales, M * kb, 0) != 0 ||
+            dma_copy(emu, REG(emu, NPU_REG_MX_X_SCALE), scales + M * kb, kb * N, 0) != 0) {
+            free(scales);
+            return -1;
+        }
+    }
+
+    uint64_t xlat_before = emu->stats.xlat_cycles;
+    int8_t *w_tmp, *x_tmp;
+    int32_t* y_tmp;
+    const int8_t* W = map_in(emu, (sg & NPU_SG_W) != 0, w_addr, w_bytes, &w_tmp);
+    const int8_t* X = map_in(emu, (sg & NPU_SG_X) != 0, x_addr, x_bytes, &x_tmp);
+    int32_t*      Y = map_out(emu, (sg & NPU_SG_Y) != 0, y_addr, y_bytes, &y_tmp);
+    int err = (W == NULL || X == NULL || Y == NULL);
+    if (!err) {
+        if (fmt == FMT_FP8)
+            ref_gemm_fp8((const uint8_t*)W, (const uint8_t*)X, scales,
+                         mx ? scales + M * kb : NULL, (uint32_t*)Y, M, K, N,
+                         (fp8 & NPU_FP8_E5M2) != 0);
+        else
+            ref_gemm_fp((const uint16_t*)W, (const uint16_t*)X, (uint32_t*)Y, M, K, N, fmt);
+        err = unmap_out(emu, (sg & NPU_SG_Y) != 0, y_addr, y_bytes, y_tmp) != 0;
+        y_tmp = NULL;
+    }
+    free(w_tmp);
+    free(x_tmp);
+    free(y_tmp);
+    free(scales);
+    if (err)
+        return -1;
+
+    uint64_t dma     = dma_cycles(w_bytes) + dma_cycles(x_bytes) + dma_cycles(y_bytes) +
+                       (mx ? dma_cycles(s_bytes) : 0) + (emu->stats.xlat_cycles - xlat_before);
+    uint64_t compute = compute_cycles(M, K * elem, N);
+    uint64_t total   = EMU_JOB_SETUP_CYCLES + dma + compute;
+
+    emu->stats.dma_cycles      += dma;
+    emu->stats.dma_bytes       += w_bytes + x_bytes + y_bytes + s_bytes;
+    emu->stats.compute_cycles  += compute;
+    emu->stats.macs            += (uint64_t)M * K * N;
+    emu->stats.cycles          += total;
+    emu->stats.last_job_cycles  = total;
+    emu->stats.jobs++;
+    return 0;
+}
+
+// RoPE on the output path: the table rows of positions pos0..pos0+N-1 are
+// fetched in one burst, then every output pair is rotated as its tile
+// leaves the cluster (the pipeline adds EMU_ROPE_PIPE_CYCLES)
+static int rope_apply(NpuEmu* emu, int32_t* Y, int M, int N, uint64_t* table_bytes) {
+    uint64_t table = REG(emu, NPU_REG_ROPE_TABLE);
+    int pos0 = (int)(REG(emu, NPU_REG_ROPE_POS) & 0xFFFF);
+    uint64_t row = (NPU_ROPE_HEAD_DIM / 2) * sizeof(uint32_t);
+
+    *table_bytes = row * N;
+    uint32_t* cs = (uint32_t*)malloc(*table_bytes);
+    int err = (cs == NULL || (table & 3) ||
+               dma_copy(emu, table + row * pos0, cs, *table_bytes, 0) != 0);
+    if (!err)
+        ref_rope(Y, M, N, NPU_ROPE_HEAD_DIM, cs, 0);
+    free(cs);
+    return err ? -1 : 0;
+}
+
+static int emu_execute(NpuEmu* emu) {
+    int num_segs = (int)REG(emu, NPU_REG_FUSE_CNT);
+    uint32_t cfg = REG(emu, NPU_REG_CONFIG);
+    if (!job_k_in_range(emu))
+        return -1;
+    // An armed preemption applies to this job; others ignore it
+    if (emu->preempt_armed) {
+        if (job_preemptible(emu))
+            return emu_run_tiles(emu, NULL);
+        emu->preempt_armed = 0;
+    }
+    if (cfg & NPU_CFG_GATHER) {
+        // Gather only fills the input buffer: no other mode bits, no SG
+        if (num_segs > 1 || (cfg & (0xFF | NPU_CFG_ROPE)) != NPU_CFG_GATHER ||
+            REG(emu, NPU_REG_SG))
+            return -1;
+        return emu_gather(emu);
+    }
+    if (NPU_CFG_FMT(cfg) != FMT_INT8) {
+        // Floating point: plain GEMM (no fused/chained/paged/top-k/RoPE)
+        if (num_segs > 1 || (cfg & (0xFF | NPU_CFG_ROPE)))
+            return -1;
+        return emu_execute_fp(emu, NPU_CFG_FMT(cfg));
+    }
+    if (num_segs > 1) {
+        // Chaining, paging, top-k and RoPE are not combined with fused jobs
+        if (cfg & (NPU_CFG_CHAIN_IN | NPU_CFG_CHAIN_OUT | NPU_CFG_KV_W | NPU_CFG_KV_X |
+                   NPU_CFG_TOPK | NPU_CFG_ROPE))
+            return -1;
+        return emu_execute_fused(emu, num_segs);
+    }
+
+    int M = (int)REG(emu, NPU_REG_DIM_M);
+    int K = (int)REG(emu, NPU_REG_DIM_K);
+    int N = (int)REG(emu, NPU_REG_DIM_N);
+    uint64_t w_addr = REG(emu, NPU_REG_ADDR_WEIGHT);
+    uint64_t x_addr = REG(emu, NPU_REG_ADDR_INPUT);
+    uint64_t y_addr = REG(emu, NPU_REG_ADDR_OUTPUT);
+    uint32_t sg     = REG(emu, NPU_REG_SG);
+    int chain_in  = (cfg & NPU_CFG_CHAIN_IN)  != 0;
+    int chain_out = (cfg & NPU_CFG_CHAIN_OUT) != 0;
+    int wstream   = (cfg & NPU_CFG_WSTREAM)   != 0;
+    int kv_w      = (cfg & NPU_CFG_KV_W)      != 0;
+    int kv_x      = (cfg & NPU_CFG_KV_X)      != 0;
+    int topk      = (cfg & NPU_CFG_TOPK)      != 0;
+    int rope      = (cfg & NPU_CFG_ROPE)      != 0;
+    int k         = (int)(REG(emu, NPU_REG_TOPK) & 0xF);
+    int sg_w      = (sg & NPU_SG_W) != 0;
+    int sg_x      = (sg & NPU_SG_X) != 0;
+    int sg_y      = (sg & NPU_SG_Y) != 0;
+
+    uint64_t w_bytes = (uint64_t)M * K;
+    uint64_t x_bytes = chain_in  ? 0 : (uint64_t)K * N;
+    uint64_t y_bytes = chain_out ? 0 : topk ? (uint64_t)k * 2 * sizeof(int32_t)
+                                            : (uint64_t)M * N * sizeof(int32_t);
+
+    if (M <= 0 || K <= 0 || N <= 0 || (y_addr & 3))
+        return -1;
+    // One block table per job; a paged or chained operand has no SG chain
+    if ((kv_w && kv_x) || (kv_x && chain_in) || (kv_w && sg_w) ||
+        (kv_x && sg_x) || (chain_in && sg_x) || (chain_out && sg_y))
+        return -1;
+    if (chain_in && (uint64_t)K * N != emu->ibuf_len)
+        return -1;
+    if (wstream && N != 1)
+        return -1;
+    if (chain_out && (uint64_t)M * N > EMU_IBUF_BYTES)
+        return -1;
+    // Top-k replaces the output store: a GEMV with at least K outputs
+    if (topk && (N != 1 || k < 1 || k > NPU_TOPK_MAX || k > M || chain_out || sg_y))
+        return -1;
+    // RoPE rotates whole heads of Q/K (not logits)
+    if (rope && (M % NPU_ROPE_HEAD_DIM != 0 || topk))
+        return -1;
+
+    uint64_t xlat_before = emu->stats.xlat_cycles;
+
+    // Block-table walk (paged operand gathered in walker order)
+    int8_t* paged = NULL;
+    uint64_t table_bytes = 0;
+    if (kv_w || kv_x) {
+        paged = (int8_t*)malloc(kv_w ? w_bytes : x_bytes);
+        if (paged == NULL ||
+            kv_gather(emu, paged, kv_w ? M : K, kv_w ? K : N, &table_bytes) != 0) {
+            free(paged);
+            return -1;
+        }
+    }
+
+    // Datapath
+    int8_t *w_tmp = NULL, *x_tmp = NULL;
+    int32_t* y_tmp = NULL;
+    const int8_t* W = kv_w ? paged : map_in(emu, sg_w, w_addr, w_bytes, &w_tmp);
+    const int8_t* X = kv_x ? paged : chain_in ? emu->ibuf
+                                              : map_in(emu, sg_x, x_addr, x_bytes, &x_tmp);
+    int on_chip = chain_out || topk;   // Y never leaves the chip
+    int32_t* Y = on_chip ? (int32_t*)malloc((size_t)M * N * sizeof(int32_t))
+                         : map_out(emu, sg_y, y_addr, y_bytes, &y_tmp);
+    int err = (W == NULL || X == NULL || Y == NULL);
+    uint64_t rope_bytes = 0;
+    if (!err) {
+        ref_gemm_fast(W, X, Y, M, K, N);
+        if (rope)
+            err = rope_apply(emu, Y, M, N, &rope_bytes) != 0;
+        if (!on_chip)
+            err |= unmap_out(emu, sg_y, y_addr, y_bytes, y_tmp) != 0;
+        y_tmp = NULL;
+    }
+    free(paged);
+    free(w_tmp);
+    free(x_tmp);
+    free(y_tmp);
+    if (!err && topk) {
+        // Merged per-PE lists, stored as {index, value} pairs
+        int32_t idx[NPU_TOPK_MAX], val[NPU_TOPK_MAX], pairs[2 * NPU_TOPK_MAX];
+        ref_topk(Y, M, k, idx, val);
+        for (int i = 0; i < k; i++) {
+            pairs[2 * i]     = idx[i];
+            pairs[2 * i + 1] = val[i];
+        }
+        err = dma_copy(emu, y_addr, pairs, y_bytes, 1) != 0;
+        free(Y);
+        Y = NULL;
+    }
+    if (err) {
+        if (on_chip) free(Y);
+        return -1;
+    }
+
+    // Y[M][N] requantised is X[K=M][N] of the next layer
+    uint64_t chain = 0;
+    if (chain_out) {
+        ref_requant(Y, emu->ibuf, M * N, NPU_CFG_SCALE(cfg), NPU_CFG_SHIFT(cfg),
+                    (cfg & NPU_CFG_RELU) != 0);
+        emu->ibuf_len = (uint32_t)(M * N);
+        chain = chain_cycles(M, N);
+        free(Y);
+    }
+
+    // Timing: load weight → load input → compute → store (no overlap).
+    // Weight streaming: lines go DMA → skid FIFO → gemv, so compute hides
+    // behind the weight transfer (16 PEs take far more than one line per
+    // DMA beat) and only the pipeline drain is exposed.
+    uint64_t dma     = dma_cycles(w_bytes) + dma_cycles(x_bytes) + dma_cycles(y_bytes) +
+                       dma_cycles(table_bytes) + dma_cycles(rope_bytes) +
+                       (emu->stats.xlat_cycles - xlat_before);
+    uint64_t compute = (wstream ? EMU_STREAM_DRAIN_CYCLES : compute_cycles(M, K, N)) + chain +
+                       (rope ? EMU_ROPE_PIPE_CYCLES : 0);
+
+    // Top-k: each PE's unit sorts its outputs as they are produced (over the
+    // compute, or the weight transfer when streaming); only inserts beyond
+    // that window and the final drain/merge are exposed
+    if (topk) {
+        uint64_t window  = wstream ? dma_cycles(w_bytes) : compute;
+        uint64_t inserts = ((uint64_t)M + TOTAL_PE_UNITS - 1) / TOTAL_PE_UNITS;
+        compute += (inserts > window ? inserts - window : 0) + EMU_TOPK_DRAIN_CYCLES(k);
+    }
+    uint64_t total   = EMU_JOB_SETUP_CYCLES + dma + compute;
+
+    emu->stats.dma_cycles      += dma;
+    emu->stats.dma_bytes       += w_bytes + x_bytes + y_bytes + table_bytes + rope_bytes;
+    emu->stats.compute_cycles  += compute;
+    emu->stats.macs            += (uint64_t)M * K * N;
+    emu->stats.cycles          += total;
+    emu->stats.last_job_cycles  = total;
+    emu->stats.jobs++;
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Controller: job queue
+//-----------------------------------------------------------------------------
+
+// Bytes that land in the weight buffer banks (streamed jobs bypass them)
+static uint64_t job_weight_bytes(NpuEmu* emu) {
+    int num_segs = (int)REG(emu, NPU_REG_FUSE_CNT);
+    if (REG(emu, NPU_REG_CONFIG) & (NPU_CFG_WSTREAM | NPU_CFG_GATHER))
+        return 0;
+    uint64_t M = 0;
+    if (num_segs > 1) {
+        for (int s = 0; s < num_segs && s < NPU_FUSE_MAX_SEGS; s++)
+            M += REG(emu, NPU_REG_FUSE_M(s));
+    } else {
+        M = REG(emu, NPU_REG_DIM_M);
+    }
+    int      fmt  = NPU_CFG_FMT(REG(emu, NPU_REG_CONFIG));
+    uint64_t elem = (fmt == FMT_BF16 || fmt == FMT_FP16) ? 2 : 1;
+    return M * REG(emu, NPU_REG_DIM_K) * elem;
+}
+
+// Jobs run in queue order. The lookahead entry is the next descriptor: its
+// first wave of weight tiles is fetched while the memory port is idle
+// during the current job's compute, so that part of its weight DMA
+// (including setup) overlaps instead of following the previous store.
+static int emu_run_queue(NpuEmu* emu) {
+    int prefetch = (REG(emu, NPU_REG_QUEUE) & NPU_QUEUE_PREFETCH) != 0;
+    uint32_t queue  = REG(emu, NPU_REG_QUEUE);
+    uint64_t window = 0;   // Previous job's compute (memory port idle)
+    int err = 0;
+
+    emu->preempt_armed = 0;   // Queued jobs are not preempted
+
+    for (int j = 0; j < emu->jobq_len && !err; j++) {
+        memcpy(emu->regs, emu->jobq[j], sizeof(emu->regs));
+        REG(emu, NPU_REG_QUEUE) = queue;
+
+        uint64_t first  = job_weight_bytes(emu);
+        uint64_t before = emu->stats.compute_cycles;
+        if (emu_execute(emu) != 0) {
+            err = -1;
+            break;
+        }
+
+        if (prefetch && j > 0 && first > 0) {
+            uint64_t fill   = dma_cycles(first < EMU_PREFETCH_BYTES ? first : EMU_PREFETCH_BYTES);
+            uint64_t hidden = fill < window ? fill : window;
+            emu->stats.cycles          -= hidden;
+            emu->stats.last_job_cycles -= hidden;
+            emu->stats.prefetch_cycles += hidden;
+        }
+        window = emu->stats.compute_cycles - before;
+    }
+
+    emu->jobq_len = 0;
+    return err;
+}
+
+//-----------------------------------------------------------------------------
+// Register Interface
+//-----------------------------------------------------------------------------
+
+void npu_emu_init(NpuEmu* emu, NpuMem* mem) {
+    memset(emu, 0, sizeof(*emu));
+    emu->mem = mem;
+    REG(emu, NPU_REG_PE_EN_0) = 0xF;  // Default: all PEs enabled
+    REG(emu, NPU_REG_PE_EN_1) = 0xF;
+    REG(emu, NPU_REG_PE_EN_2) = 0xF;
+    REG(emu, NPU_REG_PE_EN_3) = 0xF;
+    REG(emu, NPU_REG_TRACE_FILTER) = 0xFF;  // Default: all events
+}
+
+void npu_emu_write_reg(NpuEmu* emu, uint32_t offset, uint32_t value) {
+    if (offset >= NPU_REG_SPACE || (offset & 3) || offset == NPU_REG_STATUS)
+        return;
+
+    if (offset == NPU_REG_QUEUE) {
+        REG(emu, offset) = value & NPU_QUEUE_PREFETCH;
+        return;
+    }
+    if (offset == NPU_REG_IOMMU_CTRL) {
+        if (value & NPU_IOMMU_FLUSH)
+            tlb_flush(&emu->tlb);
+        REG(emu, offset) = value & NPU_IOMMU_EN;
+        return;
+    }
+    if (offset == NPU_REG_TLB_HITS || offset == NPU_REG_TLB_MISSES)
+        return;
+    if (offset == NPU_REG_TRACE_CTRL) {
+        trace_write_ctrl(emu, value);
+        return;
+    }
+    if (offset == NPU_REG_TRACE_MARK) {
+        trace_event(emu, NPU_TRACE_EV_MARK, value);
+        return;
+    }
+    if (offset == NPU_REG_TRACE_STATUS || offset == NPU_REG_TRACE_DROP ||
+        offset == NPU_REG_TRACE_RD_TS || offset == NPU_REG_TRACE_RD_EVT)
+        return;
+    if (offset == NPU_REG_TRACE_FILTER || offset == NPU_REG_TRACE_TRIG ||
+        offset == NPU_REG_TRACE_RD_IDX) {
+        REG(emu, offset) = value & (offset == NPU_REG_TRACE_FILTER ? 0xFFu
+                                  : offset == NPU_REG_TRACE_TRIG   ? 0x7u : 0xFFFFu);
+        return;
+    }
+    if (offset != NPU_REG_CTRL) {
+        REG(emu, offset) = value;
+        return;
+    }
+
+    // CTRL: start/clear/enqueue are pulses, nothing else is latched
+    if (value & NPU_CTRL_CLEAR) {
+        REG(emu, NPU_REG_STATUS) = 0;
+        emu->jobq_len = 0;
+    }
+    if (value & NPU_CTRL_ENQUEUE) {
+        // Queue overflow drops the job and flags an error
+        if (emu->jobq_len < EMU_JOBQ_DEPTH)
+            memcpy(emu->jobq[emu->jobq_len++], emu->regs, sizeof(emu->regs));
+        else
+            REG(emu, NPU_REG_STATUS) |= NPU_STATUS_ERROR;
+    }
+    // Jobs complete (or stop at a preemption) synchronously: busy is never
+    // observed by the host, and CTRL.preempt has nothing to stop
+    if (value & (NPU_CTRL_START | NPU_CTRL_RESUME)) {
+        trace_event(emu, NPU_TRACE_EV_JOB_START, REG(emu, NPU_REG_CONFIG));
+        int ret = (value & NPU_CTRL_RESUME) ? emu_resume(emu)
+                : emu->jobq_len             ? emu_run_queue(emu)
+                                            : emu_execute(emu);
+        REG(emu, NPU_REG_STATUS) = (ret > 0) ? NPU_STATUS_PREEMPTED
+                                 : NPU_STATUS_DONE | (ret ? NPU_STATUS_ERROR : 0);
+        trace_event(emu, NPU_TRACE_EV_JOB_END, REG(emu, NPU_REG_STATUS));
+    }
+}
+
+uint32_t npu_emu_read_reg(NpuEmu* emu, uint32_t offset) {
+    if (offset >= NPU_REG_SPACE || (offset & 3))
+        return 0;
+    if (offset == NPU_REG_QUEUE)
+        return REG(emu, offset) | ((uint32_t)emu->jobq_len << 8);
+    if (offset == NPU_REG_TLB_HITS)
+        return (uint32_t)emu->stats.tlb_hits;
+    if (offset == NPU_REG_TLB_MISSES)
+        return (uint32_t)emu->stats.tlb_misses;
+    if (offset == NPU_REG_TRACE_STATUS)
+        return emu->trace.status | emu->trace.wr_ptr;
+    if (offset == NPU_REG_TRACE_DROP)
+        return 0;
+    if (offset == NPU_REG_TRACE_RD_TS || offset == NPU_REG_TRACE_RD_EVT)
+        return emu->trace.ring[REG(emu, NPU_REG_TRACE_RD_IDX) % NPU_TRACE_DEPTH]
+                              [offset == NPU_REG_TRACE_RD_EVT];
+    return REG(emu, offset);
+}
+
+//-----------------------------------------------------------------------------
+// Command Streams
+//-----------------------------------------------------------------------------
+
+int npu_emu_run(NpuEmu* emu, const NpuCmd* cmds, int count) {
+    for (int i = 0; i < count; i++) {
+        switch (cmds[i].op) {
+            case NPU_CMD_END:
+                return 0;
+            case NPU_CMD_WRITE_REG:
+                npu_emu_write_reg(emu, cmds[i].addr, cmds[i].data);
+                break;
+            case NPU_CMD_WAIT_DONE:
+                if (npu_emu_read_reg(emu, NPU_REG_STATUS) & NPU_STATUS_ERROR)
+                    return -1;
+                break;
+            case NPU_CMD_PREEMPT:
+                emu->preempt_armed = 1;
+                emu->preempt_at    = cmds[i].data;
+                break;
+            default:
+                return -1;
+        }
+    }
+    return 0;
+}
+
+int npu_cmd_gemm(NpuCmd* cmds, uint32_t w_addr, uint32_t x_addr, uint32_t y_addr,
+                 int M, int K, int N) {
+    int n = 0;
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_DIM_M,       (uint32_t)M };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_DIM_K,       (uint32_t)K };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_DIM_N,       (uint32_t)N };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_ADDR_WEIGHT, w_addr };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_ADDR_INPUT,  x_addr };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_ADDR_OUTPUT, y_addr };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CTRL,        NPU_CTRL_START };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WAIT_DONE, 0, 0 };
+    return n;
+}
+
+int npu_cmd_enqueue_gemm(NpuCmd* cmds, uint32_t w_addr, uint32_t x_addr,
+                         uint32_t y_addr, int M, int K, int N) {
+    int n = npu_cmd_gemm(cmds, w_addr, x_addr, y_addr, M, K, N) - 1;
+    cmds[n - 1].data = NPU_CTRL_ENQUEUE;
+    return n;
+}
+
+int npu_cmd_embed_gather(NpuCmd* cmds, uint32_t table_addr, uint32_t ids_addr,
+                         int vocab, int hidden, int tokens) {
+    int n = 0;
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CONFIG,      NPU_CFG_GATHER };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_DIM_M,       (uint32_t)vocab };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_DIM_K,       (uint32_t)hidden };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_DIM_N,       (uint32_t)tokens };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_ADDR_WEIGHT, table_addr };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_ADDR_INPUT,  ids_addr };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CTRL,        NPU_CTRL_START };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WAIT_DONE, 0, 0 };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CONFIG,      0 };
+    return n;
+}
+
+int npu_cmd_preempt(NpuCmd* cmds, uint32_t ctx_addr, uint32_t after) {
+    int n = 0;
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CTX_ADDR,    ctx_addr };
+    cmds[n++] = (NpuCmd){ NPU_CMD_PREEMPT,   0,                   after };
+    return n;
+}
+
+int npu_cmd_resume(NpuCmd* cmds, uint32_t ctx_addr) {
+    int n = 0;
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CTX_ADDR,    ctx_addr };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CTRL,        NPU_CTRL_RESUME };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WAIT_DONE, 0, 0 };
+    return n;
+}
+
+int npu_cmd_gemm_fused(NpuCmd* cmds, uint32_t w_addr, uint32_t x_addr,
+                       const uint32_t* y_addrs, const int* seg_m, int num_segs,
+                       int K, int N) {
+    int n = 0;
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_FUSE_CNT,    (uint32_t)num_segs };
+    for (int s = 0; s < num_segs; s++) {
+        cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_FUSE_M(s),   (uint32_t)seg_m[s] };
+        cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_FUSE_OUT(s), y_addrs[s] };
+    }
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_DIM_K,       (uint32_t)K };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_DIM_N,       (uint32_t)N };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_ADDR_WEIGHT, w_addr };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_ADDR_INPUT,  x_addr };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CTRL,        NPU_CTRL_START };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WAIT_DONE, 0, 0 };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_FUSE_CNT,    0 };
+    return n;
+}
+
+//-----------------------------------------------------------------------------
+// Reporting
+//-----------------------------------------------------------------------------
+
+void npu_emu_print_stats(const NpuEmu* emu, const char* label) {
+    const NpuEmuStats* s = &emu->stats;
+    double time_us = (double)s->cycles / EMU_CLOCK_MHZ;
+    double util = s->cycles ? 100.0 * (double)s->macs /
+                              ((double)s->cycles * TOTAL_MACS) : 0.0;
+
+    printf("  --- Emulator Stats: %s ---\n", label);
+    printf("  Jobs            : %llu\n", (unsigned long long)s->jobs);
+    printf("  Modelled cycles : %llu  (%.1f us @ %d MHz)\n",
+           (unsigned long long)s->cycles, time_us, EMU_CLOCK_MHZ);
+    printf("  Compute cycles  : %llu\n", (unsigned long long)s->compute_cycles);
+    printf("  DMA cycles      : %llu  (%llu bytes)\n",
+           (unsigned long long)s->dma_cycles, (unsigned long long)s->dma_bytes);
+    if (s->prefetch_cycles)
+        printf("  Prefetch hidden : %llu cycles\n", (unsigned long long)s->prefetch_cycles);
+    if (s->tlb_hits + s->tlb_misses)
+        printf("  TLB hit rate    : %.2f%%  (%llu misses, %llu SG descriptors)\n",
+               100.0 * (double)s->tlb_hits / (double)(s->tlb_hits + s->tlb_misses),
+               (unsigned long long)s->tlb_misses, (unsigned long long)s->sg_descs);
+    if (s->preemptions)
+        printf("  Preemptions     : %llu  (last latency %llu cycles, context %llu cycles)\n",
+               (unsigned long long)s->preemptions, (unsigned long long)s->preempt_latency,
+               (unsigned long long)s->ctx_cycles);
+    printf("  MAC utilization : %.2f%%  (%llu MACs)\n",
+           util, (unsigned long long)s->macs);
+}
@@ -0,0 +1,326 @@
+//-----------------------------------------------------------------------------
+// NPU Functional Emulator Header
+// Description: CPU-side model of the full NPU for driver/compiler bring-up
+//              - Register map identical to axi_lite_slave (npu_pkg.sv)
+//              - DMA between a byte-addressed memory model and the buffers
+//              - Controller tiling loop (M tiles x N x K tiles, PLAN.md 3.4)
+//              - PE cluster executed with the fast reference kernels while a
+//                cycle model accumulates estimated hardware timing
+//-----------------------------------------------------------------------------
+
+#ifndef NPU_EMU_H
+#define NPU_EMU_H
+
+#include <stddef.h>
+
+#include "npu_ref.h"
+
+//-----------------------------------------------------------------------------
+// Register Map (matches npu_pkg.sv / axi_lite_slave.sv)
+//-----------------------------------------------------------------------------
+#define NPU_REG_CTRL         0x000   // [0] start, [1] clear, [2] enqueue,
+                                     // [3] preempt, [4] resume (pulses)
+#define NPU_REG_STATUS       0x004   // [0] busy, [1] done, [2] error, [3] preempted
+#define NPU_REG_CLUSTER_EN   0x008
+#define NPU_REG_PE_EN_0      0x00C
+#define NPU_REG_PE_EN_1      0x010
+#define NPU_REG_PE_EN_2      0x014
+#define NPU_REG_PE_EN_3      0x018
+#define NPU_REG_CONFIG       0x01C
+#define NPU_REG_DIM_M        0x020
+#define NPU_REG_DIM_K        0x024
+#define NPU_REG_DIM_N        0x028
+#define NPU_REG_ADDR_INPUT   0x02C   // X[K][N] int8 (CONFIG.fmt: bf16/fp16)
+#define NPU_REG_ADDR_WEIGHT  0x030   // W[M][K] int8 (row-major, or bf16/fp16)
+#define NPU_REG_ADDR_OUTPUT  0x034   // Y[M][N] int32 (fp32 for bf16/fp16)
+#define NPU_REG_FUSE_CNT     0x038   // Fused segments (0/1: single GEMV)
+#define NPU_REG_QUEUE        0x03C   // [0] prefetch en, [11:8] queued jobs (RO)
+#define NPU_REG_FUSE_M(i)    (0x040 + 4 * (i))   // Segment i rows
+#define NPU_REG_FUSE_OUT(i)  (0x050 + 4 * (i))   // Segment i Y[M_i][N]
+
+#define NPU_REG_KV_TABLE     0x060   // Block table: uint32 physical block addrs
+#define NPU_REG_KV_BLOCK     0x064   // [4:0] log2(rows per block)
+#define NPU_REG_SG           0x068   // [0] W, [1] X, [2] Y: ADDR_* is an SG chain
+#define NPU_REG_TOPK         0x06C   // [3:0] K: CONFIG.topk returns K pairs
+#define NPU_REG_IOMMU_CTRL   0x070   // [0] enable, [1] TLB flush (pulse)
+#define NPU_REG_IOMMU_PT     0x074   // Page table: one uint32 PTE per page
+#define NPU_REG_IOMMU_PAGES  0x078   // Page table entries (IOVA limit)
+#define NPU_REG_TLB_HITS     0x07C   // RO
+#define NPU_REG_TLB_MISSES   0x080   // RO
+#define NPU_REG_ROPE_TABLE   0x084   // RoPE table [pos][64] {int16 cos, int16 sin}
+#define NPU_REG_ROPE_POS     0x088   // [15:0] position of output column 0
+#define NPU_REG_CTX_ADDR     0x08C   // Preemption context (NpuCtx)
+#define NPU_REG_TRACE_CTRL   0x090   // [0] enable, [1] clear (pulse), [2] stop_full, [3] trig_en
+#define NPU_REG_TRACE_FILTER 0x094   // [7:0] events recorded (reset: all)
+#define NPU_REG_TRACE_TRIG   0x098   // [2:0] trigger event
+#define NPU_REG_TRACE_MARK   0x09C   // W: marker event, arg = [23:0]
+#define NPU_REG_TRACE_STATUS 0x0A0   // RO: [15:0] wr_ptr, [16] wrapped, [17] triggered, [18] stopped
+#define NPU_REG_TRACE_DROP   0x0A4   // RO: events lost to a full slot
+#define NPU_REG_TRACE_RD_IDX 0x0A8   // Entry to read
+#define NPU_REG_TRACE_RD_TS  0x0AC   // RO: entry timestamp (cycles)
+#define NPU_REG_TRACE_RD_EVT 0x0B0   // RO: entry {id[7:0], arg[23:0]}
+#define NPU_REG_FP8          0x0B4   // [0] E5M2 (else E4M3), [1] MX block scales
+#define NPU_REG_MX_W_SCALE   0x0B8   // W scales [M][ceil(K/32)] E8M0
+#define NPU_REG_MX_X_SCALE   0x0BC   // X scales [ceil(K/32)][N] E8M0
+
+#define NPU_FUSE_MAX_SEGS    4
+
+#define NPU_REG_SPACE        0x100   // Emulated register window (bytes)
+
+#define NPU_CTRL_START       (1u << 0)
+#define NPU_CTRL_CLEAR       (1u << 1)
+#define NPU_CTRL_ENQUEUE     (1u << 2)   // Latch job registers into the queue
+#define NPU_CTRL_PREEMPT     (1u << 3)   // Stop at the next tile boundary
+#define NPU_CTRL_RESUME      (1u << 4)   // Continue the job saved at CTX_ADDR
+
+#define NPU_STATUS_BUSY      (1u << 0)
+#define NPU_STATUS_DONE      (1u << 1)
+#define NPU_STATUS_ERROR     (1u << 2)
+#define NPU_STATUS_PREEMPTED (1u << 3)   // Context saved, controller idle
+
+// SG
+#define NPU_SG_W             (1u << 0)
+#define NPU_SG_X             (1u << 1)
+#define NPU_SG_Y             (1u << 2)
+
+// IOMMU: DMA addresses (incl. SG descriptors and KV tables) are IOVAs,
+// PTE = physical page address | valid
+#define NPU_IOMMU_EN         (1u << 0)
+#define NPU_IOMMU_FLUSH      (1u << 1)
+#define NPU_PAGE_SHIFT       12
+#define NPU_PAGE_SIZE        (1u << NPU_PAGE_SHIFT)
+#define NPU_PTE_VALID        (1u << 0)
+
+// TOPK: Y[K][2] int32 {index, value}, sorted by value descending (ties:
+// lower index first)
+#define NPU_TOPK_MAX         8
+
+// ROPE: rotation over heads of NPU_ROPE_HEAD_DIM output rows (DIM_M must
+// be a multiple), table rows as built by ref_rope_table()
+#define NPU_ROPE_HEAD_DIM    LLAMA_HEAD_DIM
+
+// Preemption: plain jobs (no CONFIG mode bits but relu, no SG, not
+// fused) stop at the next tile boundary of the PLAN.md 3.4 loop, flush the
+// finished outputs and save the context; other jobs run to completion
+#define NPU_CTX_ACC_WORDS    (TOTAL_PE_UNITS * SUBARRAY_ROWS)   // One wave
+
+// TRACE (trace_unit): event ids as npu_pkg TRACE_EV_*. The emulator records
+// the job-level events (JOB_START/JOB_END per CTRL.start or resume,
+// PREEMPT, MARK) at cycle-model time; TILE/DMA/STALL need the cycle-level
+// RTL
+#define NPU_TRACE_DEPTH      256
+#define NPU_TRACE_EN         (1u << 0)
+#define NPU_TRACE_CLEAR      (1u << 1)
+#define NPU_TRACE_STOP_FULL  (1u << 2)
+#define NPU_TRACE_TRIG_EN    (1u << 3)
+#define NPU_TRACE_WRAPPED    (1u << 16)
+#define NPU_TRACE_TRIGGERED  (1u << 17)
+#define NPU_TRACE_STOPPED    (1u << 18)
+#define NPU_TRACE_WR_PTR(s)  ((s) & 0xFFFFu)
+
+#define NPU_TRACE_EV_JOB_START 0   // CONFIG[23:0]
+#define NPU_TRACE_EV_JOB_END   1   // STATUS[23:0]
+#define NPU_TRACE_EV_TILE      2   // Mask of the PEs with a valid tile
+#define NPU_TRACE_EV_DMA_RD    3   // Burst bytes
+#define NPU_TRACE_EV_DMA_WR    4   // Burst bytes
+#define NPU_TRACE_EV_STALL     5   // Mask of the stalled PEs
+#define NPU_TRACE_EV_PREEMPT   6   // Wave of the saved context
+#define NPU_TRACE_EV_MARK      7   // TRACE_MARK [23:0]
+
+// FP8 (CONFIG.fmt = FMT_FP8)
+#define NPU_FP8_E5M2         (1u << 0)
+#define NPU_FP8_MX           (1u << 1)
+
+// QUEUE
+#define NPU_QUEUE_PREFETCH   (1u << 0)   // Cross-layer weight prefetch
+#define NPU_QUEUE_COUNT(q)   ((int)(((q) >> 8) & 0xF))
+
+// CONFIG (npu_pkg::config_t)
+#define NPU_CFG_CHAIN_OUT    (1u << 0)   // Requantised Y → on-chip input buffer
+#define NPU_CFG_CHAIN_IN     (1u << 1)   // X from on-chip input buffer
+#define NPU_CFG_RELU         (1u << 2)
+#define NPU_CFG_WSTREAM      (1u << 3)   // Batch-1 weight streaming (N = 1)
+#define NPU_CFG_KV_W         (1u << 4)   // W rows paged through KV_TABLE
+#define NPU_CFG_KV_X         (1u << 5)   // X rows paged through KV_TABLE
+#define NPU_CFG_TOPK         (1u << 6)   // Y = top-K {index, value} pairs (N = 1)
+#define NPU_CFG_GATHER       (1u << 7)   // Embedding gather into the input buffer
+#define NPU_CFG_ROPE         (1u << 13)  // Rotate Q/K outputs (ROPE_TABLE/POS)
+#define NPU_CFG_FMT_MASK     (3u << 14)  // Element format (FMT_INT8/BF16/FP16/FP8)
+#define NPU_CFG_FMT(cfg)     ((int)(((cfg) >> 14) & 3))
+#define NPU_CFG_FMT_SET(fmt) ((uint32_t)(fmt) << 14)
+#define NPU_CFG_SHIFT(cfg)   ((int)(((cfg) >> 8) & 0x1F))
+#define NPU_CFG_SCALE(cfg)   ((int16_t)((cfg) >> 16))
+#define NPU_CFG_RQ(scale, shift, relu) \
+    (((uint32_t)(uint16_t)(scale) << 16) | (((uint32_t)(shift) & 0x1F) << 8) | \
+     ((relu) ? NPU_CFG_RELU : 0))
+
+//-----------------------------------------------------------------------------
+// Cycle Model
+//-----------------------------------------------------------------------------
+#define EMU_CLOCK_MHZ            200
+// gemv_subarray fan-out register stages (npu_pkg FANOUT_STAGES): each adds a
+// cycle to the gemv latency, once per buffered tile, once per stream drain
+#define EMU_GEMV_FANOUT_STAGES   1
+#define EMU_TILE_CYCLES          (8 + EMU_GEMV_FANOUT_STAGES)  // PE_ctrl LOAD → DONE for one tile
+#define EMU_DMA_BYTES_PER_CYCLE  16   // 128-bit memory port
+#define EMU_DMA_SETUP_CYCLES     16   // Per transfer (descriptor + first beat)
+#define EMU_JOB_SETUP_CYCLES     4    // Controller start → first request
+#define EMU_IBUF_BYTES           16384  // On-chip activation buffer (chaining)
+#define EMU_STREAM_DRAIN_CYCLES  (8 + EMU_GEMV_FANOUT_STAGES)  // Skid FIFO (4) + gemv pipeline (3) + store
+#define EMU_JOBQ_DEPTH           8    // Job descriptors (CTRL.enqueue)
+#define EMU_TLB_ENTRIES          16   // Fully associative, round-robin refill
+#define EMU_DMA_BURST_BYTES      64   // One TLB lookup per burst (4 beats)
+#define EMU_PTW_CYCLES           24   // TLB miss: PTE read (setup + beat) + refill
+#define EMU_SG_DESC_CYCLES       20   // Descriptor read + new burst per SG chunk
+#define EMU_SG_MAX_DESCS         65536  // Chain length limit (loop guard)
+// Top-K: one topk_unit per PE inserts one output per cycle while the GEMV
+// runs; at the end the last tile drains and the PE lists merge into one
+#define EMU_TOPK_DRAIN_CYCLES(k) (SUBARRAY_ROWS + TOTAL_PE_UNITS * (k))
+#define EMU_ROPE_PIPE_CYCLES     2    // rope_unit: multiply, round/saturate
+// Prefetch fills the free weight bank with the next job's first wave: one
+// SUBARRAY_ROWS x SUBARRAY_COLS tile per PE (top_pe NUM_WBANKS = 2)
+#define EMU_PREFETCH_BYTES       (TOTAL_PE_UNITS * SUBARRAY_ROWS * SUBARRAY_COLS)
+
+//-----------------------------------------------------------------------------
+// Data Structures
+//-----------------------------------------------------------------------------
+
+// Byte-addressed device memory (DRAM model)
+typedef struct {
+    uint8_t* data;
+    uint64_t size;
+} NpuMem;
+
+// Modelled timing / activity counters
+typedef struct {
+    uint64_t cycles;           // Total modelled cycles
+    uint64_t compute_cycles;   // PE cluster busy
+    uint64_t dma_cycles;       // Memory transfers
+    uint64_t dma_bytes;        // Bytes moved over the memory port
+    uint64_t macs;             // Useful MACs (M*K*N per job)
+    uint64_t jobs;             // Completed jobs
+    uint64_t last_job_cycles;  // Cycles of the most recent job
+    uint64_t prefetch_cycles;  // Weight DMA hidden behind the previous job
+    uint64_t xlat_cycles;      // Page walks + SG descriptor fetches
+    uint64_t tlb_hits;
+    uint64_t tlb_misses;
+    uint64_t sg_descs;         // SG descriptors consumed
+    uint64_t preemptions;
+    uint64_t preempt_latency;  // Last preemption: request → context saved
+    uint64_t ctx_cycles;       // Context save + restore transfers
+} NpuEmuStats;
+
+// Preemption context (CTX_ADDR): job registers, loop position of the next
+// tile and, mid column (k_tile != 0), the partial sums of the wave's rows
+typedef struct {
+    uint32_t job[7];           // CONFIG, DIM_M/K/N, ADDR_INPUT/WEIGHT/OUTPUT
+    uint32_t wave;             // M tile group (TOTAL_PE_UNITS tiles)
+    uint32_t n;
+    uint32_t k_tile;
+    uint32_t reserved[6];
+    int32_t  acc[NPU_CTX_ACC_WORDS];
+} NpuCtx;
+
+#define NPU_CTX_HDR_BYTES    ((uint64_t)offsetof(NpuCtx, acc))
+
+// Scatter-gather descriptor (16 bytes, chained until next == 0)
+typedef struct {
+    uint32_t addr;             // Chunk address (IOVA when the IOMMU is on)
+    uint32_t len;              // Chunk bytes
+    uint32_t next;             // Next descriptor, 0 = end of chain
+    uint32_t reserved;
+} NpuSgDesc;
+
+// IOMMU TLB (page numbers)
+typedef struct {
+    uint32_t vpn[EMU_TLB_ENTRIES];
+    uint32_t ppn[EMU_TLB_ENTRIES];
+    uint32_t valid;            // Bit per entry
+    int      next;             // Round-robin refill pointer
+} NpuTlb;
+
+// Event trace ring: {ts, {id, arg}} per entry (TRACE_RD_TS / TRACE_RD_EVT)
+typedef struct {
+    uint32_t ring[NPU_TRACE_DEPTH][2];
+    uint32_t wr_ptr;
+    uint32_t status;           // NPU_TRACE_WRAPPED / TRIGGERED / STOPPED
+    uint64_t ts;               // Counts stats.cycles while enabled
+    uint64_t seen;             // stats.cycles at the last update of ts
+} NpuTrace;
+
+typedef struct {
+    uint32_t    regs[NPU_REG_SPACE / 4];
+    NpuMem*     mem;
+    NpuEmuStats stats;
+    int8_t      ibuf[EMU_IBUF_BYTES];   // Chained activations (INT8)
+    uint32_t    ibuf_len;               // Valid bytes (K*N of the next layer)
+    uint32_t    jobq[EMU_JOBQ_DEPTH][NPU_REG_SPACE / 4];  // Register snapshots
+    int         jobq_len;
+    NpuTlb      tlb;
+    int         preempt_armed;          // NPU_CMD_PREEMPT pending
+    uint64_t    preempt_at;             // ... cycles after the next start/resume
+    NpuTrace    trace;
+} NpuEmu;
+
+// Command stream: register writes and completion waits, as issued by a driver
+typedef enum {
+    NPU_CMD_END       = 0,
+    NPU_CMD_WRITE_REG = 1,    // regs[addr] = data (CTRL.start launches a job,
+                              // or the queued jobs if any were enqueued)
+    NPU_CMD_WAIT_DONE = 2,    // Block until STATUS.done (or error)
+    NPU_CMD_PREEMPT   = 3     // CTRL.preempt arrives `data` cycles after the
+                              // next start/resume (jobs run synchronously, so
+                              // the request is armed ahead of it)
+} NpuCmdOp;
+
+typedef struct {
+    uint32_t op;
+    uint32_t addr;
+    uint32_t data;
+} NpuCmd;
+
+//-----------------------------------------------------------------------------
+// Function Prototypes
+//-----------------------------------------------------------------------------
+
+// Memory model
+int  npu_mem_init(NpuMem* mem, uint64_t size);
+void npu_mem_free(NpuMem* mem);
+int  npu_mem_write(NpuMem* mem, uint64_t addr, const void* src, uint64_t len);
+int  npu_mem_read(NpuMem* mem, uint64_t addr, void* dst, uint64_t len);
+
+// Emulator
+void     npu_emu_init(NpuEmu* emu, NpuMem* mem);
+void     npu_emu_write_reg(NpuEmu* emu, uint32_t offset, uint32_t value);
+uint32_t npu_emu_read_reg(NpuEmu* emu, uint32_t offset);
+int      npu_emu_run(NpuEmu* emu, const NpuCmd* cmds, int count);
+void     npu_emu_print_stats(const NpuEmu* emu, const char* label);
+
+// Command stream builder: appends one GeMM/GeMV job (N=1) + wait, returns
+// number of commands written
+int npu_cmd_gemm(NpuCmd* cmds, uint32_t w_addr, uint32_t x_addr, uint32_t y_addr,
+                 int M, int K, int N);
+
+// Queued job: as npu_cmd_gemm but latched with CTRL.enqueue (no start/wait);
+// a later CTRL.start runs the queue in order
+int npu_cmd_enqueue_gemm(NpuCmd* cmds, uint32_t w_addr, uint32_t x_addr,
+                         uint32_t y_addr, int M, int K, int N);
+
+// Embedding gather: token ids (uint32[tokens]) at ids_addr select rows of
+// the INT8 table[vocab][hidden] at table_addr; token n's row becomes column
+// n of X[hidden][tokens] in the input buffer (consumed with CONFIG.chain_in)
+int npu_cmd_embed_gather(NpuCmd* cmds, uint32_t table_addr, uint32_t ids_addr,
+                         int vocab, int hidden, int tokens);
+
+// Preemption: arm a request `after` cycles into the next job (context
+// saved at ctx_addr), or resume the job saved there (+ wait)
+int npu_cmd_preempt(NpuCmd* cmds, uint32_t ctx_addr, uint32_t after);
+int npu_cmd_resume(NpuCmd* cmds, uint32_t ctx_addr);
+
+// Fused job: segments share X, weights concatenated at w_addr, segment i
+// (seg_m[i] rows) written to y_addrs[i]
+int npu_cmd_gemm_fused(NpuCmd* cmds, uint32_t w_addr, uint32_t x_addr,
+                       const uint32_t* y_addrs, const int* seg_m, int num_segs,
+                       int K, int N);
+
+#endif // NPU_EMU_H
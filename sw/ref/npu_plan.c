@@ -0,0 +1,204 @@
+//-----------------------------------------------------------------------------
+// NPU Activation Memory Planner
+// Description: Lifetime analysis and arena packing for the activations of
+//              a layer graph (ops in execution order)
+//              The on-chip rule follows the emulator's chaining constraints
+//              (npu_emu.c emu_execute): one chained tensor per op boundary,
+//              INT8, at most EMU_IBUF_BYTES
+//-----------------------------------------------------------------------------
+
+#include "npu_plan.h"
+
+static uint64_t tensor_bytes(const NpuTensor* t) {
+    return t->elems * (uint64_t)t->elem_bytes;
+}
+
+static uint64_t plan_align(uint64_t bytes) {
+    return (bytes + NPU_PLAN_ALIGN - 1) & ~(uint64_t)(NPU_PLAN_ALIGN - 1);
+}
+
+//-----------------------------------------------------------------------------
+// Graph Construction
+//-----------------------------------------------------------------------------
+
+void npu_graph_init(NpuGraph* g) {
+    memset(g, 0, sizeof(*g));
+}
+
+int npu_graph_tensor(NpuGraph* g, uint64_t elems, int elem_bytes, uint32_t flags) {
+    if (g->num_tensors >= NPU_PLAN_MAX_TENSORS || elems == 0 ||
+        (elem_bytes != 1 && elem_bytes != 4))
+        return -1;
+    NpuTensor* t = &g->t[g->num_tensors];
+    memset(t, 0, sizeof(*t));
+    t->elems      = elems;
+    t->elem_bytes = elem_bytes;
+    t->flags      = flags;
+    return g->num_tensors++;
+}
+
+// A GEMM has one activation operand (X); host ops up to NPU_PLAN_MAX_INPUTS
+int npu_graph_op(NpuGraph* g, NpuOpKind kind, const int* in, int num_in, int out) {
+    if (g->num_ops >= NPU_PLAN_MAX_OPS || num_in < 1 || num_in > NPU_PLAN_MAX_INPUTS ||
+        (kind == NPU_OP_GEMM && num_in != 1) || out < 0 || out >= g->num_tensors)
+        return -1;
+    NpuOp* op = &g->op[g->num_ops];
+    for (int j = 0; j < num_in; j++) {
+        if (in[j] < 0 || in[j] >= g->num_tensors || in[j] == out)
+            return -1;
+        op->in[j] = in[j];
+    }
+    op->kind   = kind;
+    op->num_in = num_in;
+    op->out    = out;
+    return g->num_ops++;
+}
+
+//-----------------------------------------------------------------------------
+// Planning
+//-----------------------------------------------------------------------------
+
+static int lifetimes_overlap(const NpuTensor* a, const NpuTensor* b) {
+    return a->first <= b->last && b->first <= a->last;
+}
+
+// Chained: written by GEMM i, read only by GEMM i+1 as X, INT8, fits the
+// input buffer, never seen by the host
+static int plan_chainable(const NpuGraph* g, int i) {
+    const NpuTensor* t = &g->t[g->op[i].out];
+    return g->op[i].kind == NPU_OP_GEMM && i + 1 < g->num_ops &&
+           g->op[i + 1].kind == NPU_OP_GEMM && g->op[i + 1].in[0] == g->op[i].out &&
+           t->consumers == 1 && t->elem_bytes == 1 &&
+           !(t->flags & (NPU_TENSOR_INPUT | NPU_TENSOR_OUTPUT)) &&
+           tensor_bytes(t) <= EMU_IBUF_BYTES;
+}
+
+uint64_t npu_plan(NpuGraph* g, int onchip) {
+    int written[NPU_PLAN_MAX_TENSORS];
+
+    // Lifetimes
+    for (int i = 0; i < g->num_tensors; i++) {
+        NpuTensor* t = &g->t[i];
+        written[i]   = (t->flags & NPU_TENSOR_INPUT) != 0;
+        t->first     = 0;
+        t->last      = 0;
+        t->consumers = 0;
+        t->where     = NPU_MEM_DRAM;
+        t->offset    = 0;
+    }
+    for (int i = 0; i < g->num_ops; i++) {
+        const NpuOp* op = &g->op[i];
+        for (int j = 0; j < op->num_in; j++) {
+            NpuTensor* t = &g->t[op->in[j]];
+            if (!written[op->in[j]])
+                return NPU_PLAN_FAIL;
+            t->last = i;
+            t->consumers++;
+        }
+        if (written[op->out])
+            return NPU_PLAN_FAIL;
+        written[op->out] = 1;
+        g->t[op->out].first = i;
+        g->t[op->out].last  = i;
+    }
+    for (int i = 0; i < g->num_tensors; i++) {
+        if (!written[i])
+            return NPU_PLAN_FAIL;
+        if (g->t[i].flags & NPU_TENSOR_OUTPUT)
+            g->t[i].last = g->num_ops > 0 ? g->num_ops - 1 : 0;
+    }
+
+    // On chip: chained tensors leave the arena
+    g->onchip       = 0;
+    g->onchip_bytes = 0;
+    for (int i = 0; onchip && i < g->num_ops; i++) {
+        if (plan_chainable(g, i)) {
+            g->t[g->op[i].out].where = NPU_MEM_ONCHIP;
+            g->onchip++;
+            g->onchip_bytes += tensor_bytes(&g->t[g->op[i].out]);
+        }
+    }
+
+    // Arena: largest first (earlier first on ties), lowest free offset
+    int order[NPU_PLAN_MAX_TENSORS], n = 0;
+    for (int i = 0; i < g->num_tensors; i++) {
+        if (g->t[i].where != NPU_MEM_DRAM)
+            continue;
+        int j = n++;
+        while (j > 0) {
+            const NpuTensor* a = &g->t[order[j - 1]];
+            const NpuTensor* b = &g->t[i];
+            if (tensor_bytes(a) > tensor_bytes(b) ||
+                (tensor_bytes(a) == tensor_bytes(b) && a->first <= b->first))
+                break;
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    g->arena_bytes = 0;
+    g->naive_bytes = 0;
+    for (int i = 0; i < g->num_tensors; i++)
+        g->naive_bytes += plan_align(tensor_bytes(&g->t[i]));
+
+    for (int p = 0; p < n; p++) {
+        NpuTensor* t = &g->t[order[p]];
+        uint64_t size = plan_align(tensor_bytes(t));
+
+        // Placed tensors live at the same time, by offset
+        int busy[NPU_PLAN_MAX_TENSORS], nb = 0;
+        for (int q = 0; q < p; q++) {
+            const NpuTensor* u = &g->t[order[q]];
+            if (!lifetimes_overlap(t, u))
+                continue;
+            int j = nb++;
+            while (j > 0 && g->t[busy[j - 1]].offset > u->offset) {
+                busy[j] = busy[j - 1];
+                j--;
+            }
+            busy[j] = order[q];
+        }
+
+        uint64_t off = 0;
+        for (int q = 0; q < nb; q++) {
+            const NpuTensor* u = &g->t[busy[q]];
+            if (off + size <= u->offset)
+                break;
+            uint64_t end = u->offset + plan_align(tensor_bytes(u));
+            if (end > off)
+                off = end;
+        }
+        t->offset = off;
+        if (off + size > g->arena_bytes)
+            g->arena_bytes = off + size;
+    }
+    return g->arena_bytes;
+}
+
+uint32_t npu_plan_op_cfg(const NpuGraph* g, int op) {
+    const NpuOp* o = &g->op[op];
+    uint32_t cfg = 0;
+    if (o->kind != NPU_OP_GEMM)
+        return 0;
+    if (g->t[o->in[0]].where == NPU_MEM_ONCHIP)
+        cfg |= NPU_CFG_CHAIN_IN;
+    if (g->t[o->out].where == NPU_MEM_ONCHIP)
+        cfg |= NPU_CFG_CHAIN_OUT;
+    return cfg;
+}
+
+//-----------------------------------------------------------------------------
+// Reporting
+//-----------------------------------------------------------------------------
+
+void npu_plan_print(const NpuGraph* g, const char* label) {
+    printf("  --- Memory Plan: %s ---\n", label);
+    printf("  Graph           : %d ops, %d tensors (%d on chip, %llu bytes)\n",
+           g->num_ops, g->num_tensors, g->onchip, (unsigned long long)g->onchip_bytes);
+    printf("  Naive           : %llu bytes  (one buffer per tensor)\n",
+           (unsigned long long)g->naive_bytes);
+    printf("  Arena           : %llu bytes  (%.1f%% of naive)\n",
+           (unsigned long long)g->arena_bytes,
+           g->naive_bytes ? 100.0 * (double)g->arena_bytes / (double)g->naive_bytes : 0.0);
+}
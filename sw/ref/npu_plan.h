@@ -0,0 +1,99 @@
+//-----------------------------------------------------------------------------
+// NPU Activation Memory Planner Header
+// Description: Liveness-based placement of a layer graph's activations
+//              - Lifetime of a tensor: producing op → last consuming op
+//                (graph inputs from op 0, graph outputs to the last op)
+//              - Short-lived tensors go on chip: an INT8 (requantised) GEMM
+//                output read only by the next op, as its X operand, fits
+//                the input buffer and is chained (CONFIG.chain_out/in)
+//              - All other tensors share one DRAM arena: largest first, each
+//                at the lowest offset not used by a tensor live at the same
+//                time (offsets aligned to a DMA burst)
+//-----------------------------------------------------------------------------
+
+#ifndef NPU_PLAN_H
+#define NPU_PLAN_H
+
+#include "npu_emu.h"
+
+//-----------------------------------------------------------------------------
+// Configuration
+//-----------------------------------------------------------------------------
+#define NPU_PLAN_MAX_TENSORS     64
+#define NPU_PLAN_MAX_OPS         64
+#define NPU_PLAN_MAX_INPUTS      4
+#define NPU_PLAN_ALIGN           EMU_DMA_BURST_BYTES
+
+#define NPU_PLAN_FAIL            UINT64_MAX
+
+// Tensor flags
+#define NPU_TENSOR_INPUT         (1u << 0)   // Written by the host before op 0
+#define NPU_TENSOR_OUTPUT        (1u << 1)   // Read by the host after the last op
+
+typedef enum {
+    NPU_OP_GEMM = 0,    // Y = W * X, in[0] = X (weights are not planned)
+    NPU_OP_HOST = 1     // Host/CPU op (softmax, residual, ...): DRAM operands
+} NpuOpKind;
+
+typedef enum {
+    NPU_MEM_DRAM   = 0,   // Arena offset
+    NPU_MEM_ONCHIP = 1    // Input buffer (chained)
+} NpuMemKind;
+
+//-----------------------------------------------------------------------------
+// Data Structures
+//-----------------------------------------------------------------------------
+
+typedef struct {
+    uint64_t   elems;
+    int        elem_bytes;     // 1: INT8 (requantised), 4: INT32
+    uint32_t   flags;
+
+    // Plan
+    int        first;          // Producing op (0 for graph inputs)
+    int        last;           // Last op that reads it
+    int        consumers;
+    NpuMemKind where;
+    uint64_t   offset;         // Arena offset (NPU_MEM_DRAM)
+} NpuTensor;
+
+typedef struct {
+    NpuOpKind  kind;
+    int        num_in;
+    int        in[NPU_PLAN_MAX_INPUTS];
+    int        out;
+} NpuOp;
+
+typedef struct {
+    int        num_tensors;
+    int        num_ops;
+    NpuTensor  t[NPU_PLAN_MAX_TENSORS];
+    NpuOp      op[NPU_PLAN_MAX_OPS];
+
+    uint64_t   arena_bytes;    // Planned DRAM arena
+    uint64_t   naive_bytes;    // One buffer per tensor
+    uint64_t   onchip_bytes;   // Traffic kept on chip (chained tensors)
+    int        onchip;         // Chained tensors
+} NpuGraph;
+
+//-----------------------------------------------------------------------------
+// Function Prototypes
+//-----------------------------------------------------------------------------
+
+// Graph construction; ops are listed in execution order. Return the new
+// tensor/op id, or -1 if the graph is full or an operand is invalid
+void npu_graph_init(NpuGraph* g);
+int  npu_graph_tensor(NpuGraph* g, uint64_t elems, int elem_bytes, uint32_t flags);
+int  npu_graph_op(NpuGraph* g, NpuOpKind kind, const int* in, int num_in, int out);
+
+// Lifetimes, on-chip placement (onchip = 0: everything in DRAM) and arena
+// offsets; returns the arena size, or NPU_PLAN_FAIL if a tensor is read
+// before it is written or written twice
+uint64_t npu_plan(NpuGraph* g, int onchip);
+
+// CONFIG chain bits of a planned GEMM op
+uint32_t npu_plan_op_cfg(const NpuGraph* g, int op);
+
+void npu_plan_print(const NpuGraph* g, const char* label);
+
+#endif // NPU_PLAN_H
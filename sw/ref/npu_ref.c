@@ -4,6 +4,7 @@
 //-----------------------------------------------------------------------------
 
 #include "npu_ref.h"
+#include <math.h>
 
 //-----------------------------------------------------------------------------
 // Initialization Functions
@@ -131,27 +132,609 @@ void ref_gemv_tiled(int8_t* input, int8_t* weights, int32_t* output,
     }
 }
 
+//-----------------------------------------------------------------------------
+// Accumulator Width
+//-----------------------------------------------------------------------------
+
+int ref_acc_bits(int64_t k) {
+    int64_t hi = k << (INPUT_WIDTH + WEIGHT_WIDTH - 2);   // k * (-128 * -128)
+    int bits = 1;
+    while (bits < 63 && hi > ((int64_t)1 << (bits - 1)) - 1)
+        bits++;
+    return bits;
+}
+
+// Two's-complement wrap of v to bits bits
+static int64_t acc_wrap(int64_t v, int bits) {
+    uint64_t m = (uint64_t)1 << (bits - 1);
+    uint64_t u = (uint64_t)v & ((m << 1) - 1);
+    return (int64_t)(u ^ m) - (int64_t)m;
+}
+
+int ref_gemv_acc(const int8_t* input, const int8_t* weights, int32_t* output,
+                 int input_dim, int output_dim, int acc_bits, int col_bits) {
+    int wrapped = 0;
+    for (int o = 0; o < output_dim; o++) {
+        int64_t acc[SUBARRAY_COLS] = { 0 };
+        int row_wrapped = 0;
+        for (int i = 0; i < input_dim; i++) {
+            int c = i % SUBARRAY_COLS;
+            int bits = c == 0 ? acc_bits : col_bits;
+            int64_t sum = acc[c] + (int32_t)weights[(int64_t)o * input_dim + i] * (int32_t)input[i];
+            acc[c] = acc_wrap(sum, bits);
+            row_wrapped |= acc[c] != sum;
+        }
+        int64_t row = 0;
+        for (int c = 0; c < SUBARRAY_COLS; c++)
+            row += acc[c];
+        output[o] = (int32_t)acc_wrap(row, acc_bits);
+        row_wrapped |= output[o] != row;
+        wrapped += row_wrapped;
+    }
+    return wrapped;
+}
+
+//-----------------------------------------------------------------------------
+// Floating-Point MAC (fp_pkg.sv)
+//-----------------------------------------------------------------------------
+
+// 16-bit operand: value = m / 2^10 * 2^e
+typedef struct {
+    int      s, e, zero, inf, nan;
+    uint32_t m;
+} FpOp;
+
+static FpOp fp16_decode(uint16_t x, int fmt) {
+    FpOp d = { (x >> 15) & 1, 0, 0, 0, 0, 0 };
+    if (fmt == FMT_BF16) {
+        int ef = (x >> 7) & 0xFF, f = x & 0x7F;
+        d.e    = ef - 127;
+        d.m    = (0x80u | f) << 3;
+        d.zero = ef == 0;
+        d.inf  = ef == 0xFF && f == 0;
+        d.nan  = ef == 0xFF && f != 0;
+    } else {
+        int ef = (x >> 10) & 0x1F, f = x & 0x3FF;
+        d.e    = ef - 15;
+        d.m    = 0x400u | f;
+        d.inf  = ef == 0x1F && f == 0;
+        d.nan  = ef == 0x1F && f != 0;
+        if (ef == 0) {
+            // Subnormal: 0.f * 2^-14, normalised
+            d.zero = f == 0;
+            d.m    = f;
+            d.e    = -14;
+            while (!d.zero && !(d.m & 0x400)) {
+                d.m <<= 1;
+                d.e--;
+            }
+        }
+    }
+    return d;
+}
+
+uint32_t ref_fp_mul(uint16_t a, uint16_t b, int fmt) {
+    FpOp da = fp16_decode(a, fmt), db = fp16_decode(b, fmt);
+    uint32_t s = (uint32_t)(da.s ^ db.s) << 31;
+
+    if (da.nan || db.nan || (da.inf && db.zero) || (db.inf && da.zero))
+        return FP32_QNAN;
+    if (da.inf || db.inf)
+        return s | 0x7F800000u;
+    if (da.zero || db.zero)
+        return s;
+
+    // p / 2^20 in [1, 4)
+    uint32_t p = da.m * db.m, frac;
+    int e = da.e + db.e + 127;
+    if (p & (1u << 21)) {
+        e++;
+        frac = (p & 0x1FFFFF) << 2;
+    } else {
+        frac = (p & 0xFFFFF) << 3;
+    }
+    if (e >= 255)
+        return s | 0x7F800000u;
+    if (e <= 0)
+        return s;
+    return s | ((uint32_t)e << 23) | frac;
+}
+
+uint32_t ref_fp32_add(uint32_t a, uint32_t b) {
+    int ea = (a >> 23) & 0xFF, eb = (b >> 23) & 0xFF;
+    uint32_t fa = a & 0x7FFFFF, fb = b & 0x7FFFFF;
+
+    if ((ea == 0xFF && fa) || (eb == 0xFF && fb) ||
+        (ea == 0xFF && eb == 0xFF && (a >> 31) != (b >> 31)))
+        return FP32_QNAN;
+    if (ea == 0xFF) return a;
+    if (eb == 0xFF) return b;
+    if (ea == 0 && eb == 0) return a & b & 0x80000000u;
+    if (ea == 0) return b;
+    if (eb == 0) return a;
+
+    // |x| >= |y|
+    uint32_t x = a, y = b;
+    if ((a & 0x7FFFFFFF) < (b & 0x7FFFFFFF)) {
+        x = b;
+        y = a;
+    }
+    uint32_t s = x & 0x80000000u;
+    int e = (x >> 23) & 0xFF;
+    int d = e - (int)((y >> 23) & 0xFF);
+    uint32_t xm = (0x800000u | (x & 0x7FFFFF)) << 3;
+    uint32_t yfull = (0x800000u | (y & 0x7FFFFF)) << 3;
+    uint32_t ym = d >= 27 ? 1 : (yfull >> d) | ((yfull & ((1u << d) - 1)) != 0);
+
+    uint32_t sum;
+    if ((x ^ y) >> 31 == 0) {
+        sum = xm + ym;
+        if (sum & (1u << 27)) {
+            sum = (sum >> 1) | (sum & 1);
+            e++;
+        }
+    } else {
+        sum = xm - ym;
+        if (sum == 0)
+            return 0;
+        while (!(sum & (1u << 26))) {
+            sum <<= 1;
+            e--;
+        }
+    }
+
+    // sum[26:3] significand, sum[2] guard, sum[1] round, sum[0] sticky
+    uint32_t mant = sum >> 3;
+    if ((sum & 4) && (sum & 0xB))
+        mant++;
+    if (mant & (1u << 24)) {
+        mant >>= 1;
+        e++;
+    }
+    if (e >= 255)
+        return s | 0x7F800000u;
+    if (e <= 0)
+        return s;
+    return s | ((uint32_t)e << 23) | (mant & 0x7FFFFF);
+}
+
+uint32_t ref_f32_to_u32(float f) {
+    uint32_t u;
+    memcpy(&u, &f, 4);
+    return u;
+}
+
+float ref_u32_to_f32(uint32_t u) {
+    float f;
+    memcpy(&f, &u, 4);
+    return f;
+}
+
+uint16_t ref_f32_to_bf16(float f) {
+    uint32_t u = ref_f32_to_u32(f);
+    if ((u & 0x7F800000u) == 0x7F800000u && (u & 0x7FFFFF))
+        return 0x7FC0;
+    return (uint16_t)((u + 0x7FFF + ((u >> 16) & 1)) >> 16);
+}
+
+uint16_t ref_f32_to_fp16(float f) {
+    uint32_t u = ref_f32_to_u32(f);
+    uint16_t s = (uint16_t)((u >> 16) & 0x8000);
+    int e = (u >> 23) & 0xFF;
+    uint32_t m = u & 0x7FFFFF;
+    if (e == 0xFF)
+        return s | 0x7C00 | (m ? 0x200 : 0);
+    int E = e - 127 + 15;
+    if (E >= 31)
+        return s | 0x7C00;
+
+    // Normal: drop 13 bits; subnormal: value / 2^-24 (carry reaches the
+    // exponent field / smallest normal by itself)
+    int shift = 13;
+    uint32_t base = (uint32_t)E << 10;
+    if (E <= 0) {
+        if (E < -10)
+            return s;
+        m |= 0x800000;
+        shift = 14 - E;
+        base  = 0;
+    }
+    uint32_t q = m >> shift, rem = m & ((1u << shift) - 1), half = 1u << (shift - 1);
+    if (rem > half || (rem == half && (q & 1)))
+        q++;
+    return s | (uint16_t)(base + q);
+}
+
+float ref_bf16_to_f32(uint16_t h) {
+    return ref_u32_to_f32((uint32_t)h << 16);
+}
+
+float ref_fp16_to_f32(uint16_t h) {
+    int e = (h >> 10) & 0x1F, f = h & 0x3FF;
+    float v;
+    if (e == 0x1F)
+        v = f ? NAN : INFINITY;
+    else if (e == 0)
+        v = ldexpf((float)f, -24);
+    else
+        v = ldexpf((float)(0x400 | f), e - 25);
+    return (h & 0x8000) ? -v : v;
+}
+
+void ref_gemm_fp(const uint16_t* W, const uint16_t* X, uint32_t* Y,
+                 int M, int K, int N, int fmt) {
+    for (int m = 0; m < M; m++) {
+        for (int n = 0; n < N; n++) {
+            uint32_t lane[FP_COLS] = { 0 };
+            for (int k = 0; k < K; k++)
+                lane[k % FP_COLS] = ref_fp32_add(lane[k % FP_COLS],
+                                                 ref_fp_mul(X[(size_t)k * N + n],
+                                                            W[(size_t)m * K + k], fmt));
+            for (int w = FP_COLS; w > 1; w /= 2)
+                for (int i = 0; i < w / 2; i++)
+                    lane[i] = ref_fp32_add(lane[2 * i], lane[2 * i + 1]);
+            Y[(size_t)m * N + n] = lane[0];
+        }
+    }
+}
+
+// FP8 operand: value = m / 8 * 2^e (m[3] set unless zero)
+static FpOp fp8_decode(uint8_t x, int e5m2) {
+    FpOp d = { (x >> 7) & 1, 0, 0, 0, 0, 0 };
+    int ef, f, emin;
+    if (e5m2) {
+        ef     = (x >> 2) & 0x1F;
+        f      = (x & 3) << 1;
+        d.e    = ef - 15;
+        emin   = -14;
+        d.inf  = ef == 0x1F && f == 0;
+        d.nan  = ef == 0x1F && f != 0;
+    } else {
+        ef     = (x >> 3) & 0xF;
+        f      = x & 7;
+        d.e    = ef - 7;
+        emin   = -6;
+        d.nan  = ef == 0xF && f == 7;
+    }
+    d.m = 8u | (uint32_t)f;
+    if (ef == 0) {
+        // Subnormal: 0.f * 2^emin, normalised
+        d.zero = f == 0;
+        d.m    = (uint32_t)f;
+        d.e    = emin;
+        while (!d.zero && !(d.m & 8)) {
+            d.m <<= 1;
+            d.e--;
+        }
+    }
+    return d;
+}
+
+uint32_t ref_fp8_mul(uint8_t a, uint8_t b, int e5m2, int scale_exp) {
+    FpOp da = fp8_decode(a, e5m2), db = fp8_decode(b, e5m2);
+    uint32_t s = (uint32_t)(da.s ^ db.s) << 31;
+
+    if (da.nan || db.nan || (da.inf && db.zero) || (db.inf && da.zero))
+        return FP32_QNAN;
+    if (da.inf || db.inf)
+        return s | 0x7F800000u;
+    if (da.zero || db.zero)
+        return s;
+
+    // p / 2^6 in [1, 4)
+    uint32_t p = da.m * db.m, frac;
+    int e = da.e + db.e + scale_exp + 127;
+    if (p & 0x80) {
+        e++;
+        frac = (p & 0x7F) << 16;
+    } else {
+        frac = (p & 0x3F) << 17;
+    }
+    if (e >= 255)
+        return s | 0x7F800000u;
+    if (e <= 0)
+        return s;
+    return s | ((uint32_t)e << 23) | frac;
+}
+
+uint8_t ref_f32_to_fp8(float f, int e5m2) {
+    int mb = e5m2 ? 2 : 3, bias = e5m2 ? 15 : 7;
+    uint32_t max = e5m2 ? 0x7B : 0x7E, nan = e5m2 ? 0x7E : 0x7F;
+    uint32_t u = ref_f32_to_u32(f);
+    uint8_t s = (uint8_t)((u >> 24) & 0x80);
+    int e = (u >> 23) & 0xFF;
+    uint32_t m = u & 0x7FFFFF;
+    if (e == 0xFF)
+        return s | (uint8_t)(m ? nan : max);
+    if (e == 0)
+        return s;
+    int E = e - 127 + bias;
+
+    // As ref_f32_to_fp16: normal drops 23 - mb bits, subnormal is value /
+    // smallest subnormal; beyond the largest finite value saturates
+    int shift = 23 - mb;
+    uint32_t base = (uint32_t)(E > 0 ? E : 0) << mb;
+    if (E <= 0) {
+        if (E < -mb)
+            return s;
+        m |= 0x800000;
+        shift = 24 - mb - E;
+    }
+    uint32_t q = m >> shift, rem = m & ((1u << shift) - 1), half = 1u << (shift - 1);
+    if (rem > half || (rem == half && (q & 1)))
+        q++;
+    uint32_t r = base + q;
+    return s | (uint8_t)(r > max ? max : r);
+}
+
+float ref_fp8_to_f32(uint8_t h, int e5m2) {
+    float v;
+    if (e5m2) {
+        int e = (h >> 2) & 0x1F, f = h & 3;
+        if (e == 0x1F)
+            v = f ? NAN : INFINITY;
+        else if (e == 0)
+            v = ldexpf((float)f, -16);
+        else
+            v = ldexpf((float)(4 | f), e - 17);
+    } else {
+        int e = (h >> 3) & 0xF, f = h & 7;
+        if (e == 0xF && f == 7)
+            v = NAN;
+        else if (e == 0)
+            v = ldexpf((float)f, -9);
+        else
+            v = ldexpf((float)(8 | f), e - 10);
+    }
+    return (h & 0x80) ? -v : v;
+}
+
+void ref_mx_quantize(const float* x, int len, int e5m2, uint8_t* elems, uint8_t* scales) {
+    int emax = e5m2 ? 15 : 8;
+    float fmax = e5m2 ? 57344.0f : 448.0f;
+    for (int b = 0; b * MX_BLOCK < len; b++) {
+        int lo = b * MX_BLOCK, hi = lo + MX_BLOCK < len ? lo + MX_BLOCK : len;
+        float amax = 0.0f;
+        for (int i = lo; i < hi; i++)
+            amax = fmaxf(amax, fabsf(x[i]));
+        int se = 0;
+        if (amax > 0.0f) {
+            int ex;
+            frexpf(amax, &ex);
+            se = ex - 1 - emax;
+            if (ldexpf(amax, -se) > fmax)
+                se++;   // Top binade above the largest finite: no clamping
+        }
+        if (se < -MX_SCALE_ONE) se = -MX_SCALE_ONE;
+        if (se > MX_SCALE_ONE)  se = MX_SCALE_ONE;
+        scales[b] = (uint8_t)(se + MX_SCALE_ONE);
+        for (int i = lo; i < hi; i++)
+            elems[i] = ref_f32_to_fp8(ldexpf(x[i], -se), e5m2);
+    }
+}
+
+void ref_gemm_fp8(const uint8_t* W, const uint8_t* X, const uint8_t* w_scale,
+                  const uint8_t* x_scale, uint32_t* Y, int M, int K, int N, int e5m2) {
+    int kb = (K + MX_BLOCK - 1) / MX_BLOCK;
+    for (int m = 0; m < M; m++) {
+        for (int n = 0; n < N; n++) {
+            uint32_t lane[FP_COLS] = { 0 };
+            for (int k0 = 0; k0 < K; k0 += SUBARRAY_COLS) {
+                int ws = w_scale ? w_scale[(size_t)m * kb + k0 / MX_BLOCK] : MX_SCALE_ONE;
+                int xs = x_scale ? x_scale[(size_t)(k0 / MX_BLOCK) * N + n] : MX_SCALE_ONE;
+                for (int j = 0; j < FP_COLS; j++) {
+                    uint32_t p[2];
+                    for (int h = 0; h < 2; h++) {
+                        int k = k0 + 2 * j + h;
+                        p[h] = 0;
+                        if (k < K)
+                            p[h] = ref_fp8_mul(X[(size_t)k * N + n], W[(size_t)m * K + k],
+                                               e5m2, ws + xs - 2 * MX_SCALE_ONE);
+                    }
+                    uint32_t pair = (ws == MX_SCALE_NAN || xs == MX_SCALE_NAN)
+                                    ? FP32_QNAN : ref_fp32_add(p[0], p[1]);
+                    lane[j] = ref_fp32_add(lane[j], pair);
+                }
+            }
+            for (int w = FP_COLS; w > 1; w /= 2)
+                for (int i = 0; i < w / 2; i++)
+                    lane[i] = ref_fp32_add(lane[2 * i], lane[2 * i + 1]);
+            Y[(size_t)m * N + n] = lane[0];
+        }
+    }
+}
+
+// Horizontally fused GeMV: segments share one input vector, their weights
+// are concatenated row-wise ([sum seg_dims][input_dim]). The concatenation is
+// tiled as one GeMV (tiles may straddle segments), then rows are scattered
+// to the per-segment outputs.
+void ref_gemv_fused(int8_t* input, int8_t* weights, int32_t** outputs,
+                    const int* seg_dims, int num_segs, int input_dim) {
+    int total = 0;
+    for (int s = 0; s < num_segs; s++)
+        total += seg_dims[s];
+
+    int32_t* cat = (int32_t*)malloc(total * sizeof(int32_t));
+    ref_gemv_tiled(input, weights, cat, input_dim, total);
+
+    int row = 0;
+    for (int s = 0; s < num_segs; s++) {
+        memcpy(outputs[s], &cat[row], seg_dims[s] * sizeof(int32_t));
+        row += seg_dims[s];
+    }
+    free(cat);
+}
+
+// Requantise INT32 accumulators to INT8 (matches requant_unit.sv):
+// y = clamp((x * scale + round) >> shift, -128, 127), round = 1 << (shift-1)
+void ref_requant(const int32_t* input, int8_t* output, int len,
+                 int16_t scale, int shift, int relu) {
+    int64_t round = (shift > 0) ? ((int64_t)1 << (shift - 1)) : 0;
+    for (int i = 0; i < len; i++) {
+        int64_t y = ((int64_t)input[i] * scale + round) >> shift;
+        if (relu && y < 0) y = 0;
+        if (y > 127)  y = 127;
+        if (y < -128) y = -128;
+        output[i] = (int8_t)y;
+    }
+}
+
+// RoPE table: cos/sin rounded to Q1.14 (|value| <= 1 << 14 fits int16).
+// The table is data to the NPU; bit-exactness only depends on ref_rope().
+void ref_rope_table(uint32_t* table, int positions, int head_dim) {
+    int pairs = head_dim / 2;
+    double one = (double)(1 << ROPE_FRAC_BITS);
+    for (int p = 0; p < positions; p++) {
+        for (int i = 0; i < pairs; i++) {
+            double angle = p * pow(ROPE_THETA, -2.0 * i / head_dim);
+            int16_t c = (int16_t)lround(cos(angle) * one);
+            int16_t s = (int16_t)lround(sin(angle) * one);
+            table[(size_t)p * pairs + i] = ((uint32_t)(uint16_t)s << 16) | (uint16_t)c;
+        }
+    }
+}
+
+// Fixed-point rotation (matches rope_unit.sv), per pair (x0, x1):
+//   y0 = sat32((x0*c - x1*s + round) >> FRAC), y1 = sat32((x0*s + x1*c + round) >> FRAC)
+// round = 1 << (FRAC-1), arithmetic shift, 64-bit intermediates
+static int32_t rope_sat32(int64_t v) {
+    if (v > INT32_MAX) return INT32_MAX;
+    if (v < INT32_MIN) return INT32_MIN;
+    return (int32_t)v;
+}
+
+void ref_rope(int32_t* Y, int M, int N, int head_dim, const uint32_t* table, int pos0) {
+    int pairs = head_dim / 2;
+    int64_t round = (int64_t)1 << (ROPE_FRAC_BITS - 1);
+    for (int n = 0; n < N; n++) {
+        const uint32_t* cs = &table[(size_t)(pos0 + n) * pairs];
+        for (int m = 0; m + 1 < M; m += 2) {
+            int i = (m % head_dim) / 2;
+            int64_t c  = (int16_t)(cs[i] & 0xFFFF);
+            int64_t s  = (int16_t)(cs[i] >> 16);
+            int64_t x0 = Y[(size_t)m * N + n];
+            int64_t x1 = Y[(size_t)(m + 1) * N + n];
+            Y[(size_t)m * N + n]       = rope_sat32((x0 * c - x1 * s + round) >> ROPE_FRAC_BITS);
+            Y[(size_t)(m + 1) * N + n] = rope_sat32((x0 * s + x1 * c + round) >> ROPE_FRAC_BITS);
+        }
+    }
+}
+
+// Top-k (matches topk_unit.sv): the best k outputs under the order
+// (value descending, index ascending), sorted. The order is total, so the
+// result does not depend on the order in which the per-PE units see the
+// values or on how their lists are merged.
+// Returns the number of pairs written (min(k, len)).
+int ref_topk(const int32_t* input, int len, int k, int32_t* idx, int32_t* val) {
+    int n = 0;
+    for (int i = 0; i < len; i++) {
+        // Indices arrive ascending: a tie never moves ahead of an entry
+        int pos = n;
+        while (pos > 0 && input[i] > val[pos - 1])
+            pos--;
+        if (pos >= k)
+            continue;
+        int last = (n < k) ? n : k - 1;
+        for (int j = last; j > pos; j--) {
+            idx[j] = idx[j - 1];
+            val[j] = val[j - 1];
+        }
+        idx[pos] = i;
+        val[pos] = input[i];
+        if (n < k) n++;
+    }
+    return n;
+}
+
+// Trace unit (matches trace_unit.sv): each cycle the lowest pending event is
+// written to the ring, then the cycle's accepted events take their slots (a
+// slot still full drops the event). Status updates (trigger, stop) take
+// effect from the next cycle. Runs past the stimulus until nothing is
+// pending or recording stopped.
+void ref_trace_unit(TraceRun* run, const uint8_t* valid, const uint32_t* arg,
+                    int cycles, uint32_t* ring) {
+    uint32_t pend = 0;
+    uint32_t pend_ts[TRACE_NUM_EVENTS], pend_arg[TRACE_NUM_EVENTS];
+
+    run->wr_ptr    = 0;
+    run->wrapped   = 0;
+    run->triggered = 0;
+    run->stopped   = 0;
+    run->dropped   = 0;
+
+    for (int c = 0; c < cycles || (pend && !run->stopped); c++) {
+        uint32_t v    = c < cycles ? valid[c] : 0;
+        int      fire = pend && !run->stopped;
+        int      sel  = 0;
+        uint32_t next = pend;
+
+        if (fire) {
+            while (!((pend >> sel) & 1))
+                sel++;
+            ring[2 * run->wr_ptr]     = pend_ts[sel];
+            ring[2 * run->wr_ptr + 1] = ((uint32_t)sel << 24) | pend_arg[sel];
+            next &= ~(1u << sel);
+        }
+        for (int e = 0; e < TRACE_NUM_EVENTS; e++) {
+            int accept = ((v >> e) & 1) && ((run->filter >> e) & 1) && !run->stopped &&
+                         (run->triggered || !run->trig_en || e == run->trig_event);
+            if (!accept)
+                continue;
+            if (((pend >> e) & 1) && !(fire && sel == e)) {
+                run->dropped++;
+                continue;
+            }
+            next       |= 1u << e;
+            pend_ts[e]  = (uint32_t)c;
+            pend_arg[e] = arg[(size_t)c * TRACE_NUM_EVENTS + e] & TRACE_ARG_MASK;
+        }
+        if (run->trig_en && ((v >> run->trig_event) & 1))
+            run->triggered = 1;
+        if (fire) {
+            if (run->wr_ptr == (uint32_t)run->depth - 1) {
+                run->wrapped = 1;
+                run->stopped = run->stop_full;
+            }
+            run->wr_ptr = (run->wr_ptr + 1) % (uint32_t)run->depth;
+        }
+        pend = next;
+    }
+}
+
 // Tiled GeMM: process large matrices using 32x8 sub-array tiles
 void ref_gemm_tiled(int8_t* A, int8_t* B, int32_t* C,
                     int M, int K, int N) {
+    ref_gemm_tiled_region(A, B, C, M, K, N, 0, M, 0, N);
+}
+
+// Tiled GeMM over a sub-block of C: rows [m_begin, m_end), cols [n_begin, n_end)
+// Only the selected C elements are cleared and recomputed, in the same
+// M-tile / K-tile order as the full tiled GeMM (bit-exact with it)
+void ref_gemm_tiled_region(int8_t* A, int8_t* B, int32_t* C,
+                           int M, int K, int N,
+                           int m_begin, int m_end, int n_begin, int n_end) {
 
     int tile_m = SUBARRAY_ROWS;  // 32
     int tile_k = SUBARRAY_COLS;  // 8
 
-    // Initialize output
-    memset(C, 0, M * N * sizeof(int32_t));
+    if (m_end > M) m_end = M;
+    if (n_end > N) n_end = N;
+
+    // Initialize output region
+    for (int m = m_begin; m < m_end; m++)
+        memset(&C[m * N + n_begin], 0, (n_end - n_begin) * sizeof(int32_t));
 
     // Tile over M dimension
-    for (int m_tile = 0; m_tile < M; m_tile += tile_m) {
-        int m_end = (m_tile + tile_m < M) ? m_tile + tile_m : M;
+    for (int m_tile = m_begin; m_tile < m_end; m_tile += tile_m) {
+        int m_stop = (m_tile + tile_m < m_end) ? m_tile + tile_m : m_end;
 
         // Tile over K dimension (accumulate partial sums)
         for (int k_tile = 0; k_tile < K; k_tile += tile_k) {
             int k_end = (k_tile + tile_k < K) ? k_tile + tile_k : K;
 
-            // Process all N columns for this M x K tile
-            for (int n = 0; n < N; n++) {
-                for (int m = m_tile; m < m_end; m++) {
+            // Process selected N columns for this M x K tile
+            for (int n = n_begin; n < n_end; n++) {
+                for (int m = m_tile; m < m_stop; m++) {
                     for (int k = k_tile; k < k_end; k++) {
                         int idx_a = m * K + k;
                         int idx_b = k * N + n;
@@ -164,6 +747,136 @@ void ref_gemm_tiled(int8_t* A, int8_t* B, int32_t* C,
     }
 }
 
+// Fast GeMM for emulation: m-k-n loop order keeps B and C rows contiguous
+// (A element hoisted). INT32 accumulation is order independent, so results
+// are bit-exact with ref_gemm / ref_gemm_tiled.
+void ref_gemm_fast(const int8_t* A, const int8_t* B, int32_t* C,
+                   int M, int K, int N) {
+    if (N == 1) {
+        // GeMV: contiguous dot product per output row
+        for (int m = 0; m < M; m++) {
+            const int8_t* a = &A[(int64_t)m * K];
+            int32_t sum = 0;
+            for (int k = 0; k < K; k++)
+                sum += (int32_t)a[k] * (int32_t)B[k];
+            C[m] = sum;
+        }
+        return;
+    }
+
+    for (int m = 0; m < M; m++) {
+        int32_t* c = &C[(int64_t)m * N];
+        memset(c, 0, N * sizeof(int32_t));
+        for (int k = 0; k < K; k++) {
+            int32_t a = A[(int64_t)m * K + k];
+            const int8_t* b = &B[(int64_t)k * N];
+            for (int n = 0; n < N; n++)
+                c[n] += a * (int32_t)b[n];
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Incremental GeMM Update (dirty-tile recompute + in-place output patch)
+//-----------------------------------------------------------------------------
+
+// Write C[first .. first+len) into an already generated output file
+// Hex files use fixed-width lines, so element i lives at i * line_bytes
+static int patch_elements(FILE* fp, void* data, int first, int len,
+                          int width, int binary) {
+    int elem_bytes = width / 8;
+    long line_bytes = binary ? elem_bytes : (width / 4) + 1;  // digits + '\n'
+
+    if (fseek(fp, (long)first * line_bytes, SEEK_SET) != 0)
+        return -1;
+
+    if (binary) {
+        uint8_t* d = (uint8_t*)data + (long)first * elem_bytes;
+        return (fwrite(d, elem_bytes, len, fp) == (size_t)len) ? 0 : -1;
+    }
+
+    if (width == 8) {
+        int8_t* d = (int8_t*)data;
+        for (int i = first; i < first + len; i++)
+            fprintf(fp, "%02X\n", (uint8_t)d[i]);
+    } else if (width == 32) {
+        int32_t* d = (int32_t*)data;
+        for (int i = first; i < first + len; i++)
+            fprintf(fp, "%08X\n", (uint32_t)d[i]);
+    }
+    return ferror(fp) ? -1 : 0;
+}
+
+// Recompute only the C elements affected by a GemmDirty region
+//   - changed A rows invalidate whole C rows (widened to M-tile boundaries)
+//   - changed B cols invalidate C cols in every remaining M tile
+// If c_file is non-NULL, the recomputed elements are patched into it in place
+// Returns number of recomputed C elements, or -1 on file error
+int ref_gemm_update(int8_t* A, int8_t* B, int32_t* C, int M, int K, int N,
+                    const GemmDirty* dirty, const char* c_file, int binary) {
+
+    int tile_m = SUBARRAY_ROWS;
+    int recomputed = 0;
+
+    // Dirty C row band (tile aligned)
+    int m0 = 0, m1 = 0;
+    if (dirty->a_row_begin < dirty->a_row_end) {
+        m0 = (dirty->a_row_begin / tile_m) * tile_m;
+        m1 = ((dirty->a_row_end + tile_m - 1) / tile_m) * tile_m;
+        if (m0 < 0) m0 = 0;
+        if (m1 > M) m1 = M;
+    }
+
+    // Dirty C col band
+    int n0 = 0, n1 = 0;
+    if (dirty->b_col_begin < dirty->b_col_end) {
+        n0 = (dirty->b_col_begin < 0) ? 0 : dirty->b_col_begin;
+        n1 = (dirty->b_col_end > N) ? N : dirty->b_col_end;
+    }
+
+    FILE* fp = NULL;
+    if (c_file) {
+        fp = fopen(c_file, binary ? "r+b" : "r+");
+        if (!fp) {
+            printf("Error: Cannot open file %s\n", c_file);
+            return -1;
+        }
+    }
+
+    int err = 0;
+
+    // Row band: whole rows are contiguous in C
+    if (m0 < m1) {
+        ref_gemm_tiled_region(A, B, C, M, K, N, m0, m1, 0, N);
+        recomputed += (m1 - m0) * N;
+        if (fp)
+            err |= patch_elements(fp, C, m0 * N, (m1 - m0) * N, 32, binary);
+    }
+
+    // Col band: every M tile outside the row band, one segment per row
+    if (n0 < n1) {
+        for (int m_tile = 0; m_tile < M; m_tile += tile_m) {
+            int m_stop = (m_tile + tile_m < M) ? m_tile + tile_m : M;
+            if (m0 < m1 && m_tile >= m0 && m_stop <= m1)
+                continue;  // Already recomputed with the row band
+
+            ref_gemm_tiled_region(A, B, C, M, K, N, m_tile, m_stop, n0, n1);
+            recomputed += (m_stop - m_tile) * (n1 - n0);
+            for (int m = m_tile; fp && m < m_stop; m++)
+                err |= patch_elements(fp, C, m * N + n0, n1 - n0, 32, binary);
+        }
+    }
+
+    if (fp) {
+        fclose(fp);
+        if (err) {
+            printf("Error: Cannot patch file %s\n", c_file);
+            return -1;
+        }
+    }
+    return recomputed;
+}
+
 //-----------------------------------------------------------------------------
 // Utility Functions
 //-----------------------------------------------------------------------------
@@ -227,12 +940,42 @@ void generate_random_i8(int8_t* data, int len, int seed) {
     }
 }
 
+static uint64_t splitmix64_mix(uint64_t z) {
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Counter-based INT8 generator: element idx of stream 'seed' does not depend
+// on how the stream is split, so shards can generate their slice directly.
+// The seed is hashed into the counter base, so streams of different seeds do
+// not alias for any idx
+int8_t generate_random_i8_at(int seed, int64_t idx) {
+    uint64_t z = splitmix64_mix((uint64_t)(uint32_t)seed) + (uint64_t)idx;
+    return (int8_t)(splitmix64_mix(z) & 0xFF);
+}
+
 void generate_sequential_i8(int8_t* data, int len, int8_t start) {
     for (int i = 0; i < len; i++) {
         data[i] = start + i;
     }
 }
 
+//-----------------------------------------------------------------------------
+// Checksums (32-bit FNV-1a over 32-bit words, cheap to mirror in RTL/TB)
+//-----------------------------------------------------------------------------
+
+uint32_t ref_hash_u32(uint32_t hash, uint32_t word) {
+    return (hash ^ word) * REF_HASH_PRIME;
+}
+
+uint32_t ref_hash_i32(uint32_t hash, const int32_t* data, int64_t len) {
+    for (int64_t i = 0; i < len; i++)
+        hash = ref_hash_u32(hash, (uint32_t)data[i]);
+    return hash;
+}
+
 //-----------------------------------------------------------------------------
 // File I/O for RTL Comparison
 //-----------------------------------------------------------------------------
@@ -260,6 +1003,74 @@ void dump_to_hex_file(const char* filename, void* data, int len, int width) {
     printf("Dumped %d elements to %s\n", len, filename);
 }
 
+void dump_to_bin_file(const char* filename, void* data, int len, int width) {
+    FILE* fp = fopen(filename, "wb");
+    if (!fp) {
+        printf("Error: Cannot open file %s\n", filename);
+        return;
+    }
+
+    fwrite(data, width / 8, len, fp);
+
+    fclose(fp);
+    printf("Dumped %d elements to %s\n", len, filename);
+}
+
+// Per-tile checksum file: one 32-bit FNV-1a hash per tile_len consecutive
+// elements (last tile may be short). Lets testbenches compare pass/fail by hash
+void dump_tile_hash_file(const char* filename, int32_t* data, int len, int tile_len) {
+    FILE* fp = fopen(filename, "w");
+    if (!fp) {
+        printf("Error: Cannot open file %s\n", filename);
+        return;
+    }
+
+    int num_tiles = 0;
+    for (int i = 0; i < len; i += tile_len) {
+        int n = (i + tile_len < len) ? tile_len : len - i;
+        fprintf(fp, "%08X\n", ref_hash_i32(REF_HASH_INIT, &data[i], n));
+        num_tiles++;
+    }
+
+    fclose(fp);
+    printf("Dumped %d tile hashes (%d elements/tile) to %s\n", num_tiles, tile_len, filename);
+}
+
+// One GEMM output tile in hardware drain order: column segment
+// C[m_tile .. m_tile+tile_m-1][n] (rows past M read as 0, as the padded
+// subarray drains them)
+void ref_gemm_drain_tile(const int32_t* C, int M, int N, int m_tile, int n,
+                         int32_t* tile, int tile_m) {
+    for (int r = 0; r < tile_m; r++)
+        tile[r] = (m_tile + r < M) ? C[(m_tile + r) * N + n] : 0;
+}
+
+// Per-tile checksum file for a row-major M x N GEMM output: one hash per
+// (m_tile, n) output tile, M-tile outer / column inner (the order the
+// tiled GEMM drains them)
+void dump_gemm_tile_hash_file(const char* filename, const int32_t* C,
+                              int M, int N, int tile_m) {
+    FILE* fp = fopen(filename, "w");
+    if (!fp) {
+        printf("Error: Cannot open file %s\n", filename);
+        return;
+    }
+
+    int32_t* tile = (int32_t*)malloc(tile_m * sizeof(int32_t));
+    int num_tiles = 0;
+    for (int m_tile = 0; m_tile < M; m_tile += tile_m) {
+        for (int n = 0; n < N; n++) {
+            ref_gemm_drain_tile(C, M, N, m_tile, n, tile, tile_m);
+            fprintf(fp, "%08X\n", ref_hash_i32(REF_HASH_INIT, tile, tile_m));
+            num_tiles++;
+        }
+    }
+    free(tile);
+
+    fclose(fp);
+    printf("Dumped %d GEMM tile hashes (%d rows/tile) to %s\n", num_tiles, tile_m, filename);
+}
+
 int load_from_hex_file(const char* filename, void* data, int len, int width) {
     FILE* fp = fopen(filename, "r");
     if (!fp) {
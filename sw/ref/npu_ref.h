@@ -18,6 +18,30 @@
 #define WEIGHT_WIDTH     8
 #define OUTPUT_WIDTH     32
 
+// Accumulators sized for dot products up to MAX_K (npu_pkg MAX_K):
+// ACC_WIDTH = ref_acc_bits(MAX_K), COL_ACC_WIDTH = ref_acc_bits(MAX_K / 8)
+// for MAC columns 1..7, which see every SUBARRAY_COLS-th product only
+#define MAX_K            16384
+#define ACC_WIDTH        30
+#define COL_ACC_WIDTH    27
+
+// Element formats (CONFIG.fmt, fp_pkg.sv): BF16/FP16 elements are lane
+// pairs, SUBARRAY_COLS / 2 per line, FP32 accumulate. FP8 (E4M3/E5M2)
+// elements are one lane each; a lane pair's two products are summed
+// before they reach the FP32 accumulator
+#define FMT_INT8         0
+#define FMT_BF16         1
+#define FMT_FP16         2
+#define FMT_FP8          3
+#define FP_COLS          (SUBARRAY_COLS / 2)
+#define FP32_QNAN        0x7FC00000u
+
+// MX (OCP microscaling): one E8M0 scale 2^(s - 127) per MX_BLOCK
+// consecutive K elements of a W row / X column, 0xFF = NaN
+#define MX_BLOCK         32
+#define MX_SCALE_ONE     127
+#define MX_SCALE_NAN     0xFF
+
 #define SUBARRAY_ROWS    32    // Output vector size
 #define SUBARRAY_COLS    8     // Input vector size
 
@@ -37,6 +61,12 @@
 #define LLAMA_INTERMEDIATE   11008
 #define LLAMA_NUM_HEADS      32
 #define LLAMA_HEAD_DIM       128
+#define LLAMA_VOCAB          32000
+
+// Rotary position embedding: pairs (2i, 2i+1) of each head rotated by
+// pos * ROPE_THETA^(-2i/head_dim); cos/sin in Q1.ROPE_FRAC_BITS
+#define ROPE_THETA           10000.0
+#define ROPE_FRAC_BITS       14
 
 // Smaller model for testing (fits single sub-array)
 #define TEST_INPUT_DIM       SUBARRAY_COLS   // 8
@@ -63,6 +93,34 @@ typedef struct {
     int32_t* C;           // [M][N] output
 } GemmLayer;
 
+// Changed input ranges for incremental GeMM recompute (empty when begin >= end)
+// A change in A rows affects the same C rows; a change in B cols affects the
+// same C cols. K-range changes (A cols / B rows) touch all of C: use
+// ref_gemm_tiled instead.
+typedef struct {
+    int a_row_begin;      // First changed row of A
+    int a_row_end;        // One past last changed row of A
+    int b_col_begin;      // First changed col of B
+    int b_col_end;        // One past last changed col of B
+} GemmDirty;
+
+// Trace unit run (trace_unit.sv): configuration in, final status out
+#define TRACE_NUM_EVENTS 8
+#define TRACE_ARG_MASK   0xFFFFFFu
+typedef struct {
+    int      depth;       // Ring entries
+    uint32_t filter;      // Bit e: record event e
+    int      stop_full;
+    int      trig_en;
+    int      trig_event;
+    // Status
+    uint32_t wr_ptr;
+    int      wrapped;
+    int      triggered;
+    int      stopped;
+    uint32_t dropped;
+} TraceRun;
+
 //-----------------------------------------------------------------------------
 // Function Prototypes
 //-----------------------------------------------------------------------------
@@ -84,6 +142,90 @@ void ref_gemv_tiled(int8_t* input, int8_t* weights, int32_t* output,
                     int input_dim, int output_dim);
 void ref_gemm_tiled(int8_t* A, int8_t* B, int32_t* C,
                     int M, int K, int N);
+void ref_gemv_fused(int8_t* input, int8_t* weights, int32_t** outputs,
+                    const int* seg_dims, int num_segs, int input_dim);
+
+// Accumulator guard bits: signed width that holds any sum of k INT8
+// products (k * -128 * -128 sets the bound)
+int ref_acc_bits(int64_t k);
+
+// GeMV through gemv_subarray accumulators of acc_bits bits (column 0 and
+// the row adder) and col_bits bits (columns 1..7), wrapping like the RTL;
+// output sign-extended. Returns the number of rows where any accumulator
+// wrapped (output then differs from ref_gemv_tiled)
+int ref_gemv_acc(const int8_t* input, const int8_t* weights, int32_t* output,
+                 int input_dim, int output_dim, int acc_bits, int col_bits);
+
+// Floating-point MAC (bit-exact with fp_pkg.sv): BF16/FP16 product → FP32
+// (FP16 subnormals exact, BF16/FP32 subnormal inputs read as zero, results
+// below the normal range flush to signed zero), FP32 add with RNE
+uint32_t ref_fp_mul(uint16_t a, uint16_t b, int fmt);
+uint32_t ref_fp32_add(uint32_t a, uint32_t b);
+
+// Encode (RNE) / decode BF16 and FP16
+uint16_t ref_f32_to_bf16(float f);
+uint16_t ref_f32_to_fp16(float f);
+float    ref_bf16_to_f32(uint16_t h);
+float    ref_fp16_to_f32(uint16_t h);
+float    ref_u32_to_f32(uint32_t u);
+uint32_t ref_f32_to_u32(float f);
+
+// FP8 product with an exponent offset (MX scales) → FP32, same rules as
+// ref_fp_mul. E4M3: no inf, S.1111.111 NaN; E5M2: IEEE-style inf/NaN
+uint32_t ref_fp8_mul(uint8_t a, uint8_t b, int e5m2, int scale_exp);
+
+// FP8 encode (RNE, saturating to the largest finite value) / decode
+uint8_t  ref_f32_to_fp8(float f, int e5m2);
+float    ref_fp8_to_f32(uint8_t h, int e5m2);
+
+// MX quantisation of len values: per MX_BLOCK block the scale makes the
+// block maximum land in the top binade of the element format (OCP MX:
+// floor(log2(amax)) - emax, one more if that would clamp the maximum),
+// elements are ref_f32_to_fp8(x / scale)
+void ref_mx_quantize(const float* x, int len, int e5m2, uint8_t* elems, uint8_t* scales);
+
+// GeMM in FP8 (optionally MX block-scaled): W[M][K], X[K][N] FP8 bytes,
+// w_scale[M][ceil(K / MX_BLOCK)], x_scale[ceil(K / MX_BLOCK)][N] E8M0 or
+// NULL (scale 1). Line t (elements 8t..8t+7, zero padded past K) adds
+// (p[8t+2j] + p[8t+2j+1]) to lane j, lanes reduced as in ref_gemm_fp.
+// N = 1 is the GEMV
+void ref_gemm_fp8(const uint8_t* W, const uint8_t* X, const uint8_t* w_scale,
+                  const uint8_t* x_scale, uint32_t* Y, int M, int K, int N, int e5m2);
+
+// GeMM in BF16/FP16 through gemv_subarray's FP MACs: W[M][K], X[K][N],
+// Y[M][N] FP32 bits. Element k goes to lane k % FP_COLS (accumulated in k
+// order), lanes reduced pairwise ((l0 + l1) + (l2 + l3))
+void ref_gemm_fp(const uint16_t* W, const uint16_t* X, uint32_t* Y,
+                 int M, int K, int N, int fmt);
+
+// Output requantisation INT32 → INT8 (layer chaining)
+void ref_requant(const int32_t* input, int8_t* output, int len,
+                 int16_t scale, int shift, int relu);
+
+// RoPE table [positions][head_dim/2] of {int16 cos (low), int16 sin (high)}
+// and the fixed-point rotation of Y[M][N] (column n at position pos0 + n)
+void ref_rope_table(uint32_t* table, int positions, int head_dim);
+void ref_rope(int32_t* Y, int M, int N, int head_dim, const uint32_t* table, int pos0);
+
+// Streaming top-k of a logit vector (sorted, ties → lower index first)
+int ref_topk(const int32_t* input, int len, int k, int32_t* idx, int32_t* val);
+
+// Event trace: valid[c] bit e = event e in cycle c (timestamp c), argument
+// arg[c * TRACE_NUM_EVENTS + e]; ring[2i] = ts, ring[2i + 1] = {id, arg}
+void ref_trace_unit(TraceRun* run, const uint8_t* valid, const uint32_t* arg,
+                    int cycles, uint32_t* ring);
+
+void ref_gemm_tiled_region(int8_t* A, int8_t* B, int32_t* C,
+                           int M, int K, int N,
+                           int m_begin, int m_end, int n_begin, int n_end);
+
+// Fast (cache-friendly) GeMM, bit-exact with ref_gemm_tiled
+void ref_gemm_fast(const int8_t* A, const int8_t* B, int32_t* C,
+                   int M, int K, int N);
+
+// Incremental GeMM (recompute dirty tiles, patch c_file in place if non-NULL)
+int ref_gemm_update(int8_t* A, int8_t* B, int32_t* C, int M, int K, int N,
+                    const GemmDirty* dirty, const char* c_file, int binary);
 
 // Utility functions
 void print_vector_i8(const char* name, int8_t* vec, int len);
@@ -94,9 +236,22 @@ void print_matrix_i32(const char* name, int32_t* mat, int rows, int cols);
 // Test data generation
 void generate_random_i8(int8_t* data, int len, int seed);
 void generate_sequential_i8(int8_t* data, int len, int8_t start);
+int8_t generate_random_i8_at(int seed, int64_t idx);
+
+// Checksums (FNV-1a over 32-bit words)
+#define REF_HASH_INIT    0x811C9DC5u
+#define REF_HASH_PRIME   0x01000193u
+uint32_t ref_hash_u32(uint32_t hash, uint32_t word);
+uint32_t ref_hash_i32(uint32_t hash, const int32_t* data, int64_t len);
 
 // File I/O for RTL comparison
 void dump_to_hex_file(const char* filename, void* data, int len, int width);
+void dump_tile_hash_file(const char* filename, int32_t* data, int len, int tile_len);
+void ref_gemm_drain_tile(const int32_t* C, int M, int N, int m_tile, int n,
+                         int32_t* tile, int tile_m);
+void dump_gemm_tile_hash_file(const char* filename, const int32_t* C,
+                              int M, int N, int tile_m);
+void dump_to_bin_file(const char* filename, void* data, int len, int width);
 int load_from_hex_file(const char* filename, void* data, int len, int width);
 
 #endif // NPU_REF_H
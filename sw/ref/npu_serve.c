@@ -0,0 +1,293 @@
+//-----------------------------------------------------------------------------
+// NPU Serving Runtime
+// Description: Continuous-batching decode loop over one NpuEmu instance
+//              The batch is re-formed every step: finished sequences free
+//              their column, waiting requests fill free columns in arrival
+//              order. NPU time comes from the emulator cycle model, host
+//              time from the EMU_HOST_* costs in npu_serve.h
+//-----------------------------------------------------------------------------
+
+#include "npu_serve.h"
+
+//-----------------------------------------------------------------------------
+// Setup
+//-----------------------------------------------------------------------------
+
+int npu_serve_init(NpuServe* srv, NpuEmu* emu, const NpuModel* model,
+                   uint32_t ids_addr, uint32_t logits_addr, int max_batch,
+                   NpuBatchPolicy policy, int overlap) {
+    if (max_batch < 1 || max_batch > NPU_SERVE_MAX_BATCH ||
+        model->layers < 0 || model->layers > NPU_SERVE_MAX_LAYERS ||
+        model->vocab <= 0 || model->hidden <= 0 ||
+        (uint64_t)model->hidden * max_batch > EMU_IBUF_BYTES ||
+        (ids_addr & 3) || (logits_addr & 3))
+        return -1;
+
+    memset(srv, 0, sizeof(*srv));
+    srv->emu         = emu;
+    srv->model       = *model;
+    srv->policy      = policy;
+    srv->max_batch   = max_batch;
+    srv->overlap     = overlap;
+    srv->ids_addr    = ids_addr;
+    srv->logits_addr = logits_addr;
+    srv->logits      = (int32_t*)malloc((size_t)model->vocab * max_batch * sizeof(int32_t));
+    if (srv->logits == NULL)
+        return -1;
+
+    // Next step's first weight tiles load during the current job's compute
+    npu_emu_write_reg(emu, NPU_REG_QUEUE, NPU_QUEUE_PREFETCH);
+    return 0;
+}
+
+void npu_serve_free(NpuServe* srv) {
+    for (int i = 0; i < srv->num_seqs; i++)
+        free(srv->seq[i].out);
+    free(srv->logits);
+    free(srv->step_lat);
+    srv->num_seqs = 0;
+    srv->logits   = NULL;
+    srv->step_lat = NULL;
+}
+
+int npu_serve_submit(NpuServe* srv, const uint32_t* prompt, int prompt_len,
+                     int max_new, uint64_t arrival) {
+    if (srv->num_seqs >= NPU_SERVE_MAX_SEQS || prompt_len < 1 || max_new < 1)
+        return -1;
+    for (int i = 0; i < prompt_len; i++)
+        if (prompt[i] >= (uint32_t)srv->model.vocab)
+            return -1;
+
+    NpuSeq* s = &srv->seq[srv->num_seqs];
+    memset(s, 0, sizeof(*s));
+    s->out = (uint32_t*)malloc((size_t)max_new * sizeof(uint32_t));
+    if (s->out == NULL)
+        return -1;
+    s->state      = NPU_SEQ_WAITING;
+    s->arrival    = arrival;
+    s->prompt     = prompt;
+    s->prompt_len = prompt_len;
+    s->max_new    = max_new;
+    return srv->num_seqs++;
+}
+
+//-----------------------------------------------------------------------------
+// Scheduling
+//-----------------------------------------------------------------------------
+
+static uint64_t serve_next_arrival(const NpuServe* srv) {
+    uint64_t next = UINT64_MAX;
+    for (int i = 0; i < srv->num_seqs; i++)
+        if (srv->seq[i].state == NPU_SEQ_WAITING && srv->seq[i].arrival < next)
+            next = srv->seq[i].arrival;
+    return next;
+}
+
+// Fill free columns with arrived requests, oldest first; returns the
+// number admitted
+static int serve_admit(NpuServe* srv) {
+    int admitted = 0;
+    if (srv->policy == NPU_BATCH_STATIC && srv->batch_len > 0)
+        return 0;
+
+    while (srv->batch_len < srv->max_batch) {
+        int best = -1;
+        for (int i = 0; i < srv->num_seqs; i++) {
+            const NpuSeq* s = &srv->seq[i];
+            if (s->state == NPU_SEQ_WAITING && s->arrival <= srv->now &&
+                (best < 0 || s->arrival < srv->seq[best].arrival))
+                best = i;
+        }
+        if (best < 0)
+            break;
+        srv->seq[best].state = NPU_SEQ_RUNNING;
+        srv->batch[srv->batch_len++] = best;
+        admitted++;
+    }
+    return admitted;
+}
+
+// Whole step as one queue: gather → hidden layers (chained through the
+// input buffer) → LM head to logits_addr, one CTRL.start
+static int serve_step_cmds(const NpuServe* srv, NpuCmd* cmds, int B) {
+    const NpuModel* m = &srv->model;
+    int n = 0;
+
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CONFIG, NPU_CFG_GATHER };
+    n += npu_cmd_enqueue_gemm(cmds + n, m->embed_addr, srv->ids_addr, 0,
+                              m->vocab, m->hidden, B);
+    for (int l = 0; l < m->layers; l++) {
+        cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CONFIG,
+                              NPU_CFG_CHAIN_IN | NPU_CFG_CHAIN_OUT | m->rq_cfg };
+        n += npu_cmd_enqueue_gemm(cmds + n, m->layer_addr[l], 0, 0,
+                                  m->hidden, m->hidden, B);
+    }
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CONFIG, NPU_CFG_CHAIN_IN };
+    n += npu_cmd_enqueue_gemm(cmds + n, m->head_addr, 0, srv->logits_addr,
+                              m->vocab, m->hidden, B);
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CTRL,   NPU_CTRL_START };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WAIT_DONE, 0, 0 };
+    cmds[n++] = (NpuCmd){ NPU_CMD_WRITE_REG, NPU_REG_CONFIG, 0 };
+    return n;
+}
+
+// Greedy sampling of column c (ties: lowest token id)
+static uint32_t serve_argmax(const NpuServe* srv, int c, int B) {
+    uint32_t best = 0;
+    for (int v = 1; v < srv->model.vocab; v++)
+        if (srv->logits[(size_t)v * B + c] > srv->logits[(size_t)best * B + c])
+            best = (uint32_t)v;
+    return best;
+}
+
+static int serve_record_step(NpuServe* srv, uint64_t latency) {
+    if (srv->steps == srv->step_cap) {
+        uint64_t cap = srv->step_cap ? 2 * srv->step_cap : 256;
+        uint64_t* lat = (uint64_t*)realloc(srv->step_lat, cap * sizeof(uint64_t));
+        if (lat == NULL)
+            return -1;
+        srv->step_lat = lat;
+        srv->step_cap = cap;
+    }
+    srv->step_lat[srv->steps++] = latency;
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Decode Loop
+//-----------------------------------------------------------------------------
+
+int npu_serve_step(NpuServe* srv) {
+    NpuEmu* emu = srv->emu;
+    const NpuModel* m = &srv->model;
+
+    // Idle: finish streaming, then wait for the next request
+    if (srv->batch_len == 0) {
+        uint64_t next = serve_next_arrival(srv);
+        if (next == UINT64_MAX)
+            return 0;
+        srv->now          += srv->pending_host;
+        srv->host_cycles  += srv->pending_host;
+        srv->pending_host  = 0;
+        if (next > srv->now) {
+            srv->idle_cycles += next - srv->now;
+            srv->now          = next;
+        }
+    }
+
+    uint64_t start = srv->now;
+    int admitted = serve_admit(srv);
+    int B = srv->batch_len;
+
+    // Current token of every column: next prompt token, else the last output
+    uint32_t ids[NPU_SERVE_MAX_BATCH];
+    for (int c = 0; c < B; c++) {
+        const NpuSeq* s = &srv->seq[srv->batch[c]];
+        ids[c] = s->pos < s->prompt_len ? s->prompt[s->pos] : s->out[s->generated - 1];
+    }
+    if (npu_mem_write(emu->mem, srv->ids_addr, ids, (uint64_t)B * sizeof(uint32_t)) != 0)
+        return -1;
+
+    NpuCmd cmds[8 * (NPU_SERVE_MAX_LAYERS + 2) + 4];
+    int n = serve_step_cmds(srv, cmds, B);
+    uint64_t before = emu->stats.cycles;
+    if (npu_emu_run(emu, cmds, n) != 0)
+        return -1;
+    uint64_t npu = emu->stats.cycles - before;
+
+    // Timing: submit + admission → NPU step (the previous step's tokens are
+    // streamed meanwhile, or after it without overlap) → logits scan
+    uint64_t crit = EMU_HOST_SUBMIT_CYCLES + (uint64_t)admitted * EMU_HOST_ADMIT_CYCLES;
+    uint64_t scan = ((uint64_t)m->vocab * B * sizeof(int32_t) + EMU_HOST_SCAN_BYTES_PER_CYCLE - 1) /
+                    EMU_HOST_SCAN_BYTES_PER_CYCLE;
+    uint64_t busy = srv->overlap ? (npu > srv->pending_host ? npu : srv->pending_host)
+                                 : npu + srv->pending_host;
+    if (srv->overlap)
+        srv->host_hidden += npu < srv->pending_host ? npu : srv->pending_host;
+    srv->host_cycles  += crit + srv->pending_host + scan;
+    srv->npu_cycles   += npu;
+    srv->pending_host  = 0;
+    srv->now          += crit + busy + scan;
+
+    // Sampling; finished sequences leave the batch
+    if (npu_mem_read(emu->mem, srv->logits_addr, srv->logits,
+                     (uint64_t)m->vocab * B * sizeof(int32_t)) != 0)
+        return -1;
+    int kept = 0;
+    for (int c = 0; c < B; c++) {
+        NpuSeq* s = &srv->seq[srv->batch[c]];
+        if (++s->pos >= s->prompt_len) {
+            s->out[s->generated++] = serve_argmax(srv, c, B);
+            if (s->generated == 1)
+                s->first_token = srv->now;
+            srv->pending_host += EMU_HOST_TOKEN_CYCLES;
+            srv->tokens++;
+        }
+        if (s->generated == s->max_new) {
+            s->state  = NPU_SEQ_DONE;
+            s->finish = srv->now;
+        } else {
+            srv->batch[kept++] = srv->batch[c];
+        }
+    }
+    srv->batch_len  = kept;
+    srv->batch_sum += (uint64_t)B;
+    return serve_record_step(srv, srv->now - start) == 0 ? 1 : -1;
+}
+
+int npu_serve_run(NpuServe* srv) {
+    int ret;
+    while ((ret = npu_serve_step(srv)) > 0)
+        ;
+    srv->now          += srv->pending_host;
+    srv->host_cycles  += srv->pending_host;
+    srv->pending_host  = 0;
+    return ret;
+}
+
+//-----------------------------------------------------------------------------
+// Reporting
+//-----------------------------------------------------------------------------
+
+static int cmp_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+uint64_t npu_serve_p99_step(const NpuServe* srv) {
+    if (srv->steps == 0)
+        return 0;
+    uint64_t* lat = (uint64_t*)malloc(srv->steps * sizeof(uint64_t));
+    if (lat == NULL)
+        return 0;
+    memcpy(lat, srv->step_lat, srv->steps * sizeof(uint64_t));
+    qsort(lat, srv->steps, sizeof(uint64_t), cmp_u64);
+    uint64_t p99 = lat[(srv->steps * 99 + 99) / 100 - 1];
+    free(lat);
+    return p99;
+}
+
+double npu_serve_tokens_per_sec(const NpuServe* srv) {
+    return srv->now ? (double)srv->tokens * EMU_CLOCK_MHZ * 1e6 / (double)srv->now : 0.0;
+}
+
+void npu_serve_print_stats(const NpuServe* srv, const char* label) {
+    uint64_t p99 = npu_serve_p99_step(srv);
+    printf("  --- Serving Stats: %s ---\n", label);
+    printf("  Policy          : %s batching, max batch %d, host overlap %s\n",
+           srv->policy == NPU_BATCH_STATIC ? "static" : "continuous",
+           srv->max_batch, srv->overlap ? "on" : "off");
+    printf("  Requests        : %d  (%llu steps, mean batch %.1f)\n", srv->num_seqs,
+           (unsigned long long)srv->steps,
+           srv->steps ? (double)srv->batch_sum / (double)srv->steps : 0.0);
+    printf("  Modelled cycles : %llu  (%.1f us @ %d MHz, idle %llu)\n",
+           (unsigned long long)srv->now, (double)srv->now / EMU_CLOCK_MHZ,
+           EMU_CLOCK_MHZ, (unsigned long long)srv->idle_cycles);
+    printf("  Throughput      : %.0f tokens/s  (%llu tokens)\n",
+           npu_serve_tokens_per_sec(srv), (unsigned long long)srv->tokens);
+    printf("  Step latency p99: %llu cycles  (%.2f us)\n",
+           (unsigned long long)p99, (double)p99 / EMU_CLOCK_MHZ);
+    printf("  NPU / host      : %llu / %llu cycles  (%llu host cycles overlapped)\n",
+           (unsigned long long)srv->npu_cycles, (unsigned long long)srv->host_cycles,
+           (unsigned long long)srv->host_hidden);
+}
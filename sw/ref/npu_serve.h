@@ -0,0 +1,125 @@
+//-----------------------------------------------------------------------------
+// NPU Serving Runtime Header
+// Description: Continuous batching of decode requests on one instance
+//              - Requests join the batch at any decode step (up to
+//                max_batch columns) and leave as soon as they finish
+//              - One step = one queued command stream, started once:
+//                embedding gather of the batch's tokens → chained hidden
+//                layers → LM head (logits Y[vocab][batch] in memory)
+//              - Prompts are fed one token per step, their outputs dropped
+//              - Host cost model: submission, admission and sampling are on
+//                the critical path; streaming of the step's tokens runs
+//                during the next step's NPU execution (overlap = 1)
+//-----------------------------------------------------------------------------
+
+#ifndef NPU_SERVE_H
+#define NPU_SERVE_H
+
+#include "npu_emu.h"
+
+//-----------------------------------------------------------------------------
+// Configuration
+//-----------------------------------------------------------------------------
+#define NPU_SERVE_MAX_BATCH      32     // Columns (hidden * batch <= EMU_IBUF_BYTES)
+#define NPU_SERVE_MAX_LAYERS     (EMU_JOBQ_DEPTH - 2)   // + gather + LM head
+#define NPU_SERVE_MAX_SEQS       256
+
+// Host cost model (cycles at EMU_CLOCK_MHZ)
+#define EMU_HOST_SUBMIT_CYCLES   1000   // Batch formation, ids + command stream
+#define EMU_HOST_ADMIT_CYCLES    4000   // Per new request (sequence state)
+#define EMU_HOST_TOKEN_CYCLES    300    // Per generated token (detokenize, stream)
+#define EMU_HOST_SCAN_BYTES_PER_CYCLE 16   // Logits readback + argmax
+
+typedef enum {
+    NPU_BATCH_CONTINUOUS = 0,   // Admit whenever a column is free
+    NPU_BATCH_STATIC     = 1    // Admit only into an empty batch
+} NpuBatchPolicy;
+
+typedef enum {
+    NPU_SEQ_WAITING = 0,
+    NPU_SEQ_RUNNING = 1,
+    NPU_SEQ_DONE    = 2
+} NpuSeqState;
+
+//-----------------------------------------------------------------------------
+// Data Structures
+//-----------------------------------------------------------------------------
+
+// Decoder in memory: x = E[token]; x = requant(W_l * x) per layer;
+// next token = argmax(W_head * x) (ties: lowest id)
+typedef struct {
+    int      vocab;
+    int      hidden;
+    int      layers;
+    uint32_t embed_addr;                        // INT8 [vocab][hidden]
+    uint32_t layer_addr[NPU_SERVE_MAX_LAYERS];  // INT8 [hidden][hidden]
+    uint32_t head_addr;                         // INT8 [vocab][hidden]
+    uint32_t rq_cfg;                            // NPU_CFG_RQ of the layers
+} NpuModel;
+
+typedef struct {
+    NpuSeqState     state;
+    uint64_t        arrival;       // Cycle the request is submitted
+    const uint32_t* prompt;
+    int             prompt_len;
+    int             max_new;
+    int             pos;           // Tokens fed so far (prompt + generated)
+    uint32_t*       out;           // Generated tokens [max_new]
+    int             generated;
+    uint64_t        first_token;   // Cycle of the first generated token
+    uint64_t        finish;
+} NpuSeq;
+
+typedef struct {
+    NpuEmu*        emu;
+    NpuModel       model;
+    NpuBatchPolicy policy;
+    int            max_batch;
+    int            overlap;        // Stream tokens during the next step
+    uint32_t       ids_addr;       // uint32 [max_batch]
+    uint32_t       logits_addr;    // int32 [vocab][max_batch]
+    int32_t*       logits;         // Host copy
+
+    NpuSeq         seq[NPU_SERVE_MAX_SEQS];
+    int            num_seqs;
+    int            batch[NPU_SERVE_MAX_BATCH];   // Sequence of each column
+    int            batch_len;
+
+    uint64_t       now;            // Serving clock (cycles)
+    uint64_t       pending_host;   // Token streaming not yet done
+    uint64_t       npu_cycles;
+    uint64_t       host_cycles;
+    uint64_t       host_hidden;    // Host cycles overlapped with the NPU
+    uint64_t       idle_cycles;    // No request to run
+    uint64_t       steps;
+    uint64_t       tokens;         // Generated tokens
+    uint64_t       batch_sum;      // Sum of batch sizes over steps
+    uint64_t*      step_lat;       // Per step: start → tokens sampled
+    uint64_t       step_cap;
+} NpuServe;
+
+//-----------------------------------------------------------------------------
+// Function Prototypes
+//-----------------------------------------------------------------------------
+
+// ids_addr / logits_addr: scratch buffers for max_batch columns
+int  npu_serve_init(NpuServe* srv, NpuEmu* emu, const NpuModel* model,
+                    uint32_t ids_addr, uint32_t logits_addr, int max_batch,
+                    NpuBatchPolicy policy, int overlap);
+void npu_serve_free(NpuServe* srv);
+
+// Queue a request arriving at cycle `arrival`; returns its sequence id
+int  npu_serve_submit(NpuServe* srv, const uint32_t* prompt, int prompt_len,
+                      int max_new, uint64_t arrival);
+
+// One decode step over the current batch (waits for the next arrival when
+// idle); returns 1 if a step ran, 0 when every request is done, -1 on error
+int  npu_serve_step(NpuServe* srv);
+int  npu_serve_run(NpuServe* srv);
+
+// Reporting
+uint64_t npu_serve_p99_step(const NpuServe* srv);
+double   npu_serve_tokens_per_sec(const NpuServe* srv);
+void     npu_serve_print_stats(const NpuServe* srv, const char* label);
+
+#endif // NPU_SERVE_H
@@ -0,0 +1,422 @@
+//-----------------------------------------------------------------------------
+// NPU Sharded Golden-Data Generator
+// Description: Coordinator forks up to 'workers' processes, one shard each.
+//              Every shard covers tiles_per_shard M tiles of C = A * B:
+//                - A rows are generated from a counter-based stream, so a
+//                  shard never needs the rest of A
+//                - A and C lines are written with pwrite() at fixed offsets
+//                  (fixed-width hex lines), so shards finish in any order
+//                - The worker returns (hash_a, hash_c) through a pipe and the
+//                  coordinator appends them to <prefix>.progress (fsync'd)
+//              Resume re-reads every recorded shard, checks its hashes and
+//              only recomputes shards that are missing or corrupt.
+//-----------------------------------------------------------------------------
+
+#include "npu_shard.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define I8_LINE_BYTES   3   // "XX\n"
+#define I32_LINE_BYTES  9   // "XXXXXXXX\n"
+
+typedef struct {
+    uint32_t hash_a;
+    uint32_t hash_c;
+} ShardResult;
+
+//-----------------------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------------------
+
+int64_t shard_count(const ShardJob* job) {
+    int64_t m_tiles = (job->M + SUBARRAY_ROWS - 1) / SUBARRAY_ROWS;
+    return (m_tiles + job->tiles_per_shard - 1) / job->tiles_per_shard;
+}
+
+static void shard_rows(const ShardJob* job, int64_t s,
+                       int64_t* m_begin, int64_t* m_end) {
+    int64_t rows = (int64_t)job->tiles_per_shard * SUBARRAY_ROWS;
+    *m_begin = s * rows;
+    *m_end   = (*m_begin + rows < job->M) ? *m_begin + rows : job->M;
+}
+
+static void path_join(char* dst, size_t size, const char* prefix, const char* suffix) {
+    snprintf(dst, size, "%s%s", prefix, suffix);
+}
+
+static int write_all_at(int fd, const char* buf, size_t len, off_t off) {
+    while (len > 0) {
+        ssize_t n = pwrite(fd, buf, len, off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buf += n;
+        len -= (size_t)n;
+        off += n;
+    }
+    return 0;
+}
+
+static int read_all_at(int fd, char* buf, size_t len, off_t off) {
+    while (len > 0) {
+        ssize_t n = pread(fd, buf, len, off);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            return -1;
+        }
+        buf += n;
+        len -= (size_t)n;
+        off += n;
+    }
+    return 0;
+}
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+static void format_hex_i8(char* dst, const int8_t* d, int64_t len) {
+    for (int64_t i = 0; i < len; i++) {
+        uint8_t v = (uint8_t)d[i];
+        *dst++ = hex_digits[v >> 4];
+        *dst++ = hex_digits[v & 0xF];
+        *dst++ = '\n';
+    }
+}
+
+static void format_hex_i32(char* dst, const int32_t* d, int64_t len) {
+    for (int64_t i = 0; i < len; i++) {
+        uint32_t v = (uint32_t)d[i];
+        for (int b = 7; b >= 0; b--)
+            *dst++ = hex_digits[(v >> (b * 4)) & 0xF];
+        *dst++ = '\n';
+    }
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Parse fixed-width hex lines; returns -1 on malformed (e.g. unwritten) lines
+static int parse_hex_words(const char* src, uint32_t* d, int64_t len, int digits) {
+    for (int64_t i = 0; i < len; i++) {
+        uint32_t v = 0;
+        for (int b = 0; b < digits; b++) {
+            int x = hex_value(*src++);
+            if (x < 0) return -1;
+            v = (v << 4) | (uint32_t)x;
+        }
+        if (*src++ != '\n') return -1;
+        d[i] = v;
+    }
+    return 0;
+}
+
+static uint32_t hash_i8(const int8_t* d, int64_t len) {
+    uint32_t hash = REF_HASH_INIT;
+    for (int64_t i = 0; i < len; i++)
+        hash = ref_hash_u32(hash, (uint8_t)d[i]);
+    return hash;
+}
+
+//-----------------------------------------------------------------------------
+// Worker: compute one shard and write it in place
+//-----------------------------------------------------------------------------
+
+static int shard_compute(const ShardJob* job, int64_t s, const int8_t* B,
+                         int fd_a, int fd_c, ShardResult* res) {
+    int64_t m_begin, m_end;
+    shard_rows(job, s, &m_begin, &m_end);
+    int rows = (int)(m_end - m_begin);
+    int64_t a_len = (int64_t)rows * job->K;
+    int64_t c_len = (int64_t)rows * job->N;
+
+    int8_t*  A   = (int8_t*)malloc(a_len);
+    int32_t* C   = (int32_t*)malloc(c_len * sizeof(int32_t));
+    char*    buf = (char*)malloc(c_len * I32_LINE_BYTES > a_len * I8_LINE_BYTES
+                                 ? c_len * I32_LINE_BYTES : a_len * I8_LINE_BYTES);
+    int ret = -1;
+
+    if (A && C && buf) {
+        for (int64_t i = 0; i < a_len; i++)
+            A[i] = generate_random_i8_at(job->seed, m_begin * job->K + i);
+
+        ref_gemm_tiled(A, (int8_t*)B, C, rows, job->K, job->N);
+
+        res->hash_a = hash_i8(A, a_len);
+        res->hash_c = ref_hash_i32(REF_HASH_INIT, C, c_len);
+
+        format_hex_i8(buf, A, a_len);
+        ret = write_all_at(fd_a, buf, a_len * I8_LINE_BYTES,
+                           (off_t)(m_begin * job->K * I8_LINE_BYTES));
+        if (ret == 0) {
+            format_hex_i32(buf, C, c_len);
+            ret = write_all_at(fd_c, buf, c_len * I32_LINE_BYTES,
+                               (off_t)(m_begin * job->N * I32_LINE_BYTES));
+        }
+    }
+
+    free(A);
+    free(C);
+    free(buf);
+    return ret;
+}
+
+// Re-read a recorded shard from disk and check it against its checksums
+static int shard_verify(const ShardJob* job, int64_t s, int fd_a, int fd_c,
+                        const ShardResult* expect) {
+    int64_t m_begin, m_end;
+    shard_rows(job, s, &m_begin, &m_end);
+    int64_t a_len = (m_end - m_begin) * job->K;
+    int64_t c_len = (m_end - m_begin) * job->N;
+
+    uint32_t* words = (uint32_t*)malloc((a_len > c_len ? a_len : c_len) * sizeof(uint32_t));
+    char*     buf   = (char*)malloc(c_len * I32_LINE_BYTES > a_len * I8_LINE_BYTES
+                                    ? c_len * I32_LINE_BYTES : a_len * I8_LINE_BYTES);
+    int ok = 0;
+
+    if (words && buf &&
+        read_all_at(fd_a, buf, a_len * I8_LINE_BYTES,
+                    (off_t)(m_begin * job->K * I8_LINE_BYTES)) == 0 &&
+        parse_hex_words(buf, words, a_len, 2) == 0) {
+
+        uint32_t hash_a = REF_HASH_INIT;
+        for (int64_t i = 0; i < a_len; i++)
+            hash_a = ref_hash_u32(hash_a, words[i]);
+
+        if (hash_a == expect->hash_a &&
+            read_all_at(fd_c, buf, c_len * I32_LINE_BYTES,
+                        (off_t)(m_begin * job->N * I32_LINE_BYTES)) == 0 &&
+            parse_hex_words(buf, words, c_len, 8) == 0) {
+            ok = (ref_hash_i32(REF_HASH_INIT, (int32_t*)words, c_len)
+                  == expect->hash_c);
+        }
+    }
+
+    free(words);
+    free(buf);
+    return ok;
+}
+
+//-----------------------------------------------------------------------------
+// Coordinator
+//-----------------------------------------------------------------------------
+
+static int open_output(const char* path, off_t size, int resume) {
+    int fd = open(path, O_RDWR | O_CREAT | (resume ? 0 : O_TRUNC), 0644);
+    if (fd < 0) {
+        printf("Error: Cannot open file %s\n", path);
+        return -1;
+    }
+    if (ftruncate(fd, size) != 0) {
+        printf("Error: Cannot size file %s\n", path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Stop and reap every worker still in the pool (coordinator error path)
+static void reap_workers(pid_t* slot_pid, int* slot_pipe, int workers) {
+    for (int slot = 0; slot < workers; slot++) {
+        if (slot_pid[slot] == 0) continue;
+        kill(slot_pid[slot], SIGKILL);
+        while (waitpid(slot_pid[slot], NULL, 0) < 0 && errno == EINTR)
+            ;
+        close(slot_pipe[slot]);
+        slot_pid[slot] = 0;
+    }
+}
+
+int shard_generate(const ShardJob* job, int resume) {
+    char path_a[256], path_b[256], path_c[256], path_p[256];
+    path_join(path_a, sizeof(path_a), job->prefix, "_a.hex");
+    path_join(path_b, sizeof(path_b), job->prefix, "_b.hex");
+    path_join(path_c, sizeof(path_c), job->prefix, "_c.hex");
+    path_join(path_p, sizeof(path_p), job->prefix, ".progress");
+
+    int64_t num_shards = shard_count(job);
+    int64_t b_len = (int64_t)job->K * job->N;
+    int workers = (job->workers > 0) ? job->workers : 1;
+
+    printf("  Sharded GEMM: M=%lld K=%d N=%d, %lld shards x %d M-tiles, %d workers%s\n",
+           (long long)job->M, job->K, job->N, (long long)num_shards,
+           job->tiles_per_shard, workers, resume ? " (resume)" : "");
+
+    // If there is nothing to resume from, start fresh
+    FILE* fp = resume ? fopen(path_p, "r") : NULL;
+    if (resume && !fp) resume = 0;
+
+    int fd_a = open_output(path_a, (off_t)(job->M * job->K * I8_LINE_BYTES), resume);
+    int fd_c = open_output(path_c, (off_t)(job->M * job->N * I32_LINE_BYTES), resume);
+    uint8_t* done = (uint8_t*)calloc(num_shards, 1);
+    int8_t*  B    = (int8_t*)malloc(b_len);
+    if (fd_a < 0 || fd_c < 0 || !done || !B) {
+        if (fp) fclose(fp);
+        if (fd_a >= 0) close(fd_a);
+        if (fd_c >= 0) close(fd_c);
+        free(done);
+        free(B);
+        return -1;
+    }
+
+    // B is shared by every shard; forked workers see it copy-on-write
+    for (int64_t i = 0; i < b_len; i++)
+        B[i] = generate_random_i8_at(job->seed + 2000, i);
+
+    // Replay progress: "b <hash>" once, then "shard <id> <hash_a> <hash_c>"
+    int b_done = 0;
+    int64_t verified = 0, rejected = 0;
+    if (fp) {
+        char line[128];
+        while (fgets(line, sizeof(line), fp)) {
+            long long id;
+            unsigned int ha, hc;
+            if (sscanf(line, "b %x", &ha) == 1) {
+                b_done = (ha == hash_i8(B, b_len));
+            } else if (sscanf(line, "shard %lld %x %x", &id, &ha, &hc) == 3 &&
+                       id >= 0 && id < num_shards && !done[id]) {
+                ShardResult expect = { ha, hc };
+                if (shard_verify(job, id, fd_a, fd_c, &expect)) {
+                    done[id] = 1;
+                    verified++;
+                } else {
+                    rejected++;
+                }
+            }
+        }
+        fclose(fp);
+        printf("  Resume: %lld shards verified, %lld rejected\n",
+               (long long)verified, (long long)rejected);
+    }
+
+    FILE* progress = fopen(path_p, resume ? "a" : "w");
+    if (!progress) {
+        printf("Error: Cannot open file %s\n", path_p);
+        close(fd_a);
+        close(fd_c);
+        free(done);
+        free(B);
+        return -1;
+    }
+
+    if (!b_done) {
+        char* buf = (char*)malloc(b_len * I8_LINE_BYTES);
+        int fd_b = open_output(path_b, (off_t)(b_len * I8_LINE_BYTES), 0);
+        int err = (!buf || fd_b < 0);
+        if (!err) {
+            format_hex_i8(buf, B, b_len);
+            err = write_all_at(fd_b, buf, b_len * I8_LINE_BYTES, 0) != 0 ||
+                  fsync(fd_b) != 0;
+        }
+        if (fd_b >= 0) close(fd_b);
+        free(buf);
+        if (!err) {
+            fprintf(progress, "b %08X\n", hash_i8(B, b_len));
+            fflush(progress);
+            fsync(fileno(progress));
+        }
+    }
+
+    // Worker pool: one forked process per shard, at most 'workers' at once
+    pid_t*   slot_pid   = (pid_t*)calloc(workers, sizeof(pid_t));
+    int64_t* slot_shard = (int64_t*)calloc(workers, sizeof(int64_t));
+    int*     slot_pipe  = (int*)calloc(workers, sizeof(int));
+    int active = 0, err = (!slot_pid || !slot_shard || !slot_pipe), computed = 0;
+    int64_t next = 0;
+
+    // A launch error stops new launches; running workers are still
+    // collected below before returning
+    while (!err || active > 0) {
+        // Launch
+        while (!err && active < workers && next < num_shards) {
+            if (done[next]) { next++; continue; }
+
+            int fds[2];
+            if (pipe(fds) != 0) { err = 1; break; }
+
+            fflush(stdout);
+            fflush(progress);
+            pid_t pid = fork();
+            if (pid < 0) {
+                close(fds[0]);
+                close(fds[1]);
+                err = 1;
+                break;
+            }
+            if (pid == 0) {
+                // Worker process
+                ShardResult res;
+                close(fds[0]);
+                int ok = (shard_compute(job, next, B, fd_a, fd_c, &res) == 0 &&
+                          fsync(fd_a) == 0 && fsync(fd_c) == 0 &&
+                          write(fds[1], &res, sizeof(res)) == (ssize_t)sizeof(res));
+                _exit(ok ? 0 : 1);
+            }
+
+            close(fds[1]);
+            int slot = 0;
+            while (slot_pid[slot] != 0) slot++;
+            slot_pid[slot]   = pid;
+            slot_shard[slot] = next;
+            slot_pipe[slot]  = fds[0];
+            active++;
+            next++;
+        }
+
+        if (active == 0) break;
+
+        // Collect one finished worker
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            err = 1;
+            break;
+        }
+        int slot = 0;
+        while (slot < workers && slot_pid[slot] != pid) slot++;
+        if (slot == workers) continue;
+
+        ShardResult res;
+        ssize_t n = read(slot_pipe[slot], &res, sizeof(res));
+        close(slot_pipe[slot]);
+        slot_pid[slot] = 0;
+        active--;
+
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0 && n == (ssize_t)sizeof(res)) {
+            fprintf(progress, "shard %lld %08X %08X\n",
+                    (long long)slot_shard[slot], res.hash_a, res.hash_c);
+            fflush(progress);
+            fsync(fileno(progress));
+            done[slot_shard[slot]] = 1;
+            computed++;
+        } else {
+            printf("Error: Shard %lld worker failed\n", (long long)slot_shard[slot]);
+            err = 1;
+        }
+    }
+
+    // waitpid failed with workers outstanding: never return with them running
+    if (active > 0)
+        reap_workers(slot_pid, slot_pipe, workers);
+
+    printf("  Computed %d shards, %lld already done\n", computed, (long long)verified);
+
+    fclose(progress);
+    close(fd_a);
+    close(fd_c);
+    free(slot_pid);
+    free(slot_shard);
+    free(slot_pipe);
+    free(done);
+    free(B);
+    return err ? -1 : computed;
+}
@@ -0,0 +1,32 @@
+//-----------------------------------------------------------------------------
+// NPU Sharded Golden-Data Generator Header
+// Description: Coordinator/worker generation of large GEMM golden data
+//              - M tiles are split into shards, each computed by a forked
+//                worker process and written in place (fixed-width hex lines)
+//              - Per-shard checksums are appended to a progress file so an
+//                interrupted run can be resumed without recomputing
+//-----------------------------------------------------------------------------
+
+#ifndef NPU_SHARD_H
+#define NPU_SHARD_H
+
+#include "npu_ref.h"
+
+typedef struct {
+    int64_t M;              // Output rows (may be very large)
+    int K;                  // Shared dimension
+    int N;                  // Output cols
+    int seed;               // A = stream seed, B = stream seed + 2000
+    int tiles_per_shard;    // M tiles (SUBARRAY_ROWS rows each) per shard
+    int workers;            // Max concurrent worker processes
+    const char* prefix;     // Files: <prefix>_{a,b,c}.hex, <prefix>.progress
+} ShardJob;
+
+// Generate (or resume) all shards; returns number of shards computed
+// in this run, or -1 on error
+int shard_generate(const ShardJob* job, int resume);
+
+// Number of shards for a job
+int64_t shard_count(const ShardJob* job);
+
+#endif // NPU_SHARD_H
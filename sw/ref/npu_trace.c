@@ -0,0 +1,93 @@
+//-----------------------------------------------------------------------------
+// NPU Trace Decoder
+// Description: Ring ordering, timestamp unwrap and timeline formatting for
+//              trace_unit dumps (emulator registers or testbench hex file)
+//-----------------------------------------------------------------------------
+
+#include "npu_trace.h"
+
+static const char* const trace_names[] = {
+    "JOB_START", "JOB_END", "TILE", "DMA_RD", "DMA_WR", "STALL", "PREEMPT", "MARK"
+};
+
+const char* npu_trace_event_name(int id) {
+    if (id < 0 || id >= (int)(sizeof(trace_names) / sizeof(trace_names[0])))
+        return "?";
+    return trace_names[id];
+}
+
+//-----------------------------------------------------------------------------
+// Decoding
+//-----------------------------------------------------------------------------
+
+int npu_trace_decode(const uint32_t* ring, int depth, uint32_t status, NpuTraceEvent* ev) {
+    uint32_t wr_ptr = NPU_TRACE_WR_PTR(status);
+    if (depth <= 0 || wr_ptr >= (uint32_t)depth)
+        return 0;
+    int wrapped = (status & NPU_TRACE_WRAPPED) != 0;
+    int count   = wrapped ? depth : (int)wr_ptr;
+    int first   = wrapped ? (int)wr_ptr : 0;
+
+    // Timestamps increase along the ring: a smaller one has wrapped 2^32
+    uint64_t hi = 0;
+    uint32_t prev = 0;
+    for (int i = 0; i < count; i++) {
+        const uint32_t* e = &ring[2 * ((first + i) % depth)];
+        if (i > 0 && e[0] < prev)
+            hi += 1ull << 32;
+        prev      = e[0];
+        ev[i].ts  = hi | e[0];
+        ev[i].id  = (int)(e[1] >> 24);
+        ev[i].arg = e[1] & 0xFFFFFFu;
+    }
+    return count;
+}
+
+int npu_trace_read(NpuEmu* emu, NpuTraceEvent* ev, int max) {
+    uint32_t        ring[2 * NPU_TRACE_DEPTH];
+    NpuTraceEvent   all[NPU_TRACE_DEPTH];
+
+    uint32_t status = npu_emu_read_reg(emu, NPU_REG_TRACE_STATUS);
+    for (int i = 0; i < NPU_TRACE_DEPTH; i++) {
+        npu_emu_write_reg(emu, NPU_REG_TRACE_RD_IDX, (uint32_t)i);
+        ring[2 * i]     = npu_emu_read_reg(emu, NPU_REG_TRACE_RD_TS);
+        ring[2 * i + 1] = npu_emu_read_reg(emu, NPU_REG_TRACE_RD_EVT);
+    }
+    int count = npu_trace_decode(ring, NPU_TRACE_DEPTH, status, all);
+    int skip  = count > max ? count - max : 0;
+    for (int i = skip; i < count; i++)
+        ev[i - skip] = all[i];
+    return count - skip;
+}
+
+int npu_trace_load_hex(const char* path, uint32_t* ring, int max_depth,
+                       uint32_t* status, uint32_t* dropped) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        printf("Error: Cannot open file %s\n", path);
+        return -1;
+    }
+    unsigned int s, d, w;
+    if (fscanf(fp, "%x", &s) != 1 || fscanf(fp, "%x", &d) != 1) {
+        fclose(fp);
+        return -1;
+    }
+    int words = 0;
+    while (words < 2 * max_depth && fscanf(fp, "%x", &w) == 1)
+        ring[words++] = w;
+    fclose(fp);
+
+    *status  = s;
+    *dropped = d;
+    return words / 2;
+}
+
+//-----------------------------------------------------------------------------
+// Timeline
+//-----------------------------------------------------------------------------
+
+void npu_trace_print(FILE* fp, const NpuTraceEvent* ev, int count) {
+    for (int i = 0; i < count; i++)
+        fprintf(fp, "%10llu  %-9s  0x%06x\n", (unsigned long long)ev[i].ts,
+                npu_trace_event_name(ev[i].id), ev[i].arg);
+}
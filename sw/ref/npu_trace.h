@@ -0,0 +1,51 @@
+//-----------------------------------------------------------------------------
+// NPU Trace Decoder Header
+// Description: Event trace dumps (trace_unit ring) → timeline
+//              - Raw ring: two words per entry, {ts, {id[7:0], arg[23:0]}},
+//                read over TRACE_RD_IDX / TRACE_RD_TS / TRACE_RD_EVT or
+//                from the hex dump written by trace_unit_tb
+//              - Entries are ordered oldest first (from wr_ptr once the
+//                ring has wrapped) and the 32-bit timestamps unwrapped
+//              - Timeline line: "<cycle:10>  <event:-9>  0x<arg:06x>",
+//                the format trace_unit_tb prints while it drives the events
+//-----------------------------------------------------------------------------
+
+#ifndef NPU_TRACE_H
+#define NPU_TRACE_H
+
+#include <stdio.h>
+
+#include "npu_emu.h"
+
+//-----------------------------------------------------------------------------
+// Data Structures
+//-----------------------------------------------------------------------------
+
+typedef struct {
+    uint64_t ts;       // Cycles since TRACE_CTRL.clear
+    int      id;       // NPU_TRACE_EV_*
+    uint32_t arg;
+} NpuTraceEvent;
+
+//-----------------------------------------------------------------------------
+// Function Prototypes
+//-----------------------------------------------------------------------------
+
+const char* npu_trace_event_name(int id);
+
+// Order a raw ring of `depth` entries by age using TRACE_STATUS; returns the
+// number of events written to ev (at most depth)
+int npu_trace_decode(const uint32_t* ring, int depth, uint32_t status, NpuTraceEvent* ev);
+
+// Read the emulator's ring over the register window; returns the number of
+// events (at most max, the newest kept)
+int npu_trace_read(NpuEmu* emu, NpuTraceEvent* ev, int max);
+
+// Testbench dump: TRACE_STATUS, TRACE_DROP, then ts / evt per entry.
+// Returns the number of entries (at most max_depth), -1 on error
+int npu_trace_load_hex(const char* path, uint32_t* ring, int max_depth,
+                       uint32_t* status, uint32_t* dropped);
+
+void npu_trace_print(FILE* fp, const NpuTraceEvent* ev, int count);
+
+#endif // NPU_TRACE_H
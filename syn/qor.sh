@@ -0,0 +1,169 @@
+#!/usr/bin/env bash
+#-----------------------------------------------------------------------------
+# Script: qor.sh
+# Description: Yosys area / logic-depth benchmark of the compute modules
+#              Each configs.txt entry (top module + parameter set) is
+#              synthesised out of context with synth_xilinx (-flatten,
+#              no I/O buffers) and reported as
+#                LUT    LUT1..LUT6
+#                FF     FD* flip-flops
+#                DSP    DSP48 slices
+#                CARRY  CARRY4/CARRY8
+#                DEPTH  longest combinational path in cells between
+#                       registers/ports (ltp -noff; LUT + carry levels)
+#              One row per configuration is appended to qor_results.csv
+#              with the commit (-dirty: uncommitted rtl/ changes), so
+#              datapath changes are compared by commit with `diff`
+#              Frontend: yosys-slang (read_slang) when the plugin loads,
+#              else read_verilog -sv (FRONTEND=slang|verilog to force)
+# Usage:       qor.sh [NAME ...]          run all or the named configs
+#              qor.sh diff [REV_A [REV_B]] compare two commits in the CSV
+#                                         (default: last two)
+#-----------------------------------------------------------------------------
+
+set -euo pipefail
+
+SYN_DIR=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(cd "$SYN_DIR/.." && pwd)
+
+YOSYS=${YOSYS:-yosys}
+FAMILY=${FAMILY:-xc7}
+FRONTEND=${FRONTEND:-auto}
+CONFIGS=${CONFIGS:-$SYN_DIR/configs.txt}
+RESULTS=${RESULTS:-$SYN_DIR/qor_results.csv}
+WORK=${WORK:-$SYN_DIR/work}
+
+# Packages first
+SOURCES=(
+    rtl/pkg/fp_pkg.sv
+    rtl/compute/mac_unit.sv
+    rtl/compute/fp_mac_unit.sv
+    rtl/compute/gemv_subarray.sv
+    rtl/compute/pe_unit.sv
+)
+
+HEADER="commit,date,config,top,params,frontend,lut,ff,dsp,carry,depth"
+
+#-----------------------------------------------------------------------------
+# diff: per-config table of REV_A → REV_B (last row of each commit)
+#-----------------------------------------------------------------------------
+qor_diff() {
+    [ -f "$RESULTS" ] || { echo "qor: no $RESULTS" >&2; exit 1; }
+    local revs a b
+    revs=$(awk -F, 'NR > 1 && !seen[$1]++ { print $1 }' "$RESULTS")
+    [ -n "$revs" ] || { echo "qor: no results in $RESULTS (run qor.sh first)" >&2; exit 1; }
+    b=${2:-$(echo "$revs" | tail -n 1)}
+    a=${1:-$(echo "$revs" | tail -n 2 | head -n 1)}
+
+    awk -F, -v a="$a" -v b="$b" '
+        function pct(x, y) { return (x == 0) ? "" : sprintf("%+.1f%%", 100.0 * (y - x) / x) }
+        NR > 1 && $1 == a { A[$3] = $0 }
+        NR > 1 && $1 == b { B[$3] = $0; if (!($3 in order)) { order[$3] = ++n; names[n] = $3 } }
+        END {
+            printf "QoR %s → %s\n", a, b
+            printf "%-18s %-13s %-13s %-9s %-9s %-8s\n", "config", "LUT", "FF", "DSP", "CARRY", "DEPTH"
+            for (i = 1; i <= n; i++) {
+                split(B[names[i]], y, ",")
+                if (names[i] in A) {
+                    split(A[names[i]], x, ",")
+                    printf "%-18s %6d→%-6d %6d→%-6d %4d→%-4d %4d→%-4d %3d→%-4d LUT %s FF %s\n",
+                           names[i], x[7], y[7], x[8], y[8], x[9], y[9], x[10], y[10], x[11], y[11],
+                           pct(x[7], y[7]), pct(x[8], y[8])
+                } else {
+                    printf "%-18s %-13d %-13d %-9d %-9d %-8d (new)\n",
+                           names[i], y[7], y[8], y[9], y[10], y[11]
+                }
+            }
+        }' "$RESULTS"
+}
+
+if [ "${1:-}" = "diff" ]; then
+    shift
+    qor_diff "$@"
+    exit 0
+fi
+
+command -v "$YOSYS" > /dev/null || { echo "qor: $YOSYS not found (set YOSYS=...)" >&2; exit 1; }
+
+if [ "$FRONTEND" = "auto" ]; then
+    if "$YOSYS" -q -p "plugin -i slang" > /dev/null 2>&1; then
+        FRONTEND=slang
+    else
+        FRONTEND=verilog
+    fi
+fi
+
+COMMIT=$(git -C "$ROOT" rev-parse --short HEAD 2> /dev/null || echo none)
+git -C "$ROOT" diff --quiet HEAD -- rtl 2> /dev/null || COMMIT="$COMMIT-dirty"
+DATE=$(date +%Y-%m-%d)
+
+mkdir -p "$WORK"
+[ -f "$RESULTS" ] || echo "$HEADER" > "$RESULTS"
+
+#-----------------------------------------------------------------------------
+# One configuration: NAME TOP [PARAM=value ...]
+#-----------------------------------------------------------------------------
+run_config() {
+    local name=$1 top=$2
+    shift 2
+    local ys=$WORK/$name.ys
+    local src p
+
+    src=""
+    for p in "${SOURCES[@]}"; do
+        src="$src $ROOT/$p"
+    done
+
+    {
+        if [ "$FRONTEND" = "slang" ]; then
+            echo "plugin -i slang"
+            printf "read_slang --top %s" "$top"
+            for p in "$@"; do printf " -G %s" "$p"; done
+            echo "$src"
+        else
+            echo "read_verilog -sv$src"
+            for p in "$@"; do echo "chparam -set ${p%%=*} ${p#*=} $top"; done
+        fi
+        echo "synth_xilinx -family $FAMILY -top $top -flatten -noiopad -noclkbuf"
+        echo "tee -q -o $WORK/$name.stat.json stat -json"
+        echo "tee -q -o $WORK/$name.ltp.txt ltp -noff"
+    } > "$ys"
+
+    if ! "$YOSYS" -q -l "$WORK/$name.log" -s "$ys" > /dev/null; then
+        echo "qor: $name failed, see $WORK/$name.log" >&2
+        return 1
+    fi
+
+    # Design totals only (the json also lists each module)
+    local counts depth
+    counts=$(awk '
+        /"design":/ { d = 1 }
+        match($0, /"[A-Z0-9_]+": *[0-9]+/) {
+            split(substr($0, RSTART, RLENGTH), kv, /": */)
+            cell = substr(kv[1], 2); num = kv[2]
+            if (cell ~ /^LUT[1-6]$/)        c[d, "lut"]   += num
+            else if (cell ~ /^FD/)          c[d, "ff"]    += num
+            else if (cell ~ /^DSP48/)       c[d, "dsp"]   += num
+            else if (cell ~ /^CARRY[48]$/)  c[d, "carry"] += num
+        }
+        END { printf "%d,%d,%d,%d", c[d, "lut"], c[d, "ff"], c[d, "dsp"], c[d, "carry"] }' \
+        "$WORK/$name.stat.json")
+    depth=$(sed -n 's/.*length=\([0-9]*\).*/\1/p' "$WORK/$name.ltp.txt" | sort -n | tail -n 1)
+
+    echo "$COMMIT,$DATE,$name,$top,$*,$FRONTEND,$counts,${depth:-0}" >> "$RESULTS"
+    IFS=, read -r lut ff dsp carry <<< "$counts"
+    printf "  %-18s LUT %6d  FF %6d  DSP %4d  CARRY %5d  DEPTH %3d\n" \
+           "$name" "$lut" "$ff" "$dsp" "$carry" "${depth:-0}"
+}
+
+echo "QoR: $COMMIT, $FRONTEND frontend, synth_xilinx -family $FAMILY"
+status=0
+while read -r name top params; do
+    case "$name" in ''|\#*) continue ;; esac
+    if [ $# -gt 0 ]; then
+        case " $* " in *" $name "*) ;; *) continue ;; esac
+    fi
+    # shellcheck disable=SC2086
+    run_config "$name" "$top" $params || status=1
+done < "$CONFIGS"
+exit $status
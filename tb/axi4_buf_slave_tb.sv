@@ -0,0 +1,565 @@
+`timescale 1ns/1ps
+//-----------------------------------------------------------------------------
+// Testbench: axi4_buf_slave_tb
+// Description: axi4_buf_slave on NUM_PE top_pe instances
+//              1. GEMV through the window: W/X tiles (gemv_test_*.hex, test
+//                 p on PE p) written with bursts, computed, Y line read back
+//                 and compared with the C reference
+//              2. SLVERR cases: Y write, W read, narrow beats, line out of
+//                 range
+//              3. Fill bandwidth: every W and X line of every PE, one INCR
+//                 burst per buffer (axi_buf_test_fill.hex, committed lines
+//                 checked on the buffer ports), then all Y lines read back;
+//                 compared with AXI-Lite single-beat 32-bit writes
+//-----------------------------------------------------------------------------
+
+module axi4_buf_slave_tb;
+
+    //-------------------------------------------------------------------------
+    // Parameters
+    //-------------------------------------------------------------------------
+    parameter int INPUT_WIDTH    = 8;
+    parameter int WEIGHT_WIDTH   = 8;
+    parameter int OUTPUT_WIDTH   = 32;
+    parameter int SUBARRAY_ROWS  = 32;
+    parameter int SUBARRAY_COLS  = 8;
+    parameter int BUF_DEPTH      = 4;      // AXIBUF_DEPTH in sw/ref/main.c
+    parameter int NUM_PE         = 2;      // AXIBUF_PES
+    parameter int AXI_ADDR_WIDTH = 20;
+    parameter int AXI_DATA_WIDTH = 64;
+    parameter int AXI_ID_WIDTH   = 4;
+    parameter int CLK_PERIOD     = 10;
+    parameter int CLOCK_MHZ      = 200;    // EMU_CLOCK_MHZ
+    parameter int LITE_CYCLES    = 2;      // axi_lite_slave: cycles per 32-bit write
+
+    parameter string DATA_PATH = "/home/yc/yc_npu/sw/ref/hex_data/";
+
+    localparam int WLINE_WIDTH = SUBARRAY_ROWS * SUBARRAY_COLS * WEIGHT_WIDTH;  // 2048
+    localparam int ILINE_WIDTH = SUBARRAY_COLS * INPUT_WIDTH;                   // 64
+    localparam int OLINE_WIDTH = SUBARRAY_ROWS * OUTPUT_WIDTH;                  // 1024
+    localparam int WLINE_BYTES = WLINE_WIDTH / 8;
+    localparam int ILINE_BYTES = ILINE_WIDTH / 8;
+    localparam int OLINE_BYTES = OLINE_WIDTH / 8;
+    localparam int BEAT_BYTES  = AXI_DATA_WIDTH / 8;
+    localparam int BEAT_SIZE   = $clog2(BEAT_BYTES);
+    localparam int PE_FILL     = BUF_DEPTH * (WLINE_BYTES + ILINE_BYTES);
+
+    localparam int WIN_BYTES   = 4096;     // npu_pkg BUF_WIN_BYTES
+    localparam int REGION_W    = 0;
+    localparam int REGION_X    = 1;
+    localparam int REGION_Y    = 2;
+
+    localparam logic [1:0] RESP_OKAY   = 2'b00;
+    localparam logic [1:0] RESP_SLVERR = 2'b10;
+
+    //-------------------------------------------------------------------------
+    // DUT Signals
+    //-------------------------------------------------------------------------
+    logic                              clk;
+    logic                              rst_n;
+
+    logic [AXI_ID_WIDTH-1:0]           awid;
+    logic [AXI_ADDR_WIDTH-1:0]         awaddr;
+    logic [7:0]                        awlen;
+    logic [2:0]                        awsize;
+    logic [1:0]                        awburst;
+    logic                              awvalid;
+    logic                              awready;
+    logic [AXI_DATA_WIDTH-1:0]         wdata;
+    logic [AXI_DATA_WIDTH/8-1:0]       wstrb;
+    logic                              wlast;
+    logic                              wvalid;
+    logic                              wready;
+    logic [AXI_ID_WIDTH-1:0]           bid;
+    logic [1:0]                        bresp;
+    logic                              bvalid;
+    logic                              bready;
+    logic [AXI_ID_WIDTH-1:0]           arid;
+    logic [AXI_ADDR_WIDTH-1:0]         araddr;
+    logic [7:0]                        arlen;
+    logic [2:0]                        arsize;
+    logic [1:0]                        arburst;
+    logic                              arvalid;
+    logic                              arready;
+    logic [AXI_ID_WIDTH-1:0]           rid;
+    logic [AXI_DATA_WIDTH-1:0]         rdata;
+    logic [1:0]                        rresp;
+    logic                              rlast;
+    logic                              rvalid;
+    logic                              rready;
+
+    logic [$clog2(BUF_DEPTH)-1:0]      wbuf_wr_addr;
+    logic [WLINE_WIDTH-1:0]            wbuf_wr_data;
+    logic [NUM_PE-1:0]                 wbuf_wr_en;
+    logic [$clog2(BUF_DEPTH)-1:0]      ibuf_wr_addr;
+    logic [ILINE_WIDTH-1:0]            ibuf_wr_data;
+    logic [NUM_PE-1:0]                 ibuf_wr_en;
+    logic [$clog2(BUF_DEPTH)-1:0]      obuf_rd_addr;
+    logic [NUM_PE-1:0]                 obuf_rd_en;
+    logic [NUM_PE-1:0][OLINE_WIDTH-1:0] obuf_rd_data;
+
+    logic                              start;
+    logic                              clear_acc;
+    logic [NUM_PE-1:0]                 pe_busy;
+    logic [NUM_PE-1:0]                 pe_done;
+
+    //-------------------------------------------------------------------------
+    // Reference Data Memory
+    //-------------------------------------------------------------------------
+    logic [7:0]  ref_weight [0:NUM_PE*SUBARRAY_ROWS*SUBARRAY_COLS-1];
+    logic [7:0]  ref_input  [0:NUM_PE*SUBARRAY_COLS-1];
+    logic [31:0] ref_output [0:NUM_PE*SUBARRAY_ROWS-1];
+    logic [7:0]  ref_fill   [0:NUM_PE*PE_FILL-1];
+
+    //-------------------------------------------------------------------------
+    // Test Variables
+    //-------------------------------------------------------------------------
+    int test_count;
+    int pass_count;
+    int fail_count;
+    int cycle;
+    int fill_check;       // Compare committed lines with ref_fill
+    int fill_lines;
+    int fill_errors;
+
+    logic [7:0]  burst_buf [0:4095];   // Bytes of the current burst
+
+    //-------------------------------------------------------------------------
+    // DUT Instance
+    //-------------------------------------------------------------------------
+    axi4_buf_slave #(
+        .NUM_PE         (NUM_PE),
+        .AXI_ADDR_WIDTH (AXI_ADDR_WIDTH),
+        .AXI_DATA_WIDTH (AXI_DATA_WIDTH),
+        .AXI_ID_WIDTH   (AXI_ID_WIDTH),
+        .BUF_DEPTH      (BUF_DEPTH),
+        .WLINE_WIDTH    (WLINE_WIDTH),
+        .ILINE_WIDTH    (ILINE_WIDTH),
+        .OLINE_WIDTH    (OLINE_WIDTH)
+    ) dut (
+        .clk           (clk),
+        .rst_n         (rst_n),
+        .s_axi_awid    (awid),
+        .s_axi_awaddr  (awaddr),
+        .s_axi_awlen   (awlen),
+        .s_axi_awsize  (awsize),
+        .s_axi_awburst (awburst),
+        .s_axi_awvalid (awvalid),
+        .s_axi_awready (awready),
+        .s_axi_wdata   (wdata),
+        .s_axi_wstrb   (wstrb),
+        .s_axi_wlast   (wlast),
+        .s_axi_wvalid  (wvalid),
+        .s_axi_wready  (wready),
+        .s_axi_bid     (bid),
+        .s_axi_bresp   (bresp),
+        .s_axi_bvalid  (bvalid),
+        .s_axi_bready  (bready),
+        .s_axi_arid    (arid),
+        .s_axi_araddr  (araddr),
+        .s_axi_arlen   (arlen),
+        .s_axi_arsize  (arsize),
+        .s_axi_arburst (arburst),
+        .s_axi_arvalid (arvalid),
+        .s_axi_arready (arready),
+        .s_axi_rid     (rid),
+        .s_axi_rdata   (rdata),
+        .s_axi_rresp   (rresp),
+        .s_axi_rlast   (rlast),
+        .s_axi_rvalid  (rvalid),
+        .s_axi_rready  (rready),
+        .wbuf_wr_addr  (wbuf_wr_addr),
+        .wbuf_wr_data  (wbuf_wr_data),
+        .wbuf_wr_en    (wbuf_wr_en),
+        .ibuf_wr_addr  (ibuf_wr_addr),
+        .ibuf_wr_data  (ibuf_wr_data),
+        .ibuf_wr_en    (ibuf_wr_en),
+        .obuf_rd_addr  (obuf_rd_addr),
+        .obuf_rd_en    (obuf_rd_en),
+        .obuf_rd_data  (obuf_rd_data)
+    );
+
+    //-------------------------------------------------------------------------
+    // PE Instances
+    //-------------------------------------------------------------------------
+    generate
+        for (genvar p = 0; p < NUM_PE; p++) begin : gen_pe
+            top_pe #(
+                .SUBARRAY_ROWS (SUBARRAY_ROWS),
+                .SUBARRAY_COLS (SUBARRAY_COLS),
+                .INPUT_WIDTH   (INPUT_WIDTH),
+                .WEIGHT_WIDTH  (WEIGHT_WIDTH),
+                .OUTPUT_WIDTH  (OUTPUT_WIDTH),
+                .BUF_DEPTH     (BUF_DEPTH)
+            ) u_pe (
+                .clk             (clk),
+                .rst_n           (rst_n),
+                .start           (start),
+                .clear_acc       (clear_acc),
+                .restore_acc     (1'b0),
+                .busy            (pe_busy[p]),
+                .done            (pe_done[p]),
+                .wbuf_bank       ('0),
+                .wbuf_wr_addr    (wbuf_wr_addr),
+                .wbuf_wr_data    (wbuf_wr_data),
+                .wbuf_wr_en      (wbuf_wr_en[p]),
+                .ibuf_wr_addr    (ibuf_wr_addr),
+                .ibuf_wr_data    (ibuf_wr_data),
+                .ibuf_wr_en      (ibuf_wr_en[p]),
+                .obuf_rd_addr    (obuf_rd_addr),
+                .obuf_rd_en      (obuf_rd_en[p]),
+                .obuf_rd_data    (obuf_rd_data[p]),
+                .chain_en        (1'b0),
+                .chain_ibuf_base ('0),
+                .rq_scale        ('0),
+                .rq_shift        ('0),
+                .rq_relu         (1'b0),
+                .chain_busy      (),
+                .stream_mode     (1'b0),
+                .stream_len      ('0),
+                .wstream_data    ('0),
+                .wstream_valid   (1'b0),
+                .wstream_ready   (),
+                .restore_data    ('0)
+            );
+        end
+    endgenerate
+
+    //-------------------------------------------------------------------------
+    // Clock Generation
+    //-------------------------------------------------------------------------
+    initial begin
+        clk = 0;
+        forever #(CLK_PERIOD/2) clk = ~clk;
+    end
+
+    always @(posedge clk) cycle <= cycle + 1;
+
+    //-------------------------------------------------------------------------
+    // Line Monitor (fill benchmark: committed lines vs axi_buf_test_fill.hex)
+    //-------------------------------------------------------------------------
+    always @(posedge clk) begin
+        if (fill_check) begin
+            for (int p = 0; p < NUM_PE; p++) begin
+                if (wbuf_wr_en[p]) begin
+                    fill_lines++;
+                    for (int b = 0; b < WLINE_BYTES; b++)
+                        if (wbuf_wr_data[b*8 +: 8] !== ref_fill[p*PE_FILL + int'(wbuf_wr_addr)*WLINE_BYTES + b])
+                            fill_errors++;
+                end
+                if (ibuf_wr_en[p]) begin
+                    fill_lines++;
+                    for (int b = 0; b < ILINE_BYTES; b++)
+                        if (ibuf_wr_data[b*8 +: 8] !== ref_fill[p*PE_FILL + BUF_DEPTH*WLINE_BYTES +
+                                                                 int'(ibuf_wr_addr)*ILINE_BYTES + b])
+                            fill_errors++;
+                end
+            end
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Tasks
+    //-------------------------------------------------------------------------
+
+    task automatic init_signals();
+        rst_n       = 0;
+        awid        = '0;
+        awaddr      = '0;
+        awlen       = '0;
+        awsize      = 3'(BEAT_SIZE);
+        awburst     = 2'b01;
+        awvalid     = 0;
+        wdata       = '0;
+        wstrb       = '0;
+        wlast       = 0;
+        wvalid      = 0;
+        bready      = 0;
+        arid        = '0;
+        araddr      = '0;
+        arlen       = '0;
+        arsize      = 3'(BEAT_SIZE);
+        arburst     = 2'b01;
+        arvalid     = 0;
+        rready      = 0;
+        start       = 0;
+        clear_acc   = 0;
+        test_count  = 0;
+        pass_count  = 0;
+        fail_count  = 0;
+        cycle       = 0;
+        fill_check  = 0;
+        fill_lines  = 0;
+        fill_errors = 0;
+    endtask
+
+    task automatic do_reset();
+        @(posedge clk);
+        rst_n <= 0;
+        repeat(5) @(posedge clk);
+        rst_n <= 1;
+        repeat(2) @(posedge clk);
+    endtask
+
+    task automatic load_test_data();
+        $display("  Loading: %sgemv_test_weight.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "gemv_test_weight.hex"},  ref_weight);
+        $display("  Loading: %sgemv_test_input.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "gemv_test_input.hex"},   ref_input);
+        $display("  Loading: %sgemv_test_output.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "gemv_test_output.hex"},  ref_output);
+        $display("  Loading: %saxi_buf_test_fill.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "axi_buf_test_fill.hex"}, ref_fill);
+    endtask
+
+    function automatic logic [AXI_ADDR_WIDTH-1:0] win_addr(int pe, int region, int offset);
+        return AXI_ADDR_WIDTH'(pe * 4 * WIN_BYTES + region * WIN_BYTES + offset);
+    endfunction
+
+    // INCR burst of burst_buf[0 .. beats*BEAT_BYTES-1]; returns BRESP and
+    // the cycles from AWVALID to the B handshake
+    task automatic axi_write(logic [AXI_ADDR_WIDTH-1:0] addr, int beats, int size,
+                             output logic [1:0] resp, output int cycles);
+        int t0;
+        @(posedge clk);
+        t0      = cycle;
+        awaddr  <= addr;
+        awlen   <= 8'(beats - 1);
+        awsize  <= 3'(size);
+        awvalid <= 1;
+        @(posedge clk);
+        while (!awready) @(posedge clk);
+        awvalid <= 0;
+        for (int b = 0; b < beats; b++) begin
+            for (int i = 0; i < BEAT_BYTES; i++)
+                wdata[i*8 +: 8] <= burst_buf[b*BEAT_BYTES + i];
+            wstrb  <= '1;
+            wlast  <= (b == beats - 1);
+            wvalid <= 1;
+            @(posedge clk);
+            while (!wready) @(posedge clk);
+        end
+        wvalid <= 0;
+        wlast  <= 0;
+        bready <= 1;
+        @(posedge clk);
+        while (!bvalid) @(posedge clk);
+        resp   = bresp;
+        bready <= 0;
+        cycles = cycle - t0;
+    endtask
+
+    // INCR burst into burst_buf; returns the worst RRESP and the cycles
+    // from ARVALID to the last beat
+    task automatic axi_read(logic [AXI_ADDR_WIDTH-1:0] addr, int beats, int size,
+                            output logic [1:0] resp, output int cycles);
+        int t0, b;
+        @(posedge clk);
+        t0      = cycle;
+        araddr  <= addr;
+        arlen   <= 8'(beats - 1);
+        arsize  <= 3'(size);
+        arvalid <= 1;
+        @(posedge clk);
+        while (!arready) @(posedge clk);
+        arvalid <= 0;
+        rready  <= 1;
+        resp    = RESP_OKAY;
+        b       = 0;
+        do begin
+            @(posedge clk);
+            if (rvalid) begin
+                for (int i = 0; i < BEAT_BYTES; i++)
+                    burst_buf[b*BEAT_BYTES + i] = rdata[i*8 +: 8];
+                if (rresp != RESP_OKAY)
+                    resp = rresp;
+                b++;
+            end
+        end while (!(rvalid && rlast));
+        rready <= 0;
+        cycles = cycle - t0;
+    endtask
+
+    task automatic check(logic ok, string msg);
+        test_count++;
+        if (ok) begin
+            pass_count++;
+            $display("[PASS] %s", msg);
+        end else begin
+            fail_count++;
+            $display("[FAIL] %s", msg);
+        end
+    endtask
+
+    //-------------------------------------------------------------------------
+    // Main Test Sequence
+    //-------------------------------------------------------------------------
+    initial begin
+        logic [1:0] resp;
+        int         cycles, bytes, total_cycles, mismatch;
+        logic [31:0] y;
+        real        bpc, lite_bpc;
+
+        $display("");
+        $display("=============================================================");
+        $display("      axi4_buf_slave Testbench");
+        $display("=============================================================");
+        $display("  NUM_PE:     %0d", NUM_PE);
+        $display("  BUF_DEPTH:  %0d", BUF_DEPTH);
+        $display("  DATA_WIDTH: %0d (W line %0d beats, Y line %0d beats)",
+                 AXI_DATA_WIDTH, WLINE_BYTES / BEAT_BYTES, OLINE_BYTES / BEAT_BYTES);
+        $display("=============================================================");
+        $display("");
+
+        init_signals();
+
+        $display("--- Loading C Reference Data ---");
+        load_test_data();
+        $display("");
+
+        do_reset();
+
+        //---------------------------------------------------------------------
+        // 1. GEMV through the window
+        //---------------------------------------------------------------------
+        for (int p = 0; p < NUM_PE; p++) begin
+            for (int i = 0; i < WLINE_BYTES; i++)
+                burst_buf[i] = ref_weight[p*WLINE_BYTES + i];
+            axi_write(win_addr(p, REGION_W, 0), WLINE_BYTES / BEAT_BYTES, BEAT_SIZE, resp, cycles);
+            check(resp == RESP_OKAY, $sformatf("PE %0d: W line written (%0d beats, %0d cycles)",
+                                               p, WLINE_BYTES / BEAT_BYTES, cycles));
+            for (int i = 0; i < ILINE_BYTES; i++)
+                burst_buf[i] = ref_input[p*ILINE_BYTES + i];
+            axi_write(win_addr(p, REGION_X, 0), ILINE_BYTES / BEAT_BYTES, BEAT_SIZE, resp, cycles);
+            check(resp == RESP_OKAY, $sformatf("PE %0d: X line written", p));
+        end
+
+        @(posedge clk);
+        start     <= 1;
+        clear_acc <= 1;
+        @(posedge clk);
+        start     <= 0;
+        clear_acc <= 0;
+        wait(&pe_done);
+        @(posedge clk);
+
+        for (int p = 0; p < NUM_PE; p++) begin
+            axi_read(win_addr(p, REGION_Y, 0), OLINE_BYTES / BEAT_BYTES, BEAT_SIZE, resp, cycles);
+            mismatch = 0;
+            for (int r = 0; r < SUBARRAY_ROWS; r++) begin
+                y = {burst_buf[4*r+3], burst_buf[4*r+2], burst_buf[4*r+1], burst_buf[4*r]};
+                if (y !== ref_output[p*SUBARRAY_ROWS + r]) begin
+                    if (mismatch < 4)
+                        $display("  PE %0d Y[%0d]: RTL=%0d REF=%0d", p, r,
+                                 $signed(y), $signed(ref_output[p*SUBARRAY_ROWS + r]));
+                    mismatch++;
+                end
+            end
+            check(resp == RESP_OKAY && mismatch == 0,
+                  $sformatf("PE %0d: Y line read back matches C reference (%0d cycles)", p, cycles));
+        end
+
+        //---------------------------------------------------------------------
+        // 2. Error responses
+        //---------------------------------------------------------------------
+        axi_write(win_addr(0, REGION_Y, 0), 2, BEAT_SIZE, resp, cycles);
+        check(resp == RESP_SLVERR, "Write to the output buffer: SLVERR");
+        axi_read(win_addr(0, REGION_W, 0), 2, BEAT_SIZE, resp, cycles);
+        check(resp == RESP_SLVERR, "Read from the weight buffer: SLVERR");
+        axi_write(win_addr(0, REGION_W, 0), 2, BEAT_SIZE - 1, resp, cycles);
+        check(resp == RESP_SLVERR, "Narrow beats: SLVERR");
+        axi_read(win_addr(0, REGION_Y, (BUF_DEPTH - 1) * OLINE_BYTES), 2 * OLINE_BYTES / BEAT_BYTES,
+                 BEAT_SIZE, resp, cycles);
+        check(resp == RESP_SLVERR, "Read past the last output line: SLVERR");
+
+        //---------------------------------------------------------------------
+        // 3. Fill / readback bandwidth
+        //---------------------------------------------------------------------
+        fill_check   = 1;
+        total_cycles = 0;
+        bytes        = 0;
+        for (int p = 0; p < NUM_PE; p++) begin
+            for (int i = 0; i < BUF_DEPTH * WLINE_BYTES; i++)
+                burst_buf[i] = ref_fill[p*PE_FILL + i];
+            axi_write(win_addr(p, REGION_W, 0), BUF_DEPTH * WLINE_BYTES / BEAT_BYTES, BEAT_SIZE,
+                      resp, cycles);
+            total_cycles += cycles;
+            bytes        += BUF_DEPTH * WLINE_BYTES;
+            for (int i = 0; i < BUF_DEPTH * ILINE_BYTES; i++)
+                burst_buf[i] = ref_fill[p*PE_FILL + BUF_DEPTH*WLINE_BYTES + i];
+            axi_write(win_addr(p, REGION_X, 0), BUF_DEPTH * ILINE_BYTES / BEAT_BYTES, BEAT_SIZE,
+                      resp, cycles);
+            total_cycles += cycles;
+            bytes        += BUF_DEPTH * ILINE_BYTES;
+        end
+        repeat(2) @(posedge clk);
+        fill_check = 0;
+
+        bpc      = real'(bytes) / real'(total_cycles);
+        lite_bpc = 4.0 / real'(LITE_CYCLES);
+        $display("");
+        $display("-------------------------------------------------------------");
+        $display("  Host Fill Bandwidth (W + X, %0d PEs)", NUM_PE);
+        $display("-------------------------------------------------------------");
+        $display("  Bytes               : %0d", bytes);
+        $display("  Cycles              : %0d", total_cycles);
+        $display("  AXI4 bursts         : %0.2f B/cycle (%0.1f%% of %0d), %0.0f MB/s @ %0d MHz",
+                 bpc, 100.0 * bpc / BEAT_BYTES, BEAT_BYTES, bpc * CLOCK_MHZ, CLOCK_MHZ);
+        $display("  AXI-Lite registers  : %0.2f B/cycle (%0d cycles / 32-bit write)",
+                 lite_bpc, LITE_CYCLES);
+        $display("  Speedup             : %0.1fx", bpc / lite_bpc);
+        $display("-------------------------------------------------------------");
+        check(fill_errors == 0 && fill_lines == NUM_PE * 2 * BUF_DEPTH,
+              $sformatf("Fill: %0d lines committed, %0d byte errors", fill_lines, fill_errors));
+        check(bpc >= 0.9 * BEAT_BYTES, "Fill sustains >= 90% of the beat rate");
+
+        total_cycles = 0;
+        bytes        = 0;
+        for (int p = 0; p < NUM_PE; p++) begin
+            axi_read(win_addr(p, REGION_Y, 0), BUF_DEPTH * OLINE_BYTES / BEAT_BYTES, BEAT_SIZE,
+                     resp, cycles);
+            total_cycles += cycles;
+            bytes        += BUF_DEPTH * OLINE_BYTES;
+        end
+        bpc = real'(bytes) / real'(total_cycles);
+        $display("  Readback (Y)        : %0d B in %0d cycles, %0.2f B/cycle", bytes, total_cycles, bpc);
+        check(resp == RESP_OKAY && bpc >= 0.85 * BEAT_BYTES, "Readback sustains >= 85% of the beat rate");
+
+        $display("");
+        $display("=============================================================");
+        $display("                    TEST SUMMARY");
+        $display("=============================================================");
+        $display("  Total tests:  %0d", test_count);
+        $display("  Passed:       %0d", pass_count);
+        $display("  Failed:       %0d", fail_count);
+        $display("=============================================================");
+
+        if (fail_count == 0) begin
+            $display("");
+            $display("  *** ALL TESTS PASSED ***");
+            $display("");
+        end
+
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Timeout Watchdog
+    //-------------------------------------------------------------------------
+    initial begin
+        #(CLK_PERIOD * 20000);
+        $display("");
+        $display("!!! SIMULATION TIMEOUT !!!");
+        $display("");
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Waveform Dump
+    //-------------------------------------------------------------------------
+    initial begin
+        $dumpfile("axi4_buf_slave_tb.vcd");
+        $dumpvars(0, axi4_buf_slave_tb);
+    end
+
+endmodule
@@ -0,0 +1,289 @@
+`timescale 1ns/1ps
+//-----------------------------------------------------------------------------
+// Testbench: embed_gather_tb
+// Description: embed_gather verification with C reference comparison
+//              embed_test_ids.hex holds the token ids of two jobs (memory
+//              model with 2-cycle read latency); embed_test_addr.hex the
+//              expected row burst addresses of job 1
+//              Job 2 has an out-of-vocab id at BAD_POS: the same first
+//              BAD_POS rows must be issued, then done with error
+//              The DMA model takes one row every ROW_CYCLES cycles
+//-----------------------------------------------------------------------------
+
+module embed_gather_tb;
+
+    //-------------------------------------------------------------------------
+    // Parameters
+    //-------------------------------------------------------------------------
+    parameter int ADDR_WIDTH  = 32;
+    parameter int TOK_WIDTH   = 16;
+    parameter int CLK_PERIOD  = 10;
+    parameter int NUM_TOKENS  = 32;      // EG_TOKENS in sw/ref/main.c
+    parameter int VOCAB       = 32000;   // EG_VOCAB
+    parameter int ROW_BYTES   = 512;     // EG_ROW_BYTES
+    parameter int BAD_POS     = 20;      // EG_BAD_POS
+    parameter int ID_LATENCY  = 2;
+    parameter int ROW_CYCLES  = 4;       // DMA busy per row burst
+
+    parameter string DATA_PATH = "/home/yc/yc_npu/sw/ref/hex_data/";
+
+    localparam logic [ADDR_WIDTH-1:0] TABLE_BASE = 32'h1000_0000;  // EG_TABLE
+    localparam logic [ADDR_WIDTH-1:0] IDS_BASE   = 32'h0000_0200;
+
+    //-------------------------------------------------------------------------
+    // DUT Signals
+    //-------------------------------------------------------------------------
+    logic                  clk;
+    logic                  rst_n;
+    logic                  start;
+    logic [ADDR_WIDTH-1:0] ids_base;
+    logic [ADDR_WIDTH-1:0] id_addr;
+    logic                  id_req;
+    logic                  id_gnt;
+    logic [31:0]           id_data;
+    logic                  id_data_valid;
+    logic [ADDR_WIDTH-1:0] row_addr;
+    logic [15:0]           row_len;
+    logic [TOK_WIDTH-1:0]  row_col;
+    logic                  row_valid;
+    logic                  row_ready;
+    logic                  busy;
+    logic                  done;
+    logic                  error;
+
+    //-------------------------------------------------------------------------
+    // Reference Data Memory
+    //-------------------------------------------------------------------------
+    logic [31:0] ref_ids  [0:2*NUM_TOKENS-1];
+    logic [31:0] ref_addr [0:NUM_TOKENS-1];
+
+    //-------------------------------------------------------------------------
+    // Test Variables
+    //-------------------------------------------------------------------------
+    int test_count;
+    int pass_count;
+    int fail_count;
+    int row_count;
+
+    //-------------------------------------------------------------------------
+    // DUT Instance
+    //-------------------------------------------------------------------------
+    embed_gather #(
+        .ADDR_WIDTH (ADDR_WIDTH),
+        .TOK_WIDTH  (TOK_WIDTH)
+    ) dut (
+        .clk           (clk),
+        .rst_n         (rst_n),
+        .start         (start),
+        .table_base    (TABLE_BASE),
+        .row_bytes     (16'(ROW_BYTES)),
+        .vocab         (32'(VOCAB)),
+        .ids_base      (ids_base),
+        .num_tokens    (TOK_WIDTH'(NUM_TOKENS)),
+        .id_addr       (id_addr),
+        .id_req        (id_req),
+        .id_gnt        (id_gnt),
+        .id_data       (id_data),
+        .id_data_valid (id_data_valid),
+        .row_addr      (row_addr),
+        .row_len       (row_len),
+        .row_col       (row_col),
+        .row_valid     (row_valid),
+        .row_ready     (row_ready),
+        .busy          (busy),
+        .done          (done),
+        .error         (error)
+    );
+
+    //-------------------------------------------------------------------------
+    // Clock Generation
+    //-------------------------------------------------------------------------
+    initial begin
+        clk = 0;
+        forever #(CLK_PERIOD/2) clk = ~clk;
+    end
+
+    //-------------------------------------------------------------------------
+    // Id Memory Model (always granted, ID_LATENCY-cycle read data)
+    //-------------------------------------------------------------------------
+    logic [ID_LATENCY-1:0] rd_pipe;
+    logic [31:0]           rd_data [ID_LATENCY];
+
+    assign id_gnt        = id_req;
+    assign id_data_valid = rd_pipe[ID_LATENCY-1];
+    assign id_data       = rd_data[ID_LATENCY-1];
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rd_pipe <= '0;
+        end else begin
+            rd_pipe[0] <= id_req && id_gnt;
+            rd_data[0] <= ref_ids[(id_addr - IDS_BASE) >> 2];
+            for (int i = 1; i < ID_LATENCY; i++) begin
+                rd_pipe[i] <= rd_pipe[i-1];
+                rd_data[i] <= rd_data[i-1];
+            end
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // DMA Model (one row burst accepted every ROW_CYCLES cycles) + Checker
+    //-------------------------------------------------------------------------
+    int dma_wait;
+
+    assign row_ready = (dma_wait == 0);
+
+    always @(posedge clk) begin
+        if (!rst_n) begin
+            dma_wait <= 0;
+        end else if (row_valid && row_ready) begin
+            dma_wait <= ROW_CYCLES - 1;
+            test_count++;
+            if (row_addr !== ref_addr[row_count] || row_col !== TOK_WIDTH'(row_count) ||
+                row_len !== 16'(ROW_BYTES)) begin
+                fail_count++;
+                $display("[FAIL] Row #%0d RTL=(0x%08h, col %0d) REF=(0x%08h, col %0d)",
+                         row_count, row_addr, row_col, ref_addr[row_count], row_count);
+            end else begin
+                pass_count++;
+            end
+            row_count++;
+        end else if (dma_wait > 0) begin
+            dma_wait <= dma_wait - 1;
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Tasks
+    //-------------------------------------------------------------------------
+
+    task automatic init_signals();
+        rst_n      = 0;
+        start      = 0;
+        ids_base   = IDS_BASE;
+        test_count = 0;
+        pass_count = 0;
+        fail_count = 0;
+        row_count  = 0;
+    endtask
+
+    task automatic do_reset();
+        @(posedge clk);
+        rst_n <= 0;
+        repeat(5) @(posedge clk);
+        rst_n <= 1;
+        repeat(2) @(posedge clk);
+    endtask
+
+    task automatic load_test_data();
+        $display("  Loading: %sembed_test_ids.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "embed_test_ids.hex"},  ref_ids);
+        $display("  Loading: %sembed_test_addr.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "embed_test_addr.hex"}, ref_addr);
+    endtask
+
+    // Run one job from ids at base, returns cycles start → done and error
+    task automatic run_job(logic [ADDR_WIDTH-1:0] base, output int cycles,
+                           output logic err);
+        cycles    = 0;
+        row_count = 0;
+        ids_base  <= base;
+        start     <= 1;
+        @(posedge clk);
+        start     <= 0;
+        while (!done) begin
+            @(posedge clk);
+            cycles++;
+        end
+        err = error;
+    endtask
+
+    //-------------------------------------------------------------------------
+    // Main Test Sequence
+    //-------------------------------------------------------------------------
+    initial begin
+        int   cycles;
+        logic err;
+
+        $display("");
+        $display("=============================================================");
+        $display("      embed_gather Testbench");
+        $display("=============================================================");
+        $display("  NUM_TOKENS: %0d", NUM_TOKENS);
+        $display("  ROW_BYTES:  %0d", ROW_BYTES);
+        $display("  ROW_CYCLES: %0d (DMA model)", ROW_CYCLES);
+        $display("=============================================================");
+        $display("");
+
+        init_signals();
+
+        $display("--- Loading C Reference Data ---");
+        load_test_data();
+        $display("");
+
+        do_reset();
+
+        // Job 1: all ids valid
+        run_job(IDS_BASE, cycles, err);
+        test_count++;
+        if (err || row_count != NUM_TOKENS) begin
+            fail_count++;
+            $display("[FAIL] Job 1: %0d rows, error=%0b", row_count, err);
+        end else begin
+            pass_count++;
+            $display("[PASS] Job 1: %0d rows in %0d cycles (%0.2f cycles/row)",
+                     row_count, cycles, real'(cycles) / NUM_TOKENS);
+        end
+
+        repeat(4) @(posedge clk);
+
+        // Job 2: stops at the out-of-vocab id
+        run_job(IDS_BASE + ADDR_WIDTH'(4 * NUM_TOKENS), cycles, err);
+        test_count++;
+        if (!err || row_count != BAD_POS) begin
+            fail_count++;
+            $display("[FAIL] Job 2: %0d rows, error=%0b (expected %0d rows, error)",
+                     row_count, err, BAD_POS);
+        end else begin
+            pass_count++;
+            $display("[PASS] Job 2: stopped after %0d rows with error", row_count);
+        end
+
+        $display("");
+        $display("=============================================================");
+        $display("                    TEST SUMMARY");
+        $display("=============================================================");
+        $display("  Total tests:  %0d", test_count);
+        $display("  Passed:       %0d", pass_count);
+        $display("  Failed:       %0d", fail_count);
+        $display("=============================================================");
+
+        if (fail_count == 0) begin
+            $display("");
+            $display("  *** ALL TESTS PASSED ***");
+            $display("");
+        end
+
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Timeout Watchdog
+    //-------------------------------------------------------------------------
+    initial begin
+        #(CLK_PERIOD * 10000);
+        $display("");
+        $display("!!! SIMULATION TIMEOUT !!!");
+        $display("");
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Waveform Dump
+    //-------------------------------------------------------------------------
+    initial begin
+        $dumpfile("embed_gather_tb.vcd");
+        $dumpvars(0, embed_gather_tb);
+    end
+
+endmodule
@@ -0,0 +1,388 @@
+`timescale 1ns/1ps
+//-----------------------------------------------------------------------------
+// Testbench: gemv_ctrl_tb
+// Description: K-tiled GeMV verification on top_pe (CTRL_ROWS x CTRL_COLS)
+//              Test data is packed per real K (no MAX_K padding):
+//                gemv_ctrl_test_offset.hex = { input_offset, weight_offset }
+//                per test, weight row stride = dim_k
+//              Each K-tile is loaded by indexed reads from the packed arrays;
+//              columns past dim_k in the last tile are zero-filled here
+//              gemv input pipeline on (FANOUT_STAGES): PE_ctrl must wait
+//              for the later valid_out, results are unchanged
+//              Zero-length stream (stream_mode, stream_len = 0): done within
+//              a few cycles, output buffer left as the last test wrote it
+//-----------------------------------------------------------------------------
+
+module gemv_ctrl_tb;
+
+    //-------------------------------------------------------------------------
+    // Parameters (match CTRL_* in sw/ref/main.c)
+    //-------------------------------------------------------------------------
+    parameter int INPUT_WIDTH   = 8;
+    parameter int WEIGHT_WIDTH  = 8;
+    parameter int OUTPUT_WIDTH  = 32;
+    parameter int SUBARRAY_ROWS = 16;  // CTRL_ROWS
+    parameter int SUBARRAY_COLS = 4;   // CTRL_COLS
+    parameter int BUF_DEPTH     = 4;
+    parameter int CLK_PERIOD    = 10;
+    parameter int NUM_TESTS     = 8;   // CTRL_NUM_TESTS
+    parameter int MAX_K         = 32;  // CTRL_MAX_K (memory upper bound only)
+    parameter int FANOUT_STAGES = 2;   // gemv input pipeline
+    parameter int FANOUT_GROUPS = 4;   // 4 rows per broadcast copy
+
+    parameter string DATA_PATH = "/home/yc/yc_npu/sw/ref/hex_data/";
+
+    localparam int WEIGHT_BUF_WIDTH = SUBARRAY_ROWS * SUBARRAY_COLS * WEIGHT_WIDTH;
+    localparam int INPUT_BUF_WIDTH  = SUBARRAY_COLS * INPUT_WIDTH;
+    localparam int OUTPUT_BUF_WIDTH = SUBARRAY_ROWS * OUTPUT_WIDTH;
+
+    //-------------------------------------------------------------------------
+    // DUT Signals
+    //-------------------------------------------------------------------------
+    logic clk;
+    logic rst_n;
+
+    logic start;
+    logic clear_acc;
+    logic stream_mode;
+    logic [15:0] stream_len;
+    logic busy;
+    logic done;
+
+    logic [$clog2(BUF_DEPTH)-1:0]    wbuf_wr_addr;
+    logic [WEIGHT_BUF_WIDTH-1:0]     wbuf_wr_data;
+    logic                             wbuf_wr_en;
+
+    logic [$clog2(BUF_DEPTH)-1:0]    ibuf_wr_addr;
+    logic [INPUT_BUF_WIDTH-1:0]      ibuf_wr_data;
+    logic                             ibuf_wr_en;
+
+    logic [$clog2(BUF_DEPTH)-1:0]    obuf_rd_addr;
+    logic                             obuf_rd_en;
+    logic [OUTPUT_BUF_WIDTH-1:0]     obuf_rd_data;
+
+    //-------------------------------------------------------------------------
+    // Reference Data Memory (sized for the worst case, filled to real K)
+    //-------------------------------------------------------------------------
+    logic [INPUT_WIDTH-1:0]  ref_input  [0:NUM_TESTS*MAX_K-1];
+    logic [WEIGHT_WIDTH-1:0] ref_weight [0:NUM_TESTS*SUBARRAY_ROWS*MAX_K-1];
+    logic [OUTPUT_WIDTH-1:0] ref_output [0:NUM_TESTS*SUBARRAY_ROWS-1];
+    logic [31:0]             ref_dimk   [0:NUM_TESTS-1];
+    logic [31:0]             ref_offset [0:2*NUM_TESTS-1];  // {input, weight} per test
+
+    //-------------------------------------------------------------------------
+    // Test Variables
+    //-------------------------------------------------------------------------
+    int test_count;
+    int pass_count;
+    int fail_count;
+    int tile_count;
+    int load_cycles;   // Cycles spent writing weight/input buffers
+
+    //-------------------------------------------------------------------------
+    // DUT Instance
+    //-------------------------------------------------------------------------
+    top_pe #(
+        .SUBARRAY_ROWS (SUBARRAY_ROWS),
+        .SUBARRAY_COLS (SUBARRAY_COLS),
+        .INPUT_WIDTH   (INPUT_WIDTH),
+        .WEIGHT_WIDTH  (WEIGHT_WIDTH),
+        .OUTPUT_WIDTH  (OUTPUT_WIDTH),
+        .BUF_DEPTH     (BUF_DEPTH),
+        .FANOUT_STAGES (FANOUT_STAGES),
+        .FANOUT_GROUPS (FANOUT_GROUPS)
+    ) dut (
+        .clk          (clk),
+        .rst_n        (rst_n),
+        .start        (start),
+        .clear_acc    (clear_acc),
+        .restore_acc  (1'b0),
+        .busy         (busy),
+        .done         (done),
+        .wbuf_bank    ('0),
+        .wbuf_wr_addr (wbuf_wr_addr),
+        .wbuf_wr_data (wbuf_wr_data),
+        .wbuf_wr_en   (wbuf_wr_en),
+        .ibuf_wr_addr (ibuf_wr_addr),
+        .ibuf_wr_data (ibuf_wr_data),
+        .ibuf_wr_en   (ibuf_wr_en),
+        .obuf_rd_addr (obuf_rd_addr),
+        .obuf_rd_en   (obuf_rd_en),
+        .obuf_rd_data (obuf_rd_data),
+        .chain_en        (1'b0),
+        .chain_ibuf_base ('0),
+        .rq_scale        ('0),
+        .rq_shift        ('0),
+        .rq_relu         (1'b0),
+        .chain_busy      (),
+        .stream_mode     (stream_mode),
+        .stream_len      (stream_len),
+        .wstream_data    ('0),
+        .wstream_valid   (1'b0),
+        .wstream_ready   (),
+        .restore_data    ('0)
+    );
+
+    //-------------------------------------------------------------------------
+    // Clock Generation
+    //-------------------------------------------------------------------------
+    initial begin
+        clk = 0;
+        forever #(CLK_PERIOD/2) clk = ~clk;
+    end
+
+    //-------------------------------------------------------------------------
+    // Tasks
+    //-------------------------------------------------------------------------
+
+    task automatic init_signals();
+        rst_n        = 0;
+        start        = 0;
+        clear_acc    = 0;
+        stream_mode  = 0;
+        stream_len   = '0;
+        wbuf_wr_addr = '0;
+        wbuf_wr_data = '0;
+        wbuf_wr_en   = 0;
+        ibuf_wr_addr = '0;
+        ibuf_wr_data = '0;
+        ibuf_wr_en   = 0;
+        obuf_rd_addr = '0;
+        obuf_rd_en   = 0;
+        test_count   = 0;
+        pass_count   = 0;
+        fail_count   = 0;
+        tile_count   = 0;
+        load_cycles  = 0;
+    endtask
+
+    task automatic do_reset();
+        @(posedge clk);
+        rst_n <= 0;
+        repeat(5) @(posedge clk);
+        rst_n <= 1;
+        repeat(2) @(posedge clk);
+    endtask
+
+    task automatic load_test_data();
+        $display("  Loading: %sgemv_ctrl_test_input.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "gemv_ctrl_test_input.hex"},  ref_input);
+        $display("  Loading: %sgemv_ctrl_test_weight.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "gemv_ctrl_test_weight.hex"}, ref_weight);
+        $display("  Loading: %sgemv_ctrl_test_output.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "gemv_ctrl_test_output.hex"}, ref_output);
+        $display("  Loading: %sgemv_ctrl_test_dimk.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "gemv_ctrl_test_dimk.hex"},   ref_dimk);
+        $display("  Loading: %sgemv_ctrl_test_offset.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "gemv_ctrl_test_offset.hex"}, ref_offset);
+    endtask
+
+    //-------------------------------------------------------------------------
+    // Indexed K-tile load: weight[w_off + r*dim_k + k], input[i_off + k]
+    //-------------------------------------------------------------------------
+    task automatic write_k_tile(int test_idx, int tile);
+        int dim_k, i_off, w_off, k;
+
+        dim_k = ref_dimk[test_idx];
+        i_off = ref_offset[2*test_idx];
+        w_off = ref_offset[2*test_idx + 1];
+
+        @(posedge clk);
+        wbuf_wr_addr <= '0;
+        wbuf_wr_en   <= 1;
+        ibuf_wr_addr <= '0;
+        ibuf_wr_en   <= 1;
+
+        for (int c = 0; c < SUBARRAY_COLS; c++) begin
+            k = tile*SUBARRAY_COLS + c;
+            ibuf_wr_data[c*INPUT_WIDTH +: INPUT_WIDTH]
+                <= (k < dim_k) ? ref_input[i_off + k] : '0;
+            for (int r = 0; r < SUBARRAY_ROWS; r++) begin
+                wbuf_wr_data[(r*SUBARRAY_COLS + c)*WEIGHT_WIDTH +: WEIGHT_WIDTH]
+                    <= (k < dim_k) ? ref_weight[w_off + r*dim_k + k] : '0;
+            end
+        end
+
+        @(posedge clk);
+        wbuf_wr_en <= 0;
+        ibuf_wr_en <= 0;
+        load_cycles += 2;
+    endtask
+
+    task automatic run_tile(logic do_clear);
+        @(posedge clk);
+        start     <= 1;
+        clear_acc <= do_clear;
+        @(posedge clk);
+        start     <= 0;
+        clear_acc <= 0;
+
+        wait(done);
+        @(posedge clk);
+    endtask
+
+    //-------------------------------------------------------------------------
+    // Run one test: all K-tiles, then compare output buffer
+    //-------------------------------------------------------------------------
+    task automatic run_test(int test_idx);
+        int dim_k, num_tiles, mismatch_found;
+        logic [OUTPUT_WIDTH-1:0] rtl_val;
+        logic [OUTPUT_WIDTH-1:0] ref_val;
+
+        dim_k     = ref_dimk[test_idx];
+        num_tiles = (dim_k + SUBARRAY_COLS - 1) / SUBARRAY_COLS;
+        mismatch_found = 0;
+        test_count++;
+
+        for (int tile = 0; tile < num_tiles; tile++) begin
+            write_k_tile(test_idx, tile);
+            run_tile(tile == 0);  // clear_acc on first K-tile only
+            tile_count++;
+        end
+
+        // Read output buffer (HIGH_PERFORMANCE: 2-cycle latency)
+        @(posedge clk);
+        obuf_rd_addr <= '0;
+        obuf_rd_en   <= 1;
+        @(posedge clk);
+        @(posedge clk);
+        @(posedge clk);
+        obuf_rd_en <= 0;
+
+        for (int r = 0; r < SUBARRAY_ROWS; r++) begin
+            rtl_val = obuf_rd_data[r*OUTPUT_WIDTH +: OUTPUT_WIDTH];
+            ref_val = ref_output[test_idx*SUBARRAY_ROWS + r];
+
+            if ($signed(rtl_val) !== $signed(ref_val)) begin
+                if (!mismatch_found) begin
+                    fail_count++;
+                    mismatch_found = 1;
+                    $display("[FAIL] Test #%0d (dim_k=%0d)", test_idx, dim_k);
+                end
+                $display("  [%2d] RTL=%0d, REF=%0d", r, $signed(rtl_val), $signed(ref_val));
+            end
+        end
+
+        if (!mismatch_found) begin
+            pass_count++;
+            $display("[PASS] Test #%0d (dim_k=%0d, %0d K-tiles)", test_idx, dim_k, num_tiles);
+        end
+    endtask
+
+    //-------------------------------------------------------------------------
+    // Zero-length stream: no lines to wait for, must finish without a
+    // store (output buffer still holds test last_idx)
+    //-------------------------------------------------------------------------
+    task automatic do_zero_stream_test(int last_idx);
+        int cycles, mismatch;
+        time t0;
+
+        test_count++;
+        @(posedge clk);
+        start       <= 1;
+        clear_acc   <= 1;
+        stream_mode <= 1;
+        stream_len  <= '0;
+        @(posedge clk);
+        start       <= 0;
+        clear_acc   <= 0;
+        stream_mode <= 0;
+
+        t0 = $time;
+        fork
+            wait(done);
+            repeat(16) @(posedge clk);
+        join_any
+        disable fork;
+        cycles = ($time - t0) / CLK_PERIOD;
+        @(posedge clk);
+
+        @(posedge clk);
+        obuf_rd_addr <= '0;
+        obuf_rd_en   <= 1;
+        @(posedge clk);
+        @(posedge clk);
+        @(posedge clk);
+        obuf_rd_en <= 0;
+
+        mismatch = 0;
+        for (int r = 0; r < SUBARRAY_ROWS; r++)
+            if (obuf_rd_data[r*OUTPUT_WIDTH +: OUTPUT_WIDTH] !== ref_output[last_idx*SUBARRAY_ROWS + r])
+                mismatch++;
+
+        if (cycles < 16 && mismatch == 0) begin
+            pass_count++;
+            $display("[PASS] Zero-length stream: done after %0d cycles, output buffer kept", cycles);
+        end else begin
+            fail_count++;
+            $display("[FAIL] Zero-length stream: %s, %0d rows overwritten",
+                     (cycles < 16) ? "done" : "no done", mismatch);
+        end
+    endtask
+
+    //-------------------------------------------------------------------------
+    // Main Test Sequence
+    //-------------------------------------------------------------------------
+    initial begin
+        $display("");
+        $display("=============================================================");
+        $display("      gemv_ctrl (K-tiled top_pe) Testbench");
+        $display("=============================================================");
+        $display("  SUBARRAY_ROWS: %0d", SUBARRAY_ROWS);
+        $display("  SUBARRAY_COLS: %0d", SUBARRAY_COLS);
+        $display("  NUM_TESTS:     %0d", NUM_TESTS);
+        $display("=============================================================");
+        $display("");
+
+        init_signals();
+
+        $display("--- Loading C Reference Data (variable-K packed) ---");
+        load_test_data();
+        $display("");
+
+        do_reset();
+
+        for (int t = 0; t < NUM_TESTS; t++)
+            run_test(t);
+        do_zero_stream_test(NUM_TESTS - 1);
+
+        $display("");
+        $display("=============================================================");
+        $display("                    TEST SUMMARY");
+        $display("=============================================================");
+        $display("  Total tests:  %0d", test_count);
+        $display("  Passed:       %0d", pass_count);
+        $display("  Failed:       %0d", fail_count);
+        $display("  K-tiles:      %0d", tile_count);
+        $display("  Load cycles:  %0d", load_cycles);
+        $display("=============================================================");
+
+        if (fail_count == 0) begin
+            $display("");
+            $display("  *** ALL TESTS PASSED ***");
+            $display("");
+        end
+
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Timeout Watchdog
+    //-------------------------------------------------------------------------
+    initial begin
+        #(CLK_PERIOD * 500000);
+        $display("");
+        $display("!!! SIMULATION TIMEOUT !!!");
+        $display("");
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Waveform Dump
+    //-------------------------------------------------------------------------
+    initial begin
+        $dumpfile("gemv_ctrl_tb.vcd");
+        $dumpvars(0, gemv_ctrl_tb);
+    end
+
+endmodule
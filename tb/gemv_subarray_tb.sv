@@ -3,6 +3,18 @@
 // Testbench: gemv_subarray_tb
 // Description: GeMV Sub-array verification with C reference comparison
 //              Loads test data via $readmemh and compares results
+//              Guard-bit test: accumulators sized for MAX_K, one tile held
+//              for MAX_K / SUBARRAY_COLS cycles (worst-case -128 * -128
+//              rows, acc_test_*.hex) must not wrap
+//              FP test: BF16 and FP16 GEMVs of FP_TEST_LINES lines through
+//              the FP MACs (fp_fmt), bit-exact with ref_gemm_fp
+//              (fp_test_*.hex)
+//              FP8 test: E4M3 and MX E5M2 GEMVs, block scales switched
+//              every MX_BLOCK / SUBARRAY_COLS lines, bit-exact with
+//              ref_gemm_fp8 (fp8_test_*.hex)
+//              DUT built with FANOUT_STAGES input registers replicated over
+//              FANOUT_GROUPS row groups (npu_pkg): every test sees the extra
+//              latency, the fixed waits allow for it
 //              For Vivado simulation
 //-----------------------------------------------------------------------------
 
@@ -18,6 +30,12 @@ module gemv_subarray_tb;
     parameter int SUBARRAY_COLS = 8;
     parameter int CLK_PERIOD    = 10;
     parameter int NUM_TESTS     = 20;  // seed=42 기준, C reference 재생성 시 업데이트 필요
+    parameter int MAX_K         = 512; // ACC_TEST_K in sw/ref/main.c (25-bit accumulators)
+    parameter int FP_TEST_LINES = 16;  // FP_TEST_LINES in sw/ref/main.c (K = 64)
+    parameter int FP8_TEST_LINES = 16; // FP8_TEST_LINES in sw/ref/main.c (K = 128)
+    parameter int FP8_TEST_KB   = FP8_TEST_LINES * SUBARRAY_COLS / 32;  // MX blocks
+    parameter int FANOUT_STAGES = 2;   // gemv input pipeline
+    parameter int FANOUT_GROUPS = 4;
 
     // Test data path (update this path for your environment)
     parameter string DATA_PATH = "/home/yc/yc_npu/sw/ref/hex_data/";
@@ -29,6 +47,10 @@ module gemv_subarray_tb;
     logic                      rst_n;
     logic                      enable;
     logic                      clear_acc;
+    logic [1:0]                fp_fmt;
+    logic                      fp8_e5m2;
+    logic [SUBARRAY_ROWS-1:0][7:0] mx_w_scale;
+    logic [7:0]                mx_x_scale;
     logic [SUBARRAY_COLS-1:0][INPUT_WIDTH-1:0]  input_vector;
     logic [SUBARRAY_ROWS-1:0][SUBARRAY_COLS-1:0][WEIGHT_WIDTH-1:0] weight_matrix;
     logic [SUBARRAY_ROWS-1:0][OUTPUT_WIDTH-1:0] output_vector;
@@ -40,6 +62,17 @@ module gemv_subarray_tb;
     logic [INPUT_WIDTH-1:0]  ref_input  [0:NUM_TESTS*SUBARRAY_COLS-1];
     logic [WEIGHT_WIDTH-1:0] ref_weight [0:NUM_TESTS*SUBARRAY_ROWS*SUBARRAY_COLS-1];
     logic [OUTPUT_WIDTH-1:0] ref_output [0:NUM_TESTS*SUBARRAY_ROWS-1];
+    logic [INPUT_WIDTH-1:0]  acc_input  [0:SUBARRAY_COLS-1];
+    logic [WEIGHT_WIDTH-1:0] acc_weight [0:SUBARRAY_ROWS*SUBARRAY_COLS-1];
+    logic [OUTPUT_WIDTH-1:0] acc_output [0:SUBARRAY_ROWS-1];
+    logic [INPUT_WIDTH-1:0]  fp_input   [0:2*FP_TEST_LINES*SUBARRAY_COLS-1];
+    logic [WEIGHT_WIDTH-1:0] fp_weight  [0:2*FP_TEST_LINES*SUBARRAY_ROWS*SUBARRAY_COLS-1];
+    logic [OUTPUT_WIDTH-1:0] fp_output  [0:2*SUBARRAY_ROWS-1];
+    logic [INPUT_WIDTH-1:0]  fp8_input  [0:2*FP8_TEST_LINES*SUBARRAY_COLS-1];
+    logic [WEIGHT_WIDTH-1:0] fp8_weight [0:2*FP8_TEST_LINES*SUBARRAY_ROWS*SUBARRAY_COLS-1];
+    logic [7:0]              fp8_wscale [0:2*SUBARRAY_ROWS*FP8_TEST_KB-1];
+    logic [7:0]              fp8_xscale [0:2*FP8_TEST_KB-1];
+    logic [OUTPUT_WIDTH-1:0] fp8_output [0:2*SUBARRAY_ROWS-1];
 
     //-------------------------------------------------------------------------
     // Test Variables
@@ -56,14 +89,24 @@ module gemv_subarray_tb;
         .WEIGHT_WIDTH  (WEIGHT_WIDTH),
         .OUTPUT_WIDTH  (OUTPUT_WIDTH),
         .SUBARRAY_ROWS (SUBARRAY_ROWS),
-        .SUBARRAY_COLS (SUBARRAY_COLS)
+        .SUBARRAY_COLS (SUBARRAY_COLS),
+        .MAX_K         (MAX_K),
+        .FP_EN         (1),
+        .FANOUT_STAGES (FANOUT_STAGES),
+        .FANOUT_GROUPS (FANOUT_GROUPS)
     ) dut (
         .clk           (clk),
         .rst_n         (rst_n),
         .enable        (enable),
         .clear_acc     (clear_acc),
+        .load_acc      (1'b0),
+        .fp_fmt        (fp_fmt),
+        .fp8_e5m2      (fp8_e5m2),
+        .mx_w_scale    (mx_w_scale),
+        .mx_x_scale    (mx_x_scale),
         .input_vector  (input_vector),
         .weight_matrix (weight_matrix),
+        .acc_in        ('0),
         .output_vector (output_vector),
         .valid_out     (valid_out)
     );
@@ -85,6 +128,10 @@ module gemv_subarray_tb;
         rst_n     = 0;
         enable    = 0;
         clear_acc = 0;
+        fp_fmt    = 2'd0;
+        fp8_e5m2  = 1'b0;
+        mx_w_scale = {SUBARRAY_ROWS{8'd127}};
+        mx_x_scale = 8'd127;
         input_vector  = '0;
         weight_matrix = '0;
         test_count = 0;
@@ -113,6 +160,169 @@ module gemv_subarray_tb;
 
         $display("  Loading: %sgemv_test_output.hex", DATA_PATH);
         $readmemh({DATA_PATH, "gemv_test_output.hex"}, ref_output);
+        $display("  Loading: %sacc_test_*.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "acc_test_input.hex"},   acc_input);
+        $readmemh({DATA_PATH, "acc_test_weight.hex"},  acc_weight);
+        $readmemh({DATA_PATH, "acc_test_output.hex"},  acc_output);
+        $display("  Loading: %sfp_test_*.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "fp_test_input.hex"},    fp_input);
+        $readmemh({DATA_PATH, "fp_test_weight.hex"},   fp_weight);
+        $readmemh({DATA_PATH, "fp_test_output.hex"},   fp_output);
+        $display("  Loading: %sfp8_test_*.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "fp8_test_input.hex"},   fp8_input);
+        $readmemh({DATA_PATH, "fp8_test_weight.hex"},  fp8_weight);
+        $readmemh({DATA_PATH, "fp8_test_wscale.hex"},  fp8_wscale);
+        $readmemh({DATA_PATH, "fp8_test_xscale.hex"},  fp8_xscale);
+        $readmemh({DATA_PATH, "fp8_test_output.hex"},  fp8_output);
+    endtask
+
+    //-------------------------------------------------------------------------
+    // Guard bits: the acc_test tile for MAX_K / SUBARRAY_COLS enable cycles
+    // (K = MAX_K), compared with the C reference
+    //-------------------------------------------------------------------------
+    task automatic do_acc_test();
+        int mismatch;
+
+        @(posedge clk);
+        for (int c = 0; c < SUBARRAY_COLS; c++)
+            input_vector[c] <= acc_input[c];
+        for (int r = 0; r < SUBARRAY_ROWS; r++)
+            for (int c = 0; c < SUBARRAY_COLS; c++)
+                weight_matrix[r][c] <= acc_weight[r * SUBARRAY_COLS + c];
+
+        @(posedge clk);
+        clear_acc <= 1;
+        @(posedge clk);
+        clear_acc <= 0;
+
+        enable <= 1;
+        repeat(MAX_K / SUBARRAY_COLS) @(posedge clk);
+        enable <= 0;
+        repeat(4 + FANOUT_STAGES) @(posedge clk);
+
+        test_count++;
+        mismatch = 0;
+        for (int r = 0; r < SUBARRAY_ROWS; r++) begin
+            if (output_vector[r] !== acc_output[r]) begin
+                if (mismatch < 4)
+                    $display("  Row [%0d]: RTL=%0d REF=%0d", r,
+                             $signed(output_vector[r]), $signed(acc_output[r]));
+                mismatch++;
+            end
+        end
+        if (mismatch == 0) begin
+            pass_count++;
+            $display("[PASS] K=%0d accumulation: row 0 = %0d, row 1 = %0d", MAX_K,
+                     $signed(output_vector[0]), $signed(output_vector[1]));
+        end else begin
+            fail_count++;
+            $display("[FAIL] K=%0d accumulation: %0d rows differ", MAX_K, mismatch);
+        end
+    endtask
+
+    //-------------------------------------------------------------------------
+    // FP GEMV: FP_TEST_LINES input/weight lines of test t (0 = BF16,
+    // 1 = FP16), one line per enable cycle, FP32 outputs compared bit-exact
+    //-------------------------------------------------------------------------
+    task automatic do_fp_test(int t);
+        int mismatch;
+        int line;
+
+        @(posedge clk);
+        fp_fmt    <= 2'(t + 1);
+        clear_acc <= 1;
+        @(posedge clk);
+        clear_acc <= 0;
+
+        for (int l = 0; l < FP_TEST_LINES; l++) begin
+            line = t * FP_TEST_LINES + l;
+            for (int c = 0; c < SUBARRAY_COLS; c++)
+                input_vector[c] <= fp_input[line * SUBARRAY_COLS + c];
+            for (int r = 0; r < SUBARRAY_ROWS; r++)
+                for (int c = 0; c < SUBARRAY_COLS; c++)
+                    weight_matrix[r][c] <= fp_weight[(line * SUBARRAY_ROWS + r) * SUBARRAY_COLS + c];
+            enable <= 1;
+            @(posedge clk);
+        end
+        enable <= 0;
+        repeat(4 + FANOUT_STAGES) @(posedge clk);
+
+        test_count++;
+        mismatch = 0;
+        for (int r = 0; r < SUBARRAY_ROWS; r++) begin
+            if (output_vector[r] !== fp_output[t * SUBARRAY_ROWS + r]) begin
+                if (mismatch < 4)
+                    $display("  Row [%0d]: RTL=%08h REF=%08h", r,
+                             output_vector[r], fp_output[t * SUBARRAY_ROWS + r]);
+                mismatch++;
+            end
+        end
+        if (mismatch == 0) begin
+            pass_count++;
+            $display("[PASS] %s GEMV K=%0d: row 0 = %08h", (t == 0) ? "BF16" : "FP16",
+                     FP_TEST_LINES * SUBARRAY_COLS / 2, output_vector[0]);
+        end else begin
+            fail_count++;
+            $display("[FAIL] %s GEMV: %0d rows differ", (t == 0) ? "BF16" : "FP16", mismatch);
+        end
+        fp_fmt <= 2'd0;
+    endtask
+
+    //-------------------------------------------------------------------------
+    // FP8 GEMV: test t (0 = E4M3 unscaled, 1 = E5M2 MX), one line of
+    // SUBARRAY_COLS elements per enable cycle, the block's scales with it
+    //-------------------------------------------------------------------------
+    task automatic do_fp8_test(int t);
+        int mismatch;
+        int line;
+        int blk;
+
+        @(posedge clk);
+        fp_fmt    <= 2'd3;
+        fp8_e5m2  <= (t == 1);
+        clear_acc <= 1;
+        @(posedge clk);
+        clear_acc <= 0;
+
+        for (int l = 0; l < FP8_TEST_LINES; l++) begin
+            line = t * FP8_TEST_LINES + l;
+            blk  = l * SUBARRAY_COLS / 32;
+            for (int c = 0; c < SUBARRAY_COLS; c++)
+                input_vector[c] <= fp8_input[line * SUBARRAY_COLS + c];
+            for (int r = 0; r < SUBARRAY_ROWS; r++) begin
+                for (int c = 0; c < SUBARRAY_COLS; c++)
+                    weight_matrix[r][c] <= fp8_weight[(line * SUBARRAY_ROWS + r) * SUBARRAY_COLS + c];
+                mx_w_scale[r] <= fp8_wscale[(t * SUBARRAY_ROWS + r) * FP8_TEST_KB + blk];
+            end
+            mx_x_scale <= fp8_xscale[t * FP8_TEST_KB + blk];
+            enable <= 1;
+            @(posedge clk);
+        end
+        enable <= 0;
+        repeat(4 + FANOUT_STAGES) @(posedge clk);
+
+        test_count++;
+        mismatch = 0;
+        for (int r = 0; r < SUBARRAY_ROWS; r++) begin
+            if (output_vector[r] !== fp8_output[t * SUBARRAY_ROWS + r]) begin
+                if (mismatch < 4)
+                    $display("  Row [%0d]: RTL=%08h REF=%08h", r,
+                             output_vector[r], fp8_output[t * SUBARRAY_ROWS + r]);
+                mismatch++;
+            end
+        end
+        if (mismatch == 0) begin
+            pass_count++;
+            $display("[PASS] %s GEMV K=%0d: row 0 = %08h", (t == 0) ? "E4M3" : "E5M2 MX",
+                     FP8_TEST_LINES * SUBARRAY_COLS, output_vector[0]);
+        end else begin
+            fail_count++;
+            $display("[FAIL] %s GEMV: %0d rows differ", (t == 0) ? "E4M3" : "E5M2 MX", mismatch);
+        end
+        fp_fmt     <= 2'd0;
+        fp8_e5m2   <= 1'b0;
+        mx_w_scale <= {SUBARRAY_ROWS{8'd127}};
+        mx_x_scale <= 8'd127;
     endtask
 
     //-------------------------------------------------------------------------
@@ -215,9 +425,11 @@ module gemv_subarray_tb;
         $display("  SUBARRAY_ROWS: %0d", SUBARRAY_ROWS);
         $display("  SUBARRAY_COLS: %0d", SUBARRAY_COLS);
         $display("  INPUT_WIDTH:   %0d", INPUT_WIDTH);
+        $display("  FANOUT:        %0d stages x %0d groups", FANOUT_STAGES, FANOUT_GROUPS);
         $display("  WEIGHT_WIDTH:  %0d", WEIGHT_WIDTH);
         $display("  OUTPUT_WIDTH:  %0d", OUTPUT_WIDTH);
         $display("  NUM_TESTS:     %0d", NUM_TESTS);
+        $display("  MAX_K:         %0d", MAX_K);
         $display("  DATA_PATH:     %s", DATA_PATH);
         $display("=============================================================");
         $display("");
@@ -243,6 +455,17 @@ module gemv_subarray_tb;
             check_result(i);
         end
 
+        $display("--- Guard Bits (MAX_K=%0d) ---", MAX_K);
+        do_acc_test();
+
+        $display("--- BF16 / FP16 MACs ---");
+        do_fp_test(0);
+        do_fp_test(1);
+
+        $display("--- FP8 / MX ---");
+        do_fp8_test(0);
+        do_fp8_test(1);
+
         //=====================================================================
         // Test Summary
         //=====================================================================
@@ -0,0 +1,281 @@
+`timescale 1ns/1ps
+//-----------------------------------------------------------------------------
+// Testbench: iommu_tlb_tb
+// Description: iommu_tlb verification with C reference comparison
+//              tlb_test_pt.hex is the page table (memory model with
+//              2-cycle read latency), tlb_test_iova.hex the request
+//              addresses (streaming, then a random 12-page working set,
+//              then two faults) and tlb_test_pa.hex the expected physical
+//              addresses (FFFFFFFF = fault)
+//              Reports TLB hit rate and translations per cycle per phase
+//-----------------------------------------------------------------------------
+
+module iommu_tlb_tb;
+
+    //-------------------------------------------------------------------------
+    // Parameters
+    //-------------------------------------------------------------------------
+    parameter int ADDR_WIDTH  = 32;
+    parameter int ENTRIES     = 16;    // TLB_TEST_ENTRIES in sw/ref/main.c
+    parameter int PAGE_SHIFT  = 12;
+    parameter int CLK_PERIOD  = 10;
+    parameter int PT_PAGES    = 64;    // TLB_PT_PAGES
+    parameter int NUM_STREAM  = 128;   // TLB_STREAM_REQS
+    parameter int NUM_REQS    = 256;   // TLB_NUM_REQS
+    parameter int PTW_LATENCY = 2;
+
+    parameter string DATA_PATH = "/home/yc/yc_npu/sw/ref/hex_data/";
+
+    localparam logic [ADDR_WIDTH-1:0] PT_BASE    = 32'h0001_0000;
+    localparam logic [31:0]           FAULT_ADDR = 32'hFFFF_FFFF;
+
+    //-------------------------------------------------------------------------
+    // DUT Signals
+    //-------------------------------------------------------------------------
+    logic                  clk;
+    logic                  rst_n;
+    logic                  flush;
+    logic [ADDR_WIDTH-1:0] req_iova;
+    logic                  req_valid;
+    logic                  req_ready;
+    logic [ADDR_WIDTH-1:0] rsp_addr;
+    logic                  rsp_fault;
+    logic                  rsp_valid;
+    logic [ADDR_WIDTH-1:0] ptw_addr;
+    logic                  ptw_req;
+    logic                  ptw_gnt;
+    logic [31:0]           ptw_data;
+    logic                  ptw_data_valid;
+    logic [31:0]           hit_count;
+    logic [31:0]           miss_count;
+
+    //-------------------------------------------------------------------------
+    // Reference Data Memory
+    //-------------------------------------------------------------------------
+    logic [31:0] ref_pt   [0:PT_PAGES-1];
+    logic [31:0] ref_iova [0:NUM_REQS-1];
+    logic [31:0] ref_pa   [0:NUM_REQS-1];
+
+    //-------------------------------------------------------------------------
+    // Test Variables
+    //-------------------------------------------------------------------------
+    int test_count;
+    int pass_count;
+    int fail_count;
+    int rsp_count;
+
+    //-------------------------------------------------------------------------
+    // DUT Instance
+    //-------------------------------------------------------------------------
+    iommu_tlb #(
+        .ADDR_WIDTH (ADDR_WIDTH),
+        .ENTRIES    (ENTRIES),
+        .PAGE_SHIFT (PAGE_SHIFT)
+    ) dut (
+        .clk            (clk),
+        .rst_n          (rst_n),
+        .enable         (1'b1),
+        .flush          (flush),
+        .pt_base        (PT_BASE),
+        .pt_pages       (ADDR_WIDTH'(PT_PAGES)),
+        .req_iova       (req_iova),
+        .req_valid      (req_valid),
+        .req_ready      (req_ready),
+        .rsp_addr       (rsp_addr),
+        .rsp_fault      (rsp_fault),
+        .rsp_valid      (rsp_valid),
+        .rsp_ready      (1'b1),
+        .ptw_addr       (ptw_addr),
+        .ptw_req        (ptw_req),
+        .ptw_gnt        (ptw_gnt),
+        .ptw_data       (ptw_data),
+        .ptw_data_valid (ptw_data_valid),
+        .hit_count      (hit_count),
+        .miss_count     (miss_count)
+    );
+
+    //-------------------------------------------------------------------------
+    // Clock Generation
+    //-------------------------------------------------------------------------
+    initial begin
+        clk = 0;
+        forever #(CLK_PERIOD/2) clk = ~clk;
+    end
+
+    //-------------------------------------------------------------------------
+    // Page Table Memory Model (always granted, PTW_LATENCY-cycle read data)
+    //-------------------------------------------------------------------------
+    logic [PTW_LATENCY-1:0] rd_pipe;
+    logic [31:0]            rd_data [PTW_LATENCY];
+
+    assign ptw_gnt        = ptw_req;
+    assign ptw_data_valid = rd_pipe[PTW_LATENCY-1];
+    assign ptw_data       = rd_data[PTW_LATENCY-1];
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rd_pipe <= '0;
+        end else begin
+            rd_pipe[0] <= ptw_req && ptw_gnt;
+            rd_data[0] <= ref_pt[(ptw_addr - PT_BASE) >> 2];
+            for (int i = 1; i < PTW_LATENCY; i++) begin
+                rd_pipe[i] <= rd_pipe[i-1];
+                rd_data[i] <= rd_data[i-1];
+            end
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Response Checker (responses return in request order)
+    //-------------------------------------------------------------------------
+    always @(posedge clk) begin
+        if (rst_n && rsp_valid) begin
+            logic [31:0] got;
+            got = rsp_fault ? FAULT_ADDR : rsp_addr;
+            test_count++;
+            if (got !== ref_pa[rsp_count]) begin
+                fail_count++;
+                $display("[FAIL] Req #%0d IOVA=0x%08h RTL=0x%08h REF=0x%08h",
+                         rsp_count, ref_iova[rsp_count], got, ref_pa[rsp_count]);
+            end else begin
+                pass_count++;
+            end
+            rsp_count++;
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Tasks
+    //-------------------------------------------------------------------------
+
+    task automatic init_signals();
+        rst_n      = 0;
+        flush      = 0;
+        req_iova   = '0;
+        req_valid  = 0;
+        test_count = 0;
+        pass_count = 0;
+        fail_count = 0;
+        rsp_count  = 0;
+    endtask
+
+    task automatic do_reset();
+        @(posedge clk);
+        rst_n <= 0;
+        repeat(5) @(posedge clk);
+        rst_n <= 1;
+        repeat(2) @(posedge clk);
+    endtask
+
+    task automatic load_test_data();
+        $display("  Loading: %stlb_test_pt.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "tlb_test_pt.hex"},   ref_pt);
+        $display("  Loading: %stlb_test_iova.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "tlb_test_iova.hex"}, ref_iova);
+        $display("  Loading: %stlb_test_pa.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "tlb_test_pa.hex"},   ref_pa);
+    endtask
+
+    // Issue requests [first, last) back to back, returns elapsed cycles
+    // (req_ready is sampled at the falling edge, the handshake completes on
+    // the following rising edge)
+    task automatic run_requests(int first, int last, output int cycles);
+        cycles = 0;
+        for (int i = first; i < last; i++) begin
+            req_iova  <= ref_iova[i];
+            req_valid <= 1;
+            @(negedge clk);
+            while (!req_ready) begin
+                @(negedge clk);
+                cycles++;
+            end
+            @(posedge clk);
+            cycles++;
+        end
+        req_valid <= 0;
+    endtask
+
+    //-------------------------------------------------------------------------
+    // Main Test Sequence
+    //-------------------------------------------------------------------------
+    initial begin
+        int stream_cycles, random_cycles;
+        int stream_hits, stream_misses;
+
+        $display("");
+        $display("=============================================================");
+        $display("      iommu_tlb Testbench");
+        $display("=============================================================");
+        $display("  ENTRIES:     %0d", ENTRIES);
+        $display("  PTW_LATENCY: %0d", PTW_LATENCY);
+        $display("  NUM_REQS:    %0d (%0d streaming)", NUM_REQS, NUM_STREAM);
+        $display("=============================================================");
+        $display("");
+
+        init_signals();
+
+        $display("--- Loading C Reference Data ---");
+        load_test_data();
+        $display("");
+
+        do_reset();
+
+        run_requests(0, NUM_STREAM, stream_cycles);
+        stream_hits   = hit_count;
+        stream_misses = miss_count;
+        run_requests(NUM_STREAM, NUM_REQS, random_cycles);
+        repeat(4) @(posedge clk);
+
+        $display("  Streaming: %0d hits / %0d misses (%0.1f%%), %0.2f translations/cycle",
+                 stream_hits, stream_misses,
+                 100.0 * stream_hits / (stream_hits + stream_misses),
+                 real'(NUM_STREAM) / stream_cycles);
+        $display("  Random:    %0d hits / %0d misses (%0.1f%%), %0.2f translations/cycle",
+                 hit_count - stream_hits, miss_count - stream_misses,
+                 100.0 * (hit_count - stream_hits) /
+                         (hit_count - stream_hits + miss_count - stream_misses),
+                 real'(NUM_REQS - NUM_STREAM) / random_cycles);
+
+        if (rsp_count != NUM_REQS) begin
+            fail_count++;
+            $display("[FAIL] %0d responses for %0d requests", rsp_count, NUM_REQS);
+        end
+
+        $display("");
+        $display("=============================================================");
+        $display("                    TEST SUMMARY");
+        $display("=============================================================");
+        $display("  Total tests:  %0d", test_count);
+        $display("  Passed:       %0d", pass_count);
+        $display("  Failed:       %0d", fail_count);
+        $display("=============================================================");
+
+        if (fail_count == 0) begin
+            $display("");
+            $display("  *** ALL TESTS PASSED ***");
+            $display("");
+        end
+
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Timeout Watchdog
+    //-------------------------------------------------------------------------
+    initial begin
+        #(CLK_PERIOD * 10000);
+        $display("");
+        $display("!!! SIMULATION TIMEOUT !!!");
+        $display("");
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Waveform Dump
+    //-------------------------------------------------------------------------
+    initial begin
+        $dumpfile("iommu_tlb_tb.vcd");
+        $dumpvars(0, iommu_tlb_tb);
+    end
+
+endmodule
@@ -0,0 +1,269 @@
+`timescale 1ns/1ps
+//-----------------------------------------------------------------------------
+// Testbench: kv_block_walker_tb
+// Description: kv_block_walker verification with C reference comparison
+//              kv_walker_test_table.hex is the block table (memory model
+//              with 2-cycle read latency), kv_walker_test_rows.hex the
+//              logical rows (sequential walk, then random), and
+//              kv_walker_test_addr.hex the expected physical addresses
+//              Requests are issued back to back; the sequential part also
+//              reports rows per cycle (lookahead hides the table reads)
+//-----------------------------------------------------------------------------
+
+module kv_block_walker_tb;
+
+    //-------------------------------------------------------------------------
+    // Parameters
+    //-------------------------------------------------------------------------
+    parameter int ADDR_WIDTH  = 32;
+    parameter int ROW_WIDTH   = 16;
+    parameter int CLK_PERIOD  = 10;
+    parameter int BLOCK_SHIFT = 3;     // KV_WALK_SHIFT in sw/ref/main.c
+    parameter int ROW_BYTES   = 128;   // KV_WALK_ROW_BYTES
+    parameter int NUM_BLOCKS  = 16;    // KV_WALK_BLOCKS
+    parameter int NUM_SEQ     = 64;    // KV_WALK_SEQ
+    parameter int NUM_REQS    = 96;    // KV_WALK_REQS
+    parameter int TBL_LATENCY = 2;
+
+    parameter string DATA_PATH = "/home/yc/yc_npu/sw/ref/hex_data/";
+
+    localparam logic [ADDR_WIDTH-1:0] TABLE_BASE = 32'h0000_0100;
+
+    //-------------------------------------------------------------------------
+    // DUT Signals
+    //-------------------------------------------------------------------------
+    logic                  clk;
+    logic                  rst_n;
+    logic                  flush;
+    logic [ROW_WIDTH-1:0]  req_row;
+    logic                  req_valid;
+    logic                  req_ready;
+    logic [ADDR_WIDTH-1:0] rsp_addr;
+    logic                  rsp_valid;
+    logic [ADDR_WIDTH-1:0] tbl_addr;
+    logic                  tbl_req;
+    logic                  tbl_gnt;
+    logic [31:0]           tbl_data;
+    logic                  tbl_data_valid;
+
+    //-------------------------------------------------------------------------
+    // Reference Data Memory
+    //-------------------------------------------------------------------------
+    logic [31:0] ref_table [0:NUM_BLOCKS];
+    logic [31:0] ref_rows  [0:NUM_REQS-1];
+    logic [31:0] ref_addr  [0:NUM_REQS-1];
+
+    //-------------------------------------------------------------------------
+    // Test Variables
+    //-------------------------------------------------------------------------
+    int test_count;
+    int pass_count;
+    int fail_count;
+    int rsp_count;
+    int tbl_reads;
+
+    //-------------------------------------------------------------------------
+    // DUT Instance
+    //-------------------------------------------------------------------------
+    kv_block_walker #(
+        .ADDR_WIDTH (ADDR_WIDTH),
+        .ROW_WIDTH  (ROW_WIDTH)
+    ) dut (
+        .clk            (clk),
+        .rst_n          (rst_n),
+        .flush          (flush),
+        .table_base     (TABLE_BASE),
+        .block_shift    (5'(BLOCK_SHIFT)),
+        .row_bytes      (16'(ROW_BYTES)),
+        .req_row        (req_row),
+        .req_valid      (req_valid),
+        .req_ready      (req_ready),
+        .rsp_addr       (rsp_addr),
+        .rsp_valid      (rsp_valid),
+        .rsp_ready      (1'b1),
+        .tbl_addr       (tbl_addr),
+        .tbl_req        (tbl_req),
+        .tbl_gnt        (tbl_gnt),
+        .tbl_data       (tbl_data),
+        .tbl_data_valid (tbl_data_valid)
+    );
+
+    //-------------------------------------------------------------------------
+    // Clock Generation
+    //-------------------------------------------------------------------------
+    initial begin
+        clk = 0;
+        forever #(CLK_PERIOD/2) clk = ~clk;
+    end
+
+    //-------------------------------------------------------------------------
+    // Table Memory Model (always granted, TBL_LATENCY-cycle read data)
+    //-------------------------------------------------------------------------
+    logic [TBL_LATENCY-1:0] rd_pipe;
+    logic [31:0]            rd_data [TBL_LATENCY];
+
+    assign tbl_gnt        = tbl_req;
+    assign tbl_data_valid = rd_pipe[TBL_LATENCY-1];
+    assign tbl_data       = rd_data[TBL_LATENCY-1];
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rd_pipe   <= '0;
+            tbl_reads <= 0;
+        end else begin
+            rd_pipe[0] <= tbl_req && tbl_gnt;
+            rd_data[0] <= ref_table[(tbl_addr - TABLE_BASE) >> 2];
+            for (int i = 1; i < TBL_LATENCY; i++) begin
+                rd_pipe[i] <= rd_pipe[i-1];
+                rd_data[i] <= rd_data[i-1];
+            end
+            if (tbl_req && tbl_gnt)
+                tbl_reads <= tbl_reads + 1;
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Response Checker (responses return in request order)
+    //-------------------------------------------------------------------------
+    always @(posedge clk) begin
+        if (rst_n && rsp_valid) begin
+            test_count++;
+            if (rsp_addr !== ref_addr[rsp_count]) begin
+                fail_count++;
+                $display("[FAIL] Req #%0d row=%0d RTL=0x%08h REF=0x%08h",
+                         rsp_count, ref_rows[rsp_count], rsp_addr, ref_addr[rsp_count]);
+            end else begin
+                pass_count++;
+            end
+            rsp_count++;
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Tasks
+    //-------------------------------------------------------------------------
+
+    task automatic init_signals();
+        rst_n      = 0;
+        flush      = 0;
+        req_row    = '0;
+        req_valid  = 0;
+        test_count = 0;
+        pass_count = 0;
+        fail_count = 0;
+        rsp_count  = 0;
+    endtask
+
+    task automatic do_reset();
+        @(posedge clk);
+        rst_n <= 0;
+        repeat(5) @(posedge clk);
+        rst_n <= 1;
+        repeat(2) @(posedge clk);
+    endtask
+
+    task automatic load_test_data();
+        $display("  Loading: %skv_walker_test_table.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "kv_walker_test_table.hex"}, ref_table);
+        $display("  Loading: %skv_walker_test_rows.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "kv_walker_test_rows.hex"},  ref_rows);
+        $display("  Loading: %skv_walker_test_addr.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "kv_walker_test_addr.hex"},  ref_addr);
+    endtask
+
+    // Issue rows [first, last) back to back, returns elapsed cycles
+    // (req_ready is sampled at the falling edge, the handshake completes on
+    // the following rising edge)
+    task automatic run_requests(int first, int last, output int cycles);
+        cycles = 0;
+        for (int i = first; i < last; i++) begin
+            req_row   <= ROW_WIDTH'(ref_rows[i]);
+            req_valid <= 1;
+            @(negedge clk);
+            while (!req_ready) begin
+                @(negedge clk);
+                cycles++;
+            end
+            @(posedge clk);
+            cycles++;
+        end
+        req_valid <= 0;
+    endtask
+
+    //-------------------------------------------------------------------------
+    // Main Test Sequence
+    //-------------------------------------------------------------------------
+    initial begin
+        int seq_cycles, rnd_cycles, seq_reads;
+
+        $display("");
+        $display("=============================================================");
+        $display("      kv_block_walker Testbench");
+        $display("=============================================================");
+        $display("  BLOCK_SHIFT: %0d (%0d rows/block)", BLOCK_SHIFT, 1 << BLOCK_SHIFT);
+        $display("  ROW_BYTES:   %0d", ROW_BYTES);
+        $display("  NUM_REQS:    %0d (%0d sequential)", NUM_REQS, NUM_SEQ);
+        $display("=============================================================");
+        $display("");
+
+        init_signals();
+
+        $display("--- Loading C Reference Data ---");
+        load_test_data();
+        $display("");
+
+        do_reset();
+
+        run_requests(0, NUM_SEQ, seq_cycles);
+        seq_reads = tbl_reads;
+        run_requests(NUM_SEQ, NUM_REQS, rnd_cycles);
+        repeat(4) @(posedge clk);
+
+        $display("  Sequential walk: %0d rows in %0d cycles, %0d table reads",
+                 NUM_SEQ, seq_cycles, seq_reads);
+        $display("  Random rows:     %0d rows in %0d cycles, %0d table reads",
+                 NUM_REQS - NUM_SEQ, rnd_cycles, tbl_reads - seq_reads);
+
+        if (rsp_count != NUM_REQS) begin
+            fail_count++;
+            $display("[FAIL] %0d responses for %0d requests", rsp_count, NUM_REQS);
+        end
+
+        $display("");
+        $display("=============================================================");
+        $display("                    TEST SUMMARY");
+        $display("=============================================================");
+        $display("  Total tests:  %0d", test_count);
+        $display("  Passed:       %0d", pass_count);
+        $display("  Failed:       %0d", fail_count);
+        $display("=============================================================");
+
+        if (fail_count == 0) begin
+            $display("");
+            $display("  *** ALL TESTS PASSED ***");
+            $display("");
+        end
+
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Timeout Watchdog
+    //-------------------------------------------------------------------------
+    initial begin
+        #(CLK_PERIOD * 10000);
+        $display("");
+        $display("!!! SIMULATION TIMEOUT !!!");
+        $display("");
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Waveform Dump
+    //-------------------------------------------------------------------------
+    initial begin
+        $dumpfile("kv_block_walker_tb.vcd");
+        $dumpvars(0, kv_block_walker_tb);
+    end
+
+endmodule
@@ -59,6 +59,8 @@ module mac_unit_tb;
         .rst_n      (rst_n),
         .enable     (enable),
         .clear_acc  (clear_acc),
+        .load_acc   (1'b0),
+        .acc_in     ('0),
         .data_in    (data_in),
         .weight_in  (weight_in),
         .data_out   (data_out),
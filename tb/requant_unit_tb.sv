@@ -0,0 +1,215 @@
+`timescale 1ns/1ps
+//-----------------------------------------------------------------------------
+// Testbench: requant_unit_tb
+// Description: requant_unit verification with C reference comparison
+//              requant_test_cfg.hex holds one CONFIG word per test
+//              (npu_pkg::config_t: scale[31:16], shift[12:8], relu[2])
+//              One vector per test; the result is checked when it leaves
+//              the 2-stage pipeline (config is static during a job)
+//-----------------------------------------------------------------------------
+
+module requant_unit_tb;
+
+    //-------------------------------------------------------------------------
+    // Parameters
+    //-------------------------------------------------------------------------
+    parameter int NUM_LANES  = 32;   // SUBARRAY_ROWS
+    parameter int ACC_WIDTH  = 32;
+    parameter int OUT_WIDTH  = 8;
+    parameter int CLK_PERIOD = 10;
+    parameter int NUM_TESTS  = 16;   // REQUANT_NUM_TESTS in sw/ref/main.c
+
+    parameter string DATA_PATH = "/home/yc/yc_npu/sw/ref/hex_data/";
+
+    //-------------------------------------------------------------------------
+    // DUT Signals
+    //-------------------------------------------------------------------------
+    logic                                clk;
+    logic                                rst_n;
+    logic signed [15:0]                  scale;
+    logic [4:0]                          shift;
+    logic                                relu;
+    logic                                valid_in;
+    logic [NUM_LANES-1:0][ACC_WIDTH-1:0] data_in;
+    logic                                valid_out;
+    logic [NUM_LANES-1:0][OUT_WIDTH-1:0] data_out;
+
+    //-------------------------------------------------------------------------
+    // Reference Data Memory
+    //-------------------------------------------------------------------------
+    logic [ACC_WIDTH-1:0] ref_input  [0:NUM_TESTS*NUM_LANES-1];
+    logic [OUT_WIDTH-1:0] ref_output [0:NUM_TESTS*NUM_LANES-1];
+    logic [31:0]          ref_cfg    [0:NUM_TESTS-1];
+
+    //-------------------------------------------------------------------------
+    // Test Variables
+    //-------------------------------------------------------------------------
+    int test_count;
+    int pass_count;
+    int fail_count;
+
+    //-------------------------------------------------------------------------
+    // DUT Instance
+    //-------------------------------------------------------------------------
+    requant_unit #(
+        .NUM_LANES (NUM_LANES),
+        .ACC_WIDTH (ACC_WIDTH),
+        .OUT_WIDTH (OUT_WIDTH)
+    ) dut (
+        .clk       (clk),
+        .rst_n     (rst_n),
+        .scale     (scale),
+        .shift     (shift),
+        .relu      (relu),
+        .valid_in  (valid_in),
+        .data_in   (data_in),
+        .valid_out (valid_out),
+        .data_out  (data_out)
+    );
+
+    //-------------------------------------------------------------------------
+    // Clock Generation
+    //-------------------------------------------------------------------------
+    initial begin
+        clk = 0;
+        forever #(CLK_PERIOD/2) clk = ~clk;
+    end
+
+    //-------------------------------------------------------------------------
+    // Tasks
+    //-------------------------------------------------------------------------
+
+    task automatic init_signals();
+        rst_n      = 0;
+        scale      = '0;
+        shift      = '0;
+        relu       = 0;
+        valid_in   = 0;
+        data_in    = '0;
+        test_count = 0;
+        pass_count = 0;
+        fail_count = 0;
+    endtask
+
+    task automatic do_reset();
+        @(posedge clk);
+        rst_n <= 0;
+        repeat(5) @(posedge clk);
+        rst_n <= 1;
+        repeat(2) @(posedge clk);
+    endtask
+
+    task automatic load_test_data();
+        $display("  Loading: %srequant_test_input.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "requant_test_input.hex"},  ref_input);
+        $display("  Loading: %srequant_test_output.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "requant_test_output.hex"}, ref_output);
+        $display("  Loading: %srequant_test_cfg.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "requant_test_cfg.hex"},    ref_cfg);
+    endtask
+
+    // Config is sampled in both pipeline stages, so each test holds it for
+    // the full 2-cycle latency before the next vector is issued
+    task automatic run_test(int t);
+        int mismatch_found;
+
+        mismatch_found = 0;
+        test_count++;
+
+        @(posedge clk);
+        scale    <= ref_cfg[t][31:16];
+        shift    <= ref_cfg[t][12:8];
+        relu     <= ref_cfg[t][2];
+        valid_in <= 1;
+        for (int i = 0; i < NUM_LANES; i++)
+            data_in[i] <= ref_input[t*NUM_LANES + i];
+
+        @(posedge clk);
+        valid_in <= 0;
+
+        wait(valid_out);
+        @(negedge clk);
+
+        for (int i = 0; i < NUM_LANES; i++) begin
+            if (data_out[i] !== ref_output[t*NUM_LANES + i]) begin
+                if (!mismatch_found) begin
+                    fail_count++;
+                    mismatch_found = 1;
+                    $display("[FAIL] Test #%0d (scale=%0d, shift=%0d, relu=%0d)",
+                             t, $signed(ref_cfg[t][31:16]), ref_cfg[t][12:8], ref_cfg[t][2]);
+                end
+                $display("  [%2d] IN=%0d RTL=%0d REF=%0d", i,
+                         $signed(ref_input[t*NUM_LANES + i]),
+                         $signed(data_out[i]), $signed(ref_output[t*NUM_LANES + i]));
+            end
+        end
+
+        if (!mismatch_found) begin
+            pass_count++;
+            $display("[PASS] Test #%0d (scale=%0d, shift=%0d, relu=%0d)",
+                     t, $signed(ref_cfg[t][31:16]), ref_cfg[t][12:8], ref_cfg[t][2]);
+        end
+    endtask
+
+    //-------------------------------------------------------------------------
+    // Main Test Sequence
+    //-------------------------------------------------------------------------
+    initial begin
+        $display("");
+        $display("=============================================================");
+        $display("      requant_unit Testbench");
+        $display("=============================================================");
+        $display("  NUM_LANES: %0d", NUM_LANES);
+        $display("  NUM_TESTS: %0d", NUM_TESTS);
+        $display("=============================================================");
+        $display("");
+
+        init_signals();
+
+        $display("--- Loading C Reference Data ---");
+        load_test_data();
+        $display("");
+
+        do_reset();
+
+        for (int t = 0; t < NUM_TESTS; t++)
+            run_test(t);
+
+        $display("");
+        $display("=============================================================");
+        $display("                    TEST SUMMARY");
+        $display("=============================================================");
+        $display("  Total tests:  %0d", test_count);
+        $display("  Passed:       %0d", pass_count);
+        $display("  Failed:       %0d", fail_count);
+        $display("=============================================================");
+
+        if (fail_count == 0) begin
+            $display("");
+            $display("  *** ALL TESTS PASSED ***");
+            $display("");
+        end
+
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Timeout Watchdog
+    //-------------------------------------------------------------------------
+    initial begin
+        #(CLK_PERIOD * 10000);
+        $display("");
+        $display("!!! SIMULATION TIMEOUT !!!");
+        $display("");
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Waveform Dump
+    //-------------------------------------------------------------------------
+    initial begin
+        $dumpfile("requant_unit_tb.vcd");
+        $dumpvars(0, requant_unit_tb);
+    end
+
+endmodule
@@ -0,0 +1,231 @@
+`timescale 1ns/1ps
+//-----------------------------------------------------------------------------
+// Testbench: rope_unit_tb
+// Description: rope_unit verification with C reference comparison
+//              rope_test_cs.hex holds NUM_LANES/2 {sin, cos} table entries
+//              per test (one RoPE table row slice at a random position);
+//              test 0 is position 0 (identity), lanes 0..3 of every vector
+//              are INT32 extremes (saturation)
+//              Vectors are issued back to back with the rotation enabled,
+//              then once more with enable = 0 (pass-through)
+//-----------------------------------------------------------------------------
+
+module rope_unit_tb;
+
+    //-------------------------------------------------------------------------
+    // Parameters
+    //-------------------------------------------------------------------------
+    parameter int NUM_LANES  = 32;   // SUBARRAY_ROWS
+    parameter int ACC_WIDTH  = 32;
+    parameter int CS_WIDTH   = 16;
+    parameter int FRAC_BITS  = 14;   // ROPE_FRAC_BITS
+    parameter int CLK_PERIOD = 10;
+    parameter int NUM_TESTS  = 16;   // ROPE_NUM_TESTS in sw/ref/main.c
+
+    parameter string DATA_PATH = "/home/yc/yc_npu/sw/ref/hex_data/";
+
+    //-------------------------------------------------------------------------
+    // DUT Signals
+    //-------------------------------------------------------------------------
+    logic                                  clk;
+    logic                                  rst_n;
+    logic                                  enable;
+    logic                                  valid_in;
+    logic [NUM_LANES-1:0][ACC_WIDTH-1:0]   data_in;
+    logic [NUM_LANES/2-1:0][2*CS_WIDTH-1:0] cs_in;
+    logic                                  valid_out;
+    logic [NUM_LANES-1:0][ACC_WIDTH-1:0]   data_out;
+
+    //-------------------------------------------------------------------------
+    // Reference Data Memory
+    //-------------------------------------------------------------------------
+    logic [ACC_WIDTH-1:0]  ref_input  [0:NUM_TESTS*NUM_LANES-1];
+    logic [ACC_WIDTH-1:0]  ref_output [0:NUM_TESTS*NUM_LANES-1];
+    logic [31:0]           ref_cs     [0:NUM_TESTS*NUM_LANES/2-1];
+
+    //-------------------------------------------------------------------------
+    // Test Variables
+    //-------------------------------------------------------------------------
+    int test_count;
+    int pass_count;
+    int fail_count;
+    int out_count;
+    logic check_bypass;
+
+    //-------------------------------------------------------------------------
+    // DUT Instance
+    //-------------------------------------------------------------------------
+    rope_unit #(
+        .NUM_LANES (NUM_LANES),
+        .ACC_WIDTH (ACC_WIDTH),
+        .CS_WIDTH  (CS_WIDTH),
+        .FRAC_BITS (FRAC_BITS)
+    ) dut (
+        .clk       (clk),
+        .rst_n     (rst_n),
+        .enable    (enable),
+        .valid_in  (valid_in),
+        .data_in   (data_in),
+        .cs_in     (cs_in),
+        .valid_out (valid_out),
+        .data_out  (data_out)
+    );
+
+    //-------------------------------------------------------------------------
+    // Clock Generation
+    //-------------------------------------------------------------------------
+    initial begin
+        clk = 0;
+        forever #(CLK_PERIOD/2) clk = ~clk;
+    end
+
+    //-------------------------------------------------------------------------
+    // Output Checker (results in issue order)
+    //-------------------------------------------------------------------------
+    always @(posedge clk) begin
+        if (rst_n && valid_out) begin
+            int t;
+            int mismatch_found;
+            logic [ACC_WIDTH-1:0] expected;
+
+            t = out_count % NUM_TESTS;
+            mismatch_found = 0;
+            test_count++;
+
+            for (int i = 0; i < NUM_LANES; i++) begin
+                expected = check_bypass ? ref_input[t*NUM_LANES + i]
+                                        : ref_output[t*NUM_LANES + i];
+                if (data_out[i] !== expected) begin
+                    if (!mismatch_found) begin
+                        fail_count++;
+                        mismatch_found = 1;
+                        $display("[FAIL] Test #%0d (%s)", t, check_bypass ? "bypass" : "rotate");
+                    end
+                    $display("  [%2d] IN=%0d RTL=%0d REF=%0d", i,
+                             $signed(ref_input[t*NUM_LANES + i]),
+                             $signed(data_out[i]), $signed(expected));
+                end
+            end
+
+            if (!mismatch_found) begin
+                pass_count++;
+                $display("[PASS] Test #%0d (%s)", t, check_bypass ? "bypass" : "rotate");
+            end
+            out_count++;
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Tasks
+    //-------------------------------------------------------------------------
+
+    task automatic init_signals();
+        rst_n        = 0;
+        enable       = 0;
+        valid_in     = 0;
+        data_in      = '0;
+        cs_in        = '0;
+        test_count   = 0;
+        pass_count   = 0;
+        fail_count   = 0;
+        out_count    = 0;
+        check_bypass = 0;
+    endtask
+
+    task automatic do_reset();
+        @(posedge clk);
+        rst_n <= 0;
+        repeat(5) @(posedge clk);
+        rst_n <= 1;
+        repeat(2) @(posedge clk);
+    endtask
+
+    task automatic load_test_data();
+        $display("  Loading: %srope_test_input.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "rope_test_input.hex"},  ref_input);
+        $display("  Loading: %srope_test_cs.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "rope_test_cs.hex"},     ref_cs);
+        $display("  Loading: %srope_test_output.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "rope_test_output.hex"}, ref_output);
+    endtask
+
+    // Issue all vectors back to back (enable is captured with the data, so
+    // it may change between vectors), then wait for the pipeline to drain
+    task automatic run_pass(logic en);
+        for (int t = 0; t < NUM_TESTS; t++) begin
+            @(posedge clk);
+            enable   <= en;
+            valid_in <= 1;
+            for (int i = 0; i < NUM_LANES; i++)
+                data_in[i] <= ref_input[t*NUM_LANES + i];
+            for (int j = 0; j < NUM_LANES/2; j++)
+                cs_in[j] <= ref_cs[t*NUM_LANES/2 + j];
+        end
+        @(posedge clk);
+        valid_in <= 0;
+        repeat(4) @(posedge clk);
+    endtask
+
+    //-------------------------------------------------------------------------
+    // Main Test Sequence
+    //-------------------------------------------------------------------------
+    initial begin
+        $display("");
+        $display("=============================================================");
+        $display("      rope_unit Testbench");
+        $display("=============================================================");
+        $display("  NUM_LANES: %0d", NUM_LANES);
+        $display("  NUM_TESTS: %0d", NUM_TESTS);
+        $display("=============================================================");
+        $display("");
+
+        init_signals();
+
+        $display("--- Loading C Reference Data ---");
+        load_test_data();
+        $display("");
+
+        do_reset();
+
+        run_pass(1'b1);
+        check_bypass = 1;
+        run_pass(1'b0);
+
+        $display("");
+        $display("=============================================================");
+        $display("                    TEST SUMMARY");
+        $display("=============================================================");
+        $display("  Total tests:  %0d", test_count);
+        $display("  Passed:       %0d", pass_count);
+        $display("  Failed:       %0d", fail_count);
+        $display("=============================================================");
+
+        if (fail_count == 0) begin
+            $display("");
+            $display("  *** ALL TESTS PASSED ***");
+            $display("");
+        end
+
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Timeout Watchdog
+    //-------------------------------------------------------------------------
+    initial begin
+        #(CLK_PERIOD * 10000);
+        $display("");
+        $display("!!! SIMULATION TIMEOUT !!!");
+        $display("");
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Waveform Dump
+    //-------------------------------------------------------------------------
+    initial begin
+        $dumpfile("rope_unit_tb.vcd");
+        $dumpvars(0, rope_unit_tb);
+    end
+
+endmodule
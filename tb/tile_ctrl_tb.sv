@@ -0,0 +1,512 @@
+`timescale 1ns/1ps
+//-----------------------------------------------------------------------------
+// Testbench: tile_ctrl_tb
+// Description: Tile-boundary preemption of a K-tiled GEMM on one PE
+//              (tile_ctrl + top_pe) with C reference comparison
+//              preempt_test_weight.hex W[M][K], preempt_test_input.hex
+//              X[K][N], preempt_test_output.hex Y[M][N]
+//              1. Plain run: Y and job cycles
+//              2. For every preempt offset 0..NUM_OFFSETS-1 (cycles after
+//                 start): preempt, save the context, run a one-tile
+//                 high-priority job (overwrites buffers and accumulators),
+//                 resume from the context; Y must match and the latency
+//                 (preempt → preempted) is recorded; the worst case is
+//                 reported against the bound fetch + tile + store + save
+//              DMA model: fixed FETCH/STORE/SAVE cycles per transfer
+//-----------------------------------------------------------------------------
+
+module tile_ctrl_tb;
+
+    //-------------------------------------------------------------------------
+    // Parameters
+    //-------------------------------------------------------------------------
+    parameter int INPUT_WIDTH   = 8;
+    parameter int WEIGHT_WIDTH  = 8;
+    parameter int OUTPUT_WIDTH  = 32;
+    parameter int SUBARRAY_ROWS = 32;
+    parameter int SUBARRAY_COLS = 8;
+    parameter int BUF_DEPTH     = 4;
+    parameter int IDX_WIDTH     = 16;
+    parameter int CLK_PERIOD    = 10;
+    parameter int DIM_M         = 64;    // PREEMPT_M in sw/ref/main.c
+    parameter int DIM_K         = 64;    // PREEMPT_K
+    parameter int DIM_N         = 4;     // PREEMPT_N
+    parameter int FETCH_CYCLES  = 4;     // Weight + input tile transfer
+    parameter int STORE_CYCLES  = 4;     // Output line store
+    parameter int SAVE_CYCLES   = 6;     // Context (indices + line) store
+    parameter int NUM_OFFSETS   = 64;
+
+    parameter string DATA_PATH = "/home/yc/yc_npu/sw/ref/hex_data/";
+
+    localparam int WEIGHT_BUF_WIDTH = SUBARRAY_ROWS * SUBARRAY_COLS * WEIGHT_WIDTH;
+    localparam int INPUT_BUF_WIDTH  = SUBARRAY_COLS * INPUT_WIDTH;
+    localparam int OUTPUT_BUF_WIDTH = SUBARRAY_ROWS * OUTPUT_WIDTH;
+    localparam int M_TILES          = DIM_M / SUBARRAY_ROWS;
+    localparam int K_TILES          = DIM_K / SUBARRAY_COLS;
+
+    //-------------------------------------------------------------------------
+    // DUT Signals
+    //-------------------------------------------------------------------------
+    logic clk;
+    logic rst_n;
+
+    // tile_ctrl
+    logic                 start;
+    logic                 resume;
+    logic                 preempt;
+    logic [IDX_WIDTH-1:0] num_m_tiles, num_n, num_k_tiles;
+    logic [IDX_WIDTH-1:0] resume_m, resume_n, resume_k;
+    logic                 tile_req;
+    logic [IDX_WIDTH-1:0] tile_m, tile_n, tile_k;
+    logic                 tile_restore;
+    logic                 tile_ack;
+    logic                 pe_start, pe_clear_acc, pe_restore_acc, pe_done;
+    logic                 store_req, store_ack;
+    logic                 ctx_save_req;
+    logic [IDX_WIDTH-1:0] ctx_m, ctx_n, ctx_k;
+    logic                 ctx_acc;
+    logic                 ctx_save_ack;
+    logic                 busy, done, preempted;
+
+    // top_pe buffers
+    logic [$clog2(BUF_DEPTH)-1:0] wbuf_wr_addr;
+    logic [WEIGHT_BUF_WIDTH-1:0]  wbuf_wr_data;
+    logic                         wbuf_wr_en;
+    logic [$clog2(BUF_DEPTH)-1:0] ibuf_wr_addr;
+    logic [INPUT_BUF_WIDTH-1:0]   ibuf_wr_data;
+    logic                         ibuf_wr_en;
+    logic [$clog2(BUF_DEPTH)-1:0] obuf_rd_addr;
+    logic                         obuf_rd_en;
+    logic [OUTPUT_BUF_WIDTH-1:0]  obuf_rd_data;
+    logic [OUTPUT_BUF_WIDTH-1:0]  restore_data;
+
+    //-------------------------------------------------------------------------
+    // Reference Data Memory
+    //-------------------------------------------------------------------------
+    logic [7:0]  ref_weight [0:DIM_M*DIM_K-1];
+    logic [7:0]  ref_input  [0:DIM_K*DIM_N-1];
+    logic [31:0] ref_output [0:DIM_M*DIM_N-1];
+    logic [31:0] y_out      [0:DIM_M*DIM_N-1];   // Stored by the DMA model
+
+    // Saved context
+    logic [IDX_WIDTH-1:0]        saved_m, saved_n, saved_k;
+    logic [OUTPUT_BUF_WIDTH-1:0] saved_line;
+    logic                        hi_job;          // DMA serves the high-priority job
+
+    //-------------------------------------------------------------------------
+    // Test Variables
+    //-------------------------------------------------------------------------
+    int test_count;
+    int pass_count;
+    int fail_count;
+
+    //-------------------------------------------------------------------------
+    // DUT Instances
+    //-------------------------------------------------------------------------
+    tile_ctrl #(
+        .IDX_WIDTH (IDX_WIDTH)
+    ) u_tile_ctrl (
+        .clk            (clk),
+        .rst_n          (rst_n),
+        .start          (start),
+        .resume         (resume),
+        .preempt        (preempt),
+        .num_m_tiles    (num_m_tiles),
+        .num_n          (num_n),
+        .num_k_tiles    (num_k_tiles),
+        .resume_m       (resume_m),
+        .resume_n       (resume_n),
+        .resume_k       (resume_k),
+        .tile_req       (tile_req),
+        .tile_m         (tile_m),
+        .tile_n         (tile_n),
+        .tile_k         (tile_k),
+        .tile_restore   (tile_restore),
+        .tile_ack       (tile_ack),
+        .pe_start       (pe_start),
+        .pe_clear_acc   (pe_clear_acc),
+        .pe_restore_acc (pe_restore_acc),
+        .pe_done        (pe_done),
+        .store_req      (store_req),
+        .store_ack      (store_ack),
+        .ctx_save_req   (ctx_save_req),
+        .ctx_m          (ctx_m),
+        .ctx_n          (ctx_n),
+        .ctx_k          (ctx_k),
+        .ctx_acc        (ctx_acc),
+        .ctx_save_ack   (ctx_save_ack),
+        .busy           (busy),
+        .done           (done),
+        .preempted      (preempted)
+    );
+
+    top_pe #(
+        .SUBARRAY_ROWS (SUBARRAY_ROWS),
+        .SUBARRAY_COLS (SUBARRAY_COLS),
+        .INPUT_WIDTH   (INPUT_WIDTH),
+        .WEIGHT_WIDTH  (WEIGHT_WIDTH),
+        .OUTPUT_WIDTH  (OUTPUT_WIDTH),
+        .BUF_DEPTH     (BUF_DEPTH)
+    ) u_top_pe (
+        .clk             (clk),
+        .rst_n           (rst_n),
+        .start           (pe_start),
+        .clear_acc       (pe_clear_acc),
+        .restore_acc     (pe_restore_acc),
+        .busy            (),
+        .done            (pe_done),
+        .wbuf_bank       ('0),
+        .wbuf_wr_addr    (wbuf_wr_addr),
+        .wbuf_wr_data    (wbuf_wr_data),
+        .wbuf_wr_en      (wbuf_wr_en),
+        .ibuf_wr_addr    (ibuf_wr_addr),
+        .ibuf_wr_data    (ibuf_wr_data),
+        .ibuf_wr_en      (ibuf_wr_en),
+        .obuf_rd_addr    (obuf_rd_addr),
+        .obuf_rd_en      (obuf_rd_en),
+        .obuf_rd_data    (obuf_rd_data),
+        .chain_en        (1'b0),
+        .chain_ibuf_base ('0),
+        .rq_scale        ('0),
+        .rq_shift        ('0),
+        .rq_relu         (1'b0),
+        .chain_busy      (),
+        .stream_mode     (1'b0),
+        .stream_len      ('0),
+        .wstream_data    ('0),
+        .wstream_valid   (1'b0),
+        .wstream_ready   (),
+        .restore_data    (restore_data)
+    );
+
+    //-------------------------------------------------------------------------
+    // Clock Generation
+    //-------------------------------------------------------------------------
+    initial begin
+        clk = 0;
+        forever #(CLK_PERIOD/2) clk = ~clk;
+    end
+
+    //-------------------------------------------------------------------------
+    // DMA Model
+    //   Serves one request at a time: tile fetch (weight + input line, and
+    //   the saved line on restore), output store, context save
+    //-------------------------------------------------------------------------
+
+    // Output buffer line (HIGH_PERFORMANCE: 2-cycle latency)
+    task automatic read_obuf(output logic [OUTPUT_BUF_WIDTH-1:0] line);
+        @(posedge clk);
+        obuf_rd_addr <= '0;
+        obuf_rd_en   <= 1;
+        repeat(3) @(posedge clk);
+        obuf_rd_en   <= 0;
+        line = obuf_rd_data;
+    endtask
+
+    task automatic dma_fetch();
+        int m, n, k;
+        // The high-priority job computes the last tile of W/X with a
+        // different column, so every accumulator and buffer changes
+        m = hi_job ? M_TILES - 1 : int'(tile_m);
+        n = hi_job ? DIM_N - 1   : int'(tile_n);
+        k = hi_job ? K_TILES - 1 : int'(tile_k);
+
+        repeat(FETCH_CYCLES - 1) @(posedge clk);
+        for (int r = 0; r < SUBARRAY_ROWS; r++)
+            for (int c = 0; c < SUBARRAY_COLS; c++)
+                wbuf_wr_data[(r*SUBARRAY_COLS + c)*WEIGHT_WIDTH +: WEIGHT_WIDTH]
+                    <= ref_weight[(m*SUBARRAY_ROWS + r)*DIM_K + k*SUBARRAY_COLS + c];
+        for (int c = 0; c < SUBARRAY_COLS; c++)
+            ibuf_wr_data[c*INPUT_WIDTH +: INPUT_WIDTH] <= ref_input[(k*SUBARRAY_COLS + c)*DIM_N + n];
+        if (tile_restore)
+            restore_data <= saved_line;
+        wbuf_wr_addr <= '0;
+        ibuf_wr_addr <= '0;
+        wbuf_wr_en   <= 1;
+        ibuf_wr_en   <= 1;
+        tile_ack     <= 1;
+        @(posedge clk);
+        wbuf_wr_en   <= 0;
+        ibuf_wr_en   <= 0;
+        tile_ack     <= 0;
+    endtask
+
+    task automatic dma_store();
+        logic [OUTPUT_BUF_WIDTH-1:0] line;
+        int m, n;
+        m = int'(tile_m);
+        n = int'(tile_n);
+        read_obuf(line);
+        repeat(STORE_CYCLES - 4) @(posedge clk);
+        if (!hi_job)
+            for (int r = 0; r < SUBARRAY_ROWS; r++)
+                y_out[(m*SUBARRAY_ROWS + r)*DIM_N + n] = line[r*OUTPUT_WIDTH +: OUTPUT_WIDTH];
+        store_ack <= 1;
+        @(posedge clk);
+        store_ack <= 0;
+    endtask
+
+    task automatic dma_save();
+        saved_m = ctx_m;
+        saved_n = ctx_n;
+        saved_k = ctx_k;
+        if (ctx_acc) begin
+            read_obuf(saved_line);
+            repeat(SAVE_CYCLES - 4) @(posedge clk);
+        end else begin
+            repeat(SAVE_CYCLES / 2) @(posedge clk);   // Indices only
+        end
+        ctx_save_ack <= 1;
+        @(posedge clk);
+        ctx_save_ack <= 0;
+    endtask
+
+    initial begin
+        tile_ack     = 0;
+        store_ack    = 0;
+        ctx_save_ack = 0;
+        forever begin
+            @(negedge clk);
+            if (rst_n) begin
+                if (tile_req)          dma_fetch();
+                else if (store_req)    dma_store();
+                else if (ctx_save_req) dma_save();
+            end
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Tasks
+    //-------------------------------------------------------------------------
+
+    task automatic init_signals();
+        rst_n        = 0;
+        start        = 0;
+        resume       = 0;
+        preempt      = 0;
+        num_m_tiles  = IDX_WIDTH'(M_TILES);
+        num_n        = IDX_WIDTH'(DIM_N);
+        num_k_tiles  = IDX_WIDTH'(K_TILES);
+        resume_m     = '0;
+        resume_n     = '0;
+        resume_k     = '0;
+        wbuf_wr_addr = '0;
+        wbuf_wr_data = '0;
+        wbuf_wr_en   = 0;
+        ibuf_wr_addr = '0;
+        ibuf_wr_data = '0;
+        ibuf_wr_en   = 0;
+        obuf_rd_addr = '0;
+        obuf_rd_en   = 0;
+        restore_data = '0;
+        hi_job       = 0;
+        test_count   = 0;
+        pass_count   = 0;
+        fail_count   = 0;
+    endtask
+
+    task automatic do_reset();
+        @(posedge clk);
+        rst_n <= 0;
+        repeat(5) @(posedge clk);
+        rst_n <= 1;
+        repeat(2) @(posedge clk);
+    endtask
+
+    task automatic load_test_data();
+        $display("  Loading: %spreempt_test_weight.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "preempt_test_weight.hex"}, ref_weight);
+        $display("  Loading: %spreempt_test_input.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "preempt_test_input.hex"},  ref_input);
+        $display("  Loading: %spreempt_test_output.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "preempt_test_output.hex"}, ref_output);
+    endtask
+
+    // Start (or resume) and wait for done or preempted; cycles counted from
+    // the start pulse, preempt raised after preempt_at cycles (< 0: never)
+    task automatic run_job(logic do_resume, int preempt_at,
+                           output int cycles, output int latency, output logic was_preempted);
+        cycles        = 0;
+        latency       = -1;
+        was_preempted = 0;
+        @(posedge clk);
+        start  <= !do_resume;
+        resume <= do_resume;
+        @(posedge clk);
+        start  <= 0;
+        resume <= 0;
+        forever begin
+            if (cycles == preempt_at)
+                preempt <= 1;
+            @(posedge clk);
+            cycles++;
+            if (preempt && latency < 0)
+                latency = 0;
+            else if (latency >= 0)
+                latency++;
+            if (done) break;
+            if (preempted) begin
+                was_preempted = 1;
+                break;
+            end
+        end
+        preempt <= 0;
+    endtask
+
+    // High-priority job: one tile, its own store (not checked)
+    task automatic run_hi_job();
+        int cycles, latency;
+        logic p;
+        hi_job      = 1;
+        num_m_tiles = IDX_WIDTH'(1);
+        num_n       = IDX_WIDTH'(1);
+        num_k_tiles = IDX_WIDTH'(1);
+        run_job(1'b0, -1, cycles, latency, p);
+        hi_job      = 0;
+        num_m_tiles = IDX_WIDTH'(M_TILES);
+        num_n       = IDX_WIDTH'(DIM_N);
+        num_k_tiles = IDX_WIDTH'(K_TILES);
+    endtask
+
+    function automatic int check_y();
+        int errors;
+        errors = 0;
+        for (int i = 0; i < DIM_M*DIM_N; i++) begin
+            if (y_out[i] !== ref_output[i]) begin
+                if (errors < 4)
+                    $display("  Y[%0d][%0d] RTL=%0d REF=%0d", i / DIM_N, i % DIM_N,
+                             $signed(y_out[i]), $signed(ref_output[i]));
+                errors++;
+            end
+        end
+        return errors;
+    endfunction
+
+    task automatic clear_y();
+        for (int i = 0; i < DIM_M*DIM_N; i++)
+            y_out[i] = 'x;
+    endtask
+
+    //-------------------------------------------------------------------------
+    // Main Test Sequence
+    //-------------------------------------------------------------------------
+    initial begin
+        int   cycles, latency, job_cycles;
+        int   worst_latency, worst_offset, preemptions, bound;
+        logic was_preempted;
+
+        $display("");
+        $display("=============================================================");
+        $display("      tile_ctrl Preemption Testbench");
+        $display("=============================================================");
+        $display("  GEMM:        %0dx%0dx%0d (%0d tiles)", DIM_M, DIM_K, DIM_N,
+                 M_TILES * DIM_N * K_TILES);
+        $display("  DMA model:   fetch %0d, store %0d, save %0d cycles",
+                 FETCH_CYCLES, STORE_CYCLES, SAVE_CYCLES);
+        $display("  NUM_OFFSETS: %0d", NUM_OFFSETS);
+        $display("=============================================================");
+        $display("");
+
+        init_signals();
+
+        $display("--- Loading C Reference Data ---");
+        load_test_data();
+        $display("");
+
+        do_reset();
+
+        // Test 1: plain run
+        clear_y();
+        run_job(1'b0, -1, job_cycles, latency, was_preempted);
+        test_count++;
+        if (check_y() != 0 || was_preempted) begin
+            fail_count++;
+            $display("[FAIL] Plain run");
+        end else begin
+            pass_count++;
+            $display("[PASS] Plain run: %0d cycles", job_cycles);
+        end
+
+        // Test 2: preempt at every offset, high-priority job, resume
+        worst_latency = 0;
+        worst_offset  = 0;
+        preemptions   = 0;
+        for (int off = 0; off < NUM_OFFSETS; off++) begin
+            int errors;
+            clear_y();
+            run_job(1'b0, off, cycles, latency, was_preempted);
+            if (was_preempted) begin
+                preemptions++;
+                if (latency > worst_latency) begin
+                    worst_latency = latency;
+                    worst_offset  = off;
+                end
+                run_hi_job();
+                resume_m = saved_m;
+                resume_n = saved_n;
+                resume_k = saved_k;
+                run_job(1'b1, -1, cycles, latency, was_preempted);
+            end
+            errors = check_y();
+            test_count++;
+            if (errors != 0 || was_preempted) begin
+                fail_count++;
+                $display("[FAIL] Preempt @%0d: %0d output errors", off, errors);
+            end else begin
+                pass_count++;
+            end
+        end
+
+        // Worst case: preempt raised as a fetch starts on the last K tile of
+        // a column (fetch + compute + store + save), plus the request and
+        // handshake cycles of the controller
+        bound = FETCH_CYCLES + 16 + STORE_CYCLES + SAVE_CYCLES;
+        test_count++;
+        if (preemptions == 0 || worst_latency > bound) begin
+            fail_count++;
+            $display("[FAIL] Worst-case preemption latency %0d cycles (bound %0d)",
+                     worst_latency, bound);
+        end else begin
+            pass_count++;
+            $display("[PASS] %0d preemptions resumed correctly, worst-case latency %0d cycles (offset %0d, bound %0d)",
+                     preemptions, worst_latency, worst_offset, bound);
+        end
+
+        $display("");
+        $display("=============================================================");
+        $display("                    TEST SUMMARY");
+        $display("=============================================================");
+        $display("  Total tests:  %0d", test_count);
+        $display("  Passed:       %0d", pass_count);
+        $display("  Failed:       %0d", fail_count);
+        $display("=============================================================");
+
+        if (fail_count == 0) begin
+            $display("");
+            $display("  *** ALL TESTS PASSED ***");
+            $display("");
+        end
+
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Timeout Watchdog
+    //-------------------------------------------------------------------------
+    initial begin
+        #(CLK_PERIOD * 500000);
+        $display("");
+        $display("!!! SIMULATION TIMEOUT !!!");
+        $display("");
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Waveform Dump
+    //-------------------------------------------------------------------------
+    initial begin
+        $dumpfile("tile_ctrl_tb.vcd");
+        $dumpvars(0, tile_ctrl_tb);
+    end
+
+endmodule
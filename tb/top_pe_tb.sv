@@ -4,6 +4,9 @@
 // Description: top_pe integration verification
 //              Tests: single tile, K-tiling accumulation
 //              Uses C reference hex data for comparison
+//              HASH_COMPARE=1: compare each output tile against its FNV-1a
+//              hash (gemv_test_output_hash.hex); the full output dump is only
+//              loaded for element detail when a hash mismatches
 //-----------------------------------------------------------------------------
 
 module top_pe_tb;
@@ -19,6 +22,7 @@ module top_pe_tb;
     parameter int BUF_DEPTH     = 4;
     parameter int CLK_PERIOD    = 10;
     parameter int NUM_TESTS     = 20;
+    parameter bit HASH_COMPARE  = 1'b0;  // 1: pass/fail by per-tile hash
 
     parameter string DATA_PATH = "/home/yc/yc_npu/sw/ref/hex_data/";
 
@@ -59,6 +63,8 @@ module top_pe_tb;
     logic [INPUT_WIDTH-1:0]  ref_input  [0:NUM_TESTS*SUBARRAY_COLS-1];
     logic [WEIGHT_WIDTH-1:0] ref_weight [0:NUM_TESTS*SUBARRAY_ROWS*SUBARRAY_COLS-1];
     logic [OUTPUT_WIDTH-1:0] ref_output [0:NUM_TESTS*SUBARRAY_ROWS-1];
+    logic [31:0]             ref_output_hash [0:NUM_TESTS-1];  // One hash per tile
+    bit                      ref_output_loaded;
 
     //-------------------------------------------------------------------------
     // Test Variables
@@ -113,8 +119,10 @@ module top_pe_tb;
         .rst_n        (rst_n),
         .start        (start),
         .clear_acc    (clear_acc),
+        .restore_acc  (1'b0),
         .busy         (busy),
         .done         (done),
+        .wbuf_bank    ('0),
         .wbuf_wr_addr (wbuf_wr_addr),
         .wbuf_wr_data (wbuf_wr_data),
         .wbuf_wr_en   (wbuf_wr_en),
@@ -123,7 +131,19 @@ module top_pe_tb;
         .ibuf_wr_en   (ibuf_wr_en),
         .obuf_rd_addr (obuf_rd_addr),
         .obuf_rd_en   (obuf_rd_en),
-        .obuf_rd_data (obuf_rd_data)
+        .obuf_rd_data (obuf_rd_data),
+        .chain_en        (1'b0),
+        .chain_ibuf_base ('0),
+        .rq_scale        ('0),
+        .rq_shift        ('0),
+        .rq_relu         (1'b0),
+        .chain_busy      (),
+        .stream_mode     (1'b0),
+        .stream_len      ('0),
+        .wstream_data    ('0),
+        .wstream_valid   (1'b0),
+        .wstream_ready   (),
+        .restore_data    ('0)
     );
 
     //-------------------------------------------------------------------------
@@ -150,6 +170,7 @@ module top_pe_tb;
         ibuf_wr_en   = 0;
         obuf_rd_addr = '0;
         obuf_rd_en   = 0;
+        ref_output_loaded = 0;
         test_count   = 0;
         pass_count   = 0;
         fail_count   = 0;
@@ -234,10 +255,30 @@ module top_pe_tb;
         $readmemh({DATA_PATH, "gemv_test_input.hex"},  ref_input);
         $display("  Loading: %sgemv_test_weight.hex", DATA_PATH);
         $readmemh({DATA_PATH, "gemv_test_weight.hex"}, ref_weight);
-        $display("  Loading: %sgemv_test_output.hex", DATA_PATH);
-        $readmemh({DATA_PATH, "gemv_test_output.hex"}, ref_output);
+        if (HASH_COMPARE) begin
+            $display("  Loading: %sgemv_test_output_hash.hex", DATA_PATH);
+            $readmemh({DATA_PATH, "gemv_test_output_hash.hex"}, ref_output_hash);
+        end else begin
+            load_full_output();
+        end
+    endtask
+
+    // Full element dump: always in element mode, on demand in hash mode
+    task automatic load_full_output();
+        if (!ref_output_loaded) begin
+            $display("  Loading: %sgemv_test_output.hex", DATA_PATH);
+            $readmemh({DATA_PATH, "gemv_test_output.hex"}, ref_output);
+            ref_output_loaded = 1;
+        end
     endtask
 
+    //-------------------------------------------------------------------------
+    // Tile hash (matches ref_hash_u32 in sw/ref: FNV-1a over 32-bit words)
+    //-------------------------------------------------------------------------
+    function automatic logic [31:0] hash_word(logic [31:0] hash, logic [31:0] word);
+        return (hash ^ word) * 32'h01000193;
+    endfunction
+
     //-------------------------------------------------------------------------
     // Write weight matrix to weight buffer (pack into WEIGHT_BUF_WIDTH bits)
     //-------------------------------------------------------------------------
@@ -305,6 +346,7 @@ module top_pe_tb;
         int mismatch_found;
         logic [OUTPUT_WIDTH-1:0] rtl_val;
         logic [OUTPUT_WIDTH-1:0] ref_val;
+        logic [31:0]             rtl_hash;
 
         output_base    = test_idx * SUBARRAY_ROWS;
         mismatch_found = 0;
@@ -319,8 +361,21 @@ module top_pe_tb;
         @(posedge clk);  // Cycle 3: doutb valid
         obuf_rd_en <= 0;
 
+        // Hash mode: fold the tile into one word, element detail only on mismatch
+        if (HASH_COMPARE) begin
+            rtl_hash = 32'h811C9DC5;
+            for (int r = 0; r < SUBARRAY_ROWS; r++)
+                rtl_hash = hash_word(rtl_hash, obuf_rd_data[r*OUTPUT_WIDTH +: OUTPUT_WIDTH]);
+
+            if (rtl_hash !== ref_output_hash[test_idx]) begin
+                $display("  Test #%0d: hash mismatch RTL=0x%08X REF=0x%08X, loading element detail",
+                         test_idx, rtl_hash, ref_output_hash[test_idx]);
+                load_full_output();
+            end
+        end
+
         // Compare each output element
-        for (int r = 0; r < SUBARRAY_ROWS; r++) begin
+        for (int r = 0; r < SUBARRAY_ROWS && (!HASH_COMPARE || ref_output_loaded); r++) begin
             rtl_val = obuf_rd_data[r*OUTPUT_WIDTH +: OUTPUT_WIDTH];
             ref_val = ref_output[output_base + r];
 
@@ -338,6 +393,14 @@ module top_pe_tb;
             end
         end
 
+        // Hash mismatch with matching elements means the hash file is stale
+        if (HASH_COMPARE && ref_output_loaded && !mismatch_found &&
+            rtl_hash !== ref_output_hash[test_idx]) begin
+            fail_count++;
+            mismatch_found = 1;
+            $display("[FAIL] Test #%0d: elements match but hash differs (stale hash file?)", test_idx);
+        end
+
         if (!mismatch_found) begin
             pass_count++;
             $display("[PASS] Test #%0d", test_idx);
@@ -365,6 +428,7 @@ module top_pe_tb;
         $display("  INPUT_BUF_WIDTH:  %0d bits", INPUT_BUF_WIDTH);
         $display("  OUTPUT_BUF_WIDTH: %0d bits", OUTPUT_BUF_WIDTH);
         $display("  NUM_TESTS:     %0d", NUM_TESTS);
+        $display("  COMPARE:       %s", HASH_COMPARE ? "per-tile hash" : "element");
         $display("=============================================================");
         $display("");
 
@@ -404,6 +468,9 @@ module top_pe_tb;
         //=====================================================================
         $display("=== Test Group 2: K-Tiling Accumulation (2 tiles) ===");
 
+        // Expected sum is built from elements, so the full dump is needed
+        load_full_output();
+
         perf_start();
 
         // Load and compute first tile (clear accumulator)
@@ -0,0 +1,269 @@
+`timescale 1ns/1ps
+//-----------------------------------------------------------------------------
+// Testbench: topk_unit_tb
+// Description: topk_unit verification with C reference comparison
+//              topk_test_logits.hex holds TOPK_NUM_TESTS logit vectors; the
+//              first BEAT_LEN outputs of each are streamed as NUM_LANES-lane
+//              beats (last beat ragged), the rest fed through the pair port
+//              in reverse index order (arrival order must not matter)
+//              topk_test_idx.hex / topk_test_val.hex: expected sorted top-K
+//-----------------------------------------------------------------------------
+
+module topk_unit_tb;
+
+    //-------------------------------------------------------------------------
+    // Parameters
+    //-------------------------------------------------------------------------
+    parameter int NUM_LANES  = 32;
+    parameter int ACC_WIDTH  = 32;
+    parameter int IDX_WIDTH  = 32;
+    parameter int K          = 8;      // TOPK_TEST_K in sw/ref/main.c
+    parameter int CLK_PERIOD = 10;
+    parameter int NUM_TESTS  = 6;      // TOPK_NUM_TESTS
+    parameter int LEN        = 1000;   // TOPK_LEN
+    parameter int BEAT_LEN   = 790;    // TOPK_BEAT_LEN
+
+    parameter string DATA_PATH = "/home/yc/yc_npu/sw/ref/hex_data/";
+
+    localparam int LANE_WIDTH = $clog2(NUM_LANES+1);
+
+    //-------------------------------------------------------------------------
+    // DUT Signals
+    //-------------------------------------------------------------------------
+    logic                                clk;
+    logic                                rst_n;
+    logic                                clear;
+    logic [NUM_LANES-1:0][ACC_WIDTH-1:0] in_data;
+    logic [IDX_WIDTH-1:0]                in_base;
+    logic [LANE_WIDTH-1:0]               in_lanes;
+    logic                                in_valid;
+    logic                                in_ready;
+    logic [IDX_WIDTH-1:0]                pair_idx;
+    logic [ACC_WIDTH-1:0]                pair_val;
+    logic                                pair_valid;
+    logic                                pair_ready;
+    logic [K-1:0][IDX_WIDTH-1:0]         top_idx;
+    logic [K-1:0][ACC_WIDTH-1:0]         top_val;
+    logic [K-1:0]                        top_vld;
+    logic                                busy;
+
+    //-------------------------------------------------------------------------
+    // Reference Data Memory
+    //-------------------------------------------------------------------------
+    logic [31:0] ref_logits [0:NUM_TESTS*LEN-1];
+    logic [31:0] ref_idx    [0:NUM_TESTS*K-1];
+    logic [31:0] ref_val    [0:NUM_TESTS*K-1];
+
+    //-------------------------------------------------------------------------
+    // Test Variables
+    //-------------------------------------------------------------------------
+    int test_count;
+    int pass_count;
+    int fail_count;
+
+    //-------------------------------------------------------------------------
+    // DUT Instance
+    //-------------------------------------------------------------------------
+    topk_unit #(
+        .NUM_LANES (NUM_LANES),
+        .ACC_WIDTH (ACC_WIDTH),
+        .IDX_WIDTH (IDX_WIDTH),
+        .K         (K)
+    ) dut (
+        .clk        (clk),
+        .rst_n      (rst_n),
+        .clear      (clear),
+        .in_data    (in_data),
+        .in_base    (in_base),
+        .in_lanes   (in_lanes),
+        .in_valid   (in_valid),
+        .in_ready   (in_ready),
+        .pair_idx   (pair_idx),
+        .pair_val   (pair_val),
+        .pair_valid (pair_valid),
+        .pair_ready (pair_ready),
+        .top_idx    (top_idx),
+        .top_val    (top_val),
+        .top_vld    (top_vld),
+        .busy       (busy)
+    );
+
+    //-------------------------------------------------------------------------
+    // Clock Generation
+    //-------------------------------------------------------------------------
+    initial begin
+        clk = 0;
+        forever #(CLK_PERIOD/2) clk = ~clk;
+    end
+
+    //-------------------------------------------------------------------------
+    // Tasks
+    //-------------------------------------------------------------------------
+
+    task automatic init_signals();
+        rst_n      = 0;
+        clear      = 0;
+        in_data    = '0;
+        in_base    = '0;
+        in_lanes   = '0;
+        in_valid   = 0;
+        pair_idx   = '0;
+        pair_val   = '0;
+        pair_valid = 0;
+        test_count = 0;
+        pass_count = 0;
+        fail_count = 0;
+    endtask
+
+    task automatic do_reset();
+        @(posedge clk);
+        rst_n <= 0;
+        repeat(5) @(posedge clk);
+        rst_n <= 1;
+        repeat(2) @(posedge clk);
+    endtask
+
+    task automatic load_test_data();
+        $display("  Loading: %stopk_test_logits.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "topk_test_logits.hex"}, ref_logits);
+        $display("  Loading: %stopk_test_idx.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "topk_test_idx.hex"},    ref_idx);
+        $display("  Loading: %stopk_test_val.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "topk_test_val.hex"},    ref_val);
+    endtask
+
+    // One test: beats, then pairs; returns cycles from first beat to idle
+    // (ready is sampled at the falling edge, the handshake completes on the
+    // following rising edge)
+    task automatic run_test(int t, output int cycles);
+        cycles = 0;
+
+        @(posedge clk);
+        clear <= 1;
+        @(posedge clk);
+        clear <= 0;
+
+        for (int base = 0; base < BEAT_LEN; base += NUM_LANES) begin
+            int lanes;
+            lanes = (BEAT_LEN - base < NUM_LANES) ? BEAT_LEN - base : NUM_LANES;
+            for (int l = 0; l < NUM_LANES; l++)
+                in_data[l] <= (l < lanes) ? ref_logits[t*LEN + base + l] : '0;
+            in_base  <= IDX_WIDTH'(base);
+            in_lanes <= LANE_WIDTH'(lanes);
+            in_valid <= 1;
+            @(negedge clk);
+            while (!in_ready) begin
+                @(negedge clk);
+                cycles++;
+            end
+            @(posedge clk);
+            cycles++;
+        end
+        in_valid <= 0;
+
+        for (int i = LEN - 1; i >= BEAT_LEN; i--) begin
+            pair_idx   <= IDX_WIDTH'(i);
+            pair_val   <= ref_logits[t*LEN + i];
+            pair_valid <= 1;
+            @(negedge clk);
+            while (!pair_ready) begin
+                @(negedge clk);
+                cycles++;
+            end
+            @(posedge clk);
+            cycles++;
+        end
+        pair_valid <= 0;
+
+        @(negedge clk);
+        while (busy) begin
+            @(negedge clk);
+            cycles++;
+        end
+    endtask
+
+    task automatic check_result(int t);
+        test_count++;
+        for (int i = 0; i < K; i++) begin
+            if (!top_vld[i] || top_idx[i] !== ref_idx[t*K + i] ||
+                top_val[i] !== ref_val[t*K + i]) begin
+                fail_count++;
+                $display("[FAIL] Test #%0d entry %0d: RTL=(%0d, %0d) REF=(%0d, %0d)",
+                         t, i, top_idx[i], $signed(top_val[i]),
+                         ref_idx[t*K + i], $signed(ref_val[t*K + i]));
+                return;
+            end
+        end
+        pass_count++;
+        $display("[PASS] Test #%0d: top-1 = (%0d, %0d)",
+                 t, top_idx[0], $signed(top_val[0]));
+    endtask
+
+    //-------------------------------------------------------------------------
+    // Main Test Sequence
+    //-------------------------------------------------------------------------
+    initial begin
+        int cycles;
+
+        $display("");
+        $display("=============================================================");
+        $display("      topk_unit Testbench");
+        $display("=============================================================");
+        $display("  K:         %0d", K);
+        $display("  NUM_LANES: %0d", NUM_LANES);
+        $display("  NUM_TESTS: %0d (%0d outputs, %0d as beats)", NUM_TESTS, LEN, BEAT_LEN);
+        $display("=============================================================");
+        $display("");
+
+        init_signals();
+
+        $display("--- Loading C Reference Data ---");
+        load_test_data();
+        $display("");
+
+        do_reset();
+
+        for (int t = 0; t < NUM_TESTS; t++) begin
+            run_test(t, cycles);
+            check_result(t);
+        end
+        $display("  Last test: %0d outputs in %0d cycles", LEN, cycles);
+
+        $display("");
+        $display("=============================================================");
+        $display("                    TEST SUMMARY");
+        $display("=============================================================");
+        $display("  Total tests:  %0d", test_count);
+        $display("  Passed:       %0d", pass_count);
+        $display("  Failed:       %0d", fail_count);
+        $display("=============================================================");
+
+        if (fail_count == 0) begin
+            $display("");
+            $display("  *** ALL TESTS PASSED ***");
+            $display("");
+        end
+
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Timeout Watchdog
+    //-------------------------------------------------------------------------
+    initial begin
+        #(CLK_PERIOD * 20000);
+        $display("");
+        $display("!!! SIMULATION TIMEOUT !!!");
+        $display("");
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Waveform Dump
+    //-------------------------------------------------------------------------
+    initial begin
+        $dumpfile("topk_unit_tb.vcd");
+        $dumpvars(0, topk_unit_tb);
+    end
+
+endmodule
@@ -0,0 +1,324 @@
+`timescale 1ns/1ps
+//-----------------------------------------------------------------------------
+// Testbench: trace_unit_tb
+// Description: trace_unit verification with C reference comparison
+//              trace_test_valid.hex / trace_test_arg.hex hold one random
+//              event stream (NUM_CYCLES cycles), replayed in two configs:
+//              1. wrapping ring, STALL filtered out
+//              2. stop when full, trigger on MARK
+//              Each run is checked against ref_trace_unit(): the ring over
+//              the read port (trace_test_ring_N.hex), TRACE_STATUS and the
+//              drop counter (trace_test_status_N.hex)
+//              Run 1 is also written to trace_dump.hex (TRACE_STATUS,
+//              TRACE_DROP, then ts/evt per entry) and the filtered events
+//              it drives to trace_sim.txt, in the timeline format of
+//                npu_ref --trace-decode trace_dump.hex
+//-----------------------------------------------------------------------------
+
+module trace_unit_tb;
+
+    //-------------------------------------------------------------------------
+    // Parameters
+    //-------------------------------------------------------------------------
+    parameter int NUM_EVENTS  = 8;
+    parameter int DEPTH       = 64;      // TRACE_TEST_DEPTH in sw/ref/main.c
+    parameter int NUM_CYCLES  = 600;     // TRACE_TEST_CYCLES
+    parameter int ARG_WIDTH   = 24;
+    parameter int TS_WIDTH    = 32;
+    parameter int CLK_PERIOD  = 10;
+
+    parameter string DATA_PATH = "/home/yc/yc_npu/sw/ref/hex_data/";
+
+    localparam int IDX_WIDTH = $clog2(DEPTH);
+    localparam int EV_STALL  = 5;        // npu_pkg TRACE_EV_*
+    localparam int EV_MARK   = 7;
+
+    localparam string EV_NAME [NUM_EVENTS] = '{
+        "JOB_START", "JOB_END  ", "TILE     ", "DMA_RD   ",
+        "DMA_WR   ", "STALL    ", "PREEMPT  ", "MARK     "
+    };
+
+    //-------------------------------------------------------------------------
+    // DUT Signals
+    //-------------------------------------------------------------------------
+    logic                                 clk;
+    logic                                 rst_n;
+    logic                                 enable;
+    logic                                 clear;
+    logic                                 stop_full;
+    logic                                 trig_en;
+    logic [$clog2(NUM_EVENTS)-1:0]        trig_event;
+    logic [NUM_EVENTS-1:0]                filter;
+    logic [NUM_EVENTS-1:0]                ev_valid;
+    logic [NUM_EVENTS-1:0][ARG_WIDTH-1:0] ev_arg;
+    logic [IDX_WIDTH-1:0]                 wr_ptr;
+    logic                                 wrapped;
+    logic                                 triggered;
+    logic                                 stopped;
+    logic [31:0]                          dropped;
+    logic [IDX_WIDTH-1:0]                 rd_idx;
+    logic [TS_WIDTH-1:0]                  rd_ts;
+    logic [31:0]                          rd_evt;
+
+    //-------------------------------------------------------------------------
+    // Reference Data Memory
+    //-------------------------------------------------------------------------
+    logic [7:0]  stim_valid [0:NUM_CYCLES-1];
+    logic [31:0] stim_arg   [0:NUM_CYCLES*NUM_EVENTS-1];
+    logic [31:0] ref_ring   [0:2*DEPTH-1];
+    logic [31:0] ref_status [0:1];
+
+    //-------------------------------------------------------------------------
+    // Test Variables
+    //-------------------------------------------------------------------------
+    int test_count;
+    int pass_count;
+    int fail_count;
+    int sim_fd;       // trace_sim.txt while non-zero
+    int cycle;        // Timestamp of the events being driven
+
+    //-------------------------------------------------------------------------
+    // DUT Instance
+    //-------------------------------------------------------------------------
+    trace_unit #(
+        .NUM_EVENTS (NUM_EVENTS),
+        .DEPTH      (DEPTH),
+        .ARG_WIDTH  (ARG_WIDTH),
+        .TS_WIDTH   (TS_WIDTH)
+    ) dut (
+        .clk        (clk),
+        .rst_n      (rst_n),
+        .enable     (enable),
+        .clear      (clear),
+        .stop_full  (stop_full),
+        .trig_en    (trig_en),
+        .trig_event (trig_event),
+        .filter     (filter),
+        .ev_valid   (ev_valid),
+        .ev_arg     (ev_arg),
+        .wr_ptr     (wr_ptr),
+        .wrapped    (wrapped),
+        .triggered  (triggered),
+        .stopped    (stopped),
+        .dropped    (dropped),
+        .rd_idx     (rd_idx),
+        .rd_ts      (rd_ts),
+        .rd_evt     (rd_evt)
+    );
+
+    //-------------------------------------------------------------------------
+    // Clock Generation
+    //-------------------------------------------------------------------------
+    initial begin
+        clk = 0;
+        forever #(CLK_PERIOD/2) clk = ~clk;
+    end
+
+    //-------------------------------------------------------------------------
+    // Event Monitor (driven events that pass the filter, timeline format)
+    //-------------------------------------------------------------------------
+    always @(posedge clk) begin
+        if (sim_fd != 0 && enable) begin
+            for (int e = 0; e < NUM_EVENTS; e++) begin
+                if (ev_valid[e] && filter[e])
+                    $fdisplay(sim_fd, "%10d  %s  0x%06h", cycle, EV_NAME[e], ev_arg[e]);
+            end
+        end
+    end
+
+    //-------------------------------------------------------------------------
+    // Tasks
+    //-------------------------------------------------------------------------
+
+    task automatic init_signals();
+        rst_n      = 0;
+        enable     = 0;
+        clear      = 0;
+        stop_full  = 0;
+        trig_en    = 0;
+        trig_event = '0;
+        filter     = '1;
+        ev_valid   = '0;
+        ev_arg     = '0;
+        rd_idx     = '0;
+        test_count = 0;
+        pass_count = 0;
+        fail_count = 0;
+        sim_fd     = 0;
+        cycle      = 0;
+    endtask
+
+    task automatic do_reset();
+        @(posedge clk);
+        rst_n <= 0;
+        repeat(5) @(posedge clk);
+        rst_n <= 1;
+        repeat(2) @(posedge clk);
+    endtask
+
+    task automatic load_test_data();
+        $display("  Loading: %strace_test_valid.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "trace_test_valid.hex"}, stim_valid);
+        $display("  Loading: %strace_test_arg.hex", DATA_PATH);
+        $readmemh({DATA_PATH, "trace_test_arg.hex"},   stim_arg);
+    endtask
+
+    // Clear + enable, then cycle c's events are sampled with timestamp c;
+    // idle cycles at the end drain the pending slots
+    task automatic run_stream();
+        enable <= 1;
+        clear  <= 1;
+        @(posedge clk);
+        clear  <= 0;
+        for (int c = 0; c < NUM_CYCLES; c++) begin
+            cycle    <= c;
+            ev_valid <= stim_valid[c];
+            for (int e = 0; e < NUM_EVENTS; e++)
+                ev_arg[e] <= stim_arg[c*NUM_EVENTS + e][ARG_WIDTH-1:0];
+            @(posedge clk);
+        end
+        ev_valid <= '0;
+        repeat(NUM_EVENTS + 2) @(posedge clk);
+    endtask
+
+    // Read entry i over the read port (1-cycle latency)
+    task automatic read_entry(int i, output logic [31:0] ts, output logic [31:0] evt);
+        rd_idx <= IDX_WIDTH'(i);
+        @(posedge clk);
+        @(negedge clk);
+        ts  = rd_ts;
+        evt = rd_evt;
+    endtask
+
+    task automatic check_run(int run, string name);
+        logic [31:0] status, ts, evt;
+        int          entries, errors, dump_fd;
+
+        $display("  Loading: %strace_test_ring_%0d.hex", DATA_PATH, run);
+        $readmemh($sformatf("%strace_test_ring_%0d.hex", DATA_PATH, run),   ref_ring);
+        $readmemh($sformatf("%strace_test_status_%0d.hex", DATA_PATH, run), ref_status);
+
+        status = {13'b0, stopped, triggered, wrapped, 16'(wr_ptr)};
+        test_count++;
+        if (status !== ref_status[0] || dropped !== ref_status[1]) begin
+            fail_count++;
+            $display("[FAIL] %s: status RTL=0x%08h drop=%0d REF=0x%08h drop=%0d",
+                     name, status, dropped, ref_status[0], ref_status[1]);
+        end else begin
+            pass_count++;
+            $display("[PASS] %s: wr_ptr=%0d wrapped=%0b triggered=%0b stopped=%0b dropped=%0d",
+                     name, wr_ptr, wrapped, triggered, stopped, dropped);
+        end
+
+        dump_fd = (run == 1) ? $fopen("trace_dump.hex", "w") : 0;
+        if (dump_fd != 0) begin
+            $fdisplay(dump_fd, "%08h", status);
+            $fdisplay(dump_fd, "%08h", dropped);
+        end
+
+        entries = wrapped ? DEPTH : int'(wr_ptr);
+        errors  = 0;
+        for (int i = 0; i < DEPTH; i++) begin
+            read_entry(i, ts, evt);
+            if (dump_fd != 0) begin
+                $fdisplay(dump_fd, "%08h", ts);
+                $fdisplay(dump_fd, "%08h", evt);
+            end
+            if (i < entries && (ts !== ref_ring[2*i] || evt !== ref_ring[2*i+1])) begin
+                if (errors < 8)
+                    $display("  Entry %0d: RTL=(%0d, 0x%08h) REF=(%0d, 0x%08h)",
+                             i, ts, evt, ref_ring[2*i], ref_ring[2*i+1]);
+                errors++;
+            end
+        end
+        if (dump_fd != 0)
+            $fclose(dump_fd);
+
+        test_count++;
+        if (errors != 0) begin
+            fail_count++;
+            $display("[FAIL] %s: %0d of %0d ring entries differ", name, errors, entries);
+        end else begin
+            pass_count++;
+            $display("[PASS] %s: %0d ring entries match", name, entries);
+        end
+    endtask
+
+    //-------------------------------------------------------------------------
+    // Main Test Sequence
+    //-------------------------------------------------------------------------
+    initial begin
+        $display("");
+        $display("=============================================================");
+        $display("      trace_unit Testbench");
+        $display("=============================================================");
+        $display("  NUM_EVENTS: %0d", NUM_EVENTS);
+        $display("  DEPTH:      %0d", DEPTH);
+        $display("  NUM_CYCLES: %0d", NUM_CYCLES);
+        $display("=============================================================");
+        $display("");
+
+        init_signals();
+
+        $display("--- Loading C Reference Data ---");
+        load_test_data();
+        $display("");
+
+        do_reset();
+
+        // Run 1: wrapping ring, STALL filtered out
+        filter    <= ~(NUM_EVENTS'(1) << EV_STALL);
+        stop_full <= 0;
+        trig_en   <= 0;
+        sim_fd     = $fopen("trace_sim.txt", "w");
+        run_stream();
+        $fclose(sim_fd);
+        sim_fd     = 0;
+        check_run(1, "Wrap + filter");
+
+        // Run 2: stop when full, nothing before the first MARK
+        filter     <= '1;
+        stop_full  <= 1;
+        trig_en    <= 1;
+        trig_event <= EV_MARK;
+        run_stream();
+        check_run(2, "Stop-full + trigger");
+
+        $display("");
+        $display("=============================================================");
+        $display("                    TEST SUMMARY");
+        $display("=============================================================");
+        $display("  Total tests:  %0d", test_count);
+        $display("  Passed:       %0d", pass_count);
+        $display("  Failed:       %0d", fail_count);
+        $display("=============================================================");
+
+        if (fail_count == 0) begin
+            $display("");
+            $display("  *** ALL TESTS PASSED ***");
+            $display("");
+        end
+
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Timeout Watchdog
+    //-------------------------------------------------------------------------
+    initial begin
+        #(CLK_PERIOD * 10000);
+        $display("");
+        $display("!!! SIMULATION TIMEOUT !!!");
+        $display("");
+        $finish;
+    end
+
+    //-------------------------------------------------------------------------
+    // Waveform Dump
+    //-------------------------------------------------------------------------
+    initial begin
+        $dumpfile("trace_unit_tb.vcd");
+        $dumpvars(0, trace_unit_tb);
+    end
+
+endmodule